@@ -19,6 +19,7 @@
 #pragma once
 
 #include <unity/scopes/OperationInfo.h>
+#include <unity/scopes/QueryTimings.h>
 
 #include <memory>
 #include <string>
@@ -106,8 +107,24 @@ public:
     */
     std::vector<OperationInfo> info_list() const;
 
+    /**
+    \brief Check whether the run-time measured the query.
+
+    The details passed to ListenerBase::finished() by the run-time contain timings;
+    details created by application code do not.
+    \return True if timings() returns the measurements for the query.
+    */
+    bool has_timings() const noexcept;
+
+    /**
+    \brief Get the latency breakdown for the query.
+    \return The timings for the query. If has_timings() is false, all times and counts are zero.
+    */
+    QueryTimings timings() const;
+
 private:
     std::unique_ptr<internal::CompletionDetailsImpl> p;
+    friend class internal::CompletionDetailsImpl;
 };
 
 /**
@@ -94,6 +94,22 @@ public:
     */
     bool valid() const;
 
+    /**
+    \brief Returns a file descriptor that becomes readable when this query is cancelled.
+
+    The descriptor becomes readable when the query originator cancels the query, or when the
+    query exceeds its deadline (see SearchMetadata::deadline()). This allows code that blocks
+    in `poll()`, `select()`, or an event loop to find out about cancellation immediately,
+    instead of polling valid() or signalling its own threads from cancelled().
+
+    Once readable, the descriptor remains readable; do not read from it. The descriptor is owned
+    by the query and remains open until the query is destroyed; do not close it.
+
+    \return A file descriptor for the query's cancellation state.
+    \throws unity::SyscallException if the file descriptor cannot be created.
+    */
+    int cancel_fd() const;
+
     /**
     \brief Returns a dictionary with the scope's current settings.
 
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+class QueryTimingsImpl;
+
+}
+
+/**
+\brief A breakdown of where the time went for a query.
+
+The run-time measures each query and passes the measurements to ListenerBase::finished()
+with the CompletionDetails (see CompletionDetails::timings()).
+All times are relative to the point at which the query was started by the client
+(for example, by calling Scope::search()). Times measured by the scope are taken
+with the system clock; they are accurate provided that the client and the scope
+run on the same machine.
+
+For an aggregator, subqueries() returns the timings for the subsearches of the query,
+so a client can find out which child scopes were slow.
+*/
+
+class QueryTimings final
+{
+public:
+    /**
+    \brief Create QueryTimings with all times and counts set to zero.
+    */
+    QueryTimings();
+
+    /**@name Copy and assignment
+    Copy and assignment operators (move and non-move versions) have the usual value semantics.
+    */
+    //{@
+    QueryTimings(QueryTimings const& other);
+    QueryTimings(QueryTimings&&);
+
+    QueryTimings& operator=(QueryTimings const& other);
+    QueryTimings& operator=(QueryTimings&&);
+    //@}
+
+    /// @cond
+    ~QueryTimings();
+    /// @endcond
+
+    /**
+    \brief Get the ID of the scope that ran the query.
+    \return The scope ID, or the empty string if the scope did not run the query.
+    */
+    std::string scope_id() const;
+
+    /**
+    \brief Get the time it took to send the query to the scope.
+    \return The time until the scope had accepted the query.
+    */
+    std::chrono::microseconds send_time() const;
+
+    /**
+    \brief Get the time until the scope started running the query.
+    \return The time until the scope's `run()` method was called, or zero if it wasn't called.
+    */
+    std::chrono::microseconds run_start() const;
+
+    /**
+    \brief Get the time until the first push from the scope arrived.
+    \return The time until the first push, or zero if the scope did not push anything.
+    */
+    std::chrono::microseconds first_push() const;
+
+    /**
+    \brief Get the time until the last push from the scope arrived.
+    \return The time until the last push, or zero if the scope did not push anything.
+    */
+    std::chrono::microseconds last_push() const;
+
+    /**
+    \brief Get the time until the query completed.
+    \return The time until the query's `finished()` arrived.
+    */
+    std::chrono::microseconds total() const;
+
+    /**
+    \brief Get the number of results that were received for the query.
+    \return The number of results (not counting categories, departments, and so on).
+    */
+    std::size_t result_count() const;
+
+    /**
+    \brief Get the number of bytes that the scope sent for the query's pushes.
+    \return The size of the push messages, or zero if the scope runs in the same process as the client.
+    */
+    std::size_t byte_count() const;
+
+    /**
+    \brief Get the timings of the subsearches of the query.
+
+    Only subsearches that completed before the query completed are included.
+    \return The timings for each subsearch, in the order in which the subsearches completed.
+    */
+    std::vector<QueryTimings> subqueries() const;
+
+private:
+    QueryTimings(internal::QueryTimingsImpl* impl);
+    std::unique_ptr<internal::QueryTimingsImpl> p;
+    friend class internal::QueryTimingsImpl;
+};
+
+} // namespace scopes
+
+} // namespace unity
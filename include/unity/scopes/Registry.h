@@ -25,6 +25,7 @@
 #include <unity/scopes/ScopeMetadata.h>
 
 #include <map>
+#include <set>
 
 namespace unity
 {
@@ -102,6 +103,34 @@ public:
     */
     virtual core::ScopedConnection set_list_update_callback(std::function<void()> callback) = 0;
 
+    // find_by_keywords() and children_of() must remain after all older virtual functions,
+    // so that existing binaries keep their vtable slots.
+
+    /**
+    \brief Returns a map containing only those scopes that have at least one of the given keywords.
+
+    The registry maintains an index of scope keywords, so this is considerably cheaper
+    than calling list() and filtering the keywords of each scope. (The default implementation
+    uses list_if().)
+    \param keywords The keywords to search for.
+    \return The metadata items of all scopes that have at least one of the keywords.
+    */
+    virtual MetadataMap find_by_keywords(std::set<std::string> const& keywords);
+
+    /**
+    \brief Returns a map containing the scopes aggregated by the given aggregator.
+
+    The returned map contains the scopes listed in the aggregator's child scope IDs and,
+    if the aggregator is a keyword aggregator (see ScopeMetadata::is_aggregator()), all
+    scopes that have at least one of the aggregator's keywords. The aggregator itself is not included.
+    Child scope IDs that are unknown to the registry are ignored. (The default implementation
+    uses get_metadata() and find_by_keywords().)
+    \param scope_id The ID of the aggregator.
+    \return The metadata items of the aggregated scopes.
+    \throws NotFoundException if no scope with the given ID exists.
+    */
+    virtual MetadataMap children_of(std::string const& scope_id);
+
 protected:
     /// @cond
     Registry();
@@ -23,6 +23,7 @@
 #include <unity/scopes/Variant.h>
 #include <unity/util/DefinesPtrs.h>
 
+#include <chrono>
 #include <set>
 
 namespace unity
@@ -135,6 +136,40 @@ public:
     */
     bool is_aggregated() const;
 
+    /**
+    \brief Set the deadline for this search request.
+
+    The deadline is the point in time by which the client no longer has use for results.
+    Once the deadline passes, the scopes runtime cancels the query in the receiving scope.
+    The deadline is carried in the "deadline" hint (as milliseconds since the epoch), and
+    subsearch() forwards it to child scopes, less a safety margin for each hop.
+    \param deadline The absolute deadline.
+    */
+    void set_deadline(std::chrono::system_clock::time_point deadline);
+
+    /**
+    \brief Get the deadline for this search request.
+    \return The absolute deadline.
+    \throws unity::NotFoundException if the request has no deadline.
+    */
+    std::chrono::system_clock::time_point deadline() const;
+
+    /**
+    \brief Check if this search request has a deadline.
+    \return True if there is a deadline.
+    */
+    bool has_deadline() const;
+
+    /**
+    \brief Get the time left until the deadline for this search request expires.
+
+    Scopes can use this to decide how much work is worth doing for a query, for example,
+    by skipping a slow data source if the remaining budget is too small.
+    \return The time until the deadline, or zero if the deadline has passed already.
+    \throws unity::NotFoundException if the request has no deadline.
+    */
+    std::chrono::milliseconds remaining_time() const;
+
     /**
     \brief Sets a hint.
 
@@ -200,7 +200,7 @@ private:
     Variant(internal::NullVariant const&);
 
     std::unique_ptr<internal::VariantImpl> p;
-    friend class VariantImpl;
+    friend struct internal::VariantImpl;
 };
 
 /**
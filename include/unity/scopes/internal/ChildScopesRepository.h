@@ -22,9 +22,17 @@
 #include <unity/scopes/internal/Logger.h>
 #include <unity/util/NonCopyable.h>
 
+#include <condition_variable>
+#include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
 
 namespace unity
 {
@@ -37,6 +45,12 @@ namespace internal
 
 typedef std::map<std::string, bool> ChildScopeEnabledMap;
 
+// Keeps the contents of the repository in memory. The file is only re-read if it was
+// modified by someone else, and only re-written if the list of child scopes changes.
+// Writes replace the file atomically. Writes caused by child_scopes() happen in the
+// background; writes caused by set_child_scopes() happen immediately, so the caller
+// learns whether they succeeded.
+
 class ChildScopesRepository
 {
 public:
@@ -44,23 +58,53 @@ public:
 
     ChildScopesRepository(std::string const& repo_file_path,
                           unity::scopes::internal::Logger& logger);
+    ~ChildScopesRepository();
 
     ChildScopeList child_scopes(ChildScopeList const& child_scopes_defaulted);
     bool set_child_scopes(ChildScopeList const& child_scopes);
 
 private:
-    bool write_repo(ChildScopeList const& child_scopes_list);
-    ChildScopeEnabledMap read_repo();
+    typedef std::vector<std::pair<std::string, bool>> Entries;  // (id, enabled) in file order
+
+    struct FileStamp
+    {
+        bool exists = false;
+        ::timespec mtime = {0, 0};
+        ::ino_t inode = 0;
+        ::off_t size = 0;
+
+        bool operator==(FileStamp const& other) const;
+    };
 
-    std::string list_to_json(ChildScopeList const& child_scopes_list);
-    ChildScopeEnabledMap json_to_list(std::string const& child_scopes_json);
+    static Entries to_entries(ChildScopeList const& child_scopes_list);
+    FileStamp stamp() const;
+    void update_cache(Entries const& entries);
+
+    bool write_repo(std::string const& json, uint64_t seq);
+    void writer_thread();
+    ChildScopeEnabledMap const& read_repo();
+
+    std::string list_to_json(Entries const& entries);
+    Entries json_to_list(std::string const& child_scopes_json);
 
     std::string const repo_file_path_;
     unity::scopes::internal::Logger& logger_;
 
-    std::mutex mutex_;
-    ChildScopeEnabledMap cached_repo_;
+    std::mutex mutex_;                   // Protects everything below, except write_mutex_
+    ChildScopeEnabledMap cached_repo_;   // Enabled state of each child scope in the repo
+    Entries cached_entries_;             // Repo contents, including pending writes
     bool have_latest_cache_;
+    FileStamp file_stamp_;               // File state that the cache was read from or written to
+
+    uint64_t write_seq_;                 // Incremented for each write
+    std::unique_ptr<std::string> pending_json_;
+    uint64_t pending_seq_;
+    std::condition_variable cond_;
+    std::thread writer_;
+    bool stopping_;
+
+    std::mutex write_mutex_;             // Serializes writes to the file
+    uint64_t written_seq_;               // Most recent write that made it to the file (protected by write_mutex_)
 };
 
 } // namespace internal
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <unity/scopes/CompletionDetails.h>
+#include <unity/scopes/internal/QueryTimingsImpl.h>
 
 namespace unity
 {
@@ -45,11 +46,22 @@ public:
     std::string message() const;
     void add_info(OperationInfo const& info);
     std::vector<OperationInfo> info_list() const;
+    bool has_timings() const noexcept;
+    QueryTimings timings() const;
+
+    // Timings travel with the details from the scope to the client's ReplyObject, which
+    // completes them before passing the details to the application.
+    QueryTimingsImpl const* timings_impl() const noexcept;  // nullptr if no timings were set
+    void set_timings(QueryTimingsImpl const& timings);
+
+    static CompletionDetailsImpl* impl(CompletionDetails& details) noexcept;
+    static CompletionDetailsImpl const* impl(CompletionDetails const& details) noexcept;
 
 private:
     CompletionDetails::CompletionStatus status_;
     std::string message_;
     std::vector<OperationInfo> info_list_;
+    std::shared_ptr<QueryTimingsImpl> timings_;  // Shared because details are copied along the way
 };
 
 } // namespace internal
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/util/DefinesPtrs.h>
+#include <unity/util/NonCopyable.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+class DeadlineMonitor;
+
+// Returned by DeadlineMonitor::add(). cancel() removes the deadline *without* invoking the callback.
+// Letting a DeadlineItem go out of scope implicitly calls cancel().
+//
+// As for ReapItem, by the time cancel() returns, the callback either has completed already, or
+// will not happen at all. (If cancel() is called by the callback itself, it returns immediately.)
+// This allows a callback to refer to the object that owns the DeadlineItem.
+//
+// It is safe to call cancel() after the DeadlineMonitor has gone out of scope.
+
+class DeadlineItem final
+{
+public:
+    NONCOPYABLE(DeadlineItem);
+    UNITY_DEFINES_PTRS(DeadlineItem);
+
+    void cancel() noexcept;
+    ~DeadlineItem();
+
+private:
+    DeadlineItem(std::weak_ptr<DeadlineMonitor> const& monitor, uint64_t id);  // Only DeadlineMonitor can instantiate
+
+    std::weak_ptr<DeadlineMonitor> monitor_;
+    uint64_t id_;
+
+    friend class DeadlineMonitor;
+};
+
+// Invokes a callback once an absolute deadline has passed. The Reaper is no good for this
+// because it works with a fixed expiry interval and a granularity of seconds, whereas query
+// deadlines are arbitrary points in time with millisecond precision.
+//
+// Deadlines are system_clock time points because they are passed between processes. add()
+// converts them to steady_clock time points, so a change of the wall clock after add()
+// does not affect when the callback is invoked.
+//
+// A single thread invokes the callbacks, in deadline order, so callbacks must not block for
+// any length of time. The thread is started when the first deadline is added.
+
+class DeadlineMonitor final : public std::enable_shared_from_this<DeadlineMonitor>
+{
+public:
+    NONCOPYABLE(DeadlineMonitor);
+    UNITY_DEFINES_PTRS(DeadlineMonitor);
+
+    typedef std::function<void()> Callback;
+
+    static SPtr create();
+    ~DeadlineMonitor();
+
+    // Stops the monitor thread. Callbacks for deadlines that have not expired yet are not invoked.
+    // Must not be called from within a callback (and a callback must not drop the last
+    // reference to the monitor).
+    void destroy() noexcept;
+
+    // Calls cb once deadline has passed. If the deadline has passed already, cb is called
+    // as soon as possible (but not by the calling thread). O(log n) performance.
+    DeadlineItem::UPtr add(std::chrono::system_clock::time_point deadline, Callback const& cb);
+
+    // Returns the number of pending deadlines.
+    size_t size() const noexcept;
+
+private:
+    DeadlineMonitor();
+    void cancel(uint64_t id) noexcept;
+    void monitor_func();
+
+    typedef std::pair<std::chrono::steady_clock::time_point, uint64_t> Key;
+
+    std::weak_ptr<DeadlineMonitor> self_;
+    std::map<Key, Callback> deadlines_;                                      // In expiry order
+    std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> ids_;  // Key lookup for cancel()
+    uint64_t next_id_;
+    bool finish_;
+    bool callback_running_;                  // Set while the monitor thread invokes a callback
+    uint64_t running_id_;                    // ID of the item whose callback is running
+    mutable std::mutex mutex_;
+    std::condition_variable do_work_;
+    std::condition_variable callback_done_;
+    std::thread monitor_thread_;
+
+    friend class DeadlineItem;
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
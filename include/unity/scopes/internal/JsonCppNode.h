@@ -48,6 +48,7 @@ public:
 
     void clear() override;
     void read_json(std::string const& json_string) override;
+    void read_json(char const* data, std::size_t length);  // Parses data in place, without copying it
     std::string to_json_string() const override;
     Variant to_variant() const override;
 
@@ -68,6 +69,7 @@ public:
 
 private:
     void init_from_string(std::string const& jscon_string);
+    void init_from_data(char const* data, std::size_t length);
 
     typedef std::unique_ptr<JsonNode, decltype(&json_node_free)> NodePtr;
     NodePtr root_;
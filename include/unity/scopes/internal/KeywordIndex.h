@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// Inverted keyword -> scope ID index, used by the registries to answer
+// find_by_keywords() and children_of() without scanning the metadata of every scope.
+// Not thread-safe; the owner must serialize access.
+
+class KeywordIndex final
+{
+public:
+    void add(std::string const& scope_id, std::set<std::string> const& keywords);
+    void remove(std::string const& scope_id);
+    void clear();
+
+    // Returns the IDs of all scopes that have at least one of the given keywords.
+    std::set<std::string> find(std::set<std::string> const& keywords) const;
+
+private:
+    std::map<std::string, std::set<std::string>> scopes_by_keyword_;
+    std::map<std::string, std::set<std::string>> keywords_by_scope_;  // Needed for remove()
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -38,6 +38,8 @@ public:
     // Remote operations
     virtual ScopeMetadata get_metadata(std::string const& scope_id) = 0;
     virtual MetadataMap list() = 0;
+    virtual MetadataMap find_by_keywords(std::set<std::string> const& keywords) = 0;
+    virtual MetadataMap children_of(std::string const& scope_id) = 0;
     virtual ObjectProxy locate(std::string const& identity, int64_t timeout) = 0;
     virtual ObjectProxy locate(std::string const& identity) = 0;
     virtual bool is_scope_running(std::string const& scope_id) = 0;
@@ -47,11 +49,16 @@ public:
     // Local operations
     core::ScopedConnection set_scope_state_callback(std::string const& scope_id, std::function<void(bool)> callback);
     core::ScopedConnection set_list_update_callback(std::function<void()> callback);
+    // Like set_list_update_callback(), but passes the scope catalog version announced by the registry
+    // (empty if the registry did not write a catalog).
+    core::ScopedConnection set_catalog_update_callback(std::function<void(std::string const&)> callback);
 
 protected:
     MWRegistry(MiddlewareBase* mw_base);
 
 private:
+    MWSubscriber& list_update_subscriber();  // Call with mutex_ locked
+
     MiddlewareBase* mw_base_;
     MWSubscriber::UPtr list_update_subscriber_;
     std::map<std::string, MWSubscriber::UPtr> scope_state_subscribers_;
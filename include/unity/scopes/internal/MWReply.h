@@ -20,9 +20,11 @@
 
 #include <unity/scopes/internal/MWObjectProxy.h>
 #include <unity/scopes/internal/MWReplyProxyFwd.h>
+#include <unity/scopes/internal/QueryTimingsImpl.h>
 #include <unity/scopes/ListenerBase.h>
 #include <unity/scopes/Variant.h>
 
+#include <mutex>
 #include <string>
 
 namespace unity
@@ -43,8 +45,19 @@ public:
     virtual void finished(CompletionDetails const& details) = 0;
     virtual void info(OperationInfo const& op_info) = 0;
 
+    // The scope side of the query's timings, which finished() passes to the client.
+    void run_started(std::string const& scope_id);
+    void add_subquery_timings(QueryTimings const& timings);
+
 protected:
     MWReply(MiddlewareBase* mw_base);
+
+    void add_push_bytes(std::size_t bytes);
+    QueryTimingsImpl timings() const;
+
+private:
+    QueryTimingsImpl timings_;
+    mutable std::mutex timings_mutex_;
 };
 
 } // namespace internal
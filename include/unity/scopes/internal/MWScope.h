@@ -47,6 +47,7 @@ public:
 
     virtual QueryCtrlProxy activate(VariantMap const& result,
                                     VariantMap const& hints,
+                                    VariantMap const& context,
                                     MWReplyProxy const& reply) = 0;
 
     virtual QueryCtrlProxy perform_action(VariantMap const& result,
@@ -57,6 +58,7 @@ public:
 
     virtual QueryCtrlProxy preview(VariantMap const& result,
                                    VariantMap const& hints,
+                                   VariantMap const& context,
                                    MWReplyProxy const& reply) = 0;
 
     virtual ChildScopeList child_scopes() = 0;
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <unity/util/NonCopyable.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// Process-wide metrics, exposed in the Prometheus text format by MetricsServer.
+//
+// Metrics are created on first use via MetricsRegistry::instance() and live until the
+// process exits, so callers can keep references to them (typically in a function-local
+// static). Updating a metric never takes a lock.
+
+// A monotonically increasing count. Each thread adds to one of a number of shards that are
+// a cache line apart, so threads that update the same counter don't contend for a cache line.
+
+class Counter final
+{
+public:
+    NONCOPYABLE(Counter);
+
+    Counter();
+
+    void inc(uint64_t n = 1) noexcept;
+    uint64_t value() const noexcept;
+
+private:
+    struct Shard
+    {
+        std::atomic<uint64_t> value;
+        char pad[64 - sizeof(std::atomic<uint64_t>)];
+    };
+    std::array<Shard, 16> shards_;
+};
+
+// A value that can go up and down, such as a queue depth.
+
+class Gauge final
+{
+public:
+    NONCOPYABLE(Gauge);
+
+    Gauge();
+
+    void inc(int64_t n = 1) noexcept;
+    void dec(int64_t n = 1) noexcept;
+    void set(int64_t n) noexcept;
+    int64_t value() const noexcept;
+
+private:
+    std::atomic<int64_t> value_;
+};
+
+// A latency histogram in microseconds. As for an HDR histogram, each power of two is split
+// into eight linear sub-buckets, so a recorded value is accurate to within 12.5%, whatever
+// its magnitude. Values of 2^40 usecs (about 12 days) and more go into the last bucket.
+
+class Histogram final
+{
+public:
+    NONCOPYABLE(Histogram);
+
+    Histogram();
+
+    void record(std::chrono::microseconds t) noexcept;
+    uint64_t count() const noexcept;
+    uint64_t sum() const noexcept;                    // In usecs
+    uint64_t count_below(uint64_t usecs) const noexcept;  // Number of values < usecs (rounded down to a bucket)
+    uint64_t count_at_most(uint64_t usecs) const noexcept;  // Number of values <= usecs (rounded up to a bucket)
+    uint64_t value_at_quantile(double q) const noexcept;  // Upper bound of bucket containing the q-quantile
+
+    static constexpr int sub_bucket_bits = 3;
+    static constexpr int max_bits = 40;
+    static constexpr int num_buckets = (max_bits - sub_bucket_bits + 1) << sub_bucket_bits;
+
+    static int bucket_index(uint64_t usecs) noexcept;
+    static uint64_t bucket_lower_bound(int index) noexcept;
+
+private:
+    std::array<std::atomic<uint64_t>, num_buckets> buckets_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+};
+
+// Registry of all metrics in this process.
+//
+// A metric is identified by its name and labels. labels must be in the text format,
+// for example, `status="ok"`. All metrics with the same name must be of the same type.
+// Asking for an existing metric returns the existing instance; asking for a metric
+// with a name that is registered already with a different type throws LogicException.
+
+class MetricsRegistry final
+{
+public:
+    NONCOPYABLE(MetricsRegistry);
+
+    static MetricsRegistry& instance();
+
+    Counter& counter(std::string const& name, std::string const& help, std::string const& labels = "");
+    Gauge& gauge(std::string const& name, std::string const& help, std::string const& labels = "");
+    Histogram& histogram(std::string const& name, std::string const& help, std::string const& labels = "");
+
+    // Returns the current value of all metrics in the Prometheus text format (version 0.0.4).
+    // Histograms are in seconds (as is usual for Prometheus), with buckets at powers of two usecs.
+    std::string expose() const;
+
+private:
+    MetricsRegistry();
+
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Family
+    {
+        Type type;
+        std::string help;
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Gauge>> gauges;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+    };
+
+    Family& family(std::string const& name, std::string const& help, Type type);
+
+    std::map<std::string, Family> families_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <unity/util/DefinesPtrs.h>
+#include <unity/util/NonCopyable.h>
+
+#include <string>
+#include <thread>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+class Logger;
+
+// Serves the metrics of this process (see Metrics.h) on a unix domain socket.
+// Metrics are switched on with Metrics.Dir in the runtime config; the registry and each
+// scoperunner listen on <dir>/<id>.sock, where <id> is the scope or registry ID.
+//
+// A client connects and reads until EOF. If the client sends an HTTP GET request, the
+// reply is an HTTP response, so `curl --unix-socket <path> http://localhost/metrics` works.
+// Otherwise, the reply is the plain text (for example, with `socat - UNIX-CONNECT:<path>`).
+//
+// The registry's server aggregates: it collects the metrics of all other processes that
+// are listening in the same directory and adds a process="<id>" label to each sample.
+
+class MetricsServer final
+{
+public:
+    NONCOPYABLE(MetricsServer);
+    UNITY_DEFINES_PTRS(MetricsServer);
+
+    // Throws ResourceException if another server is listening on path already,
+    // and SyscallException if the socket cannot be created.
+    MetricsServer(std::string const& path, bool aggregate, Logger& logger);
+    ~MetricsServer();
+
+    std::string path() const;
+
+    // Returns what a client receives (without the HTTP framing).
+    std::string scrape() const;
+
+private:
+    void serve() noexcept;
+    void serve_client(int fd) noexcept;
+
+    std::string path_;
+    std::string id_;  // Basename of path_ without the .sock suffix
+    bool aggregate_;
+    Logger& logger_;
+    int listen_fd_;
+    int stop_fd_;     // eventfd that wakes up serve() when we are destroyed
+    std::thread thread_;
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
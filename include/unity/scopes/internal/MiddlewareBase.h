@@ -92,6 +92,7 @@ public:
     virtual std::string get_scope_endpoint() = 0;
     virtual std::string get_query_endpoint() = 0;
     virtual std::string get_query_ctrl_endpoint() = 0;
+    virtual std::string get_registry_catalog_path() = 0;
 
     RuntimeImpl* runtime() const noexcept;
 
@@ -45,8 +45,13 @@ public:
     unity::scopes::VariantMap settings() const;
     void set_settings_db(std::shared_ptr<unity::scopes::internal::SettingsDB> const& db);
 
+    int cancel_fd();
+    void notify_cancelled();
+
 private:
     std::shared_ptr<unity::scopes::internal::SettingsDB> db_;
+    int cancel_fd_;     // eventfd, created on demand
+    bool cancelled_;
     mutable std::mutex mutex_;
 };
 
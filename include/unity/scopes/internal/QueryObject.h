@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <unity/scopes/internal/DeadlineMonitor.h>
 #include <unity/scopes/internal/MWReplyProxyFwd.h>
 #include <unity/scopes/internal/MWQueryCtrlProxyFwd.h>
 #include <unity/scopes/internal/QueryObjectBase.h>
@@ -65,6 +66,11 @@ public:
     // and we can pass the shared_ptr to the ReplyImpl.
     void set_self(QueryObjectBase::SPtr const& self) noexcept override;
 
+    // Called by search() if the query has a deadline. The item is cancelled when we are destroyed,
+    // and its callback calls deadline_expired(), which cancels the query.
+    void set_deadline_item(DeadlineItem::UPtr item) noexcept;
+    void deadline_expired(InvokeInfo const& info);
+
 protected:
     std::shared_ptr<QueryBase> query_base_;
     MWReplyProxy const reply_;
@@ -73,7 +79,12 @@ protected:
     bool pushable_;
     QueryObjectBase::SPtr self_;
     int cardinality_;
+    DeadlineItem::UPtr deadline_item_;
+    bool deadline_expired_;
     mutable std::mutex mutex_;
+
+private:
+    void cancel_query(InvokeInfo const& info, bool deadline_expired);
 };
 
 } // namespace internal
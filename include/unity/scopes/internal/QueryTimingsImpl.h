@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <unity/scopes/QueryTimings.h>
+#include <unity/scopes/Variant.h>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// The scope fills in scope_id, run_start_time, byte_count, and subqueries, and sends them to
+// the client with finished(). The client's ReplyObject fills in the remaining values when
+// finished() arrives.
+
+class QueryTimingsImpl final
+{
+public:
+    QueryTimingsImpl();
+    QueryTimingsImpl(QueryTimingsImpl const&) = default;
+    QueryTimingsImpl& operator=(QueryTimingsImpl const&) = default;
+
+    std::string scope_id() const;
+    std::chrono::microseconds send_time() const;
+    std::chrono::microseconds run_start() const;
+    std::chrono::microseconds first_push() const;
+    std::chrono::microseconds last_push() const;
+    std::chrono::microseconds total() const;
+    std::size_t result_count() const;
+    std::size_t byte_count() const;
+    std::vector<QueryTimings> subqueries() const;
+    std::chrono::system_clock::time_point run_start_time() const;  // Epoch if run() wasn't called
+
+    void set_scope_id(std::string const& scope_id);
+    void set_send_time(std::chrono::microseconds t);
+    void set_run_start(std::chrono::microseconds t);
+    void set_first_push(std::chrono::microseconds t);
+    void set_last_push(std::chrono::microseconds t);
+    void set_total(std::chrono::microseconds t);
+    void set_result_count(std::size_t count);
+    void set_byte_count(std::size_t count);
+    void add_subquery(QueryTimings const& timings);
+    void set_run_start_time(std::chrono::system_clock::time_point t);
+
+    VariantMap serialize() const;
+
+    static VariantMap serialize(QueryTimings const& timings);
+    static QueryTimings create(QueryTimingsImpl const& impl);
+    static QueryTimings create(VariantMap const& var);
+
+private:
+    std::string scope_id_;
+    std::chrono::microseconds send_time_;
+    std::chrono::microseconds run_start_;
+    std::chrono::microseconds first_push_;
+    std::chrono::microseconds last_push_;
+    std::chrono::microseconds total_;
+    std::size_t result_count_;
+    std::size_t byte_count_;
+    std::vector<QueryTimings> subqueries_;
+    std::chrono::system_clock::time_point run_start_time_;
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -20,8 +20,11 @@
 
 #include <unity/scopes/internal/MWRegistryProxyFwd.h>
 #include <unity/scopes/internal/ObjectImpl.h>
+#include <unity/scopes/internal/ScopeCatalog.h>
 #include <unity/scopes/Registry.h>
 
+#include <mutex>
+
 namespace unity
 {
 
@@ -44,12 +47,24 @@ public:
 
     virtual core::ScopedConnection set_scope_state_callback(std::string const& scope_id, std::function<void(bool)> callback) override;
     virtual core::ScopedConnection set_list_update_callback(std::function<void()> callback) override;
+    virtual MetadataMap find_by_keywords(std::set<std::string> const& keywords) override;
+    virtual MetadataMap children_of(std::string const& scope_id) override;
 
     // Remote operation. Not part of public API, hence not override.
     ObjectProxy locate(std::string const& identity);
 
 private:
     MWRegistryProxy fwd();
+
+    // Returns the current scope catalog, or null if the registry doesn't publish one
+    // or we cannot open the version the registry last announced.
+    std::shared_ptr<ScopeCatalog const> catalog();
+
+    std::shared_ptr<ScopeCatalog const> catalog_;
+    bool catalog_stale_;
+    uint64_t announced_version_;  // Catalog version in the registry's last list update, 0 if none
+    std::mutex catalog_mutex_;
+    std::unique_ptr<core::ScopedConnection> catalog_update_connection_;  // Must be destroyed before catalog_mutex_
 };
 
 } // namespace internal
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <unity/scopes/internal/Executor.h>
+#include <unity/scopes/internal/KeywordIndex.h>
 #include <unity/scopes/internal/MiddlewareBase.h>
 #include <unity/scopes/internal/MWPublisher.h>
 #include <unity/scopes/internal/MWRegistryProxyFwd.h>
@@ -67,6 +68,8 @@ public:
     // Remote operation implementations
     virtual ScopeMetadata get_metadata(std::string const& scope_id) const override;
     virtual MetadataMap list() const override;
+    virtual MetadataMap find_by_keywords(std::set<std::string> const& keywords) const override;
+    virtual MetadataMap children_of(std::string const& scope_id) const override;
     virtual ObjectProxy locate(std::string const& identity) override;
     virtual bool is_scope_running(std::string const& scope_id) override;
 
@@ -76,6 +79,12 @@ public:
     bool remove_local_scope(std::string const& scope_id);
     void set_remote_registry(MWRegistryProxy const& remote_registry);
 
+    // While list updates are suspended, adding or removing scopes neither writes the catalog
+    // nor notifies subscribers. resume_list_updates() does both, once, if anything changed.
+    // (Used while scanning the install directories at start-up.)
+    void suspend_list_updates();
+    void resume_list_updates();
+
     StateReceiverObject::SPtr state_receiver();
 
     static std::string desktop_files_dir();
@@ -88,6 +97,7 @@ private:
     void remove_desktop_file(std::string const& scope_id);
 
     void ss_list_update();
+    void publish_list_update();
 
     class ScopeProcess
     {
@@ -148,6 +158,7 @@ private:
     Executor::SPtr executor_;
 
     MetadataMap scopes_;
+    KeywordIndex keyword_index_;    // Local scopes only
     typedef std::map<std::string, std::shared_ptr<ScopeProcess>> ProcessMap;
     ProcessMap scope_processes_;
     MWRegistryProxy remote_registry_;
@@ -157,6 +168,16 @@ private:
     MWSubscriber::SPtr ss_list_update_subscriber_;
     std::shared_ptr<core::ScopedConnection> ss_list_update_connection_;
     bool generate_desktop_files_;
+
+    // Scope catalog (see ScopeCatalog.h). Remote scopes are cached here, so adding
+    // or removing a local scope does not require a call to the remote registry.
+    std::string catalog_path_;
+    uint64_t catalog_version_;
+    MetadataMap remote_scopes_;
+    bool have_remote_scopes_;
+    std::mutex catalog_mutex_;      // Serializes catalog writes
+    bool list_updates_suspended_;   // Protected by mutex_
+    bool list_update_pending_;      // Protected by mutex_
 };
 
 } // namespace internal
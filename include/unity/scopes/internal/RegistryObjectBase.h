@@ -37,6 +37,8 @@ public:
 
     virtual ScopeMetadata get_metadata(std::string const& scope_id) const = 0;
     virtual MetadataMap list() const = 0;
+    virtual MetadataMap find_by_keywords(std::set<std::string> const& keywords) const = 0;
+    virtual MetadataMap children_of(std::string const& scope_id) const = 0;
     virtual ObjectProxy locate(std::string const& identity) = 0;
     virtual bool is_scope_running(std::string const& scope_id) = 0;
 };
@@ -20,6 +20,7 @@
 
 #include <unity/scopes/internal/MWReplyProxyFwd.h>
 #include <unity/scopes/internal/ObjectImpl.h>
+#include <unity/scopes/internal/TraceContext.h>
 #include <unity/scopes/ListenerBase.h>
 #include <unity/scopes/Reply.h>
 #include <unity/scopes/SearchReplyProxyFwd.h>
@@ -58,6 +59,7 @@ protected:
 private:
     std::shared_ptr<QueryObjectBase> qo_;
     std::atomic_bool finished_;
+    TraceContext const trace_context_;  // Replies belong to the trace of the query, whichever thread sends them
 };
 
 } // namespace internal
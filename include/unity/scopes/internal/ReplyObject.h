@@ -18,13 +18,16 @@
 
 #pragma once
 
+#include <unity/scopes/internal/QueryTimingsImpl.h>
 #include <unity/scopes/internal/ReplyObjectBase.h>
 #include <unity/scopes/internal/Reaper.h>
 #include <unity/scopes/ListenerBase.h>
 #include <unity/scopes/Variant.h>
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 
 namespace unity
 {
@@ -55,6 +58,18 @@ public:
 
     std::string origin_proxy() const;
 
+    // The id of the scope the query was sent to, for tracing.
+    void set_origin_scope_id(std::string const& scope_id);
+    std::string origin_scope_id() const;
+
+    // Called once the request for the query was sent, to measure the send time.
+    void query_sent() noexcept;
+
+    // The sink is called with the query's timings before the listener's finished().
+    // Aggregators use this to collect the timings of their subsearches.
+    typedef std::function<void(QueryTimings const&)> TimingsSink;
+    void set_timings_sink(TimingsSink const& sink);
+
     // Remote operation implementations
     void push(VariantMap const& result) noexcept override;
     void finished(CompletionDetails const& details) noexcept override;
@@ -64,15 +79,27 @@ protected:
     RuntimeImpl const* runtime() const;
 
 private:
+    QueryTimingsImpl complete_timings(CompletionDetails const& details) const;
+
     RuntimeImpl const* runtime_;
     ListenerBase::SPtr listener_base_;
     ReapItem::SPtr reap_item_;
     std::atomic_bool finished_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;
     std::condition_variable idle_;
     std::string origin_proxy_;
+    std::string origin_scope_id_;  // Protected by mutex_
     int num_push_;
     std::vector<OperationInfo> info_list_;
+
+    // Measurements for the query's QueryTimings. Protected by mutex_.
+    std::chrono::system_clock::time_point start_time_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::steady_clock::time_point sent_;
+    std::chrono::steady_clock::time_point first_push_;
+    std::chrono::steady_clock::time_point last_push_;
+    std::size_t result_count_;
+    TimingsSink timings_sink_;
 };
 
 } // namespace internal
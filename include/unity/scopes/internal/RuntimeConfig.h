@@ -44,10 +44,14 @@ public:
     std::string default_middleware_configfile() const;
     int reap_expiry() const;
     int reap_interval() const;
+    int deadline_margin() const;
     std::string cache_directory() const;
     std::string app_directory() const;
     std::string config_directory() const;
     std::vector<std::string> trace_channels() const;
+    std::string capture_directory() const;  // Empty if traffic capture is off
+    std::string trace_directory() const;    // Empty if tracing is off
+    std::string metrics_directory() const;  // Empty if metrics are not served
 
     static std::string default_cache_directory();
     static std::string default_app_directory();
@@ -62,10 +66,14 @@ private:
     std::string default_middleware_configfile_;
     int reap_expiry_;
     int reap_interval_;
+    int deadline_margin_;
     std::string cache_directory_;
     std::string app_directory_;
     std::string config_directory_;
     std::vector<std::string> trace_channels_;
+    std::string capture_directory_;
+    std::string trace_directory_;
+    std::string metrics_directory_;
 };
 
 } // namespace internal
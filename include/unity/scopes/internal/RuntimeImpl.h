@@ -18,11 +18,14 @@
 
 #pragma once
 
+#include <unity/scopes/internal/DeadlineMonitor.h>
 #include <unity/scopes/internal/Logger.h>
+#include <unity/scopes/internal/MetricsServer.h>
 #include <unity/scopes/internal/MiddlewareBase.h>
 #include <unity/scopes/internal/MiddlewareFactory.h>
 #include <unity/scopes/internal/Reaper.h>
 #include <unity/scopes/internal/ThreadPool.h>
+#include <unity/scopes/internal/TraceLog.h>
 #include <unity/scopes/Runtime.h>
 
 namespace unity
@@ -51,12 +54,21 @@ public:
     std::string ss_configfile() const;
     std::string ss_registry_identity() const;
     Reaper::SPtr reply_reaper() const;
+    DeadlineMonitor::SPtr deadline_monitor() const;
+    std::chrono::milliseconds deadline_margin() const;
     ThreadPool::SPtr async_pool() const;
     ThreadSafeQueue<std::future<void>>::SPtr future_queue() const;
     unity::scopes::internal::Logger& logger() const;
+    TraceLog* trace_log() const;  // nullptr if tracing is off
     void run_scope(ScopeBase* scope_base,
                    std::string const& scope_ini_file,
                    std::promise<void> ready_promise = std::promise<void>());
+    // Runs the scope with the given id on this run time's middleware. Several scopes
+    // can be hosted by the same run time (see scoperunner).
+    void host_scope(ScopeBase* scope_base,
+                    std::string const& scope_id,
+                    std::string const& scope_ini_file,
+                    std::promise<void> ready_promise = std::promise<void>());
 
     ObjectProxy string_to_proxy(std::string const& s) const;
     std::string proxy_to_string(ObjectProxy const& proxy) const;
@@ -73,10 +85,15 @@ private:
     std::string demangled_id(std::string const& scope_id) const;
     bool confined() const;
     std::string confinement_type() const;
-    std::string find_cache_dir() const;
-    std::string find_app_dir() const;
+    std::string find_cache_dir(std::string const& id) const;
+    std::string find_app_dir(std::string const& id) const;
     std::string find_log_dir(std::string const& id) const;
-    std::string find_tmp_dir() const;
+    std::string find_tmp_dir(std::string const& id) const;
+    void do_run_scope(ScopeBase* scope_base,
+                      std::string const& scope_id,
+                      std::string const& scope_ini_file,
+                      bool hosted,
+                      std::promise<void> ready_promise);
 
     bool destroyed_;
     std::string scope_id_;
@@ -90,16 +107,21 @@ private:
     std::string ss_registry_identity_;
     int reap_expiry_;
     int reap_interval_;
+    int deadline_margin_;
     std::string cache_dir_;
     std::string app_dir_;
     std::string log_dir_;
     std::string config_dir_;
+    std::string capture_dir_;
     Logger::UPtr logger_;
+    TraceLog::UPtr trace_log_;
+    MetricsServer::UPtr metrics_server_;
     mutable Reaper::SPtr reply_reaper_;
+    mutable DeadlineMonitor::SPtr deadline_monitor_;
     mutable ThreadPool::SPtr async_pool_;  // Pool of invocation threads for async query creation
     mutable ThreadSafeQueue<std::future<void>>::SPtr future_queue_;
     mutable std::thread waiter_thread_;
-    mutable std::mutex mutex_;  // For lazy initialization of reply_reaper_, async_pool_, and queue_
+    mutable std::mutex mutex_;  // For lazy initialization of reply_reaper_, deadline_monitor_, async_pool_, and queue_
 };
 
 } // namespace internal
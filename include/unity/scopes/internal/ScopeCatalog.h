@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/Variant.h>
+#include <unity/util/DefinesPtrs.h>
+#include <unity/util/NonCopyable.h>
+
+#include <cstdint>
+#include <map>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// Immutable, memory-mapped snapshot of the registry's scope metadata.
+//
+// The registry writes a new catalog file whenever its list of scopes changes and then
+// announces the new version via its publisher. Clients map the file read-only and look
+// up metadata without calling the registry. A new catalog is written to a temporary
+// file and renamed into place, so a mapping held by a client stays valid (and unchanged)
+// until the client re-opens the catalog.
+//
+// File layout (all integers in host byte order; the file never leaves the machine):
+//
+//   Header:  magic[4] ("USCC"), format version (uint32), catalog version (uint64),
+//            flags (uint32), entry count (uint32)
+//   Index:   entry count records of {id offset, id length, data offset, data length}
+//            (uint32 each), sorted by scope id
+//   Data:    scope ids and metadata blobs; each blob is a compact binary encoding of
+//            the VariantMap returned by ScopeMetadata::serialize().
+
+class ScopeCatalog final
+{
+public:
+    NONCOPYABLE(ScopeCatalog);
+    UNITY_DEFINES_PTRS(ScopeCatalog);
+
+    typedef std::map<std::string, VariantMap> EntryMap;
+
+    // Set if the catalog contains every scope known to the registry, including
+    // remote scopes. If not set, a lookup miss is not authoritative.
+    static constexpr uint32_t Complete = 0x1;
+
+    // Atomically replaces the catalog at path. Throws FileException on error.
+    static void write(std::string const& path, uint64_t version, uint32_t flags, EntryMap const& entries);
+
+    // Maps the catalog at path. Throws FileException if the file cannot be opened
+    // or mapped, and ResourceException if its contents are malformed.
+    static UPtr open(std::string const& path);
+
+    ~ScopeCatalog();
+
+    uint64_t version() const noexcept;
+    bool is_complete() const noexcept;
+    size_t size() const noexcept;
+
+    bool find(std::string const& scope_id, VariantMap& entry) const;
+    EntryMap entries() const;
+
+private:
+    ScopeCatalog(std::string const& path, void* addr, size_t length);
+
+    VariantMap entry_at(uint32_t index) const;
+    std::string id_at(uint32_t index) const;
+
+    std::string path_;
+    void* addr_;
+    size_t length_;
+    char const* base_;
+    uint64_t version_;
+    uint32_t flags_;
+    uint32_t count_;
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
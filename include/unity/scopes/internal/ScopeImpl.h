@@ -21,6 +21,7 @@
 #include <unity/scopes/ActivationListenerBase.h>
 #include <unity/scopes/internal/MWScopeProxyFwd.h>
 #include <unity/scopes/internal/ObjectImpl.h>
+#include <unity/scopes/internal/ReplyObject.h>
 #include <unity/scopes/internal/SearchQueryBaseImpl.h>
 #include <unity/scopes/PreviewListenerBase.h>
 #include <unity/scopes/QueryCtrlProxyFwd.h>
@@ -79,12 +80,14 @@ public:
                           std::unique_ptr<Variant> user_data,
                           SearchMetadata const& metadata,
                           SearchQueryBaseImpl::History const& history,
-                          SearchListenerBase::SPtr const& reply);       // Not remote, hence not override
+                          SearchListenerBase::SPtr const& reply,        // Not remote, hence not override
+                          ReplyObject::TimingsSink const& timings_sink = nullptr);
 
     QueryCtrlProxy search(CannedQuery const& query,
                           SearchMetadata const& metadata,
                           SearchQueryBaseImpl::History const& history,
-                          SearchListenerBase::SPtr const& reply);       // Not remote, hence not override
+                          SearchListenerBase::SPtr const& reply,        // Not remote, hence not override
+                          ReplyObject::TimingsSink const& timings_sink = nullptr);
 
     virtual QueryCtrlProxy activate(Result const& result,
                                     ActionMetadata const& metadata,
@@ -20,6 +20,7 @@
 
 #include <unity/scopes/internal/ScopeObjectBase.h>
 #include <unity/scopes/internal/QueryObjectBase.h>
+#include <unity/scopes/internal/TrafficCapture.h>
 #include <unity/scopes/QueryBase.h>
 
 #include <functional>
@@ -50,7 +51,8 @@ class ScopeObject final : public ScopeObjectBase
 public:
     UNITY_DEFINES_PTRS(ScopeObject);
 
-    ScopeObject(ScopeBase* scope_base, bool debug_mode = false);
+    // If capture is non-null, incoming search, preview, and activation requests are recorded.
+    ScopeObject(ScopeBase* scope_base, bool debug_mode = false, TrafficCapture::SPtr const& capture = nullptr);
     virtual ~ScopeObject();
 
     // Remote operation implementations
@@ -62,6 +64,7 @@ public:
 
     virtual MWQueryCtrlProxy activate(Result const& result,
                                       ActionMetadata const& hints,
+                                      VariantMap const& context,
                                       MWReplyProxy const &reply,
                                       InvokeInfo const& info) override;
 
@@ -74,6 +77,7 @@ public:
 
     virtual MWQueryCtrlProxy preview(Result const& result,
                                      ActionMetadata const& hints,
+                                     VariantMap const& context,
                                      MWReplyProxy const& reply,
                                      InvokeInfo const& info) override;
 
@@ -95,6 +99,7 @@ private:
         std::function<QueryObjectBase::SPtr(QueryBase::SPtr, MWQueryCtrlProxy)> const& query_object_factory_fun);
     ScopeBase* const scope_base_;
     bool const debug_mode_;
+    TrafficCapture::SPtr const capture_;
 };
 
 } // namespace internal
@@ -54,6 +54,7 @@ public:
 
     virtual MWQueryCtrlProxy activate(Result const& result,
                                       ActionMetadata const& hints,
+                                      VariantMap const& context,
                                       MWReplyProxy const& reply,
                                       InvokeInfo const& info) = 0;
 
@@ -66,6 +67,7 @@ public:
 
     virtual MWQueryCtrlProxy preview(Result const& result,
                                      ActionMetadata const& hints,
+                                     VariantMap const& context,
                                      MWReplyProxy const& reply,
                                      InvokeInfo const& info) = 0;
 
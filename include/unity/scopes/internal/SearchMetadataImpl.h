@@ -59,6 +59,11 @@ public:
     std::set<std::string> aggregated_keywords() const;
     bool is_aggregated() const;
 
+    void set_deadline(std::chrono::system_clock::time_point deadline);
+    std::chrono::system_clock::time_point deadline() const;
+    bool has_deadline() const;
+    std::chrono::milliseconds remaining_time() const;
+
     virtual VariantMap serialize() const override;
 
     static SearchMetadata create(VariantMap const& var);
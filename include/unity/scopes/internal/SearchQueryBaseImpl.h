@@ -21,7 +21,9 @@
 
 #include <unity/scopes/CannedQuery.h>
 #include <unity/scopes/ChildScope.h>
+#include <unity/scopes/internal/MWReplyProxyFwd.h>
 #include <unity/scopes/internal/QueryBaseImpl.h>
+#include <unity/scopes/internal/TraceContext.h>
 #include <unity/scopes/QueryCtrlProxyFwd.h>
 #include <unity/scopes/ScopeProxyFwd.h>
 #include <unity/scopes/SearchListenerBase.h>
@@ -53,6 +55,9 @@ public:
 
     void set_history(History const& h);
 
+    // The reply proxy for this query, which collects the timings of our subsearches.
+    void set_mw_reply(MWReplyProxy const& reply);
+
     QueryCtrlProxy subsearch(ScopeProxy const& scope,
                              std::set<std::string> const& keywords,
                              std::string const& query_string,
@@ -70,6 +75,7 @@ private:
 
     CannedQuery const canned_query_;
     SearchMetadata const search_metadata_;
+    TraceContext const trace_context_;  // Context of the search() that created this query
 
     mutable std::mutex mutex_;
     bool valid_;
@@ -77,6 +83,7 @@ private:
     std::string client_id_;
     History history_;
     std::vector<QueryCtrlProxy> subqueries_;
+    std::weak_ptr<MWReply> mw_reply_;
 
     QueryCtrlProxy check_for_query_loop(ScopeProxy const& scope,
                                         SearchListenerBase::SPtr const& reply,
@@ -24,6 +24,10 @@
 #include <unity/util/NonCopyable.h>
 #include <unity/util/ResourcePtr.h>
 
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
 #include <time.h>
 
 namespace unity
@@ -50,27 +54,31 @@ public:
     static UPtr create_from_json_string(std::string const& db_path, std::string const& json_string);
     static UPtr create_from_schema(std::string const& db_path, unity::scopes::internal::SettingsSchema const& schema);
 
-    ~SettingsDB() = default;
-
-    SettingsDB(SettingsDB&&) = default;
-    SettingsDB& operator=(SettingsDB&&) = default;
+    ~SettingsDB();
 
-    VariantMap settings();  // Returns the current settings (checking the DB each time).
+    VariantMap settings();  // Returns the current settings (re-reading the DB only if it has changed).
 
 private:
     SettingsDB(std::string const& db_path, unity::scopes::internal::SettingsSchema const& schema);
 
-    void process_doc_(std::string const& id, unity::util::IniParser const& parer);
+    void process_doc_(std::string const& id, unity::util::IniParser const& parer, VariantMap& values);
     void process_all_docs();
-    void set_defaults();
+    VariantMap defaults() const;
+    bool snapshot_is_current();
 
     std::string db_path_;
+    std::string db_dir_;                             // Directory containing db_path_
+    std::string db_name_;                            // Last path component of db_path_
+    int watch_;                                      // inotify watch on db_dir_, or -1 if none
+    uint64_t generation_;                            // Change count of db_path_ when we last read it
+    bool snapshot_valid_;                            // False if the last attempt to read the DB failed
     decltype(::timespec::tv_nsec) last_write_time_nsec_;
     decltype(::timespec::tv_sec) last_write_time_sec_;
     ::ino_t last_write_inode_;
     VariantArray definitions_;                       // Returned by SettingsSchema
     std::map<std::string, Variant> def_map_;  // Allows fast access to the Variants in definitions_
-    unity::scopes::VariantMap values_;
+    std::shared_ptr<VariantMap const> values_;       // Immutable snapshot, replaced whenever the DB changes
+    std::mutex mutex_;
 };
 
 }  // namespace internal
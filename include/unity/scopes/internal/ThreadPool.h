@@ -54,6 +54,8 @@ public:
 
 private:
     void run();
+    void task_queued() noexcept;      // Update the metrics for the pool (see Metrics.h).
+    void task_not_queued() noexcept;
 
     typedef ThreadSafeQueue<unity::scopes::internal::TaskWrapper> TaskQueue;
     std::unique_ptr<TaskQueue> queue_;
@@ -78,7 +80,16 @@ std::future<typename std::result_of<F()>::type> ThreadPool::submit(F f)
     }
     std::packaged_task<ResultType()> task(std::move(f));
     std::future<ResultType> result(task.get_future());
-    queue_->push(move(task));
+    task_queued();
+    try
+    {
+        queue_->push(move(task));
+    }
+    catch (...)
+    {
+        task_not_queued();
+        throw;
+    }
     return result;
 }
 
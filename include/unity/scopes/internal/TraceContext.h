@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <unity/util/NonCopyable.h>
+
+#include <cstdint>
+#include <functional>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// Identifies the span of work that a thread is doing on behalf of a traced request.
+// Every request sent by a thread with a traced context carries a child of that context
+// (see Message.capnp), and the receiving servant makes the child its current context
+// while it dispatches the request. This links all requests that result from one query,
+// across processes, into a single trace.
+//
+// A context with a trace_id of zero is not traced, and neither are its children.
+
+struct TraceContext
+{
+    uint64_t trace_id;
+    uint64_t span_id;
+    uint64_t parent_id;  // Zero for the root span of a trace
+
+    bool traced() const noexcept
+    {
+        return trace_id != 0;
+    }
+
+    // Returns a context for a new span with this span as its parent.
+    TraceContext child() const;
+
+    // Returns a context for the root span of a new trace.
+    static TraceContext root();
+
+    // Returns the calling thread's current context.
+    static TraceContext current() noexcept;
+};
+
+// Makes ctx the calling thread's current context until the TraceScope goes out of scope.
+
+class TraceScope final
+{
+public:
+    NONCOPYABLE(TraceScope);
+
+    explicit TraceScope(TraceContext const& ctx) noexcept;
+    ~TraceScope();
+
+private:
+    TraceContext saved_;
+};
+
+// Returns a function that calls f with the calling thread's current context, for work
+// that is handed to another thread.
+
+inline std::function<void()> with_trace_context(std::function<void()> f)
+{
+    auto const ctx = TraceContext::current();
+    return [ctx, f]
+    {
+        TraceScope scope(ctx);
+        f();
+    };
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
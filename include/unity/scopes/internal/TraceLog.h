@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <unity/scopes/internal/TraceContext.h>
+#include <unity/util/DefinesPtrs.h>
+#include <unity/util/NonCopyable.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+class Logger;
+
+// Records the spans of traced requests that are dispatched in this process. Tracing is
+// switched on with Trace.Dir in the runtime config; each process writes
+// <process>-<pid>.trace in that directory. tools/merge_traces.py merges the files of
+// all processes into a single Chrome trace.
+//
+// Each span is a line of JSON:
+//
+//   {"trace":"<hex>","span":"<hex>","parent":"<hex>","name":"<op>","target":"<id>",
+//    "process":"<process>","pid":<pid>,"tid":<tid>,"ts":<usecs since epoch>,"dur":<usecs>}
+//
+// Spans are appended with a single write() each, so concurrent spans don't interleave.
+
+class TraceLog final
+{
+public:
+    NONCOPYABLE(TraceLog);
+    UNITY_DEFINES_PTRS(TraceLog);
+
+    // Creates <dir>/<process>-<pid>.trace. Throws FileException if the file cannot be opened.
+    TraceLog(std::string const& dir, std::string const& process, Logger& logger);
+    ~TraceLog();
+
+    std::string path() const;
+
+    // Errors are logged, and stop the trace, but never fail the request being traced.
+    void record(TraceContext const& ctx,
+                std::string const& name,
+                std::string const& target,
+                std::chrono::system_clock::time_point start,
+                std::chrono::steady_clock::duration duration) noexcept;
+
+private:
+    std::string path_;
+    std::string process_;
+    Logger& logger_;
+    int fd_;
+    std::mutex mutex_;  // Protects fd_
+};
+
+// Makes ctx the calling thread's current context and, if log is non-null, records a span
+// for it when the TraceSpan goes out of scope. If log is non-null and ctx isn't traced
+// (because the caller isn't tracing), the span is the root of a new trace.
+
+class TraceSpan final
+{
+public:
+    NONCOPYABLE(TraceSpan);
+
+    TraceSpan(TraceLog* log, TraceContext const& ctx, std::string const& name, std::string const& target);
+    ~TraceSpan();
+
+private:
+    TraceLog* log_;
+    TraceContext ctx_;
+    TraceScope scope_;
+    std::string name_;
+    std::string target_;
+    std::chrono::system_clock::time_point start_;
+    std::chrono::steady_clock::time_point steady_start_;
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/Variant.h>
+#include <unity/util/DefinesPtrs.h>
+#include <unity/util/NonCopyable.h>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+class Logger;
+
+// Records the search, preview, and activation requests that arrive at a scope, so they
+// can be replayed later (see TrafficReplay). Capture is switched on with Capture.Dir in
+// the runtime config; each scope writes <scope_id>.capture in that directory.
+//
+// File layout (all integers in host byte order):
+//
+//   Header:  magic[4] ("USTC"), format version (uint32)
+//   Records: record length (uint32, excluding the length itself), kind (uint8),
+//            time (int64, microseconds since the epoch), client id (string),
+//            request (dictionary, see VariantBinary.h)
+//
+// A search request contains "query" and "metadata" (the serialized CannedQuery and
+// SearchMetadata), a preview or activation contains "result" and "metadata".
+//
+// Records are appended with a single write() each, so concurrent requests don't interleave.
+// A partial record at the end of the file (because the scope was killed while writing it)
+// is ignored when reading.
+
+class TrafficCapture final
+{
+public:
+    NONCOPYABLE(TrafficCapture);
+    UNITY_DEFINES_PTRS(TrafficCapture);
+
+    enum class Kind : uint8_t { Search, Preview, Activate };
+
+    struct Record
+    {
+        Kind kind;
+        std::chrono::system_clock::time_point time;
+        std::string client_id;
+        VariantMap request;
+    };
+
+    // Opens path for appending, creating it if necessary. Throws FileException
+    // if the file cannot be opened, and ResourceException if it is not a capture file.
+    TrafficCapture(std::string const& path, Logger& logger);
+    ~TrafficCapture();
+
+    // Appends a record with the current time. Errors are logged, and stop the capture,
+    // but never fail the request being recorded.
+    void record(Kind kind, std::string const& client_id, VariantMap const& request) noexcept;
+
+    // Returns all complete records in path, in the order they were written.
+    static std::vector<Record> read(std::string const& path);
+
+private:
+    std::string path_;
+    Logger& logger_;
+    int fd_;
+    std::mutex mutex_;  // Protects fd_
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
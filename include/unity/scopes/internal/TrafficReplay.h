@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/internal/TrafficCapture.h>
+#include <unity/scopes/ScopeProxyFwd.h>
+
+#include <chrono>
+#include <map>
+#include <vector>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// Latencies of the replayed requests of one kind, measured from sending the request
+// until its finished() callback.
+
+struct ReplayLatencies
+{
+    std::vector<std::chrono::microseconds> sample;  // Requests that completed with status OK
+    std::size_t failed = 0;                          // Requests that failed, were cancelled, or timed out
+};
+
+typedef std::map<TrafficCapture::Kind, ReplayLatencies> ReplayReport;
+
+// Re-issues captured requests (see TrafficCapture) against scope. The time between requests
+// is divided by speed: 1 replays at the original pacing, 10 ten times faster, and 0 sends
+// each request as soon as the previous one was sent. Requests do not wait for earlier ones
+// to complete. Requests still outstanding after timeout (counted from when the last request
+// was sent) are reported as failed.
+//
+// Deadlines in the captured metadata are moved forward, so each replayed search has the
+// same amount of time left as the original.
+
+ReplayReport replay_traffic(ScopeProxy const& scope,
+                            std::vector<TrafficCapture::Record> const& records,
+                            double speed = 1,
+                            std::chrono::milliseconds timeout = std::chrono::seconds(30));
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/Variant.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// Compact binary encoding of Variant, for files that are written and read on the same
+// machine (integers are in host byte order). Each value is a one-byte Variant::Type tag,
+// followed by the payload. Strings are a uint32 length followed by the bytes, and dictionaries
+// and arrays are a uint32 element count followed by the elements.
+
+template<typename T>
+void binary_put(std::string& buf, T val)
+{
+    buf.append(reinterpret_cast<char const*>(&val), sizeof(val));
+}
+
+void binary_put_string(std::string& buf, std::string const& s);
+void variant_to_binary(Variant const& var, std::string& buf);  // Appends to buf
+
+// Reads fixed-size values, strings, and variants from a buffer. Reading past the end of the
+// buffer, or an invalid variant type, throw unity::ResourceException.
+
+class BinaryDecoder
+{
+public:
+    BinaryDecoder(char const* begin, char const* end);
+
+    template<typename T>
+    T get()
+    {
+        T val;
+        check(sizeof(val));
+        std::memcpy(&val, p_, sizeof(val));
+        p_ += sizeof(val);
+        return val;
+    }
+
+    std::string get_string();
+    Variant get_variant();
+    VariantMap get_dict();  // Payload of a dictionary, without the type tag
+
+    std::size_t remaining() const noexcept;
+
+private:
+    void check(std::size_t len) const;
+
+    char const* p_;
+    char const* end_;
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
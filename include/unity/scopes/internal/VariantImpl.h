@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/Variant.h>
+
+#include <boost/variant.hpp>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+struct NullVariant
+{
+    bool operator<(NullVariant const&) const
+    {
+        return false;
+    }
+
+    bool operator==(NullVariant const&) const
+    {
+        return true;
+    }
+};
+
+struct VariantImpl
+{
+    boost::variant<NullVariant, int, bool, std::string, double, VariantMap, VariantArray, int64_t> v;
+
+    // The Variant accessors return copies. Code that walks or builds large Variant trees
+    // (such as the JSON codec) uses these to get at the value in place instead.
+    static VariantImpl& get(Variant& var)
+    {
+        return *var.p;
+    }
+
+    static VariantImpl const& get(Variant const& var)
+    {
+        return *var.p;
+    }
+};
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
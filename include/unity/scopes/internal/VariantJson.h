@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/Variant.h>
+
+#include <string>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+// Native JSON codec for Variant. Unlike JsonCppNode, it does not build an intermediate DOM:
+// the writer appends straight to a caller-supplied buffer, and the parser creates the
+// Variant tree directly from the input text.
+//
+// Integers that fit into 32 bits are decoded as Int, larger ones as Int64, and numbers
+// with a fraction or exponent as Double. Doubles are written with enough precision to
+// round-trip, and always with a fraction or exponent, so they decode as Double again.
+// Parse errors throw unity::ResourceException.
+
+void variant_to_json(Variant const& var, std::string& out);  // Appends to out
+std::string variant_to_json(Variant const& var);
+void string_to_json(std::string const& str, std::string& out);  // Appends str as a quoted JSON string
+
+Variant json_to_variant(char const* data, std::size_t length);
+Variant json_to_variant(std::string const& json);
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -32,7 +32,9 @@
  */
 
 #ifdef __clang__
-/* template< typename... T > void simple_tracepoint_unused_args( T&&... ) {} */
+#ifdef __cplusplus
+template< typename... T > inline void simple_tracepoint_unused_args( T&&... ) {}
+#endif
 #define simple_tracepoint( c, e, ... ) simple_tracepoint_unused_args( __VA_ARGS__ )
 #else
 #define simple_tracepoint( c, e, ... ) tracepoint( c, e, __VA_ARGS__ )
@@ -33,10 +33,133 @@
 #pragma clang diagnostic ignored "-Wmissing-field-initializers"
 #endif
 
+/*
+ * Query lifecycle events. The query_id is the identity of the reply object for the
+ * query, which is the same on the client side and the scope side, so the events
+ * for one query can be correlated across processes.
+ *
+ * The tracepoint() macro evaluates its arguments only while the event is enabled,
+ * so calls such as reply->identity().c_str() in the argument list cost nothing
+ * unless a trace session is running.
+ */
+
+/* Scope side */
+
+SIMPLE_TRACEPOINT(
+  query_created,
+  TRACE_INFO,
+  stp_string(query_id),
+  stp_string(scope_id),
+  stp_string(method)
+)
+
+SIMPLE_TRACEPOINT(
+  query_run_start,
+  TRACE_INFO,
+  stp_string(query_id),
+  stp_string(scope_id)
+)
+
+SIMPLE_TRACEPOINT(
+  query_run_end,
+  TRACE_INFO,
+  stp_string(query_id),
+  stp_string(scope_id)
+)
+
+SIMPLE_TRACEPOINT(
+  query_cancelled,
+  TRACE_INFO,
+  stp_string(query_id),
+  stp_string(scope_id),
+  stp_integer(int, deadline_expired)
+)
+
+/*
+ * size is the size in bytes of the marshaled push request, so it can be matched
+ * with reply_arrived. It is 0 for a reply object in the same process, which is
+ * invoked directly without marshaling.
+ */
+SIMPLE_TRACEPOINT(
+  reply_push,
+  TRACE_DEBUG,
+  stp_string(query_id),
+  stp_string(scope_id),
+  stp_integer(uint32_t, size)
+)
+
+/* Client side */
+
+/*
+ * scope_id is the scope the query was sent to. size is the size in bytes of the
+ * marshaled push request.
+ */
+SIMPLE_TRACEPOINT(
+  reply_arrived,
+  TRACE_DEBUG,
+  stp_string(query_id),
+  stp_string(scope_id),
+  stp_integer(uint32_t, size)
+)
+
+/* status is a CompletionDetails::CompletionStatus. */
+SIMPLE_TRACEPOINT(
+  reply_finished,
+  TRACE_INFO,
+  stp_string(query_id),
+  stp_integer(int, status)
+)
+
+/* Registry */
+
+SIMPLE_TRACEPOINT(
+  registry_locate,
+  TRACE_INFO,
+  stp_string(scope_id)
+)
+
+SIMPLE_TRACEPOINT(
+  registry_exec_start,
+  TRACE_INFO,
+  stp_string(scope_id)
+)
+
+SIMPLE_TRACEPOINT(
+  registry_exec_end,
+  TRACE_INFO,
+  stp_string(scope_id),
+  stp_integer(int, pid)
+)
+
+/*
+ * Middleware. adapter_queue fires when the pump hands an incoming request to a worker
+ * thread; idle_workers is the number of workers still waiting for work. size is the
+ * size of the marshaled request in bytes.
+ */
+
+SIMPLE_TRACEPOINT(
+  adapter_queue,
+  TRACE_DEBUG,
+  stp_string(adapter),
+  stp_integer(uint32_t, size),
+  stp_integer(uint32_t, idle_workers)
+)
+
+SIMPLE_TRACEPOINT(
+  adapter_dispatch_start,
+  TRACE_DEBUG,
+  stp_string(adapter),
+  stp_string(id),
+  stp_string(op),
+  stp_integer(uint32_t, size)
+)
+
 SIMPLE_TRACEPOINT(
-  trace,
+  adapter_dispatch_end,
   TRACE_DEBUG,
-  stp_integer(int, value)
+  stp_string(adapter),
+  stp_string(id),
+  stp_string(op)
 )
 
 #if __clang__
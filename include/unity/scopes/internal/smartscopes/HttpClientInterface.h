@@ -25,6 +25,7 @@
 #include <string>
 #include <functional>
 #include <list>
+#include <memory>
 #include <tuple>
 
 namespace unity
@@ -43,6 +44,14 @@ class HttpResponseHandle;
 
 typedef std::list<std::pair<std::string, std::string>> HttpHeaders;
 
+// Status and headers of a completed response. A "304 Not Modified" response completes
+// successfully (without any body data); other non-200 responses complete with an exception.
+struct HttpResponseInfo
+{
+    unsigned int status = 0;
+    HttpHeaders headers;
+};
+
 class HttpClientInterface : public std::enable_shared_from_this<HttpClientInterface>
 {
 public:
@@ -70,10 +79,14 @@ public:
     NONCOPYABLE(HttpResponseHandle);
     UNITY_DEFINES_PTRS(HttpResponseHandle);
 
-    HttpResponseHandle(HttpClientInterface::SPtr client, unsigned int session_id, std::shared_future<void> future)
+    HttpResponseHandle(HttpClientInterface::SPtr client,
+                       unsigned int session_id,
+                       std::shared_future<void> future,
+                       std::shared_ptr<HttpResponseInfo> info = std::make_shared<HttpResponseInfo>())
         : client_(client)
         , session_id_(session_id)
         , future_(future)
+        , info_(info)
     {
     }
 
@@ -97,10 +110,17 @@ public:
         client_->cancel_get(session_id_);
     }
 
+    // Only valid once get() has returned without throwing.
+    HttpResponseInfo const& info() const
+    {
+        return *info_;
+    }
+
 private:
     std::shared_ptr<HttpClientInterface> client_;
     unsigned int session_id_;
     std::shared_future<void> future_;
+    std::shared_ptr<HttpResponseInfo> info_;
 };
 
 }  // namespace smartscopes
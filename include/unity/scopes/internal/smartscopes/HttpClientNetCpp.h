@@ -21,7 +21,9 @@
 
 #include <unity/scopes/internal/smartscopes/HttpClientInterface.h>
 
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <thread>
 
 namespace core
@@ -50,7 +52,13 @@ namespace smartscopes
 class HttpClientNetCpp : public HttpClientInterface
 {
 public:
-    explicit HttpClientNetCpp(unsigned int no_reply_timeout);
+    // If the caller's headers include an Accept-Encoding other than identity, the response is
+    // decompressed according to its Content-Encoding (gzip or deflate) before it is passed to
+    // line_data. Because the response headers arrive only after the body, such a response is
+    // passed on in one piece once complete; other responses stream. If max_concurrent_requests is non-zero,
+    // at most that many requests are in progress at a time; further requests are queued and
+    // started, in order, as earlier ones complete.
+    explicit HttpClientNetCpp(unsigned int no_reply_timeout, unsigned int max_concurrent_requests = 0);
     ~HttpClientNetCpp();
 
     HttpResponseHandle::SPtr get(std::string const& request_url,
@@ -62,9 +70,23 @@ public:
 private:
     void cancel_get(unsigned int session_id) override;
 
+    struct PendingRequest
+    {
+        std::function<void()> start;
+        std::shared_ptr<std::promise<void>> promise;
+    };
+
+    void start_or_queue(PendingRequest request);
+    void request_finished();
+
     unsigned int no_reply_timeout;
+    unsigned int max_concurrent_requests;
     std::shared_ptr<core::net::http::StreamingClient> client;
     std::thread worker;
+
+    std::mutex requests_mutex;
+    unsigned int active_requests;
+    std::deque<PendingRequest> pending_requests;
 };
 
 }  // namespace smartscopes
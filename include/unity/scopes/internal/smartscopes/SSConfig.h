@@ -39,12 +39,14 @@ public:
     ~SSConfig();
 
     int http_reply_timeout() const;             // seconds
+    int http_max_concurrent_requests() const;   // 0 means unlimited
     int reg_refresh_rate() const;               // seconds
     int reg_refresh_fail_timeout() const;       // seconds
     std::string scope_identity() const;
 
 private:
     int http_reply_timeout_;
+    int http_max_concurrent_requests_;
     int reg_refresh_rate_;
     int reg_refresh_fail_timeout_;
     std::string scope_identity_;
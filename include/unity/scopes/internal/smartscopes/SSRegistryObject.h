@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <unity/scopes/internal/KeywordIndex.h>
 #include <unity/scopes/internal/MiddlewareBase.h>
 #include <unity/scopes/internal/RegistryObjectBase.h>
 #include <unity/scopes/internal/SettingsDB.h>
@@ -53,6 +54,8 @@ public:
 
     ScopeMetadata get_metadata(std::string const& scope_id) const override;
     MetadataMap list() const override;
+    MetadataMap find_by_keywords(std::set<std::string> const& keywords) const override;
+    MetadataMap children_of(std::string const& scope_id) const override;
 
     ObjectProxy locate(std::string const& identity) override;
     bool is_scope_running(std::string const& scope_id) override;
@@ -80,6 +83,8 @@ private:
     SmartScopesClient::SPtr ssclient_;
 
     MetadataMap scopes_;
+    std::map<std::string, RemoteScope> remote_scopes_;  // Catalog that scopes_ was built from
+    KeywordIndex keyword_index_;
     std::map<std::string, std::string> base_urls_;
     std::map<std::string, SSSettingsDef> settings_defs_;
     mutable std::mutex scopes_mutex_;
@@ -59,6 +59,7 @@ public:
 
     MWQueryCtrlProxy activate(Result const& result,
                               ActionMetadata const& hints,
+                              VariantMap const& context,
                               MWReplyProxy const& reply,
                               InvokeInfo const& info) override;
 
@@ -71,6 +72,7 @@ public:
 
     MWQueryCtrlProxy preview(Result const& result,
                              ActionMetadata const& hints,
+                             VariantMap const& context,
                              MWReplyProxy const& reply,
                              InvokeInfo const& info) override;
 
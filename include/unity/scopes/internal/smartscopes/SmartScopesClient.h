@@ -28,6 +28,7 @@
 
 #include <unity/util/NonCopyable.h>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -67,6 +68,9 @@ struct RemoteScope
     bool invisible = false;
     int version;
     std::set<std::string> keywords;             // optional
+
+    bool operator==(RemoteScope const& other) const;
+    bool operator!=(RemoteScope const& other) const;
 };
 
 struct SearchCategory
@@ -79,9 +83,9 @@ struct SearchCategory
 
 struct SearchResult
 {
-    std::string json;
+    std::string json;          // The result object exactly as received from the server
     std::string uri;
-    std::map<std::string, JsonNodeInterface::SPtr > other_params;
+    VariantMap other_params;   // All attributes other than uri and cat_id
     std::string category_id;
 };
 
@@ -147,6 +151,39 @@ private:
     std::shared_ptr<SmartScopesClient> ssc_;
 };
 
+// Splits a streamed HTTP response into lines and parses each line as a JSON document.
+// Complete lines are parsed straight out of the received chunk; only an incomplete
+// trailing line is buffered until the next chunk arrives. Each search and preview owns
+// its own parser, so concurrent queries do not serialize on a shared parser.
+
+class JsonLineParser
+{
+public:
+    NONCOPYABLE(JsonLineParser);
+    UNITY_DEFINES_PTRS(JsonLineParser);
+
+    JsonLineParser() = default;
+
+    // Calls line_handler with the parsed root of each complete line in chunk. An empty
+    // chunk marks the end of the stream and flushes any unterminated last line. Parse errors
+    // and exceptions thrown by line_handler are passed to error_handler and do not stop
+    // processing of the remaining lines.
+    // The handler also receives the text of the line, which is valid only for the duration of the call.
+    typedef std::function<void(JsonNodeInterface::SPtr const& root_node, char const* begin, char const* end)> LineHandler;
+
+    void consume(std::string const& chunk,
+                 LineHandler const& line_handler,
+                 std::function<void(std::string const&)> const& error_handler);
+
+private:
+    void parse_line(char const* begin,
+                    char const* end,
+                    LineHandler const& line_handler,
+                    std::function<void(std::string const&)> const& error_handler);
+
+    std::string leftover_;
+};
+
 struct SearchReplyHandler
 {
     std::function<void(SearchResult const&)> result_handler;
@@ -181,7 +218,13 @@ public:
     void reset_url(std::string const& url = "");
     std::string url();
 
-    bool get_remote_scopes(std::vector<RemoteScope>& scopes, std::string const& locale = "", bool caching_enabled = true);
+    // If unchanged is non-null, the catalog is fetched conditionally. If the server reports that
+    // the catalog hasn't changed since the last successful call, *unchanged is set to true,
+    // scopes is left untouched, and the caller can keep using the catalog it already has.
+    bool get_remote_scopes(std::vector<RemoteScope>& scopes,
+                           std::string const& locale = "",
+                           bool caching_enabled = true,
+                           bool* unchanged = nullptr);
 
     SearchHandle::UPtr search(SearchReplyHandler& handler,
                               std::string const& base_url,
@@ -221,16 +264,17 @@ private:
     Filters parse_filters(JsonNodeInterface::SPtr node, std::map<std::string, FilterGroup::SCPtr> const& filter_groups);
     FilterState parse_filter_state(JsonNodeInterface::SPtr node);
 
-    std::string handle_chunk(const std::string& chunk, std::function<void(const std::string&)> line_handler);
-    void handle_line(std::string const& json, SearchReplyHandler& handler);
-    void handle_line(std::string const& json, PreviewReplyHandler const& handler);
+    void handle_line(JsonNodeInterface::SPtr const& root_node, char const* begin, char const* end, SearchReplyHandler& handler);
+    void handle_line(JsonNodeInterface::SPtr const& root_node, PreviewReplyHandler const& handler);
 
     std::vector<std::string> extract_json_stream(std::string const& json_stream);
 
     void cancel_query(unsigned int query_id);
 
-    void write_cache(std::string const& scopes_json);
-    std::string read_cache();
+    std::vector<RemoteScope> parse_remote_scopes(std::string const& json);
+
+    void write_cache(std::vector<RemoteScope> const& remote_scopes);
+    bool read_cache();
 
     std::string stringify_settings(VariantMap const& settings);
 
@@ -245,7 +289,19 @@ private:
     std::mutex json_node_mutex_;
     std::mutex query_results_mutex_;
 
-    std::string cached_scopes_;
+    // Validators for the most recently retrieved remote scopes catalog.
+    struct CatalogInfo
+    {
+        bool valid = false;
+        bool returned = false;  // Catalog was handed to the caller by get_remote_scopes()
+        std::string locale;
+        uint64_t hash = 0;  // FNV-1a hash of the locale and the response body
+        std::string etag;
+        std::string last_modified;
+    };
+    CatalogInfo catalog_;
+
+    std::vector<RemoteScope> cached_scopes_;
     bool have_latest_cache_;
 
     unsigned int query_counter_;
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <unity/scopes/internal/InvokeInfo.h>
+#include <unity/scopes/internal/TraceContext.h>
 
 #include <string>
 
@@ -42,6 +43,7 @@ struct Current
     std::string category;
     std::string op_name;
     ObjectAdapter* adapter;
+    TraceContext trace = TraceContext();  // Span for the request, not traced if the caller isn't tracing
 };
 
 unity::scopes::internal::InvokeInfo to_info(Current const& c);
@@ -19,6 +19,8 @@
 #pragma once
 
 #include <unity/scopes/internal/Logger.h>
+#include <unity/scopes/internal/ThreadPool.h>
+#include <unity/scopes/internal/TraceLog.h>
 #include <unity/scopes/internal/zmq_middleware/Current.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqObjectProxy.h>
 #include <unity/scopes/ScopeExceptions.h>
@@ -26,6 +28,7 @@
 
 #include <zmqpp/socket.hpp>
 
+#include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
@@ -66,6 +69,7 @@ public:
     ZmqMiddleware* mw() const;
     std::string name() const;
     std::string endpoint() const;
+    TraceLog* trace_log() const;  // nullptr if this process isn't tracing
 
     ZmqProxy add(std::string const& id, std::shared_ptr<ServantBase> const& obj);
     void remove(std::string const& id);
@@ -75,6 +79,14 @@ public:
     void remove_dflt_servant(std::string const& category);
     std::shared_ptr<ServantBase> find_dflt_servant(std::string const& id) const;
 
+    // Direct dispatch for callers in the same process. find_local() returns the servant
+    // with the given id, or nullptr if there is no such servant or the adapter is not active.
+    // invoke_local() runs f asynchronously and in order on a single thread owned by the adapter.
+    // If the adapter has a single worker thread, f is also serialized with remote invocations,
+    // so servants see the same threading as for remote invocations only.
+    std::shared_ptr<ServantBase> find_local(std::string const& id) const;
+    void invoke_local(std::function<void()> f);
+
     void activate();
     void shutdown();
     void wait_for_shutdown();
@@ -124,6 +136,8 @@ private:
     std::thread pump_;                          // Load-balancing pump: router-router or pull-router
     std::vector<std::thread> workers_;          // Threads for incoming invocations
     std::exception_ptr exception_;              // Failed threads deposit their exception here
+    std::mutex serial_dispatch_mutex_;          // Serializes local and remote invocations if pool_size_ == 1
+    std::unique_ptr<ThreadPool> local_invoker_; // Lazily created thread for invoke_local()
     std::once_flag once_;
 
     AdapterState state_;
@@ -55,6 +55,14 @@ private:
                        capnp::AnyPointer::Reader& in_params,
                        capnproto::Response::Builder& r);
 
+    virtual void find_by_keywords_(Current const& current,
+                                   capnp::AnyPointer::Reader& in_params,
+                                   capnproto::Response::Builder& r);
+
+    virtual void children_of_(Current const& current,
+                              capnp::AnyPointer::Reader& in_params,
+                              capnproto::Response::Builder& r);
+
     virtual void locate_(Current const& current,
                          capnp::AnyPointer::Reader& in_params,
                          capnproto::Response::Builder& r);
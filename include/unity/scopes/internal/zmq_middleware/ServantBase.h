@@ -51,6 +51,10 @@ public:
                         capnproto::Response::Builder& r) noexcept;
     virtual ~ServantBase();
 
+    // The implementation object that the servant forwards to. Used by the proxies to dispatch
+    // invocations on a servant in the same process directly, without marshaling.
+    std::shared_ptr<AbstractObject> del() const noexcept;
+
 protected:
     typedef std::function<void(Current const&,
                                capnp::AnyPointer::Reader& in_params,
@@ -64,8 +68,6 @@ protected:
                    capnp::AnyPointer::Reader& in_params,
                    capnproto::Response::Builder& r);
 
-    std::shared_ptr<AbstractObject> del() const noexcept;
-
 private:
     std::shared_ptr<AbstractObject> delegate_;
     DispatchTable dispatch_table_;
@@ -42,6 +42,7 @@ public:
     int child_scopes_timeout() const;
     std::string registry_endpoint_dir() const;
     std::string ss_registry_endpoint_dir() const;
+    bool direct_dispatch() const;
 
 private:
     std::string endpoint_dir_;
@@ -51,6 +52,7 @@ private:
     int child_scopes_timeout_;
     std::string registry_endpoint_dir_;
     std::string ss_registry_endpoint_dir_;
+    bool direct_dispatch_;
 };
 
 } // namespace internal
@@ -88,6 +88,7 @@ public:
     virtual std::string get_scope_endpoint() override;
     virtual std::string get_query_endpoint() override;
     virtual std::string get_query_ctrl_endpoint() override;
+    virtual std::string get_registry_catalog_path() override;
 
     zmqpp::context* context() const noexcept;
     ThreadPool* oneway_pool();
@@ -95,6 +96,11 @@ public:
     int64_t locate_timeout() const noexcept;
     int64_t registry_timeout() const noexcept;
     int64_t child_scopes_timeout() const noexcept;
+    bool direct_dispatch() const noexcept;
+
+    // Returns the adapter with the given endpoint if it was created by a middleware
+    // in this process, nullptr otherwise.
+    static std::shared_ptr<ObjectAdapter> find_local_adapter(std::string const& endpoint);
 
 private:
     ObjectProxy make_typed_proxy(std::string const& endpoint,
@@ -141,6 +147,7 @@ private:
     int64_t locate_timeout_;                    // Timeout for registry locate()
     int64_t registry_timeout_;                  // Timeout for registry operations other than locate()
     int64_t child_scopes_timeout_;              // Timeout for child_scopes() and set_child_scopes() methods
+    bool direct_dispatch_;                      // Dispatch invocations on servants in this process directly
 
     std::string public_endpoint_dir_;
     std::string private_endpoint_dir_;
@@ -28,6 +28,9 @@
 
 #include <capnp/message.h>
 
+#include <memory>
+#include <mutex>
+
 namespace unity
 {
 
@@ -40,6 +43,8 @@ namespace internal
 namespace zmq_middleware
 {
 
+class ObjectAdapter;
+class ServantBase;
 class ZmqReceiver;
 
 // A Zmq proxy that points at some Zmq object, but without a specific type.
@@ -74,6 +79,8 @@ protected:
 
     void invoke_oneway_(capnp::MessageBuilder& in_params);
 
+    std::shared_ptr<ServantBase> find_local_servant_(std::shared_ptr<ObjectAdapter>& adapter) const;
+
     // Holds both the receiver for the unmarshaling buffer (which allocates memory)
     // and the reader that decodes the memory from the unmarshaling buffer.
     // We use unique_ptr because capnp Builder and Reader types are not movable.
@@ -110,6 +117,9 @@ private:
     std::string category_;
     RequestMode mode_;
     int64_t timeout_;
+
+    mutable std::mutex local_adapter_mutex_;
+    mutable std::weak_ptr<ObjectAdapter> local_adapter_;  // Last adapter found by find_local_servant_()
 };
 
 } // namespace zmq_middleware
@@ -50,6 +50,8 @@ public:
     // Remote operations.
     virtual ScopeMetadata get_metadata(std::string const& scope_id) override;
     virtual MetadataMap list() override;
+    virtual MetadataMap find_by_keywords(std::set<std::string> const& keywords) override;
+    virtual MetadataMap children_of(std::string const& scope_id) override;
     virtual ObjectProxy locate(std::string const& identity, int64_t timeout) override;
     virtual ObjectProxy locate(std::string const& identity) override;
     virtual bool is_scope_running(std::string const& scope_id) override;
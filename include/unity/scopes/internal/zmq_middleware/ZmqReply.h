@@ -22,6 +22,8 @@
 #include <unity/scopes/internal/zmq_middleware/ZmqReplyProxyFwd.h>
 #include <unity/scopes/internal/MWReply.h>
 
+#include <mutex>
+
 namespace unity
 {
 
@@ -31,6 +33,8 @@ namespace scopes
 namespace internal
 {
 
+class ReplyObjectBase;
+
 namespace zmq_middleware
 {
 
@@ -46,6 +50,15 @@ public:
     virtual void push(VariantMap const& result) override;
     virtual void finished(CompletionDetails const& details) override;
     virtual void info(OperationInfo const& op_info) override;
+
+private:
+    bool invoke_local_(std::string const& op_name, std::function<void(ReplyObjectBase&)> f);
+
+    // Whether the reply object lives in this process is decided once, on the first invocation.
+    std::once_flag local_once_;
+    bool is_local_;
+    std::weak_ptr<ObjectAdapter> reply_adapter_;
+    std::weak_ptr<ReplyObjectBase> reply_object_;
 };
 
 } // namespace zmq_middleware
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <unity/scopes/internal/zmq_middleware/ZmqObjectProxy.h>
+#include <unity/scopes/internal/zmq_middleware/ZmqReplyProxyFwd.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqScopeProxyFwd.h>
 #include <unity/scopes/internal/MWScope.h>
 
@@ -31,6 +32,9 @@ namespace scopes
 namespace internal
 {
 
+struct InvokeInfo;
+class ScopeObjectBase;
+
 namespace zmq_middleware
 {
 
@@ -51,6 +55,7 @@ public:
 
     virtual QueryCtrlProxy activate(VariantMap const& result,
                                     VariantMap const& hints,
+                                    VariantMap const& context,
                                     MWReplyProxy const& reply) override;
 
     virtual QueryCtrlProxy perform_action(VariantMap const& result,
@@ -61,6 +66,7 @@ public:
 
     virtual QueryCtrlProxy preview(VariantMap const& result,
                                    VariantMap const& hints,
+                                   VariantMap const& context,
                                    MWReplyProxy const& reply) override;
 
     virtual ChildScopeList child_scopes() override;
@@ -76,6 +82,13 @@ public:
 private:
     ZmqObjectProxy::TwowayOutParams invoke_scope_(capnp::MessageBuilder& in_params);
     ZmqObjectProxy::TwowayOutParams invoke_scope_(capnp::MessageBuilder& in_params, int64_t timeout);
+
+    typedef std::function<MWQueryCtrlProxy(ScopeObjectBase&, MWReplyProxy const&, InvokeInfo const&)> LocalInvocation;
+    QueryCtrlProxy invoke_local_(std::shared_ptr<ServantBase> const& servant,
+                                 std::shared_ptr<ObjectAdapter> const& adapter,
+                                 ZmqReplyProxy const& reply_proxy,
+                                 std::string const& op_name,
+                                 LocalInvocation f);
     std::mutex debug_mode_mutex_;
     std::unique_ptr<bool> debug_mode_;
 };
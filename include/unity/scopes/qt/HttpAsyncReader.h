@@ -169,6 +169,16 @@ public:
     std::string get_uri(std::string const& host,
                         std::vector<std::pair<std::string, std::string>> const& parameters) const;
 
+    /**
+     * \brief Aborts downloads in progress once the given file descriptor becomes readable.
+     * Typically, this is the descriptor returned by unity::scopes::QueryBase::cancel_fd() for the query
+     * on whose behalf the data is downloaded, so cancelling the query also aborts the download.
+     * An aborted download sets an exception on the returned future.
+     *
+     * \param fd The file descriptor to watch, or -1 to stop watching.
+     */
+    void set_cancel_fd(int fd);
+
 protected:
     /// @cond
     core::net::http::Request::Progress::Next progress_report(core::net::http::Request::Progress const& progress) const;
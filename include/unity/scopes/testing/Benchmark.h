@@ -171,6 +171,136 @@ public:
         void save_to_xml(std::ostream& out);
     };
 
+    /**
+     * \brief The LoadResult struct encapsulates the result of a load benchmark,
+     * see Benchmark::for_query_load.
+     */
+    struct LoadResult
+    {
+        /** Percentiles of a timing distribution. */
+        struct Percentiles
+        {
+            /** Median. */
+            Result::Timing::Seconds p50{Result::Timing::Seconds::zero()};
+            /** 90th percentile. */
+            Result::Timing::Seconds p90{Result::Timing::Seconds::zero()};
+            /** 99th percentile. */
+            Result::Timing::Seconds p99{Result::Timing::Seconds::zero()};
+            /** 99.9th percentile. */
+            Result::Timing::Seconds p999{Result::Timing::Seconds::zero()};
+        };
+
+        /** Statistics of the latencies of all completed queries. */
+        Result result{};
+        /** Number of concurrent clients. */
+        std::size_t client_count{0};
+        /** Length of the measurement interval, excluding the warm-up period. */
+        Result::Timing::Seconds duration{Result::Timing::Seconds::zero()};
+        /** Number of queries started during the measurement interval that completed successfully. */
+        std::size_t completed{0};
+        /** Number of queries started during the measurement interval that failed or timed out. */
+        std::size_t failed{0};
+        /** Completed queries per second. */
+        double throughput{0};
+        /** Time from the (scheduled) start of a query until it completed. */
+        Percentiles latency{};
+        /** Time from the (scheduled) start of a query until it pushed its first result.
+         *  Queries that did not push any results are not included. */
+        Percentiles time_to_first_result{};
+
+        /**
+         * \brief load_from restores a load result from the given input stream.
+         * \throw std::runtime_error in case of issues.
+         * \param in The stream to read from.
+         */
+        void load_from(std::istream& in);
+
+        /**
+         * \brief save_to stores a load result to the given output stream.
+         * \throw std::runtime_error in case of issues.
+         * \param out The stream to write to.
+         */
+        void save_to(std::ostream& out);
+
+        /**
+         * \brief load_from_xml restores a load result stored as xml from the given input stream.
+         * \throw std::runtime_error in case of issues.
+         * \param in The stream to read from.
+         */
+        void load_from_xml(std::istream& in);
+
+        /**
+         * \brief save_to_xml stores a load result as xml to the given output stream.
+         * \throw std::runtime_error in case of issues.
+         * \param out The stream to write to.
+         */
+        void save_to_xml(std::ostream& out);
+    };
+
+    /**
+     * \brief The CounterResult struct encapsulates the result of a benchmark run
+     * together with per-trial statistics of the performance counters of the
+     * benchmarking process, see Benchmark::for_query_with_counters.
+     *
+     * Counters that are not available, for example because of the kernel's
+     * perf_event_paranoid setting or in a virtual machine, are reported as such
+     * and do not fail the benchmark.
+     */
+    struct CounterResult
+    {
+        /** Statistics of a single counter across all trials. */
+        struct Counter
+        {
+            /** False if the kernel does not provide the counter. */
+            bool available{false};
+            /** Mean count per trial. */
+            double mean{0};
+            /** Standard deviation of the count per trial. */
+            double std_dev{0};
+        };
+
+        /** The timing results of the benchmark run. */
+        Result result{};
+        /** CPU cycles. */
+        Counter cycles{};
+        /** Retired instructions. */
+        Counter instructions{};
+        /** Last-level cache misses. */
+        Counter cache_misses{};
+        /** Context switches. */
+        Counter context_switches{};
+        /** Page faults. */
+        Counter page_faults{};
+
+        /**
+         * \brief load_from restores a counter result from the given input stream.
+         * \throw std::runtime_error in case of issues.
+         * \param in The stream to read from.
+         */
+        void load_from(std::istream& in);
+
+        /**
+         * \brief save_to stores a counter result to the given output stream.
+         * \throw std::runtime_error in case of issues.
+         * \param out The stream to write to.
+         */
+        void save_to(std::ostream& out);
+
+        /**
+         * \brief load_from_xml restores a counter result stored as xml from the given input stream.
+         * \throw std::runtime_error in case of issues.
+         * \param in The stream to read from.
+         */
+        void load_from_xml(std::istream& in);
+
+        /**
+         * \brief save_to_xml stores a counter result as xml to the given output stream.
+         * \throw std::runtime_error in case of issues.
+         * \param out The stream to write to.
+         */
+        void save_to_xml(std::ostream& out);
+    };
+
     /**
      * \brief The StatisticsConfiguration struct contains options controlling
      * the calculation of benchmark result statistics.
@@ -287,6 +417,38 @@ public:
         TrialConfiguration trial_configuration;
     };
 
+    /**
+     * \brief The LoadConfiguration struct contains all options controlling a
+     * load benchmark of scope query operations.
+     *
+     * A load benchmark runs client_count clients concurrently. With a target_qps of 0,
+     * each client sends its next query as soon as the previous one has completed (closed loop).
+     * Otherwise, the clients together start target_qps queries per second, independent of
+     * how long each query takes (open loop). In that case, latency is measured from the time a
+     * query was scheduled to start, so a scope that cannot keep up with the rate is charged for
+     * the time queries spent waiting for a client.
+     */
+    struct LoadConfiguration
+    {
+        /**
+         * The sampling function instance for choosing a query configuration.
+         * Has to be set to an actual instance. Calls to the sampler are serialized.
+         */
+        QueryConfiguration::Sampler sampler{};
+        /** Number of concurrent clients. */
+        std::size_t client_count{4};
+        /** Target number of queries per second across all clients, or 0 for a closed loop. */
+        double target_qps{0};
+        /** Queries started during the warm-up period are run, but not measured. */
+        std::chrono::microseconds warm_up{std::chrono::seconds{1}};
+        /** Length of the measurement interval that follows the warm-up period. */
+        std::chrono::microseconds duration{std::chrono::seconds{10}};
+        /** A query that does not complete within this time is counted as failed. */
+        std::chrono::microseconds per_query_timeout{std::chrono::seconds{10}};
+        /** Options for the statistics calculated from the latency sample. */
+        StatisticsConfiguration statistics_configuration{};
+    };
+
     /** \cond */
     virtual ~Benchmark() = default;
     Benchmark(const Benchmark&) = delete;
@@ -340,6 +502,76 @@ public:
     virtual Result for_action(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
                               ActionConfiguration configuration) = 0;
 
+    /**
+     * \brief for_query_load executes a benchmark to measure the scope's query performance
+     * under concurrent load.
+     *
+     * The scope's search() method and the queries it returns are called from several
+     * threads concurrently.
+     *
+     * The default implementation throws std::logic_error; InProcessBenchmark and
+     * OutOfProcessBenchmark override it.
+     *
+     * \throw std::logic_error in case of misconfiguration, or if the benchmark does not support load tests.
+     * \param scope The scope instance to benchmark.
+     * \param configuration Options controlling the experiment.
+     * \return An instance of LoadResult.
+     */
+    virtual LoadResult for_query_load(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                      LoadConfiguration configuration);
+
+    /**
+     * \brief for_query_with_counters executes the same benchmark as for_query, and
+     * also samples performance counters (see perf_event_open(2)) for each trial.
+     *
+     * The default implementation throws std::logic_error; InProcessBenchmark and
+     * OutOfProcessBenchmark override it.
+     *
+     * \throw std::runtime_error in case of timeouts.
+     * \throw std::logic_error in case of misconfiguration, or if the benchmark does not support counters.
+     * \param scope The scope instance to benchmark.
+     * \param configuration Options controlling the experiment.
+     * \return An instance of CounterResult.
+     */
+    virtual CounterResult for_query_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                  QueryConfiguration configuration);
+
+    /**
+     * \brief for_preview_with_counters executes the same benchmark as for_preview, and
+     * also samples performance counters for each trial, see for_query_with_counters.
+     * \throw std::runtime_error in case of timeouts.
+     * \throw std::logic_error in case of misconfiguration, or if the benchmark does not support counters.
+     * \param scope The scope instance to benchmark.
+     * \param configuration Options controlling the experiment.
+     * \return An instance of CounterResult.
+     */
+    virtual CounterResult for_preview_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                    PreviewConfiguration configuration);
+
+    /**
+     * \brief for_activation_with_counters executes the same benchmark as for_activation, and
+     * also samples performance counters for each trial, see for_query_with_counters.
+     * \throw std::runtime_error in case of timeouts.
+     * \throw std::logic_error in case of misconfiguration, or if the benchmark does not support counters.
+     * \param scope The scope instance to benchmark.
+     * \param configuration Options controlling the experiment.
+     * \return An instance of CounterResult.
+     */
+    virtual CounterResult for_activation_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                       ActivationConfiguration configuration);
+
+    /**
+     * \brief for_action_with_counters executes the same benchmark as for_action, and
+     * also samples performance counters for each trial, see for_query_with_counters.
+     * \throw std::runtime_error in case of timeouts.
+     * \throw std::logic_error in case of misconfiguration, or if the benchmark does not support counters.
+     * \param scope The scope instance to benchmark.
+     * \param configuration Options controlling the experiment.
+     * \return An instance of CounterResult.
+     */
+    virtual CounterResult for_action_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                   ActionConfiguration configuration);
+
 protected:
     Benchmark() = default;
 };
@@ -348,6 +580,14 @@ bool operator==(const Benchmark::Result& lhs, const Benchmark::Result& rhs);
 
 std::ostream& operator<<(std::ostream&, const Benchmark::Result&);
 
+bool operator==(const Benchmark::LoadResult& lhs, const Benchmark::LoadResult& rhs);
+
+std::ostream& operator<<(std::ostream&, const Benchmark::LoadResult&);
+
+bool operator==(const Benchmark::CounterResult& lhs, const Benchmark::CounterResult& rhs);
+
+std::ostream& operator<<(std::ostream&, const Benchmark::CounterResult&);
+
 } // namespace testing
 
 } // namespace scopes
@@ -59,6 +59,9 @@ public:
     virtual Result for_query(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
                              QueryConfiguration configuration) override;
 
+    virtual LoadResult for_query_load(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                      LoadConfiguration configuration) override;
+
     virtual Result for_preview(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
                                PreviewConfiguration preview_configuration) override;
 
@@ -67,6 +70,18 @@ public:
 
     virtual Result for_action(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
                               ActionConfiguration activation_configuration) override;
+
+    virtual CounterResult for_query_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                  QueryConfiguration configuration) override;
+
+    virtual CounterResult for_preview_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                    PreviewConfiguration preview_configuration) override;
+
+    virtual CounterResult for_activation_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                       ActivationConfiguration activation_configuration) override;
+
+    virtual CounterResult for_action_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                                   ActionConfiguration activation_configuration) override;
 };
 
 } // namespace testing
@@ -65,6 +65,9 @@ public:
     Result for_query(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
                      QueryConfiguration configuration) override;
 
+    LoadResult for_query_load(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                              LoadConfiguration configuration) override;
+
     Result for_preview(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
                        PreviewConfiguration preview_configuration) override;
 
@@ -73,6 +76,18 @@ public:
 
     Result for_action(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
                       ActionConfiguration activation_configuration) override;
+
+    CounterResult for_query_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                          QueryConfiguration configuration) override;
+
+    CounterResult for_preview_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                            PreviewConfiguration preview_configuration) override;
+
+    CounterResult for_activation_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                               ActivationConfiguration activation_configuration) override;
+
+    CounterResult for_action_with_counters(const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+                                           ActionConfiguration activation_configuration) override;
 };
 
 } // namespace testing
@@ -21,6 +21,9 @@
 #include <unity/scopes/SearchListenerBase.h>
 #include <unity/scopes/SearchReplyProxyFwd.h>
 
+#include <chrono>
+#include <string>
+
 namespace unity
 {
 
@@ -61,6 +64,26 @@ public:
     BufferedResultForwarder(unity::scopes::SearchReplyProxy const& upstream,
                             BufferedResultForwarder::SPtr const& next_forwarder = BufferedResultForwarder::SPtr());
 
+    /**
+    \brief Create a forwarder with a time budget.
+
+    If the forwarder has not called set_ready() within `budget` of being created, it gives up its
+    place in the chain: its follower no longer waits for it, and its own results are buffered until
+    the last forwarder in the chain has become ready, so they appear at the end. The forwarder
+    reports this by sending an OperationInfo with code OperationInfo::ResultsIncomplete upstream.
+
+    \param upstream The reply proxy for the upstream receiver.
+    \param budget The time budget. A budget of zero (or less) means no budget.
+    \param child_id The identity of the child scope (used in the OperationInfo message).
+    \param next_forwarder The forwarder that becomes ready once this forwarder calls set_ready()
+    or exceeds its budget.
+    \throws unity::LogicException when passed next_forwarder that has already been linked to another BufferedResultForwarder.
+    */
+    BufferedResultForwarder(unity::scopes::SearchReplyProxy const& upstream,
+                            std::chrono::milliseconds budget,
+                            std::string const& child_id,
+                            BufferedResultForwarder::SPtr const& next_forwarder = BufferedResultForwarder::SPtr());
+
     /**
     \brief Forwards a single result before calling `set_ready()`.
 
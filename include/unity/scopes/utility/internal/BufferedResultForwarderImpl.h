@@ -18,11 +18,14 @@
 
 #pragma once
 
+#include <unity/scopes/internal/DeadlineMonitor.h>
 #include <unity/scopes/SearchReplyProxyFwd.h>
 #include <unity/scopes/utility/BufferedResultForwarder.h>
 
+#include <future>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <atomic>
 
 namespace unity
@@ -40,7 +43,11 @@ namespace internal
 class BufferedResultForwarderImpl
 {
 public:
-    BufferedResultForwarderImpl(unity::scopes::SearchReplyProxy const& upstream, unity::scopes::utility::BufferedResultForwarder::SPtr const& next_forwarder);
+    BufferedResultForwarderImpl(unity::scopes::SearchReplyProxy const& upstream,
+                                unity::scopes::utility::BufferedResultForwarder::SPtr const& next_forwarder,
+                                std::chrono::milliseconds budget = std::chrono::milliseconds(0),
+                                std::string const& child_id = "");
+    ~BufferedResultForwarderImpl();
 
     unity::scopes::SearchReplyProxy upstream() const;
     void push(CategorisedResult result);
@@ -49,14 +56,27 @@ public:
     void finished(CompletionDetails const& details);
 
 private:
+    struct Chain;
+
     void notify_ready();
     void flush_and_notify();
+    void pass_on();
+    void budget_expired();
+    void flush_late();
 
     std::atomic<bool> ready_;
     std::atomic<bool> has_previous_;
     std::atomic<bool> previous_ready_;
     unity::scopes::SearchReplyProxy const upstream_;
     BufferedResultForwarder::SPtr const next_;
+    std::shared_ptr<Chain> chain_;            // Shared by all forwarders in the chain
+    std::chrono::milliseconds const budget_;
+    std::string const child_id_;
+    bool late_;                               // Budget expired before we were ready
+    bool passed_on_;                          // Follower (or end of chain) was notified
+    std::mutex mutex_;
+    std::future<void> expiry_;                // Expiry work posted to the budget pool
+    unity::scopes::internal::DeadlineItem::UPtr budget_item_;  // Last, so it is cancelled first
 };
 
 } // namespace internal
@@ -21,8 +21,9 @@
 #include <unity/scopes/internal/safe_strerror.h>
 #include <unity/UnityExceptions.h>
 
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/inotify.h>
-#include <sys/ioctl.h>
 #include <unistd.h>
 #include <string.h>
 
@@ -32,17 +33,67 @@ using namespace unity::scopes::internal;
 namespace scoperegistry
 {
 
-DirWatcher::DirWatcher(Logger& logger)
-    : fd_(inotify_init())
+namespace
+{
+
+// Upper bound on how long events are held back, as a multiple of the debounce window.
+int const max_debounce_windows = 10;
+
+}
+
+DirWatcher::DirWatcher(Logger& logger, std::chrono::milliseconds debounce_window)
+    : fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+    , epoll_fd_(epoll_create1(EPOLL_CLOEXEC))
+    , stop_fd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , debounce_window_(debounce_window)
     , thread_state_(Running)
     , thread_exception_(nullptr)
     , logger_(logger)
 {
-    // Validate the file descriptor
+    auto close_fds = [this]
+    {
+        for (auto fd : { fd_, epoll_fd_, stop_fd_ })
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+        }
+    };
+
+    // Validate the file descriptors
     if (fd_ < 0)
     {
-        throw SyscallException("DirWatcher(): inotify_init() failed on inotify fd (fd = " +
-                               std::to_string(fd_) + ")", errno);
+        int err = errno;
+        close_fds();
+        throw SyscallException("DirWatcher(): inotify_init1() failed on inotify fd (fd = " +
+                               std::to_string(fd_) + ")", err);
+    }
+    if (epoll_fd_ < 0)
+    {
+        int err = errno;
+        close_fds();
+        throw SyscallException("DirWatcher(): epoll_create1() failed", err);
+    }
+    if (stop_fd_ < 0)
+    {
+        int err = errno;
+        close_fds();
+        throw SyscallException("DirWatcher(): eventfd() failed", err);
+    }
+
+    for (auto fd : { fd_, stop_fd_ })
+    {
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0)
+        {
+            int err = errno;
+            close_fds();
+            throw SyscallException("DirWatcher(): epoll_ctl() failed (fd = " + std::to_string(fd) + ")", err);
+        }
     }
 }
 
@@ -50,7 +101,9 @@ DirWatcher::~DirWatcher()
 {
     cleanup();
 
-    // Close the file descriptor
+    // Close the file descriptors
+    close(stop_fd_);
+    close(epoll_fd_);
     close(fd_);
 }
 
@@ -90,8 +143,9 @@ void DirWatcher::add_watch(std::string const& path)
 
     wds_[wd] = path;
 
-    // If this is the first watch, start the thread
-    if (wds_.size() == 1)
+    // If this is the first watch, start the thread. The thread keeps running
+    // until cleanup(), even if all watches are removed in the mean time.
+    if (!thread_.joinable() && thread_state_ == Running)
     {
         thread_ = std::thread(&DirWatcher::watch_thread, this);
     }
@@ -110,13 +164,6 @@ void DirWatcher::remove_watch(std::string const& path)
     {
         if (wd.second == path)
         {
-            // If this is the last watch, stop the thread
-            if (wds_.size() == 1)
-            {
-                thread_state_ = Stopping;
-            }
-
-            // Remove watch (causes read to return)
             inotify_rm_watch(fd_, wd.first);
             wds_.erase(wd.first);
             break;
@@ -149,12 +196,19 @@ void DirWatcher::cleanup()
             // Set state to Stopping
             thread_state_ = Stopping;
 
-            // Remove watches (causes read to return)
+            // Remove watches
             for (auto& wd : wds_)
             {
                 inotify_rm_watch(fd_, wd.first);
             }
             wds_.clear();
+
+            // Wake up the thread
+            uint64_t one = 1;
+            if (write(stop_fd_, &one, sizeof(one)) != sizeof(one))
+            {
+                logger_() << "~DirWatcher(): cannot wake up watch_thread: " << safe_strerror(errno);
+            }
         }
     }
 
@@ -165,110 +219,162 @@ void DirWatcher::cleanup()
     }
 }
 
-void DirWatcher::watch_thread()
+std::string DirWatcher::coalesce_key(std::string const& path) const
 {
-    try
-    {
-        fd_set fds;
-        FD_ZERO(&fds);
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wold-style-cast"
-        FD_SET(fd_, &fds);
-#pragma GCC diagnostic pop
-
-        int bytes_avail = 0;
-        std::string buffer;
-        std::string event_path;
+    return path;
+}
 
-        // Poll for notifications until stop is requested
-        while (true)
+void DirWatcher::queue_event(std::vector<PendingEvent>& pending,
+                             EventType type,
+                             FileType file_type,
+                             std::string const& path)
+{
+    // If an Added event (or a Modified event of the same file type) with the same key is already
+    // pending, and nothing has been removed under that key since, the new Added or Modified event
+    // carries no information.
+    std::string key = coalesce_key(path);
+    if (type != Removed)
+    {
+        for (auto it = pending.rbegin(); it != pending.rend(); ++it)
         {
-            // Wait for a payload to arrive
-            int ret = select(fd_ + 1, &fds, nullptr, nullptr, nullptr);
-            if (ret < 0)
-            {
-                throw SyscallException("DirWatcher::watch_thread(): Thread aborted: "
-                                       "select() failed on inotify fd (fd = " +
-                                       std::to_string(fd_) + ")", errno);
-            }
-            // Get number of bytes available
-            ret = ioctl(fd_, FIONREAD, &bytes_avail);
-            if (ret < 0)
+            if (it->key == key)
             {
-                throw SyscallException("DirWatcher::watch_thread(): Thread aborted: "
-                                       "ioctl() failed on inotify fd (fd = " +
-                                       std::to_string(fd_) + ")", errno);
+                if (it->type == Added || (it->type == Modified && it->file_type == file_type))
+                {
+                    return;
+                }
+                break;
             }
-            // Read available bytes
-            buffer.resize(bytes_avail);
-            int bytes_read = read(fd_, &buffer[0], buffer.size());
-            if (bytes_read < 0)
+        }
+    }
+    pending.push_back(PendingEvent{ type, file_type, path, key });
+}
+
+// Returns true if at least one event was read, even if it was coalesced with a pending event.
+
+bool DirWatcher::read_events(std::vector<PendingEvent>& pending)
+{
+    alignas(struct inotify_event) char buffer[16 * 1024];
+    bool events_read = false;
+
+    // Drain the (non-blocking) inotify fd
+    while (true)
+    {
+        ssize_t bytes_read = read(fd_, buffer, sizeof(buffer));
+        if (bytes_read < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
-                throw SyscallException("DirWatcher::watch_thread(): Thread aborted: "
-                                       "read() failed on inotify fd (fd = " +
-                                       std::to_string(fd_) + ")", errno);
+                return events_read;
             }
-            if (bytes_read != bytes_avail)
+            if (errno == EINTR)
             {
-                throw ResourceException("DirWatcher::watch_thread(): Thread aborted: "
-                                       "read() returned " + std::to_string(bytes_read) +
-                                       " bytes, expected " + std::to_string(bytes_avail) +
-                                       " bytes (fd = " + std::to_string(fd_) + ")");
+                continue;
             }
+            throw SyscallException("DirWatcher::watch_thread(): Thread aborted: "
+                                   "read() failed on inotify fd (fd = " +
+                                   std::to_string(fd_) + ")", errno);
+        }
 
-            // Process event(s) received
-            int i = 0;
-            while (i < bytes_read)
-            {
-                static_assert(std::alignment_of<char*>::value >= std::alignment_of<struct inotify_event>::value,
-                              "cannot use std::string as buffer for inotify events");
+        // Process event(s) received
+        events_read = events_read || bytes_read > 0;
+        ssize_t i = 0;
+        while (i < bytes_read)
+        {
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wcast-align"
-                auto event = reinterpret_cast<inotify_event const*>(&buffer[i]);
+            auto event = reinterpret_cast<inotify_event const*>(&buffer[i]);
 #pragma GCC diagnostic pop
+            i += sizeof(inotify_event) + event->len;
+
+            std::string event_path;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = wds_.find(event->wd);
+                if (it != wds_.end())
                 {
-                    event_path = "";
-                    std::lock_guard<std::mutex> lock(mutex_);
-                    if (wds_.find(event->wd) != wds_.end())
-                    {
-                        event_path = wds_.at(event->wd) + "/" + event->name;
-                    }
+                    event_path = it->second + "/" + event->name;
                 }
+            }
 
-                if (event->mask & IN_CREATE || event->mask & IN_MOVED_TO)
+            FileType file_type = event->mask & IN_ISDIR ? Directory : File;
+            if (event->mask & IN_CREATE || event->mask & IN_MOVED_TO)
+            {
+                queue_event(pending, Added, file_type, event_path);
+            }
+            else if (event->mask & IN_DELETE || event->mask & IN_MOVED_FROM)
+            {
+                queue_event(pending, Removed, file_type, event_path);
+            }
+            else if (event->mask & IN_MODIFY)
+            {
+                if (file_type == Directory)
                 {
-                    if (event->mask & IN_ISDIR)
-                    {
-                        watch_event(Added, Directory, event_path);
-                    }
-                    else
-                    {
-                        watch_event(Added, File, event_path);
-                    }
+                    queue_event(pending, Modified, Directory, event_path);
                 }
-                else if (event->mask & IN_DELETE || event->mask & IN_MOVED_FROM)
+            }
+            else if (event->mask & IN_CLOSE_WRITE)
+            {
+                queue_event(pending, Modified, File, event_path);
+            }
+        }
+    }
+}
+
+void DirWatcher::watch_thread()
+{
+    try
+    {
+        std::vector<PendingEvent> pending;
+        std::chrono::steady_clock::time_point first_event_time;
+        std::chrono::steady_clock::time_point last_event_time;
+
+        // Poll for notifications until stop is requested
+        while (true)
+        {
+            auto deadline = [&]
+            {
+                return std::min(last_event_time + debounce_window_,
+                                first_event_time + max_debounce_windows * debounce_window_);
+            };
+
+            // Wait indefinitely if nothing is pending, otherwise until the pending events are due
+            int timeout = -1;
+            if (!pending.empty())
+            {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     deadline() - std::chrono::steady_clock::now()).count();
+                timeout = remaining > 0 ? static_cast<int>(remaining) + 1 : 0;
+            }
+
+            struct epoll_event events[2];
+            int ret = epoll_wait(epoll_fd_, events, 2, timeout);
+            if (ret < 0)
+            {
+                if (errno == EINTR)
                 {
-                    if (event->mask & IN_ISDIR)
-                    {
-                        watch_event(Removed, Directory, event_path);
-                    }
-                    else
-                    {
-                        watch_event(Removed, File, event_path);
-                    }
+                    continue;
                 }
-                else if (event->mask & IN_MODIFY)
+                throw SyscallException("DirWatcher::watch_thread(): Thread aborted: "
+                                       "epoll_wait() failed (fd = " +
+                                       std::to_string(epoll_fd_) + ")", errno);
+            }
+
+            for (int i = 0; i < ret; ++i)
+            {
+                if (events[i].data.fd == fd_)
                 {
-                    if (event->mask & IN_ISDIR)
+                    // Any event, even one that was coalesced, restarts the debounce window.
+                    bool was_empty = pending.empty();
+                    if (read_events(pending) && !pending.empty())
                     {
-                        watch_event(Modified, Directory, event_path);
+                        last_event_time = std::chrono::steady_clock::now();
+                        if (was_empty)
+                        {
+                            first_event_time = last_event_time;
+                        }
                     }
                 }
-                else if (event->mask & IN_CLOSE_WRITE)
-                {
-                    watch_event(Modified, File, event_path);
-                }
-                i += sizeof(inotify_event) + event->len;
             }
 
             // Break from the loop if we are stopping
@@ -279,6 +385,16 @@ void DirWatcher::watch_thread()
                     break;
                 }
             }
+
+            // Deliver the pending events once things have settled down
+            if (!pending.empty() && std::chrono::steady_clock::now() >= deadline())
+            {
+                for (auto const& e : pending)
+                {
+                    watch_event(e.type, e.file_type, e.path);
+                }
+                pending.clear();
+            }
         }
     }
     catch (std::exception const& e)
@@ -20,9 +20,11 @@
 
 #include <unity/scopes/internal/Logger.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <map>
 #include <thread>
+#include <vector>
 
 namespace scoperegistry
 {
@@ -31,6 +33,14 @@ namespace scoperegistry
 // the files and folders contained. If a file or folder is added, removed or modified, the pure
 // virtual watch_event() method is executed (this is to be overridden by a child class deriving
 // from DirWatcher)
+//
+// Events are not delivered as they arrive. Instead, they are collected until no new event has
+// been received for debounce_window (or until ten debounce windows have passed since the first
+// pending event, so a constant stream of changes cannot hold back delivery indefinitely).
+// Repeated Added / Modified events with the same coalesce_key() within that time are delivered
+// only once, so unpacking a package results in a single event rather than one per write. By
+// default, the key is the path itself; derived classes can widen it (for example, to the
+// directory that contains the path).
 
 class DirWatcher
 {
@@ -48,7 +58,8 @@ public:
         Directory
     };
 
-    DirWatcher(unity::scopes::internal::Logger& logger);
+    DirWatcher(unity::scopes::internal::Logger& logger,
+               std::chrono::milliseconds debounce_window = std::chrono::milliseconds(100));
     virtual ~DirWatcher();
 
     void add_watch(std::string const& path);
@@ -57,6 +68,8 @@ public:
 protected:
     void cleanup();
 
+    virtual std::string coalesce_key(std::string const& path) const;
+
 private:
     enum ThreadState
     {
@@ -65,7 +78,18 @@ private:
         Failed
     };
 
+    struct PendingEvent
+    {
+        EventType type;
+        FileType file_type;
+        std::string path;
+        std::string key;
+    };
+
     int const fd_;
+    int const epoll_fd_;
+    int const stop_fd_;
+    std::chrono::milliseconds const debounce_window_;
 
     std::map<int, std::string> wds_;
 
@@ -76,6 +100,8 @@ private:
     unity::scopes::internal::Logger& logger_;
 
     void watch_thread();
+    bool read_events(std::vector<PendingEvent>& pending);
+    void queue_event(std::vector<PendingEvent>& pending, EventType type, FileType file_type, std::string const& path);
     virtual void watch_event(EventType, FileType, std::string const&) = 0;
 };
 
@@ -25,6 +25,9 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 
+#include <fstream>
+#include <sstream>
+
 #include <sys/stat.h>
 
 using namespace unity::scopes::internal;
@@ -159,6 +162,31 @@ bool file_is_empty(std::string const& path)
 
 }
 
+// Returns true if the contents of ini_path differ from the last time this method
+// was called for the same path. Must be called with mutex_ locked.
+
+bool ScopesWatcher::ini_changed(std::string const& ini_path)
+{
+    std::ifstream ifs(ini_path);
+    if (!ifs)
+    {
+        // Let the callback deal with (and report) the problem.
+        ini_hashes_.erase(ini_path);
+        return true;
+    }
+    std::ostringstream contents;
+    contents << ifs.rdbuf();
+    auto hash = std::hash<std::string>()(contents.str());
+
+    auto it = ini_hashes_.find(ini_path);
+    if (it != ini_hashes_.end() && it->second == hash)
+    {
+        return false;
+    }
+    ini_hashes_[ini_path] = hash;
+    return true;
+}
+
 void ScopesWatcher::add_scope_dir(std::string const& dir)
 {
     try
@@ -192,6 +220,11 @@ void ScopesWatcher::add_scope_dir(std::string const& dir)
 
                 // Associate this directory with the contained config file
                 sdir_to_ini_map_[dir] = config.second;
+
+                if (!ini_changed(config.second))
+                {
+                    return;  // Already reported with the same contents, no need to restart the scope.
+                }
             }
 
             // New config found, execute callback
@@ -222,6 +255,7 @@ void ScopesWatcher::remove_scope_dir(std::string const& dir)
         // Unassociate this config file with its scope directory
         std::string ini_path = sdir_to_ini_map_.at(dir);
         sdir_to_ini_map_.erase(dir);
+        ini_hashes_.erase(ini_path);
 
         // Inform the registry that this scope has been removed
         filesystem::path p(ini_path);
@@ -235,15 +269,32 @@ void ScopesWatcher::remove_scope_dir(std::string const& dir)
     remove_watch(dir);
 }
 
+bool ScopesWatcher::is_scope_ini(std::string const& path)
+{
+    return filesystem::path(path).extension() == ".ini"
+           && !boost::algorithm::ends_with(path, "-settings.ini");
+}
+
+// A scope's .ini file shares its key with the scope directory, so that adding the directory and
+// then writing the .ini file into it (or writing the .ini file more than once) within the
+// debounce window results in a single event. Both are handled by (re-)reading the .ini file.
+
+std::string ScopesWatcher::coalesce_key(std::string const& path) const
+{
+    if (is_scope_ini(path))
+    {
+        return filesystem::path(path).parent_path().native();
+    }
+    return path;
+}
+
 void ScopesWatcher::watch_event(DirWatcher::EventType event_type,
                                 DirWatcher::FileType file_type,
                                 std::string const& path)
 {
     filesystem::path fs_path(path);
 
-    if (file_type == DirWatcher::File
-        && fs_path.extension() == ".ini"
-        && !boost::algorithm::ends_with(path, "-settings.ini"))
+    if (file_type == DirWatcher::File && is_scope_ini(path))
     {
         std::lock_guard<std::mutex> lock(mutex_);
 
@@ -269,7 +320,7 @@ void ScopesWatcher::watch_event(DirWatcher::EventType event_type,
             {
                 non_empty = !file_is_empty(path);
             }
-            if (non_empty)
+            if (non_empty && ini_changed(path))
             {
                 sdir_to_ini_map_[parent_path] = path;
                 ini_added_callback_(std::make_pair(scope_id, path));
@@ -281,6 +332,7 @@ void ScopesWatcher::watch_event(DirWatcher::EventType event_type,
         else if (event_type == DirWatcher::Removed)
         {
             sdir_to_ini_map_.erase(parent_path);
+            ini_hashes_.erase(path);
             registry_->remove_local_scope(scope_id);
             logger_(LoggerSeverity::Info) << "scopeswatcher: scope: \"" << scope_id
                                           << "\" .ini uninstalled: \"" << path << "\"";
@@ -28,6 +28,9 @@ namespace scoperegistry
 // ScopesWatcher watches the scope install directories specified by calls to add_install_dir() for
 // the installation / uninstallation of scopes. If a scope is removed, the registry is informed
 // accordingly. If a scope is added, a user callback (provided on construction) is executed.
+// The callback is not executed again for a .ini file whose contents have not changed since
+// the last time it was reported. Events for a scope's .ini file are coalesced with the events
+// for its scope directory, so a scope that is installed is reported only once.
 
 class ScopesWatcher : public DirWatcher
 {
@@ -46,15 +49,22 @@ private:
     unity::scopes::internal::Logger& logger_;
     std::map<std::string, std::string> sdir_to_ini_map_;
     std::map<std::string, std::set<std::string>> idir_to_sdirs_map_;
+    std::map<std::string, std::size_t> ini_hashes_;
     std::mutex mutex_;
 
     static std::string parent_dir(std::string const& child_dir);
 
     void remove_install_dir(std::string const& dir);
 
+    bool ini_changed(std::string const& ini_path);
+
+    static bool is_scope_ini(std::string const& path);
+
     void add_scope_dir(std::string const& dir);
     void remove_scope_dir(std::string const& dir);
 
+    std::string coalesce_key(std::string const& path) const override;
+
     void watch_event(DirWatcher::EventType event_type,
                      DirWatcher::FileType file_type,
                      std::string const& path) override;
@@ -559,6 +559,9 @@ int main(int argc, char* argv[])
             local_scopes[scope_id] = argv[i];                   // operator[] overwrites pre-existing entries
         }
 
+        // Writing the catalog for each scope we add would make start-up quadratic
+        // in the number of scopes, so we write it once we have found them all.
+        registry->suspend_list_updates();
         add_local_scopes(registry, local_scopes, middleware, scoperunner_path, config_file, false, process_timeout);
         add_local_scopes(registry, click_scopes, middleware, scoperunner_path, config_file, true, process_timeout);
         if (ss_reg_id.empty())
@@ -569,6 +572,7 @@ int main(int argc, char* argv[])
         {
             registry->set_remote_registry(middleware->ss_registry_proxy());
         }
+        registry->resume_list_updates();
 
         // Configure watches for scope install directories
         auto local_watch_lambda = [registry, &middleware, &scoperunner_path, &config_file, process_timeout]
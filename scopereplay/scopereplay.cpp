@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Replays the requests in a capture file (see TrafficCapture) against a running scope
+// and prints the latency distribution for each kind of request.
+
+#include <unity/scopes/internal/TrafficReplay.h>
+#include <unity/scopes/Registry.h>
+#include <unity/scopes/Runtime.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+char const* prog_name;
+
+void error(string const& msg)
+{
+    cerr << prog_name << ": " << msg << endl;
+}
+
+char const* kind_name(TrafficCapture::Kind kind)
+{
+    switch (kind)
+    {
+        case TrafficCapture::Kind::Search:
+            return "search";
+        case TrafficCapture::Kind::Preview:
+            return "preview";
+        case TrafficCapture::Kind::Activate:
+            return "activate";
+    }
+    return "unknown";  // LCOV_EXCL_LINE
+}
+
+// Nearest-rank percentile of a sorted sample, in milliseconds.
+
+double percentile(vector<chrono::microseconds> const& sorted, double p)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    auto const rank = static_cast<size_t>(p / 100 * (sorted.size() - 1) + 0.5);
+    return sorted[rank].count() / 1000.0;
+}
+
+void print_report(ReplayReport const& report)
+{
+    cout << left << setw(10) << "kind" << right
+         << setw(8) << "count" << setw(8) << "failed"
+         << setw(10) << "p50(ms)" << setw(10) << "p90(ms)" << setw(10) << "p99(ms)" << setw(10) << "max(ms)"
+         << endl;
+    cout << fixed << setprecision(2);
+    for (auto const& r : report)
+    {
+        auto sample = r.second.sample;
+        sort(sample.begin(), sample.end());
+        cout << left << setw(10) << kind_name(r.first) << right
+             << setw(8) << sample.size() + r.second.failed << setw(8) << r.second.failed
+             << setw(10) << percentile(sample, 50) << setw(10) << percentile(sample, 90)
+             << setw(10) << percentile(sample, 99) << setw(10) << percentile(sample, 100)
+             << endl;
+    }
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+    prog_name = basename(argv[0]);
+
+    // Speed 1 replays in real time, 2 twice as fast, and so on. Speed 0 sends all
+    // requests back-to-back.
+    double speed = 1;
+    vector<string> args;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+        {
+            try
+            {
+                speed = stod(argv[++i]);
+            }
+            catch (std::exception const&)
+            {
+                error(string("invalid speed: ") + argv[i]);
+                return 2;
+            }
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+    if (args.size() != 3)
+    {
+        cerr << "usage: " << prog_name << " [--speed factor] runtime.ini scope_id capturefile" << endl;
+        return 2;
+    }
+    string const& runtime_config = args[0];
+    string const& scope_id = args[1];
+    string const& capture_file = args[2];
+
+    int exit_status = 1;
+    try
+    {
+        auto const records = TrafficCapture::read(capture_file);
+        if (records.empty())
+        {
+            error(capture_file + ": no requests to replay");
+            return 1;
+        }
+
+        auto rt = Runtime::create(runtime_config);
+        auto const scope = rt->registry()->get_metadata(scope_id).proxy();
+
+        auto const report = replay_traffic(scope, records, speed);
+        print_report(report);
+
+        exit_status = 0;
+        for (auto const& r : report)
+        {
+            if (r.second.failed != 0)
+            {
+                exit_status = 1;
+            }
+        }
+    }
+    catch (std::exception const& e)
+    {
+        error(e.what());
+    }
+    catch (...)
+    {
+        error("terminated due to unknown exception");
+    }
+
+    return exit_status;
+}
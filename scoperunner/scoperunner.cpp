@@ -25,6 +25,10 @@
 #include <core/posix/signal.h>
 #include <core/posix/this_process.h>
 
+#include <algorithm>
+#include <fstream>
+#include <future>
+
 using namespace std;
 using namespace unity::scopes;
 using namespace unity::scopes::internal;
@@ -69,6 +73,104 @@ private:
     std::function<void()> f_;
 };
 
+// Figure out what the scope ID is from the name of the scope config file.
+
+string scope_id_of(string const& scope_config)
+{
+    return boost::filesystem::canonical(scope_config).stem().native();
+}
+
+string lib_dir_of(string const& scope_config)
+{
+    return boost::filesystem::canonical(scope_config).parent_path().native();
+}
+
+// Make sure we set LD_LIBRARY_PATH to include <lib_dir> and <lib_dir>/lib
+// before loading the scope's .so.
+
+void set_ld_library_path(string const& lib_dir, string const& scope_id)
+{
+    string scope_ld_lib_path = lib_dir + ":" + lib_dir + "/lib";
+    string ld_lib_path = core::posix::this_process::env::get("LD_LIBRARY_PATH", "");
+    if (!boost::starts_with(ld_lib_path, lib_dir))
+    {
+        scope_ld_lib_path = scope_ld_lib_path + (ld_lib_path.empty() ? "" : (":" + ld_lib_path));
+        try
+        {
+            // No overwrite option for this_process::env::set(), need to unset first
+            core::posix::this_process::env::unset_or_throw("LD_LIBRARY_PATH");
+            core::posix::this_process::env::set_or_throw("LD_LIBRARY_PATH", scope_ld_lib_path);
+        }
+        catch (std::exception const&)
+        {
+            throw unity::ResourceException("cannot set LD_LIBRARY_PATH for scope " + scope_id);
+        }
+    }
+}
+
+ScopeLoader::SPtr load_scope(string const& scope_id, string const& lib_dir)
+{
+    // For a scope_id "Fred", we look for the library as "libFred.so", "Fred.so", and "scope.so".
+    vector<string> libs;
+    libs.push_back(lib_dir + "/" + DEB_HOST_MULTIARCH + "/lib" + scope_id + ".so");
+    libs.push_back(lib_dir + "/" + DEB_HOST_MULTIARCH + "/" + scope_id + ".so");
+    libs.push_back(lib_dir + "/" + DEB_HOST_MULTIARCH + "/scope.so");
+    libs.push_back(lib_dir + "/lib" + scope_id + ".so");
+    libs.push_back(lib_dir + "/" + scope_id + ".so");
+    libs.push_back(lib_dir + "/scope.so");
+    string failed_libs;
+    ScopeLoader::SPtr loader;
+    exception_ptr ep;
+    for (auto const& lib : libs)
+    {
+        try
+        {
+            loader = ScopeLoader::load(scope_id, lib);
+        }
+        catch (unity::ResourceException& e)
+        {
+            failed_libs += "\n    " + lib;
+            ep = e.remember(ep);
+        }
+        if (loader)
+        {
+            break;
+        }
+    }
+    if (!loader)
+    {
+        unity::ResourceException e("Cannot load scope " + scope_id + "; tried in the following locations:"
+                                   + failed_libs);
+        e.remember(ep);
+        throw e;
+    }
+    return loader;
+}
+
+// Returns the resident set size and thread count of this process, as reported
+// by /proc/self/status, so the footprint of a host process can be compared with
+// that of the equivalent number of single-scope processes.
+
+string process_stats()
+{
+    string rss = "?";
+    string threads = "?";
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line))
+    {
+        if (boost::starts_with(line, "VmRSS:"))
+        {
+            rss = boost::trim_copy(line.substr(6));
+        }
+        else if (boost::starts_with(line, "Threads:"))
+        {
+            threads = boost::trim_copy(line.substr(8));
+        }
+    }
+    return "VmRSS: " + rss + ", threads: " + threads;
+}
+
 // Run the scope specified by the config_file in a separate thread and wait for the thread to finish.
 // Return exit status for main to use.
 
@@ -83,74 +185,98 @@ int run_scope(std::string const& runtime_config, std::string const& scope_config
     std::thread trap_worker([trap]{ trap->run(); });
     ThreadWrapper trap_wrapper(std::move(trap_worker), [trap]{ trap->stop(); });
 
-    // Figure out what the scope ID is from the name of the scope config file.
-    auto scope_config_path = boost::filesystem::canonical(scope_config);
-    string lib_dir = scope_config_path.parent_path().native();
-    string scope_id = scope_config_path.stem().native();
+    string scope_id = scope_id_of(scope_config);
+    string lib_dir = lib_dir_of(scope_config);
+    set_ld_library_path(lib_dir, scope_id);
 
+    int exit_status = 1;
+    try
     {
-        // Make sure we set LD_LIBRARY_PATH to include <lib_dir> and <lib_dir>/lib
-        // before loading the scope's .so.
-        string scope_ld_lib_path = lib_dir + ":" + lib_dir + "/lib";
-        string ld_lib_path = core::posix::this_process::env::get("LD_LIBRARY_PATH", "");
-        if (!boost::starts_with(ld_lib_path, lib_dir))
+        auto loader = load_scope(scope_id, lib_dir);
+
+        static mutex rt_mutex;
+        RuntimeImpl::SPtr rt;
+
+        // Signal handler to shut down the run time on receipt of a signal.
+        trap->signal_raised().connect([&rt](core::posix::Signal)
         {
-            scope_ld_lib_path = scope_ld_lib_path + (ld_lib_path.empty() ? "" : (":" + ld_lib_path));
-            try
-            {
-                // No overwrite option for this_process::env::set(), need to unset first
-                core::posix::this_process::env::unset_or_throw("LD_LIBRARY_PATH");
-                core::posix::this_process::env::set_or_throw("LD_LIBRARY_PATH", scope_ld_lib_path);
-            }
-            catch (std::exception const&)
+            lock_guard<mutex> lock(rt_mutex);
+            if (rt)
             {
-                throw unity::ResourceException("cannot set LD_LIBRARY_PATH for scope " + scope_id);
+                rt->destroy();
             }
+        });
+
+        // Instantiate the run time and run the scope.
+        {
+            lock_guard<mutex> lock(rt_mutex);
+            rt = RuntimeImpl::create(scope_id, runtime_config);
         }
+
+        rt->run_scope(loader->scope_base(), scope_config);
+
+        exit_status = 0;
+    }
+    catch (std::exception const& e)
+    {
+        error(e.what());
+    }
+    catch (...)
+    {
+        error("unknown exception");
     }
 
-    int exit_status = 1;
-    try
+    return exit_status;
+}
+
+// Host mode: run several scopes in this process. Each scope is loaded by its own
+// ScopeLoader and keeps its own scope ID and endpoint, but all of them share a single
+// run time, so there is only one middleware (zmq context, reaper, and invocation pools)
+// for the whole process. Hosted scopes share an address space, so this is suitable
+// only for trusted, unconfined scopes. The host runs until it receives a signal.
+// Each scope reports its ready and stopping states to the registry under its own ID,
+// so the registry records every hosted scope as a manually started scope and does not
+// start a second instance of it.
+// Return exit status for main to use.
+
+int host_scopes(std::string const& runtime_config, vector<string> const& scope_configs)
+{
+    assert(!scope_configs.empty());
+
+    auto trap = core::posix::trap_signals_for_all_subsequent_threads(
     {
-        // For a scope_id "Fred", we look for the library as "libFred.so", "Fred.so", and "scope.so".
-        vector<string> libs;
-        libs.push_back(lib_dir + "/" + DEB_HOST_MULTIARCH + "/lib" + scope_id + ".so");
-        libs.push_back(lib_dir + "/" + DEB_HOST_MULTIARCH + "/" + scope_id + ".so");
-        libs.push_back(lib_dir + "/" + DEB_HOST_MULTIARCH + "/scope.so");
-        libs.push_back(lib_dir + "/lib" + scope_id + ".so");
-        libs.push_back(lib_dir + "/" + scope_id + ".so");
-        libs.push_back(lib_dir + "/scope.so");
-        string failed_libs;
-        ScopeLoader::SPtr loader;
-        exception_ptr ep;
-        for (auto const& lib : libs)
+        core::posix::Signal::sig_hup,
+        core::posix::Signal::sig_term
+    });
+
+    std::thread trap_worker([trap]{ trap->run(); });
+    ThreadWrapper trap_wrapper(std::move(trap_worker), [trap]{ trap->stop(); });
+
+    vector<string> scope_ids;
+    for (auto const& config : scope_configs)
+    {
+        auto scope_id = scope_id_of(config);
+        if (find(scope_ids.begin(), scope_ids.end(), scope_id) != scope_ids.end())
         {
-            try
-            {
-                loader = ScopeLoader::load(scope_id, lib);
-            }
-            catch (unity::ResourceException& e)
-            {
-                failed_libs += "\n    " + lib;
-                ep = e.remember(ep);
-            }
-            if (loader)
-            {
-                break;
-            }
+            throw unity::InvalidArgumentException("scope " + scope_id + " specified more than once");
         }
-        if (!loader)
+        set_ld_library_path(lib_dir_of(config), scope_id);
+        scope_ids.push_back(scope_id);
+    }
+
+    int exit_status = 1;
+    try
+    {
+        vector<ScopeLoader::SPtr> loaders;
+        for (size_t i = 0; i < scope_configs.size(); ++i)
         {
-            unity::ResourceException e("Cannot load scope " + scope_id + "; tried in the following locations:"
-                                       + failed_libs);
-            e.remember(ep);
-            throw e;
+            loaders.push_back(load_scope(scope_ids[i], lib_dir_of(scope_configs[i])));
         }
 
         static mutex rt_mutex;
         RuntimeImpl::SPtr rt;
 
-        // Signal handler to shut down the run time on receipt of a signal.
+        // Signal handler to shut down the run time (and with it, all scopes) on receipt of a signal.
         trap->signal_raised().connect([&rt](core::posix::Signal)
         {
             lock_guard<mutex> lock(rt_mutex);
@@ -160,23 +286,56 @@ int run_scope(std::string const& runtime_config, std::string const& scope_config
             }
         });
 
-        // Instantiate the run time and run the scope.
+        // The run time needs a server name that does not clash with any of the hosted scopes.
         {
             lock_guard<mutex> lock(rt_mutex);
-            rt = RuntimeImpl::create(scope_id, runtime_config);
+            rt = RuntimeImpl::create("host-" + scope_ids[0], runtime_config);
         }
 
-        rt->run_scope(loader->scope_base(), scope_config);
+        // Run each scope in its own thread. host_scope() returns once the run time shuts down.
+        vector<future<void>> ready_futures;
+        vector<future<void>> run_futures;
+        for (size_t i = 0; i < loaders.size(); ++i)
+        {
+            promise<void> ready_promise;
+            ready_futures.push_back(ready_promise.get_future());
+            auto scope_base = loaders[i]->scope_base();
+            auto const& scope_id = scope_ids[i];
+            auto const& scope_config = scope_configs[i];
+            run_futures.push_back(async(launch::async, [rt, scope_base, scope_id, scope_config](promise<void> p)
+            {
+                rt->host_scope(scope_base, scope_id, scope_config, move(p));
+            }, move(ready_promise)));
+        }
+        for (auto& f : ready_futures)
+        {
+            f.wait();
+        }
+        rt->logger()(LoggerSeverity::Info) << "hosting " << loaders.size() << " scopes, " << process_stats();
 
         exit_status = 0;
+        for (size_t i = 0; i < run_futures.size(); ++i)
+        {
+            try
+            {
+                run_futures[i].get();
+            }
+            catch (std::exception const& e)
+            {
+                error(scope_ids[i] + ": " + e.what());
+                exit_status = 1;
+            }
+        }
     }
     catch (std::exception const& e)
     {
         error(e.what());
+        exit_status = 1;
     }
     catch (...)
     {
         error("unknown exception");
+        exit_status = 1;
     }
 
     return exit_status;
@@ -188,18 +347,25 @@ int
 main(int argc, char* argv[])
 {
     prog_name = basename(argv[0]);
-    if (argc != 3)
+    if (argc < 3)
     {
-        cerr << "usage: " << prog_name << " runtime.ini configfile.ini" << endl;
+        cerr << "usage: " << prog_name << " runtime.ini configfile.ini [configfile.ini...]" << endl;
         return 2;
     }
     char const* const runtime_config = argv[1];
-    char const* const scope_config = argv[2];
+    vector<string> scope_configs(argv + 2, argv + argc);
 
     int exit_status = 1;
     try
     {
-        exit_status = run_scope(runtime_config, scope_config);
+        if (scope_configs.size() == 1)
+        {
+            exit_status = run_scope(runtime_config, scope_configs[0]);
+        }
+        else
+        {
+            exit_status = host_scopes(runtime_config, scope_configs);
+        }
     }
     catch (std::exception const& e)
     {
@@ -82,6 +82,16 @@ std::vector<OperationInfo> CompletionDetails::info_list() const
     return p->info_list();
 }
 
+bool CompletionDetails::has_timings() const noexcept
+{
+    return p->has_timings();
+}
+
+QueryTimings CompletionDetails::timings() const
+{
+    return p->timings();
+}
+
 // Possibly overkill, but safer than using the enum as the index into an array,
 // in case the enumeration is ever added to or the enumerators get re-ordered.
 
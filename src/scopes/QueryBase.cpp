@@ -43,6 +43,7 @@ QueryBase::~QueryBase()
 void QueryBase::cancel()
 {
     p->cancel();    // Forward cancel to subqueries
+    p->notify_cancelled();
     cancelled();
 }
 /// @endcond
@@ -57,6 +58,11 @@ VariantMap QueryBase::settings() const
     return p->settings();
 }
 
+int QueryBase::cancel_fd() const
+{
+    return p->cancel_fd();
+}
+
 } // namespace scopes
 
 } // namespace unity
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/QueryTimings.h>
+#include <unity/scopes/internal/QueryTimingsImpl.h>
+
+namespace unity
+{
+
+namespace scopes
+{
+
+QueryTimings::QueryTimings()
+    : p(new internal::QueryTimingsImpl)
+{
+}
+
+QueryTimings::QueryTimings(internal::QueryTimingsImpl* impl)
+    : p(impl)
+{
+}
+
+/// @cond
+
+QueryTimings::QueryTimings(QueryTimings const& other)
+    : p(new internal::QueryTimingsImpl(*other.p.get()))
+{
+}
+
+QueryTimings::QueryTimings(QueryTimings&&) = default;
+
+QueryTimings& QueryTimings::operator=(QueryTimings const& other)
+{
+    if (this != &other)
+    {
+        p.reset(new internal::QueryTimingsImpl(*other.p.get()));
+    }
+    return *this;
+}
+
+QueryTimings& QueryTimings::operator=(QueryTimings&&) = default;
+
+QueryTimings::~QueryTimings() = default;
+
+/// @endcond
+
+std::string QueryTimings::scope_id() const
+{
+    return p->scope_id();
+}
+
+std::chrono::microseconds QueryTimings::send_time() const
+{
+    return p->send_time();
+}
+
+std::chrono::microseconds QueryTimings::run_start() const
+{
+    return p->run_start();
+}
+
+std::chrono::microseconds QueryTimings::first_push() const
+{
+    return p->first_push();
+}
+
+std::chrono::microseconds QueryTimings::last_push() const
+{
+    return p->last_push();
+}
+
+std::chrono::microseconds QueryTimings::total() const
+{
+    return p->total();
+}
+
+std::size_t QueryTimings::result_count() const
+{
+    return p->result_count();
+}
+
+std::size_t QueryTimings::byte_count() const
+{
+    return p->byte_count();
+}
+
+std::vector<QueryTimings> QueryTimings::subqueries() const
+{
+    return p->subqueries();
+}
+
+} // namespace scopes
+
+} // namespace unity
@@ -18,6 +18,12 @@
 
 #include <unity/scopes/Registry.h>
 
+#include <unity/scopes/ScopeExceptions.h>
+
+#include <algorithm>
+
+using namespace std;
+
 namespace unity
 {
 
@@ -32,6 +38,43 @@ Registry::~Registry() = default;
 
 /// @endcond
 
+MetadataMap Registry::find_by_keywords(set<string> const& keywords)
+{
+    return list_if([&keywords](ScopeMetadata const& item)
+    {
+        auto const item_keywords = item.keywords();
+        return any_of(item_keywords.begin(), item_keywords.end(),
+                      [&keywords](string const& k) { return keywords.find(k) != keywords.end(); });
+    });
+}
+
+MetadataMap Registry::children_of(string const& scope_id)
+{
+    ScopeMetadata aggregator = get_metadata(scope_id);  // Throws NotFoundException if scope doesn't exist.
+
+    MetadataMap children;
+    if (aggregator.is_aggregator())
+    {
+        children = find_by_keywords(aggregator.keywords());
+    }
+    for (auto const& id : aggregator.child_scope_ids())
+    {
+        if (children.find(id) == children.end())
+        {
+            try
+            {
+                children.emplace(id, get_metadata(id));
+            }
+            catch (NotFoundException const&)
+            {
+                // Child scopes that aren't installed are ignored.
+            }
+        }
+    }
+    children.erase(scope_id);
+    return children;
+}
+
 } // namespace scopes
 
 } // namespace unity
@@ -109,6 +109,26 @@ bool SearchMetadata::is_aggregated() const
     return static_cast<internal::SearchMetadataImpl*>(p.get())->is_aggregated();
 }
 
+void SearchMetadata::set_deadline(std::chrono::system_clock::time_point deadline)
+{
+    static_cast<internal::SearchMetadataImpl*>(p.get())->set_deadline(deadline);
+}
+
+std::chrono::system_clock::time_point SearchMetadata::deadline() const
+{
+    return static_cast<internal::SearchMetadataImpl*>(p.get())->deadline();
+}
+
+bool SearchMetadata::has_deadline() const
+{
+    return static_cast<internal::SearchMetadataImpl*>(p.get())->has_deadline();
+}
+
+std::chrono::milliseconds SearchMetadata::remaining_time() const
+{
+    return static_cast<internal::SearchMetadataImpl*>(p.get())->remaining_time();
+}
+
 void SearchMetadata::set_hint(std::string const& key, Variant const& value)
 {
     static_cast<internal::SearchMetadataImpl*>(p.get())->hint(key) = value;
@@ -17,12 +17,11 @@
  */
 
 #include <unity/scopes/Variant.h>
-#include <unity/scopes/internal/JsonCppNode.h>
+#include <unity/scopes/internal/VariantImpl.h>
+#include <unity/scopes/internal/VariantJson.h>
 
 #include <unity/UnityExceptions.h>
 
-#include <boost/variant.hpp>
-
 using namespace std;
 
 namespace unity
@@ -31,29 +30,6 @@ namespace unity
 namespace scopes
 {
 
-namespace internal
-{
-
-struct NullVariant
-{
-    bool operator<(NullVariant const&) const
-    {
-        return false;
-    }
-
-    bool operator==(NullVariant const&) const
-    {
-        return true;
-    }
-};
-
-struct VariantImpl
-{
-    boost::variant<NullVariant, int, bool, string, double, VariantMap, VariantArray, int64_t> v;
-};
-
-} // namespace internal
-
 Variant::Variant() noexcept
     : p(new internal::VariantImpl { internal::NullVariant() })
 {
@@ -294,14 +270,15 @@ void swap(Variant& lhs, Variant& rhs) noexcept
 
 std::string Variant::serialize_json() const
 {
-    internal::JsonCppNode node(*this);
-    return node.to_json_string();
+    std::string json;
+    internal::variant_to_json(*this, json);
+    json += '\n';
+    return json;
 }
 
 Variant Variant::deserialize_json(std::string const& json_string)
 {
-    internal::JsonCppNode node(json_string);
-    return node.to_variant();
+    return internal::json_to_variant(json_string);
 }
 
 } // namespace scopes
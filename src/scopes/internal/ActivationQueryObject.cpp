@@ -62,6 +62,8 @@ void ActivationQueryObject::run(MWReplyProxy const& reply, InvokeInfo const& inf
 
     try
     {
+        reply->run_started(info.mw->runtime()->scope_id());  // For the client's QueryTimings
+
         // no need for intermediate proxy (like with ReplyImpl::create),
         // since we get single return value from the public API
         // and just push it ourseleves
@@ -18,7 +18,6 @@
 
 #include <unity/scopes/internal/CannedQueryImpl.h>
 #include <unity/scopes/internal/FilterStateImpl.h>
-#include <unity/scopes/internal/JsonCppNode.h>
 #include <unity/scopes/CannedQuery.h>
 #include <unity/UnityExceptions.h>
 #include <unity/scopes/internal/Utils.h>
@@ -210,13 +209,11 @@ std::string CannedQueryImpl::to_uri() const
     if (filters_var.size())
     {
         Variant const var(filters_var);
-        internal::JsonCppNode const jstr(var);
-        s << "&filters=" << to_percent_encoding(jstr.to_json_string());
+        s << "&filters=" << to_percent_encoding(var.serialize_json());
     }
     if (user_data_)
     {
-        internal::JsonCppNode const jstr(*(user_data_));
-        s << "&data=" << to_percent_encoding(jstr.to_json_string());
+        s << "&data=" << to_percent_encoding(user_data_->serialize_json());
     }
     return s.str();
 }
@@ -285,8 +282,7 @@ CannedQuery CannedQueryImpl::from_uri(std::string const& uri)
                 else if (key == "filters")
                 {
                     auto const fstate_json = decode_or_throw(val, key, uri);
-                    internal::JsonCppNode const node(fstate_json);
-                    auto const var = node.to_variant();
+                    auto const var = Variant::deserialize_json(fstate_json);
                     if (var.which() == Variant::Type::Dict)
                     {
                         q.set_filter_state(internal::FilterStateImpl::deserialize(var.get_dict()));
@@ -301,8 +297,7 @@ CannedQuery CannedQueryImpl::from_uri(std::string const& uri)
                 else if (key == "data")
                 {
                     auto const data_json = decode_or_throw(val, key, uri);
-                    internal::JsonCppNode const node(data_json);
-                    q.set_user_data(node.to_variant());
+                    q.set_user_data(Variant::deserialize_json(data_json));
                 }
                 // else - unknown keys are ignored
             } // else - the string with no '=' is ignored
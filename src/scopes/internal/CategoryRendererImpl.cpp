@@ -18,7 +18,7 @@
 
 #include <unity/scopes/internal/CategoryRendererImpl.h>
 #include <unity/scopes/CategoryRenderer.h>
-#include <unity/scopes/internal/JsonCppNode.h>
+#include <unity/scopes/Variant.h>
 #include <unity/util/FileIO.h>
 #include <unity/UnityExceptions.h>
 
@@ -39,8 +39,7 @@ CategoryRendererImpl::CategoryRendererImpl(std::string const& json_text)
 {
     try
     {
-        const internal::JsonCppNode node(json_text);
-        if (node.type() != internal::JsonNodeInterface::NodeType::Object)
+        if (Variant::deserialize_json(json_text).which() != Variant::Dict)
         {
             throw unity::InvalidArgumentException("CategoryRenderer(): invalid JSON definition, template is not a dictionary");
         }
@@ -17,9 +17,10 @@
  */
 
 #include <unity/scopes/internal/ChildScopesRepository.h>
-#include <unity/scopes/internal/JsonCppNode.h>
+#include <unity/scopes/internal/VariantJson.h>
 
 #include <cassert>
+#include <cstdio>
 #include <fstream>
 #include <set>
 #include <sstream>
@@ -27,13 +28,42 @@
 using namespace unity::scopes;
 using namespace unity::scopes::internal;
 
+bool ChildScopesRepository::FileStamp::operator==(FileStamp const& other) const
+{
+    if (!exists || !other.exists)
+    {
+        return exists == other.exists;
+    }
+    return mtime.tv_sec == other.mtime.tv_sec
+           && mtime.tv_nsec == other.mtime.tv_nsec
+           && inode == other.inode
+           && size == other.size;
+}
+
 ChildScopesRepository::ChildScopesRepository(std::string const& repo_file_path, Logger& logger)
     : repo_file_path_(repo_file_path)
     , logger_(logger)
     , have_latest_cache_(false)
+    , write_seq_(0)
+    , pending_seq_(0)
+    , stopping_(false)
+    , written_seq_(0)
 {
 }
 
+ChildScopesRepository::~ChildScopesRepository()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cond_.notify_all();
+    if (writer_.joinable())
+    {
+        writer_.join();  // Flushes any pending write
+    }
+}
+
 ChildScopeList ChildScopesRepository::child_scopes(ChildScopeList const& child_scopes_defaulted)
 {
     ChildScopeList child_scopes;
@@ -41,15 +71,16 @@ ChildScopeList ChildScopesRepository::child_scopes(ChildScopeList const& child_s
     std::lock_guard<std::mutex> lock(mutex_);
 
     // Read child scope enabled states from our repo
-    auto child_enabled_map = read_repo();
+    auto const& child_enabled_map = read_repo();
 
     // If we find a child scope in the repo, replace its enabled state with the one found in the repo
     for (auto const& child_scope : child_scopes_defaulted)
     {
-        if (child_enabled_map.find(child_scope.id) != child_enabled_map.end())
+        auto it = child_enabled_map.find(child_scope.id);
+        if (it != child_enabled_map.end())
         {
             ChildScope updated_child_scope = child_scope;
-            updated_child_scope.enabled = child_enabled_map.at(child_scope.id);
+            updated_child_scope.enabled = it->second;
             child_scopes.push_back(updated_child_scope);
         }
         else
@@ -59,8 +90,21 @@ ChildScopeList ChildScopesRepository::child_scopes(ChildScopeList const& child_s
         }
     }
 
-    // write the new ordered list to file
-    write_repo(child_scopes);
+    // Write the new ordered list to file, but only if it differs from what's in the repo already.
+    // The write happens in the background, so we don't hold up the caller.
+    auto entries = to_entries(child_scopes);
+    if (entries != cached_entries_)
+    {
+        pending_json_.reset(new std::string(list_to_json(entries)));
+        pending_seq_ = ++write_seq_;
+        update_cache(entries);
+        if (!writer_.joinable())
+        {
+            writer_ = std::thread(&ChildScopesRepository::writer_thread, this);
+        }
+        cond_.notify_all();
+    }
+
     return child_scopes;
 }
 
@@ -68,35 +112,134 @@ bool ChildScopesRepository::set_child_scopes(ChildScopeList const& child_scopes)
 {
     // simply write child_scopes_ordered to file
     std::lock_guard<std::mutex> lock(mutex_);
-    return write_repo(child_scopes);
+
+    // This write supersedes any pending background write.
+    pending_json_.reset();
+    auto entries = to_entries(child_scopes);
+    if (!write_repo(list_to_json(entries), ++write_seq_))
+    {
+        have_latest_cache_ = false;
+        return false;
+    }
+    update_cache(entries);
+    file_stamp_ = stamp();
+    return true;
+}
+
+ChildScopesRepository::Entries ChildScopesRepository::to_entries(ChildScopeList const& child_scopes_list)
+{
+    Entries entries;
+    entries.reserve(child_scopes_list.size());
+    for (auto const& child_scope : child_scopes_list)
+    {
+        entries.emplace_back(child_scope.id, child_scope.enabled);
+    }
+    return entries;
 }
 
-bool ChildScopesRepository::write_repo(ChildScopeList const& child_scopes_list)
+ChildScopesRepository::FileStamp ChildScopesRepository::stamp() const
+{
+    FileStamp s;
+    struct stat st;
+    if (::stat(repo_file_path_.c_str(), &st) == 0)
+    {
+        s.exists = true;
+        s.mtime = st.st_mtim;
+        s.inode = st.st_ino;
+        s.size = st.st_size;
+    }
+    return s;
+}
+
+void ChildScopesRepository::update_cache(Entries const& entries)
 {
     assert(!mutex_.try_lock());
 
+    // If an aggregator aggregates the same child scope more than once (say, for different keywords),
+    // we count the enabled state of its first appearance as the overall enabled state of that child.
+    cached_repo_.clear();
+    for (auto const& entry : entries)
+    {
+        cached_repo_.insert(entry);
+    }
+    cached_entries_ = entries;
+    have_latest_cache_ = true;
+}
+
+// Writes to a temporary file and renames it, so readers never see a partially written repo.
+// A write is skipped if a later write has made it to the file already.
+
+bool ChildScopesRepository::write_repo(std::string const& json, uint64_t seq)
+{
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    if (seq < written_seq_)
+    {
+        return true;
+    }
+
+    std::string const tmp_path = repo_file_path_ + ".tmp";
+
     // open repository for output
-    std::ofstream repo_file(repo_file_path_);
+    std::ofstream repo_file(tmp_path);
     if (repo_file.fail())
     {
-        logger_() << "ChildScopesRepository::write_repo(): Failed to open file: \"" << repo_file_path_ << "\"";
+        logger_() << "ChildScopesRepository::write_repo(): Failed to open file: \"" << tmp_path << "\"";
         return false;
     }
 
-    repo_file << list_to_json(child_scopes_list);
+    repo_file << json;
     repo_file.close();
+    if (repo_file.fail() || ::rename(tmp_path.c_str(), repo_file_path_.c_str()) != 0)
+    {
+        logger_() << "ChildScopesRepository::write_repo(): Failed to write file: \"" << repo_file_path_ << "\"";
+        ::remove(tmp_path.c_str());
+        return false;
+    }
 
-    have_latest_cache_ = false;
+    written_seq_ = seq;
     return true;
 }
 
-ChildScopeEnabledMap ChildScopesRepository::read_repo()
+void ChildScopesRepository::writer_thread()
 {
-    // if we already have the latest cache of the repo, simply return it
-    if (have_latest_cache_)
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true)
+    {
+        cond_.wait(lock, [this] { return pending_json_ || stopping_; });
+        if (!pending_json_)
+        {
+            return;
+        }
+
+        std::unique_ptr<std::string> json(std::move(pending_json_));
+        uint64_t const seq = pending_seq_;
+
+        lock.unlock();
+        bool const ok = write_repo(*json, seq);
+        lock.lock();
+
+        // Remember the state of our own write, so we don't read it back. If the write failed,
+        // we keep the cache, so we don't try again until the list of child scopes changes.
+        if (ok && seq == write_seq_)
+        {
+            file_stamp_ = stamp();
+        }
+    }
+}
+
+ChildScopeEnabledMap const& ChildScopesRepository::read_repo()
+{
+    assert(!mutex_.try_lock());
+
+    // if we already have the latest cache of the repo, and the file hasn't been changed
+    // by someone else since, simply return the cache
+    auto const current_stamp = stamp();
+    if (have_latest_cache_ && current_stamp == file_stamp_)
     {
         return cached_repo_;
     }
+    file_stamp_ = current_stamp;
 
     // open repository for input
     std::ifstream repo_file(repo_file_path_);
@@ -104,82 +247,85 @@ ChildScopeEnabledMap ChildScopesRepository::read_repo()
     {
         logger_(LoggerSeverity::Info) << "ChildScopesRepository::read_repo(): "
                                       << "Failed to open file: \"" << repo_file_path_ << "\"";
-        return ChildScopeEnabledMap();
+        update_cache(Entries());
+        return cached_repo_;
     }
 
-    cached_repo_ = json_to_list(std::string((std::istreambuf_iterator<char>(repo_file)),
-                                            std::istreambuf_iterator<char>()));
+    update_cache(json_to_list(std::string((std::istreambuf_iterator<char>(repo_file)),
+                                          std::istreambuf_iterator<char>())));
     repo_file.close();
 
-    have_latest_cache_ = true;
     return cached_repo_;
 }
 
-std::string ChildScopesRepository::list_to_json(ChildScopeList const& child_scopes_list)
+std::string ChildScopesRepository::list_to_json(Entries const& entries)
 {
-    std::ostringstream child_scopes_json;
-    child_scopes_json << "[";
-    for (auto const& child_scope : child_scopes_list)
+    std::string child_scopes_json = "[";
+    for (auto const& entry : entries)
     {
-        child_scopes_json << (child_scopes_json.tellp() == 1 ? "{" : ",{");
-        child_scopes_json << "\"id\":\"" << child_scope.id << "\"";
-        child_scopes_json << ",";
-        child_scopes_json << "\"enabled\":" << (child_scope.enabled ? "true" : "false");
-        child_scopes_json << "}";
+        child_scopes_json += child_scopes_json.size() == 1 ? "{" : ",{";
+        child_scopes_json += "\"id\":";
+        variant_to_json(Variant(entry.first), child_scopes_json);
+        child_scopes_json += ",";
+        child_scopes_json += "\"enabled\":";
+        child_scopes_json += entry.second ? "true" : "false";
+        child_scopes_json += "}";
     }
-    child_scopes_json << "]";
-    return child_scopes_json.str();
+    child_scopes_json += "]";
+    return child_scopes_json;
 }
 
-ChildScopeEnabledMap ChildScopesRepository::json_to_list(std::string const& child_scopes_json)
+ChildScopesRepository::Entries ChildScopesRepository::json_to_list(std::string const& child_scopes_json)
 {
-    JsonCppNode json_node;
+    Variant root;
     try
     {
-        json_node.read_json(child_scopes_json);
+        root = json_to_variant(child_scopes_json);
     }
     catch (std::exception const& e)
     {
         logger_() << "ChildScopesRepository::json_to_list(): Exception thrown while reading json string: " << e.what();
-        return ChildScopeEnabledMap();
+        return Entries();
     }
-    if (json_node.type() != JsonCppNode::Array)
+    if (root.which() != Variant::Array)
     {
         logger_() << "ChildScopesRepository::json_to_list(): Root node of json string is not an array:"
                   << std::endl << child_scopes_json;
-        return ChildScopeEnabledMap();
+        return Entries();
     }
 
-    ChildScopeEnabledMap return_map;
-    for (int i = 0; i < json_node.size(); ++i)
+    Entries entries;
+    for (auto const& child : root.get_array())
     {
-        auto child_node = json_node.get_node(i);
+        if (child.which() != Variant::Dict)
+        {
+            logger_() << "ChildScopesRepository::json_to_list(): "
+                      << "Child node is not an object. Skipping child node:"
+                      << std::endl << variant_to_json(child);
+            continue;
+        }
+        auto const child_node = child.get_dict();
+        auto id_node = child_node.find("id");
+        auto enabled_node = child_node.find("enabled");
 
-        if (!child_node->has_node("id") ||
-            !child_node->has_node("enabled"))
+        if (id_node == child_node.end() ||
+            enabled_node == child_node.end())
         {
             logger_() << "ChildScopesRepository::json_to_list(): Child node is missing a required field. "
-                     << "Skipping child node:" << std::endl << child_node->to_json_string();
+                     << "Skipping child node:" << std::endl << variant_to_json(child);
             continue;
         }
-        auto id_node = child_node->get_node("id");
-        auto enabled_node = child_node->get_node("enabled");
 
-        if (id_node->type() != JsonCppNode::String ||
-            enabled_node->type() != JsonCppNode::Bool)
+        if (id_node->second.which() != Variant::String ||
+            enabled_node->second.which() != Variant::Bool)
         {
             logger_() << "ChildScopesRepository::json_to_list(): "
                       << "Child node contains an invalid value type. Skipping child node:"
-                      << std::endl << child_node->to_json_string();
+                      << std::endl << variant_to_json(child);
             continue;
         }
 
-        // If an aggregator aggregates the same child scope more than once (say, for different keywords),
-        // we count the enabled state of its first appearance as the overall enabled state of that child.
-        if (return_map.find(id_node->as_string()) == return_map.end())
-        {
-            return_map.insert(make_pair(id_node->as_string(), enabled_node->as_bool()));
-        }
+        entries.emplace_back(id_node->second.get_string(), enabled_node->second.get_bool());
     }
-    return return_map;
+    return entries;
 }
@@ -58,6 +58,36 @@ std::vector<OperationInfo> CompletionDetailsImpl::info_list() const
     return info_list_;
 }
 
+bool CompletionDetailsImpl::has_timings() const noexcept
+{
+    return timings_ != nullptr;
+}
+
+QueryTimings CompletionDetailsImpl::timings() const
+{
+    return timings_ ? QueryTimingsImpl::create(*timings_) : QueryTimings();
+}
+
+QueryTimingsImpl const* CompletionDetailsImpl::timings_impl() const noexcept
+{
+    return timings_.get();
+}
+
+void CompletionDetailsImpl::set_timings(QueryTimingsImpl const& timings)
+{
+    timings_ = std::make_shared<QueryTimingsImpl>(timings);
+}
+
+CompletionDetailsImpl* CompletionDetailsImpl::impl(CompletionDetails& details) noexcept
+{
+    return details.p.get();
+}
+
+CompletionDetailsImpl const* CompletionDetailsImpl::impl(CompletionDetails const& details) noexcept
+{
+    return details.p.get();
+}
+
 } // namespace internal
 
 } // namespace scopes
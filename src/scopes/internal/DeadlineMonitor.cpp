@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/DeadlineMonitor.h>
+
+#include <unity/UnityExceptions.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+DeadlineItem::DeadlineItem(weak_ptr<DeadlineMonitor> const& monitor, uint64_t id) :
+    monitor_(monitor),
+    id_(id)
+{
+}
+
+DeadlineItem::~DeadlineItem()
+{
+    cancel();  // noexcept
+}
+
+void DeadlineItem::cancel() noexcept
+{
+    auto const monitor = monitor_.lock();  // Monitor may no longer be around
+    if (monitor)
+    {
+        monitor->cancel(id_);
+    }
+    monitor_.reset();
+}
+
+DeadlineMonitor::DeadlineMonitor() :
+    next_id_(0),
+    finish_(false),
+    callback_running_(false),
+    running_id_(0)
+{
+}
+
+DeadlineMonitor::~DeadlineMonitor()
+{
+    destroy();  // noexcept
+}
+
+DeadlineMonitor::SPtr DeadlineMonitor::create()
+{
+    SPtr monitor(new DeadlineMonitor);
+    monitor->self_ = monitor;
+    return monitor;
+}
+
+void DeadlineMonitor::destroy() noexcept
+{
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (finish_)
+        {
+            return;
+        }
+        finish_ = true;
+        deadlines_.clear();
+        ids_.clear();
+        do_work_.notify_one();
+    }
+    if (monitor_thread_.joinable())
+    {
+        assert(monitor_thread_.get_id() != this_thread::get_id());
+        monitor_thread_.join();
+    }
+}
+
+DeadlineItem::UPtr DeadlineMonitor::add(chrono::system_clock::time_point deadline, Callback const& cb)
+{
+    if (!cb)
+    {
+        throw unity::InvalidArgumentException("DeadlineMonitor: invalid null callback passed to add().");
+    }
+
+    // Deadlines that are absurdly far in the future are clamped, so the conversion can't overflow.
+    auto const remaining = min<chrono::system_clock::duration>(deadline - chrono::system_clock::now(),
+                                                               chrono::hours(24 * 365));
+    auto const expiry = chrono::steady_clock::now()
+                        + chrono::duration_cast<chrono::steady_clock::duration>(remaining);
+
+    lock_guard<mutex> lock(mutex_);
+
+    if (finish_)
+    {
+        throw unity::LogicException("DeadlineMonitor: cannot add item to destroyed monitor.");
+    }
+
+    if (!monitor_thread_.joinable())
+    {
+        monitor_thread_ = thread(&DeadlineMonitor::monitor_func, this);
+    }
+
+    uint64_t const id = next_id_++;
+    auto const it = deadlines_.emplace(Key(expiry, id), cb).first;
+    ids_.emplace(id, expiry);
+    if (it == deadlines_.begin())
+    {
+        do_work_.notify_one();  // New earliest deadline, monitor thread must wake up sooner
+    }
+
+    return DeadlineItem::UPtr(new DeadlineItem(self_, id));
+}
+
+size_t DeadlineMonitor::size() const noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    return deadlines_.size();
+}
+
+void DeadlineMonitor::cancel(uint64_t id) noexcept
+{
+    unique_lock<mutex> lock(mutex_);
+    auto const it = ids_.find(id);
+    if (it != ids_.end())
+    {
+        // No need to wake up the monitor thread. At worst, it wakes up for a deadline
+        // that no longer exists and goes back to sleep.
+        deadlines_.erase(Key(it->second, id));
+        ids_.erase(it);
+        return;
+    }
+
+    // If the callback for this item is running right now, wait for it to complete,
+    // unless we are called by the callback.
+    if (monitor_thread_.get_id() != this_thread::get_id())
+    {
+        callback_done_.wait(lock, [this, id]{ return !callback_running_ || running_id_ != id; });
+    }
+}
+
+// Monitor thread
+
+void DeadlineMonitor::monitor_func()
+{
+    unique_lock<mutex> lock(mutex_);
+    for (;;)
+    {
+        if (deadlines_.empty())
+        {
+            do_work_.wait(lock, [this] { return !deadlines_.empty() || finish_; });
+        }
+        else
+        {
+            // Copy the expiry time: the entry may be cancelled while we wait.
+            auto const expiry = deadlines_.begin()->first.first;
+            do_work_.wait_until(lock, expiry);
+        }
+
+        // Invoke the callbacks for everything that has expired. We take one item at a time
+        // because a callback may cancel other items.
+        auto const now = chrono::steady_clock::now();
+        while (!finish_ && !deadlines_.empty() && deadlines_.begin()->first.first <= now)
+        {
+            auto const it = deadlines_.begin();
+            running_id_ = it->first.second;
+            Callback cb = move(it->second);
+            ids_.erase(running_id_);
+            deadlines_.erase(it);
+            callback_running_ = true;
+
+            // Callbacks are made outside the synchronization, so we can't deadlock if a
+            // callback adds or cancels a deadline.
+            lock.unlock();
+            try
+            {
+                cb();
+            }
+            catch (...)
+            {
+                // Ignore exceptions from callbacks, so one bad callback doesn't stop the monitor thread.
+            }
+            cb = nullptr;  // Destroy whatever the callback captured before cancel() can return.
+            lock.lock();
+
+            callback_running_ = false;
+            callback_done_.notify_all();
+        }
+
+        if (finish_)
+        {
+            return;
+        }
+    }
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
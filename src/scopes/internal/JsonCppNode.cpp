@@ -21,20 +21,27 @@
 
 #include <unity/UnityExceptions.h>
 
+#include <algorithm>
+
 using namespace std;
 using namespace unity::scopes;
 using namespace unity::scopes::internal;
 
 void JsonCppNode::init_from_string(string const& json_string)
 {
-    if (json_string.find_first_not_of(" \t\n") == std::string::npos)
+    init_from_data(json_string.data(), json_string.size());
+}
+
+void JsonCppNode::init_from_data(char const* data, size_t length)
+{
+    if (std::all_of(data, data + length, [](char c) { return c == ' ' || c == '\t' || c == '\n'; }))
     {
         throw unity::ResourceException("JsonCppNode(): empty string is not a valid JSON");
     }
 
     gobj_ptr<JsonParser> parser(json_parser_new());
     GError *err = nullptr;
-    if (!json_parser_load_from_data(parser.get(), json_string.c_str(), json_string.size(), &err))
+    if (!json_parser_load_from_data(parser.get(), data, length, &err))
     {
         string msg = string("JsonCppNode(); parse error: ") + err->message;
         g_error_free(err);
@@ -216,6 +223,11 @@ void JsonCppNode::read_json(string const& json_string)
     init_from_string(json_string);
 }
 
+void JsonCppNode::read_json(char const* data, size_t length)
+{
+    init_from_data(data, length);
+}
+
 string JsonCppNode::to_json_string() const
 {
     gobj_ptr<JsonGenerator> generator(json_generator_new());
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/KeywordIndex.h>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+void KeywordIndex::add(string const& scope_id, set<string> const& keywords)
+{
+    remove(scope_id);  // In case the scope is re-added with different keywords.
+
+    if (keywords.empty())
+    {
+        return;
+    }
+    for (auto const& k : keywords)
+    {
+        scopes_by_keyword_[k].insert(scope_id);
+    }
+    keywords_by_scope_[scope_id] = keywords;
+}
+
+void KeywordIndex::remove(string const& scope_id)
+{
+    auto it = keywords_by_scope_.find(scope_id);
+    if (it == keywords_by_scope_.end())
+    {
+        return;
+    }
+    for (auto const& k : it->second)
+    {
+        auto kit = scopes_by_keyword_.find(k);
+        if (kit != scopes_by_keyword_.end())
+        {
+            kit->second.erase(scope_id);
+            if (kit->second.empty())
+            {
+                scopes_by_keyword_.erase(kit);
+            }
+        }
+    }
+    keywords_by_scope_.erase(it);
+}
+
+void KeywordIndex::clear()
+{
+    scopes_by_keyword_.clear();
+    keywords_by_scope_.clear();
+}
+
+set<string> KeywordIndex::find(set<string> const& keywords) const
+{
+    set<string> ids;
+    for (auto const& k : keywords)
+    {
+        auto it = scopes_by_keyword_.find(k);
+        if (it != scopes_by_keyword_.end())
+        {
+            ids.insert(it->second.begin(), it->second.end());
+        }
+    }
+    return ids;
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -55,13 +55,23 @@ core::ScopedConnection MWRegistry::set_scope_state_callback(std::string const& s
 core::ScopedConnection MWRegistry::set_list_update_callback(std::function<void()> callback)
 {
     lock_guard<mutex> lock(mutex_);
+    return list_update_subscriber().message_received().connect([callback](string const&){ callback(); });
+}
+
+core::ScopedConnection MWRegistry::set_catalog_update_callback(std::function<void(std::string const&)> callback)
+{
+    lock_guard<mutex> lock(mutex_);
+    return list_update_subscriber().message_received().connect(callback);
+}
 
+MWSubscriber& MWRegistry::list_update_subscriber()
+{
     if (!list_update_subscriber_)
     {
         // Use lazy initialization here to only subscribe to the publisher if a callback is set
         list_update_subscriber_ = mw_base_->create_subscriber(mw_base_->runtime()->registry_identity());
     }
-    return list_update_subscriber_->message_received().connect([callback](string const&){ callback(); });
+    return *list_update_subscriber_;
 }
 
 } // namespace internal
@@ -38,6 +38,31 @@ MWReply::~MWReply()
 {
 }
 
+void MWReply::run_started(string const& scope_id)
+{
+    lock_guard<mutex> lock(timings_mutex_);
+    timings_.set_scope_id(scope_id);
+    timings_.set_run_start_time(chrono::system_clock::now());
+}
+
+void MWReply::add_subquery_timings(QueryTimings const& timings)
+{
+    lock_guard<mutex> lock(timings_mutex_);
+    timings_.add_subquery(timings);
+}
+
+void MWReply::add_push_bytes(size_t bytes)
+{
+    lock_guard<mutex> lock(timings_mutex_);
+    timings_.set_byte_count(timings_.byte_count() + bytes);
+}
+
+QueryTimingsImpl MWReply::timings() const
+{
+    lock_guard<mutex> lock(timings_mutex_);
+    return timings_;
+}
+
 } // namespace internal
 
 } // namespace scopes
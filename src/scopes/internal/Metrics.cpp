@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/Metrics.h>
+
+#include <unity/UnityExceptions.h>
+
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+// Each thread uses the same shard for all counters. Threads are assigned shards round-robin.
+
+unsigned shard_index() noexcept
+{
+    static atomic<unsigned> next_shard(0);
+    static thread_local unsigned const index = next_shard++;
+    return index;
+}
+
+string with_label(string const& labels, string const& label)
+{
+    return "{" + (labels.empty() ? label : labels + "," + label) + "}";
+}
+
+string braced(string const& labels)
+{
+    return labels.empty() ? "" : "{" + labels + "}";
+}
+
+string seconds(uint64_t usecs)
+{
+    ostringstream s;
+    s << setprecision(9) << usecs / 1000000.0;
+    return s.str();
+}
+
+// Buckets for the exposed histograms, at powers of two from 1 usec to 2^26 usecs (about 67 s).
+
+int const exposed_buckets = 27;
+
+} // namespace
+
+Counter::Counter()
+{
+    for (auto& s : shards_)
+    {
+        s.value = 0;
+    }
+}
+
+void Counter::inc(uint64_t n) noexcept
+{
+    shards_[shard_index() % shards_.size()].value.fetch_add(n, memory_order_relaxed);
+}
+
+uint64_t Counter::value() const noexcept
+{
+    uint64_t sum = 0;
+    for (auto const& s : shards_)
+    {
+        sum += s.value.load(memory_order_relaxed);
+    }
+    return sum;
+}
+
+Gauge::Gauge()
+    : value_(0)
+{
+}
+
+void Gauge::inc(int64_t n) noexcept
+{
+    value_.fetch_add(n, memory_order_relaxed);
+}
+
+void Gauge::dec(int64_t n) noexcept
+{
+    value_.fetch_sub(n, memory_order_relaxed);
+}
+
+void Gauge::set(int64_t n) noexcept
+{
+    value_.store(n, memory_order_relaxed);
+}
+
+int64_t Gauge::value() const noexcept
+{
+    return value_.load(memory_order_relaxed);
+}
+
+constexpr int Histogram::sub_bucket_bits;
+constexpr int Histogram::max_bits;
+constexpr int Histogram::num_buckets;
+
+Histogram::Histogram()
+    : count_(0)
+    , sum_(0)
+{
+    for (auto& b : buckets_)
+    {
+        b = 0;
+    }
+}
+
+void Histogram::record(chrono::microseconds t) noexcept
+{
+    uint64_t const usecs = t.count() > 0 ? t.count() : 0;
+    buckets_[bucket_index(usecs)].fetch_add(1, memory_order_relaxed);
+    count_.fetch_add(1, memory_order_relaxed);
+    sum_.fetch_add(usecs, memory_order_relaxed);
+}
+
+uint64_t Histogram::count() const noexcept
+{
+    return count_.load(memory_order_relaxed);
+}
+
+uint64_t Histogram::sum() const noexcept
+{
+    return sum_.load(memory_order_relaxed);
+}
+
+uint64_t Histogram::count_below(uint64_t usecs) const noexcept
+{
+    uint64_t n = 0;
+    for (int i = 0; i < num_buckets - 1 && bucket_lower_bound(i + 1) <= usecs; ++i)
+    {
+        n += buckets_[i].load(memory_order_relaxed);
+    }
+    return n;
+}
+
+uint64_t Histogram::count_at_most(uint64_t usecs) const noexcept
+{
+    uint64_t n = 0;
+    for (int i = 0; i < num_buckets && bucket_lower_bound(i) <= usecs; ++i)
+    {
+        n += buckets_[i].load(memory_order_relaxed);
+    }
+    return n;
+}
+
+uint64_t Histogram::value_at_quantile(double q) const noexcept
+{
+    uint64_t total = 0;
+    for (auto const& b : buckets_)
+    {
+        total += b.load(memory_order_relaxed);
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+    uint64_t const target = max<uint64_t>(1, uint64_t(ceil(q * total)));
+    uint64_t n = 0;
+    for (int i = 0; i < num_buckets - 1; ++i)
+    {
+        n += buckets_[i].load(memory_order_relaxed);
+        if (n >= target)
+        {
+            return bucket_lower_bound(i + 1) - 1;
+        }
+    }
+    return bucket_lower_bound(num_buckets - 1);
+}
+
+int Histogram::bucket_index(uint64_t usecs) noexcept
+{
+    uint64_t const sub_buckets = 1 << sub_bucket_bits;
+    if (usecs < sub_buckets)
+    {
+        return int(usecs);
+    }
+    int const msb = 63 - __builtin_clzll(usecs);
+    if (msb >= max_bits)
+    {
+        return num_buckets - 1;
+    }
+    int const shift = msb - sub_bucket_bits;
+    return ((shift + 1) << sub_bucket_bits) + int((usecs >> shift) - sub_buckets);
+}
+
+uint64_t Histogram::bucket_lower_bound(int index) noexcept
+{
+    uint64_t const sub_buckets = 1 << sub_bucket_bits;
+    if (index < int(sub_buckets))
+    {
+        return index;
+    }
+    int const shift = (index >> sub_bucket_bits) - 1;
+    return (sub_buckets + (index & (sub_buckets - 1))) << shift;
+}
+
+MetricsRegistry::MetricsRegistry()
+{
+}
+
+MetricsRegistry& MetricsRegistry::instance()
+{
+    static MetricsRegistry registry;
+    return registry;
+}
+
+MetricsRegistry::Family& MetricsRegistry::family(string const& name, string const& help, Type type)
+{
+    auto it = families_.find(name);
+    if (it == families_.end())
+    {
+        Family f;
+        f.type = type;
+        f.help = help;
+        it = families_.emplace(name, move(f)).first;
+    }
+    else if (it->second.type != type)
+    {
+        throw LogicException("MetricsRegistry: metric " + name + " is registered already with a different type");
+    }
+    return it->second;
+}
+
+Counter& MetricsRegistry::counter(string const& name, string const& help, string const& labels)
+{
+    lock_guard<mutex> lock(mutex_);
+    auto& metric = family(name, help, Type::Counter).counters[labels];
+    if (!metric)
+    {
+        metric.reset(new Counter);
+    }
+    return *metric;
+}
+
+Gauge& MetricsRegistry::gauge(string const& name, string const& help, string const& labels)
+{
+    lock_guard<mutex> lock(mutex_);
+    auto& metric = family(name, help, Type::Gauge).gauges[labels];
+    if (!metric)
+    {
+        metric.reset(new Gauge);
+    }
+    return *metric;
+}
+
+Histogram& MetricsRegistry::histogram(string const& name, string const& help, string const& labels)
+{
+    lock_guard<mutex> lock(mutex_);
+    auto& metric = family(name, help, Type::Histogram).histograms[labels];
+    if (!metric)
+    {
+        metric.reset(new Histogram);
+    }
+    return *metric;
+}
+
+string MetricsRegistry::expose() const
+{
+    ostringstream s;
+
+    lock_guard<mutex> lock(mutex_);
+    for (auto const& pair : families_)
+    {
+        auto const& name = pair.first;
+        auto const& f = pair.second;
+        s << "# HELP " << name << " " << f.help << "\n";
+        switch (f.type)
+        {
+            case Type::Counter:
+            {
+                s << "# TYPE " << name << " counter\n";
+                for (auto const& c : f.counters)
+                {
+                    s << name << braced(c.first) << " " << c.second->value() << "\n";
+                }
+                break;
+            }
+            case Type::Gauge:
+            {
+                s << "# TYPE " << name << " gauge\n";
+                for (auto const& g : f.gauges)
+                {
+                    s << name << braced(g.first) << " " << g.second->value() << "\n";
+                }
+                break;
+            }
+            case Type::Histogram:
+            {
+                s << "# TYPE " << name << " histogram\n";
+                for (auto const& h : f.histograms)
+                {
+                    // Values may be recorded while we read the buckets. Clamping the buckets to
+                    // the count keeps them consistent with each other. A le bucket includes values
+                    // equal to its bound, so the histogram bucket containing the bound counts in full.
+                    uint64_t const count = h.second->count();
+                    for (int k = 0; k < exposed_buckets; ++k)
+                    {
+                        uint64_t const bound = uint64_t(1) << k;
+                        uint64_t const n = min(count, h.second->count_at_most(bound));
+                        s << name << "_bucket" << with_label(h.first, "le=\"" + seconds(bound) + "\"") << " " << n << "\n";
+                    }
+                    s << name << "_bucket" << with_label(h.first, "le=\"+Inf\"") << " " << count << "\n";
+                    s << name << "_sum" << braced(h.first) << " " << seconds(h.second->sum()) << "\n";
+                    s << name << "_count" << braced(h.first) << " " << count << "\n";
+                }
+                break;
+            }
+        }
+    }
+    return s.str();
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
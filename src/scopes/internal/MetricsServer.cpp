@@ -0,0 +1,478 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/MetricsServer.h>
+
+#include <unity/scopes/internal/Logger.h>
+#include <unity/scopes/internal/Metrics.h>
+#include <unity/scopes/internal/safe_strerror.h>
+#include <unity/UnityExceptions.h>
+#include <unity/util/ResourcePtr.h>
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+int const request_timeout = 100;  // Milliseconds we wait for a client to send a request (if any)
+int const scrape_timeout = 1000;  // Milliseconds we wait for the metrics of all other processes
+
+struct sockaddr_un make_addr(string const& path)
+{
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        throw InvalidArgumentException("MetricsServer(): socket path too long: " + path);
+    }
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+
+// Reads from fd until EOF, error, or timeout. If stop_at_blank_line is set, also stops
+// once a blank line (the end of an HTTP request header) arrives.
+
+string read_all(int fd, int timeout_ms, bool stop_at_blank_line)
+{
+    string data;
+    char buf[4096];
+    for (;;)
+    {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int rc = ::poll(&pfd, 1, timeout_ms);
+        if (rc == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (rc <= 0)
+        {
+            return data;  // Error or timeout
+        }
+        ssize_t n = ::read(fd, buf, sizeof(buf));
+        if (n == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return data;  // Error or EOF
+        }
+        data.append(buf, n);
+        if (stop_at_blank_line
+            && (data.find("\r\n\r\n") != string::npos || data.find("\n\n") != string::npos || data.size() > 8192))
+        {
+            return data;
+        }
+    }
+}
+
+bool write_all(int fd, string const& data)
+{
+    char const* p = data.data();
+    size_t len = data.size();
+    while (len > 0)
+    {
+        ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+// Returns a socket connected to path, or -1 if no-one is listening there (a process may have
+// exited without removing its socket).
+
+int connect_to(string const& path)
+{
+    auto const addr = make_addr(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<struct sockaddr const*>(&addr), sizeof(addr)) == -1)
+    {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Returns the metrics served on paths by other processes, in the same order. The result for a path
+// is the empty string if there is no-one there, or if the process did not send all of its metrics
+// in time. The processes are read in parallel within a single timeout, so a scrape does not take
+// longer with many stuck processes than with one.
+
+vector<string> fetch_all(vector<string> const& paths)
+{
+    vector<string> texts(paths.size());
+    vector<struct pollfd> pfds;
+    vector<size_t> index;  // pfds[i] is read into texts[index[i]]
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        int fd;
+        try
+        {
+            fd = connect_to(paths[i]);
+        }
+        catch (InvalidArgumentException const&)
+        {
+            continue;  // Path too long, so no-one can be listening there.
+        }
+        if (fd == -1)
+        {
+            continue;
+        }
+        ::shutdown(fd, SHUT_WR);  // No request, so the server replies straight away.
+        pfds.push_back({ fd, POLLIN, 0 });
+        index.push_back(i);
+    }
+
+    auto const deadline = chrono::steady_clock::now() + chrono::milliseconds(scrape_timeout);
+    size_t open = pfds.size();
+    char buf[4096];
+    while (open > 0)
+    {
+        auto const remaining = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+        {
+            break;
+        }
+        int rc = ::poll(pfds.data(), pfds.size(), int(remaining.count()));
+        if (rc == -1 && errno == EINTR)
+        {
+            continue;
+        }
+        if (rc <= 0)
+        {
+            break;  // Error or timeout
+        }
+        for (size_t i = 0; i < pfds.size(); ++i)
+        {
+            if (pfds[i].fd == -1 || pfds[i].revents == 0)
+            {
+                continue;
+            }
+            ssize_t n = ::read(pfds[i].fd, buf, sizeof(buf));
+            if (n == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n > 0)
+            {
+                texts[index[i]].append(buf, n);
+                continue;
+            }
+            if (n == -1)
+            {
+                texts[index[i]].clear();  // Error
+            }
+            ::close(pfds[i].fd);
+            pfds[i].fd = -1;  // Ignored by poll() from now on
+            --open;
+        }
+    }
+
+    // Partial metrics would be garbled, so we drop them.
+    for (size_t i = 0; i < pfds.size(); ++i)
+    {
+        if (pfds[i].fd != -1)
+        {
+            ::close(pfds[i].fd);
+            texts[index[i]].clear();
+        }
+    }
+    return texts;
+}
+
+// Samples of the same metric must be grouped together, with a single HELP and TYPE line,
+// so we cannot just concatenate the metrics of different processes.
+
+struct Family
+{
+    vector<string> header;
+    vector<string> samples;
+};
+
+string add_label(string const& sample, string const& label)
+{
+    auto const pos = sample.find_first_of("{ ");
+    if (pos == string::npos)
+    {
+        return sample;  // Malformed
+    }
+    if (sample[pos] == '{')
+    {
+        auto const end = sample.rfind('}');  // The value that follows can't contain a brace
+        if (end == string::npos)
+        {
+            return sample;  // Malformed
+        }
+        bool const no_labels = end == pos + 1;
+        return sample.substr(0, end) + (no_labels ? "" : ",") + label + sample.substr(end);
+    }
+    return sample.substr(0, pos) + "{" + label + "}" + sample.substr(pos);
+}
+
+void merge(string const& text, string const& process, map<string, Family>& families)
+{
+    string const label = "process=\"" + process + "\"";
+    istringstream s(text);
+    string line;
+    string current;
+    while (getline(s, line))
+    {
+        if (line.empty())
+        {
+            continue;
+        }
+        if (line.compare(0, 7, "# HELP ") == 0 || line.compare(0, 7, "# TYPE ") == 0)
+        {
+            auto const end = line.find(' ', 7);
+            current = line.substr(7, end == string::npos ? string::npos : end - 7);
+            auto& header = families[current].header;
+            bool const seen = any_of(header.begin(), header.end(),
+                                     [&line](string const& h) { return h.compare(0, 7, line, 0, 7) == 0; });
+            if (!seen)
+            {
+                header.push_back(line);
+            }
+            continue;
+        }
+        if (line[0] == '#')
+        {
+            continue;  // Other comment
+        }
+        if (current.empty())
+        {
+            current = line.substr(0, line.find_first_of("{ "));
+        }
+        families[current].samples.push_back(add_label(line, label));
+    }
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(string const& path, bool aggregate, Logger& logger)
+    : path_(path)
+    , aggregate_(aggregate)
+    , logger_(logger)
+{
+    id_ = boost::filesystem::path(path).stem().string();
+
+    auto const addr = make_addr(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1)
+    {
+        throw SyscallException("MetricsServer(): cannot create socket", errno);
+    }
+    util::ResourcePtr<int, decltype(&::close)> listen_guard(fd, ::close);
+
+    // If we can connect, another server is using the socket. Otherwise, any existing
+    // socket was left behind by a process that is no longer running.
+    int probe_fd = connect_to(path);
+    if (probe_fd != -1)
+    {
+        ::close(probe_fd);
+        throw ResourceException("MetricsServer(): another server is listening on " + path);
+    }
+    ::unlink(path.c_str());
+
+    if (::bind(fd, reinterpret_cast<struct sockaddr const*>(&addr), sizeof(addr)) == -1)
+    {
+        throw SyscallException("MetricsServer(): cannot bind to " + path, errno);
+    }
+    if (::listen(fd, 16) == -1)
+    {
+        throw SyscallException("MetricsServer(): cannot listen on " + path, errno);  // LCOV_EXCL_LINE
+    }
+
+    int efd = ::eventfd(0, EFD_CLOEXEC);
+    if (efd == -1)
+    {
+        throw SyscallException("MetricsServer(): cannot create eventfd", errno);  // LCOV_EXCL_LINE
+    }
+    util::ResourcePtr<int, decltype(&::close)> stop_guard(efd, ::close);
+
+    listen_fd_ = listen_guard.get();
+    stop_fd_ = stop_guard.get();
+    thread_ = thread(&MetricsServer::serve, this);
+    listen_guard.release();
+    stop_guard.release();
+}
+
+MetricsServer::~MetricsServer()
+{
+    uint64_t one = 1;
+    if (::write(stop_fd_, &one, sizeof(one)) != sizeof(one))
+    {
+        assert(false);  // LCOV_EXCL_LINE
+    }
+    thread_.join();
+    ::close(stop_fd_);
+    ::close(listen_fd_);
+    ::unlink(path_.c_str());
+}
+
+string MetricsServer::path() const
+{
+    return path_;
+}
+
+string MetricsServer::scrape() const
+{
+    string const own = MetricsRegistry::instance().expose();
+    if (!aggregate_)
+    {
+        return own;
+    }
+
+    map<string, Family> families;
+    merge(own, id_, families);
+
+    vector<boost::filesystem::path> peers;
+    boost::system::error_code ec;
+    auto const dir = boost::filesystem::path(path_).parent_path();
+    for (boost::filesystem::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec))
+    {
+        auto const& p = it->path();
+        if (p.extension() != ".sock" || p.string() == path_)
+        {
+            continue;
+        }
+        peers.push_back(p);
+    }
+
+    vector<string> paths;
+    for (auto const& p : peers)
+    {
+        paths.push_back(p.string());
+    }
+    auto const texts = fetch_all(paths);
+    for (size_t i = 0; i < peers.size(); ++i)
+    {
+        if (!texts[i].empty())
+        {
+            merge(texts[i], peers[i].stem().string(), families);
+        }
+    }
+
+    string result;
+    for (auto const& pair : families)
+    {
+        for (auto const& h : pair.second.header)
+        {
+            result += h + "\n";
+        }
+        for (auto const& s : pair.second.samples)
+        {
+            result += s + "\n";
+        }
+    }
+    return result;
+}
+
+void MetricsServer::serve() noexcept
+{
+    for (;;)
+    {
+        struct pollfd pfds[2] = { { listen_fd_, POLLIN, 0 }, { stop_fd_, POLLIN, 0 } };
+        int rc = ::poll(pfds, 2, -1);
+        if (rc == -1)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            logger_(LoggerSeverity::Error) << "MetricsServer: poll() failed: " << safe_strerror(errno);  // LCOV_EXCL_LINE
+            return;                                                                                     // LCOV_EXCL_LINE
+        }
+        if (pfds[1].revents)
+        {
+            return;  // We are being destroyed.
+        }
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1)
+        {
+            continue;  // Client went away already, or we ran out of descriptors
+        }
+        serve_client(fd);
+        ::close(fd);
+    }
+}
+
+void MetricsServer::serve_client(int fd) noexcept
+{
+    try
+    {
+        string const request = read_all(fd, request_timeout, true);
+        string body = scrape();
+        if (request.compare(0, 4, "GET ") == 0)
+        {
+            body = "HTTP/1.0 200 OK\r\n"
+                   "Content-Type: text/plain; version=0.0.4\r\n"
+                   "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                   "\r\n" + body;
+        }
+        write_all(fd, body);  // Nothing we can do if the client went away
+    }
+    catch (std::exception const& e)
+    {
+        logger_(LoggerSeverity::Error) << "MetricsServer: cannot serve metrics: " << e.what();
+    }
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
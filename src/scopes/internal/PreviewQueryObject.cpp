@@ -82,6 +82,8 @@ void PreviewQueryObject::run(MWReplyProxy const& reply, InvokeInfo const& info)
     {
         lock.unlock();
 
+        reply->run_started(info.mw->runtime()->scope_id());  // For the client's QueryTimings
+
         // Synchronous call into scope implementation.
         // On return, replies for the preview may still be outstanding.
         auto preview_query = dynamic_pointer_cast<PreviewQueryBase>(query_base_);
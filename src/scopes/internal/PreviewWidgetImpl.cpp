@@ -18,7 +18,6 @@
 
 #include <unity/scopes/internal/PreviewWidgetImpl.h>
 #include <unity/scopes/PreviewWidget.h>
-#include <unity/scopes/internal/JsonCppNode.h>
 #include <unity/UnityExceptions.h>
 
 namespace unity
@@ -36,8 +35,7 @@ namespace internal
 PreviewWidgetImpl PreviewWidgetImpl::from_json(std::string const& json_text)
 {
     //TODO: json validation
-    const internal::JsonCppNode node(json_text);
-    auto var = node.to_variant().get_dict();
+    auto var = Variant::deserialize_json(json_text).get_dict();
 
     return from_json_node(var);
 }
@@ -278,8 +276,7 @@ std::string PreviewWidgetImpl::data() const
     }
 
     const Variant outer(var);
-    const internal::JsonCppNode node(outer);
-    return node.to_json_string();
+    return outer.serialize_json();
 }
 
 void PreviewWidgetImpl::throw_on_empty(std::string const& name, std::string const& value)
@@ -19,6 +19,10 @@
 #include <unity/scopes/internal/QueryBaseImpl.h>
 
 #include <unity/scopes/internal/SettingsDB.h>
+#include <unity/UnityExceptions.h>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -32,11 +36,17 @@ namespace internal
 {
 
 QueryBaseImpl::QueryBaseImpl()
+    : cancel_fd_(-1)
+    , cancelled_(false)
 {
 }
 
 QueryBaseImpl::~QueryBaseImpl()
 {
+    if (cancel_fd_ != -1)
+    {
+        ::close(cancel_fd_);
+    }
 }
 
 VariantMap QueryBaseImpl::settings() const
@@ -51,6 +61,41 @@ void QueryBaseImpl::set_settings_db(SettingsDB::SPtr const& db)
     db_ = db;
 }
 
+// The eventfd is created only if the application asks for it, so queries that don't use it
+// don't cost a file descriptor. Once the query is cancelled, the eventfd is readable; we never
+// read from it, so it stays readable for the remainder of the query.
+
+int QueryBaseImpl::cancel_fd()
+{
+    lock_guard<mutex> lock(mutex_);
+    if (cancel_fd_ == -1)
+    {
+        int fd = ::eventfd(cancelled_ ? 1 : 0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (fd == -1)
+        {
+            throw SyscallException("QueryBase::cancel_fd(): cannot create eventfd", errno);
+        }
+        cancel_fd_ = fd;
+    }
+    return cancel_fd_;
+}
+
+void QueryBaseImpl::notify_cancelled()
+{
+    lock_guard<mutex> lock(mutex_);
+    if (cancelled_)
+    {
+        return;
+    }
+    cancelled_ = true;
+    if (cancel_fd_ != -1)
+    {
+        uint64_t const one = 1;
+        ssize_t rc = ::write(cancel_fd_, &one, sizeof(one));
+        (void)rc;  // Can't fail: the counter is at most 1, so it can't overflow.
+    }
+}
+
 } // namespace internal
 
 } // namespace scopes
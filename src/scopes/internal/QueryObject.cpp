@@ -26,6 +26,7 @@
 #include <unity/scopes/internal/QueryCtrlObject.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
 #include <unity/scopes/internal/SearchReplyImpl.h>
+#include <unity/scopes/internal/lttng/UnityScopes_tp.h>
 #include <unity/scopes/PreviewQueryBase.h>
 #include <unity/scopes/QueryBase.h>
 #include <unity/scopes/SearchQueryBase.h>
@@ -60,6 +61,7 @@ QueryObject::QueryObject(std::shared_ptr<QueryBase> const& query_base,
     , ctrl_(ctrl)
     , pushable_(true)
     , cardinality_(cardinality)
+    , deadline_expired_(false)
 {
 }
 
@@ -90,6 +92,12 @@ void QueryObject::run(MWReplyProxy const& reply, InvokeInfo const& info) noexcep
     // run invocation, we never forward the run() call to the implementation.
     if (!pushable_)
     {
+        if (deadline_expired_)
+        {
+            // Unlike for a cancel() from the client, the client doesn't know that the query
+            // was cancelled, so we need to tell it.
+            reply_->finished(CompletionDetails(CompletionDetails::Cancelled, "query deadline expired"));  // Oneway
+        }
         self_ = nullptr;
         disconnect();
         return;
@@ -114,10 +122,14 @@ void QueryObject::run(MWReplyProxy const& reply, InvokeInfo const& info) noexcep
     self_ = nullptr;
     disconnect();
 
+    simple_tracepoint(unity_scopes, query_run_start,
+                      reply->identity().c_str(), info.mw->runtime()->scope_id().c_str());
     try
     {
         lock.unlock();
 
+        reply->run_started(info.mw->runtime()->scope_id());  // For the client's QueryTimings
+
         // Synchronous call into scope implementation.
         // On return, replies for the query may still be outstanding.
         search_query->run(reply_proxy);
@@ -140,10 +152,23 @@ void QueryObject::run(MWReplyProxy const& reply, InvokeInfo const& info) noexcep
         info.mw->runtime()->logger()() << "QueryBase::run(): unknown exception";
         reply_->finished(CompletionDetails(CompletionDetails::Error, "QueryBase::run(): unknown exception"));
     }
+    simple_tracepoint(unity_scopes, query_run_end,
+                      reply->identity().c_str(), info.mw->runtime()->scope_id().c_str());
 }
 
 void QueryObject::cancel(InvokeInfo const& info)
 {
+    cancel_query(info, false);
+}
+
+void QueryObject::deadline_expired(InvokeInfo const& info)
+{
+    cancel_query(info, true);
+}
+
+void QueryObject::cancel_query(InvokeInfo const& info, bool deadline_expired)
+{
+    string const msg = deadline_expired ? "query deadline expired" : "";
     {
         lock_guard<mutex> lock(mutex_);
 
@@ -152,7 +177,10 @@ void QueryObject::cancel(InvokeInfo const& info)
             return;
         }
         pushable_ = false;
+        deadline_expired_ = deadline_expired;
     }  // Release lock
+    simple_tracepoint(unity_scopes, query_cancelled,
+                      reply_->identity().c_str(), info.mw->runtime()->scope_id().c_str(), deadline_expired);
 
     try
     {
@@ -166,7 +194,7 @@ void QueryObject::cancel(InvokeInfo const& info)
             // Send finished() to up-stream client to tell him the query is done.
             // We send via the MWReplyProxy here because that allows passing
             // a CompletionDetails::CompletionStatus (whereas the public ReplyProxy does not).
-            reply_->finished(CompletionDetails(CompletionDetails::Cancelled));  // Oneway, can't block
+            reply_->finished(CompletionDetails(CompletionDetails::Cancelled, msg));  // Oneway, can't block
         }
     }
     catch (std::exception const& e)
@@ -178,13 +206,13 @@ void QueryObject::cancel(InvokeInfo const& info)
         // But, removing the servant may be slow, allowing the finished message below to occasionally
         // reach the client. If it does, we want the same completion status that we get if the
         // local short-cut call hasn't done the job yet.
-        reply_->finished(CompletionDetails(CompletionDetails::Cancelled, ""));
+        reply_->finished(CompletionDetails(CompletionDetails::Cancelled, msg));
     }
     catch (...)
     {
         info.mw->runtime()->logger()() << "QueryBase::cancelled(): unknown exception";
         // Same caveat as for std::exception here.
-        reply_->finished(CompletionDetails(CompletionDetails::Cancelled, ""));
+        reply_->finished(CompletionDetails(CompletionDetails::Cancelled, msg));
     }
 }
 
@@ -223,6 +251,12 @@ void QueryObject::set_self(QueryObjectBase::SPtr const& self) noexcept
     self_ = self;
 }
 
+void QueryObject::set_deadline_item(DeadlineItem::UPtr item) noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    deadline_item_ = move(item);
+}
+
 } // namespace internal
 
 } // namespace scopes
@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/QueryTimingsImpl.h>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+int64_t get_int64(VariantMap const& var, string const& key)
+{
+    auto const it = var.find(key);
+    return it != var.end() ? it->second.get_int64_t() : 0;
+}
+
+} // namespace
+
+QueryTimingsImpl::QueryTimingsImpl()
+    : send_time_(0)
+    , run_start_(0)
+    , first_push_(0)
+    , last_push_(0)
+    , total_(0)
+    , result_count_(0)
+    , byte_count_(0)
+{
+}
+
+string QueryTimingsImpl::scope_id() const
+{
+    return scope_id_;
+}
+
+chrono::microseconds QueryTimingsImpl::send_time() const
+{
+    return send_time_;
+}
+
+chrono::microseconds QueryTimingsImpl::run_start() const
+{
+    return run_start_;
+}
+
+chrono::microseconds QueryTimingsImpl::first_push() const
+{
+    return first_push_;
+}
+
+chrono::microseconds QueryTimingsImpl::last_push() const
+{
+    return last_push_;
+}
+
+chrono::microseconds QueryTimingsImpl::total() const
+{
+    return total_;
+}
+
+size_t QueryTimingsImpl::result_count() const
+{
+    return result_count_;
+}
+
+size_t QueryTimingsImpl::byte_count() const
+{
+    return byte_count_;
+}
+
+vector<QueryTimings> QueryTimingsImpl::subqueries() const
+{
+    return subqueries_;
+}
+
+chrono::system_clock::time_point QueryTimingsImpl::run_start_time() const
+{
+    return run_start_time_;
+}
+
+void QueryTimingsImpl::set_scope_id(string const& scope_id)
+{
+    scope_id_ = scope_id;
+}
+
+void QueryTimingsImpl::set_send_time(chrono::microseconds t)
+{
+    send_time_ = t;
+}
+
+void QueryTimingsImpl::set_run_start(chrono::microseconds t)
+{
+    run_start_ = t;
+}
+
+void QueryTimingsImpl::set_first_push(chrono::microseconds t)
+{
+    first_push_ = t;
+}
+
+void QueryTimingsImpl::set_last_push(chrono::microseconds t)
+{
+    last_push_ = t;
+}
+
+void QueryTimingsImpl::set_total(chrono::microseconds t)
+{
+    total_ = t;
+}
+
+void QueryTimingsImpl::set_result_count(size_t count)
+{
+    result_count_ = count;
+}
+
+void QueryTimingsImpl::set_byte_count(size_t count)
+{
+    byte_count_ = count;
+}
+
+void QueryTimingsImpl::add_subquery(QueryTimings const& timings)
+{
+    subqueries_.push_back(timings);
+}
+
+void QueryTimingsImpl::set_run_start_time(chrono::system_clock::time_point t)
+{
+    run_start_time_ = t;
+}
+
+// Durations are in microseconds. The run start time is not serialized. It is needed only
+// until the client has worked out run_start, which happens before subquery timings are
+// passed on by an aggregator.
+
+VariantMap QueryTimingsImpl::serialize() const
+{
+    VariantMap var;
+    var["scope_id"] = scope_id_;
+    var["send_time"] = Variant(int64_t(send_time_.count()));
+    var["run_start"] = Variant(int64_t(run_start_.count()));
+    var["first_push"] = Variant(int64_t(first_push_.count()));
+    var["last_push"] = Variant(int64_t(last_push_.count()));
+    var["total"] = Variant(int64_t(total_.count()));
+    var["result_count"] = Variant(int64_t(result_count_));
+    var["byte_count"] = Variant(int64_t(byte_count_));
+    if (!subqueries_.empty())
+    {
+        VariantArray subqueries;
+        for (auto const& s : subqueries_)
+        {
+            subqueries.push_back(Variant(serialize(s)));
+        }
+        var["subqueries"] = subqueries;
+    }
+    return var;
+}
+
+VariantMap QueryTimingsImpl::serialize(QueryTimings const& timings)
+{
+    return timings.p->serialize();
+}
+
+QueryTimings QueryTimingsImpl::create(QueryTimingsImpl const& impl)
+{
+    return QueryTimings(new QueryTimingsImpl(impl));
+}
+
+QueryTimings QueryTimingsImpl::create(VariantMap const& var)
+{
+    QueryTimingsImpl impl;
+    auto it = var.find("scope_id");
+    if (it != var.end())
+    {
+        impl.scope_id_ = it->second.get_string();
+    }
+    impl.send_time_ = chrono::microseconds(get_int64(var, "send_time"));
+    impl.run_start_ = chrono::microseconds(get_int64(var, "run_start"));
+    impl.first_push_ = chrono::microseconds(get_int64(var, "first_push"));
+    impl.last_push_ = chrono::microseconds(get_int64(var, "last_push"));
+    impl.total_ = chrono::microseconds(get_int64(var, "total"));
+    impl.result_count_ = get_int64(var, "result_count");
+    impl.byte_count_ = get_int64(var, "byte_count");
+    it = var.find("subqueries");
+    if (it != var.end())
+    {
+        for (auto const& s : it->second.get_array())
+        {
+            impl.subqueries_.push_back(create(s.get_dict()));
+        }
+    }
+    return create(impl);
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -18,6 +18,7 @@
 
 #include <unity/scopes/internal/Reaper.h>
 
+#include <unity/scopes/internal/Metrics.h>
 #include <unity/UnityExceptions.h>
 
 #include <cassert>
@@ -35,6 +36,19 @@ namespace scopes
 namespace internal
 {
 
+namespace
+{
+
+Counter& reaped_items()
+{
+    static Counter& c = MetricsRegistry::instance().counter(
+        "unity_scopes_reaper_callbacks_total",
+        "Items reaped because they expired (for example, inactive queries) or their reaper was destroyed");
+    return c;
+}
+
+} // namespace
+
 ReapItem::ReapItem(weak_ptr<Reaper> const& reaper, reaper_private::Reaplist::iterator it) :
     reaper_(reaper),
     it_(it),
@@ -348,6 +362,7 @@ void Reaper::remove_zombies(reaper_private::Reaplist const& zombies) noexcept
             ri->it_ = list_.end();
         }
 
+        reaped_items().inc();
         try
         {
             assert(item.cb);
@@ -18,8 +18,10 @@
 
 #include <unity/scopes/internal/RegistryImpl.h>
 
+#include <unity/scopes/internal/MiddlewareBase.h>
 #include <unity/scopes/internal/MWRegistry.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
+#include <unity/scopes/internal/ScopeMetadataImpl.h>
 
 using namespace std;
 
@@ -34,7 +36,43 @@ namespace internal
 
 RegistryImpl::RegistryImpl(MWRegistryProxy const& mw_proxy)
     : ObjectImpl(mw_proxy)
+    , catalog_stale_(true)
+    , announced_version_(0)
 {
+    if (mw_proxy->mw_base()->get_registry_catalog_path().empty())
+    {
+        return;
+    }
+
+    // The registry announces a new catalog version whenever its list of scopes changes.
+    // We subscribe before we first open the catalog, so we cannot miss an update in between.
+    // Without the subscription, we could not tell when the catalog is out of date, so we don't use it.
+    try
+    {
+        catalog_update_connection_.reset(new core::ScopedConnection(mw_proxy->set_catalog_update_callback(
+            [this](string const& version)
+            {
+                lock_guard<mutex> lock(catalog_mutex_);
+                catalog_stale_ = true;
+                if (!version.empty())
+                {
+                    try
+                    {
+                        // Not the maximum: if the registry restarts, it counts from the start again.
+                        announced_version_ = stoull(version);
+                    }
+                    catch (std::exception const&)
+                    {
+                        // Ignore malformed announcements; the catalog is re-opened regardless.
+                    }
+                }
+            })));
+    }
+    catch (std::exception const& e)
+    {
+        mw_proxy->mw_base()->runtime()->logger()(LoggerSeverity::Warning)
+            << "Registry: cannot subscribe to catalog updates, not using the scope catalog: " << e.what();
+    }
 }
 
 RegistryImpl::~RegistryImpl()
@@ -43,11 +81,34 @@ RegistryImpl::~RegistryImpl()
 
 ScopeMetadata RegistryImpl::get_metadata(std::string const& scope_id)
 {
+    auto cat = catalog();
+    if (cat)
+    {
+        VariantMap entry;
+        if (cat->find(scope_id, entry))
+        {
+            unique_ptr<ScopeMetadataImpl> smdi(new ScopeMetadataImpl(entry, fwd()->mw_base()));
+            return ScopeMetadata(ScopeMetadataImpl::create(move(smdi)));
+        }
+        // Not found. The scope may have been installed after the catalog was written,
+        // so we ask the registry, which gives us an authoritative answer.
+    }
     return fwd()->get_metadata(scope_id);
 }
 
 MetadataMap RegistryImpl::list()
 {
+    auto cat = catalog();
+    if (cat && cat->is_complete())
+    {
+        MetadataMap scopes;
+        for (auto& pair : cat->entries())
+        {
+            unique_ptr<ScopeMetadataImpl> smdi(new ScopeMetadataImpl(pair.second, fwd()->mw_base()));
+            scopes.emplace_hint(scopes.end(), pair.first, ScopeMetadata(ScopeMetadataImpl::create(move(smdi))));
+        }
+        return scopes;
+    }
     return fwd()->list();
 }
 
@@ -70,6 +131,16 @@ MetadataMap RegistryImpl::list_if(std::function<bool(ScopeMetadata const& item)>
     return matching_entries;
 }
 
+MetadataMap RegistryImpl::find_by_keywords(std::set<std::string> const& keywords)
+{
+    return fwd()->find_by_keywords(keywords);
+}
+
+MetadataMap RegistryImpl::children_of(std::string const& scope_id)
+{
+    return fwd()->children_of(scope_id);
+}
+
 bool RegistryImpl::is_scope_running(std::string const& scope_id)
 {
     return fwd()->is_scope_running(scope_id);
@@ -90,6 +161,42 @@ MWRegistryProxy RegistryImpl::fwd()
     return dynamic_pointer_cast<MWRegistry>(proxy());
 }
 
+shared_ptr<ScopeCatalog const> RegistryImpl::catalog()
+{
+    lock_guard<mutex> lock(catalog_mutex_);
+
+    if (!catalog_update_connection_ || !catalog_stale_)
+    {
+        return catalog_;
+    }
+
+    string const path = fwd()->mw_base()->get_registry_catalog_path();
+
+    try
+    {
+        catalog_ = ScopeCatalog::open(path);
+    }
+    catch (std::exception const&)
+    {
+        // No catalog (old registry, or the registry hasn't written it yet). We
+        // fall back to remote calls and try again when the registry announces an update.
+        catalog_.reset();
+        catalog_stale_ = false;
+        return catalog_;
+    }
+
+    if (catalog_->version() < announced_version_)
+    {
+        // The catalog is older than the one the registry announced, so its entries may be out of date,
+        // and a lookup would never revalidate them. We fall back to remote calls (which refresh the
+        // scope list from the registry) and re-open the catalog on the next call until we get the new one.
+        catalog_.reset();
+        return catalog_;
+    }
+    catalog_stale_ = false;
+    return catalog_;
+}
+
 } // namespace internal
 
 } // namespace scopes
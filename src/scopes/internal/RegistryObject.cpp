@@ -20,7 +20,9 @@
 
 #include <unity/scopes/internal/MWRegistry.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
+#include <unity/scopes/internal/ScopeCatalog.h>
 #include <unity/scopes/internal/Utils.h>
+#include <unity/scopes/internal/lttng/UnityScopes_tp.h>
 #include <unity/scopes/ScopeExceptions.h>
 #include <unity/UnityExceptions.h>
 #include <unity/util/ResourcePtr.h>
@@ -72,10 +74,15 @@ RegistryObject::RegistryObject(core::posix::ChildProcess::DeathObserver& death_o
           })
       },
       executor_(executor),
-      generate_desktop_files_(generate_desktop_files)
+      generate_desktop_files_(generate_desktop_files),
+      catalog_version_(0),
+      have_remote_scopes_(false),
+      list_updates_suspended_(false),
+      list_update_pending_(false)
 {
     if (middleware)
     {
+        catalog_path_ = middleware->get_registry_catalog_path();
         try
         {
             publisher_ = middleware->create_publisher(middleware->runtime()->registry_identity());
@@ -189,6 +196,72 @@ MetadataMap RegistryObject::list() const
     return all_scopes;
 }
 
+MetadataMap RegistryObject::find_by_keywords(std::set<std::string> const& keywords) const
+{
+    MetadataMap matching_scopes;
+    MWRegistryProxy remote_registry;
+    {
+        lock_guard<decltype(mutex_)> lock(mutex_);
+        for (auto const& id : keyword_index_.find(keywords))
+        {
+            auto it = scopes_.find(id);
+            assert(it != scopes_.end());
+            matching_scopes.emplace(*it);
+        }
+        remote_registry = remote_registry_;
+    }
+    // Unlock, so we don't call the remote registry while holding a lock.
+
+    // As for list(), local scopes take precedence over remote ones with the same id.
+    if (remote_registry)
+    {
+        try
+        {
+            MetadataMap remote_scopes = remote_registry->find_by_keywords(keywords);
+            matching_scopes.insert(remote_scopes.begin(), remote_scopes.end());
+        }
+        catch (std::exception const& e)
+        {
+            logger_() << "cannot find scopes by keywords in remote registry: " << e.what();
+        }
+    }
+
+    return matching_scopes;
+}
+
+MetadataMap RegistryObject::children_of(std::string const& scope_id) const
+{
+    if (scope_id.empty())
+    {
+        // If the id is empty, it was sent as empty by the remote client.
+        throw unity::InvalidArgumentException("RegistryObject::children_of(): Cannot search for scope with empty id");
+    }
+
+    ScopeMetadata aggregator = get_metadata(scope_id);  // Throws NotFoundException if scope doesn't exist.
+
+    MetadataMap children;
+    if (aggregator.is_aggregator())
+    {
+        children = find_by_keywords(aggregator.keywords());
+    }
+    for (auto const& id : aggregator.child_scope_ids())
+    {
+        if (children.find(id) == children.end())
+        {
+            try
+            {
+                children.emplace(id, get_metadata(id));
+            }
+            catch (NotFoundException const&)
+            {
+                // Child scopes that aren't installed are ignored.
+            }
+        }
+    }
+    children.erase(scope_id);
+    return children;
+}
+
 ObjectProxy RegistryObject::locate(std::string const& identity)
 {
     // If the id is empty, it was sent as empty by the remote client.
@@ -196,6 +269,7 @@ ObjectProxy RegistryObject::locate(std::string const& identity)
     {
         throw unity::InvalidArgumentException("RegistryObject::locate(): Cannot locate scope with empty id");
     }
+    simple_tracepoint(unity_scopes, registry_locate, identity.c_str());
 
     ObjectProxy proxy;
     shared_ptr<ScopeProcess> proc;
@@ -249,27 +323,26 @@ bool RegistryObject::add_local_scope(std::string const& scope_id, ScopeMetadata
         throw unity::InvalidArgumentException("RegistryObject::add_local_scope(): Cannot create a scope with '/' in its id");
     }
 
-    lock_guard<decltype(mutex_)> lock(mutex_);
-
     bool return_value = true;
-    if (scopes_.find(scope_id) != scopes_.end())
     {
-        // If scope is known already, remove it's details and kill it if it is running.
-        scopes_.erase(scope_id);
-        scope_processes_.erase(scope_id);
-        remove_desktop_file(scope_id);
-        return_value = false;
-    }
-    scopes_.insert(make_pair(scope_id, metadata));
-    scope_processes_.insert(make_pair(scope_id, make_shared<ScopeProcess>(exec_data, publisher_, logger_)));
+        lock_guard<decltype(mutex_)> lock(mutex_);
 
-    if (publisher_)
-    {
-        // Send a blank message to subscribers to inform them that the registry has been updated
-        publisher_->send_message("");
+        if (scopes_.find(scope_id) != scopes_.end())
+        {
+            // If scope is known already, remove it's details and kill it if it is running.
+            scopes_.erase(scope_id);
+            scope_processes_.erase(scope_id);
+            remove_desktop_file(scope_id);
+            return_value = false;
+        }
+        scopes_.insert(make_pair(scope_id, metadata));
+        keyword_index_.add(scope_id, metadata.keywords());
+        scope_processes_.insert(make_pair(scope_id, make_shared<ScopeProcess>(exec_data, publisher_, logger_)));
+
+        create_desktop_file(metadata);
     }
 
-    create_desktop_file(metadata);
+    publish_list_update();
     return return_value;
 }
 
@@ -312,6 +385,7 @@ bool RegistryObject::remove_local_scope(std::string const& scope_id)
         unique_lock<decltype(mutex_)> lock(mutex_);
 
         scope_processes_.erase(scope_id);
+        keyword_index_.remove(scope_id);
         erased = scopes_.erase(scope_id) == 1;
         if (erased)
         {
@@ -319,10 +393,9 @@ bool RegistryObject::remove_local_scope(std::string const& scope_id)
         }
     }
 
-    if (publisher_ && erased)
+    if (erased)
     {
-        // Send a blank message to subscribers to inform them that the registry has been updated
-        publisher_->send_message("");
+        publish_list_update();
     }
 
     if (ex)
@@ -334,9 +407,37 @@ bool RegistryObject::remove_local_scope(std::string const& scope_id)
 }
 
 void RegistryObject::set_remote_registry(MWRegistryProxy const& remote_registry)
+{
+    {
+        lock_guard<decltype(mutex_)> lock(mutex_);
+        remote_registry_ = remote_registry;
+        remote_scopes_.clear();
+        have_remote_scopes_ = false;
+    }
+
+    // Until the remote registry tells us about its scopes, the catalog is incomplete.
+    publish_list_update();
+}
+
+void RegistryObject::suspend_list_updates()
 {
     lock_guard<decltype(mutex_)> lock(mutex_);
-    remote_registry_ = remote_registry;
+    list_updates_suspended_ = true;
+}
+
+void RegistryObject::resume_list_updates()
+{
+    bool pending;
+    {
+        lock_guard<decltype(mutex_)> lock(mutex_);
+        list_updates_suspended_ = false;
+        pending = list_update_pending_;
+        list_update_pending_ = false;
+    }
+    if (pending)
+    {
+        publish_list_update();
+    }
 }
 
 StateReceiverObject::SPtr RegistryObject::state_receiver()
@@ -453,10 +554,97 @@ void RegistryObject::remove_desktop_file(std::string const& scope_id)
 
 void RegistryObject::ss_list_update()
 {
+    MWRegistryProxy remote_registry;
+    {
+        lock_guard<decltype(mutex_)> lock(mutex_);
+        remote_registry = remote_registry_;
+    }
+
+    // Refresh our copy of the remote scopes for the catalog.
+    // We don't call the remote registry while holding a lock.
+    if (remote_registry && !catalog_path_.empty())
+    {
+        MetadataMap remote_scopes;
+        bool have_remote_scopes = false;
+        try
+        {
+            remote_scopes = remote_registry->list();
+            have_remote_scopes = true;
+        }
+        catch (std::exception const& e)
+        {
+            logger_() << "RegistryObject::ss_list_update(): cannot get scopes list from remote registry: " << e.what();
+        }
+
+        lock_guard<decltype(mutex_)> lock(mutex_);
+        remote_scopes_ = move(remote_scopes);
+        have_remote_scopes_ = have_remote_scopes;
+    }
+
+    publish_list_update();
+}
+
+void RegistryObject::publish_list_update()
+{
+    {
+        lock_guard<decltype(mutex_)> lock(mutex_);
+        if (list_updates_suspended_)
+        {
+            list_update_pending_ = true;
+            return;
+        }
+    }
+
+    string catalog_version;
+    if (!catalog_path_.empty())
+    {
+        lock_guard<decltype(catalog_mutex_)> catalog_lock(catalog_mutex_);
+
+        MetadataMap local_scopes;
+        MetadataMap remote_scopes;
+        uint32_t flags = ScopeCatalog::Complete;
+        {
+            lock_guard<decltype(mutex_)> lock(mutex_);
+            local_scopes = scopes_;
+            if (remote_registry_)
+            {
+                remote_scopes = remote_scopes_;
+                if (!have_remote_scopes_)
+                {
+                    flags = 0;
+                }
+            }
+        }
+
+        try
+        {
+            ScopeCatalog::EntryMap entries;
+            for (auto const& pair : local_scopes)
+            {
+                entries.emplace(pair.first, pair.second.serialize());
+            }
+            // Local scopes take precedence over remote ones of the same id (see list()).
+            for (auto const& pair : remote_scopes)
+            {
+                if (entries.find(pair.first) == entries.end())
+                {
+                    entries.emplace(pair.first, pair.second.serialize());
+                }
+            }
+            ScopeCatalog::write(catalog_path_, catalog_version_ + 1, flags, entries);
+            catalog_version = std::to_string(++catalog_version_);
+        }
+        catch (std::exception const& e)
+        {
+            logger_() << "RegistryObject::publish_list_update(): cannot write scope catalog: " << e.what();
+        }
+    }
+
     if (publisher_)
     {
-        // Send a blank message to subscribers to inform them that the smart scopes proxy has been updated
-        publisher_->send_message("");
+        // Inform subscribers that the registry has been updated. The message carries the
+        // catalog version (or is empty if no catalog was written).
+        publisher_->send_message(catalog_version);
     }
 }
 
@@ -532,6 +720,7 @@ void RegistryObject::ScopeProcess::exec(
 
     // 2. exec the scope.
     update_state_unlocked(Starting);
+    simple_tracepoint(unity_scopes, registry_exec_start, exec_data_.scope_id.c_str());
 
     std::string program;
     std::vector<std::string> argv;
@@ -606,6 +795,7 @@ void RegistryObject::ScopeProcess::exec(
 
     logger_(LoggerSeverity::Info) << "RegistryObject::ScopeProcess::exec(): Process for scope: \""
                                   << exec_data_.scope_id << "\" started";
+    simple_tracepoint(unity_scopes, registry_exec_end, exec_data_.scope_id.c_str(), process_.pid());
 
     // 4. add the scope process to the death observer
     death_observer.add(process_);
@@ -42,6 +42,7 @@ ReplyImpl::ReplyImpl(MWReplyProxy const& mw_proxy, std::shared_ptr<QueryObjectBa
     : ObjectImpl(mw_proxy)
     , qo_(qo)
     , finished_(false)
+    , trace_context_(TraceContext::current())
 {
     assert(mw_proxy);
 }
@@ -71,6 +72,7 @@ bool ReplyImpl::push(VariantMap const& variant_map)
         return false;
     }
 
+    TraceScope trace_scope(trace_context_);
     try
     {
         fwd()->push(variant_map);
@@ -88,6 +90,7 @@ void ReplyImpl::finished()
 {
     if (!finished_.exchange(true))
     {
+        TraceScope trace_scope(trace_context_);
         try
         {
             fwd()->finished(CompletionDetails(CompletionDetails::OK));  // Oneway, can't block
@@ -123,6 +126,7 @@ void ReplyImpl::error(exception_ptr ex)
     }
     mw_proxy_->mw_base()->runtime()->logger()() << "ReplyImpl::error(): " << error_message;
 
+    TraceScope trace_scope(trace_context_);
     try
     {
         fwd()->finished(CompletionDetails(CompletionDetails::Error, error_message));  // Oneway, can't block
@@ -140,6 +144,7 @@ void ReplyImpl::info(OperationInfo const& op_info)
         return; // Ignore info messages that arrive after finished().
     }
 
+    TraceScope trace_scope(trace_context_);
     try
     {
         fwd()->info(op_info);
@@ -21,6 +21,8 @@
 #include <unity/scopes/internal/PreviewReplyObject.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
 #include <unity/scopes/internal/AnnotationImpl.h>
+#include <unity/scopes/internal/CompletionDetailsImpl.h>
+#include <unity/scopes/internal/Metrics.h>
 #include <unity/scopes/ListenerBase.h>
 #include <unity/scopes/Category.h>
 #include <unity/scopes/CategorisedResult.h>
@@ -40,6 +42,44 @@ namespace scopes
 namespace internal
 {
 
+namespace
+{
+
+// Queries as seen by the client side, that is, including the middleware round trips.
+
+Gauge& active_queries()
+{
+    static Gauge& g = MetricsRegistry::instance().gauge("unity_scopes_active_queries",
+                                                        "Queries that were sent and have not finished yet");
+    return g;
+}
+
+void record_query(CompletionDetails::CompletionStatus status, chrono::microseconds duration) noexcept
+{
+    static MetricsRegistry& r = MetricsRegistry::instance();
+    static char const* const help = "Queries that have finished, by completion status";
+    static Counter& ok = r.counter("unity_scopes_queries_total", help, "status=\"ok\"");
+    static Counter& cancelled = r.counter("unity_scopes_queries_total", help, "status=\"cancelled\"");
+    static Counter& error = r.counter("unity_scopes_queries_total", help, "status=\"error\"");
+    static Histogram& durations = r.histogram("unity_scopes_query_duration_seconds",
+                                              "Time from sending a query until it finished");
+    switch (status)
+    {
+        case CompletionDetails::OK:
+            ok.inc();
+            break;
+        case CompletionDetails::Cancelled:
+            cancelled.inc();
+            break;
+        default:
+            error.inc();
+            break;
+    }
+    durations.record(duration);
+}
+
+} // namespace
+
 ReplyObject::ReplyObject(ListenerBase::SPtr const& receiver_base,
                          RuntimeImpl const* runtime,
                          std::string const& scope_proxy,
@@ -49,6 +89,9 @@ ReplyObject::ReplyObject(ListenerBase::SPtr const& receiver_base,
     , finished_(false)
     , origin_proxy_(scope_proxy)
     , num_push_(0)
+    , start_time_(chrono::system_clock::now())
+    , start_(chrono::steady_clock::now())
+    , result_count_(0)
 {
     assert(receiver_base);
     assert(runtime);
@@ -61,6 +104,7 @@ ReplyObject::ReplyObject(ListenerBase::SPtr const& receiver_base,
             this->finished(CompletionDetails(CompletionDetails::Error, msg));
         });
     }
+    active_queries().inc();  // Last, so the gauge stays balanced if we throw.
 }
 
 ReplyObject::~ReplyObject()
@@ -105,6 +149,16 @@ void ReplyObject::push(VariantMap const& result) noexcept
         unique_lock<mutex> lock(mutex_);
         assert(num_push_ >= 0);
         ++num_push_;
+
+        last_push_ = chrono::steady_clock::now();
+        if (first_push_ == chrono::steady_clock::time_point())
+        {
+            first_push_ = last_push_;
+        }
+        if (result.find("result") != result.end())
+        {
+            ++result_count_;
+        }
     }  // Forward invocations to application outside synchronization
 
     bool stop = false;
@@ -156,6 +210,7 @@ void ReplyObject::finished(CompletionDetails const& details) noexcept
     }
 
     // Only one thread can reach this point, any others were thrown out above.
+    active_queries().dec();
 
     ReapItem::SPtr ri;
     {
@@ -178,7 +233,15 @@ void ReplyObject::finished(CompletionDetails const& details) noexcept
         {
             details_with_info.add_info(info);
         }
+        auto const timings = complete_timings(details);
+        record_query(details.status(), timings.total());
+        CompletionDetailsImpl::impl(details_with_info)->set_timings(timings);
+        auto const sink = timings_sink_;
         lock.unlock(); // Inform the application code that the query is complete outside synchronization.
+        if (sink)
+        {
+            sink(QueryTimingsImpl::create(timings));
+        }
         listener_base_->finished(details_with_info);
     }
     catch (std::exception const& e)
@@ -232,6 +295,56 @@ std::string ReplyObject::origin_proxy() const
     return origin_proxy_;
 }
 
+void ReplyObject::set_origin_scope_id(std::string const& scope_id)
+{
+    lock_guard<mutex> lock(mutex_);
+    origin_scope_id_ = scope_id;
+}
+
+std::string ReplyObject::origin_scope_id() const
+{
+    lock_guard<mutex> lock(mutex_);
+    return origin_scope_id_;
+}
+
+void ReplyObject::query_sent() noexcept
+{
+    lock_guard<mutex> lock(mutex_);
+    sent_ = chrono::steady_clock::now();
+}
+
+void ReplyObject::set_timings_sink(TimingsSink const& sink)
+{
+    lock_guard<mutex> lock(mutex_);
+    timings_sink_ = sink;
+}
+
+// Adds our own measurements to the ones that arrived from the scope with finished() (if any).
+// Called with mutex_ locked.
+
+QueryTimingsImpl ReplyObject::complete_timings(CompletionDetails const& details) const
+{
+    auto const scope_timings = CompletionDetailsImpl::impl(details)->timings_impl();
+    QueryTimingsImpl timings = scope_timings ? *scope_timings : QueryTimingsImpl();
+
+    auto const since_start = [this](chrono::steady_clock::time_point t)
+    {
+        return t == chrono::steady_clock::time_point()
+                   ? chrono::microseconds(0)
+                   : chrono::duration_cast<chrono::microseconds>(t - start_);
+    };
+    timings.set_send_time(since_start(sent_));
+    if (timings.run_start_time() != chrono::system_clock::time_point())
+    {
+        timings.set_run_start(chrono::duration_cast<chrono::microseconds>(timings.run_start_time() - start_time_));
+    }
+    timings.set_first_push(since_start(first_push_));
+    timings.set_last_push(since_start(last_push_));
+    timings.set_total(since_start(chrono::steady_clock::now()));
+    timings.set_result_count(result_count_);
+    return timings;
+}
+
 RuntimeImpl const* ReplyObject::runtime() const
 {
     return runtime_;
@@ -50,10 +50,14 @@ const string default_middleware_key = "Default.Middleware";
 const string default_middleware_configfile_key = ".ConfigFile";
 const string reap_expiry_key = "Reap.Expiry";
 const string reap_interval_key = "Reap.Interval";
+const string deadline_margin_key = "Deadline.Margin";
 const string cache_dir_key = "CacheDir";
 const string app_dir_key = "AppDir";
 const string config_dir_key = "ConfigDir";
 const string trace_channels_key = "Log.TraceChannels";
+const string capture_dir_key = "Capture.Dir";
+const string trace_dir_key = "Trace.Dir";
+const string metrics_dir_key = "Metrics.Dir";
 
 }  // namespace
 
@@ -70,6 +74,7 @@ RuntimeConfig::RuntimeConfig(string const& configfile) :
         default_middleware_configfile_ = snap_root() + DFLT_ZMQ_MIDDLEWARE_INI;
         reap_expiry_ = DFLT_REAP_EXPIRY;
         reap_interval_ = DFLT_REAP_INTERVAL;
+        deadline_margin_ = DFLT_DEADLINE_MARGIN;
         cache_directory_ = default_cache_directory();
         app_directory_ = default_app_directory();
         config_directory_ = default_config_directory();
@@ -94,6 +99,11 @@ RuntimeConfig::RuntimeConfig(string const& configfile) :
         {
             throw_ex("Illegal value (" + to_string(reap_interval_) + ") for " + reap_interval_key + ": value must be > 0");
         }
+        deadline_margin_ = get_optional_int(runtime_config_group, deadline_margin_key, DFLT_DEADLINE_MARGIN);
+        if (deadline_margin_ < 0)
+        {
+            throw_ex("Illegal value (" + to_string(deadline_margin_) + ") for " + deadline_margin_key + ": value must be >= 0");
+        }
 
         cache_directory_ = get_optional_string(runtime_config_group, cache_dir_key);
         if (cache_directory_.empty())
@@ -154,6 +164,32 @@ RuntimeConfig::RuntimeConfig(string const& configfile) :
             split(channels, tc, boost::is_any_of(";"), boost::token_compress_on);
             trace_channels_ = channels;
         }
+
+        capture_directory_ = get_optional_string(runtime_config_group, capture_dir_key);
+        trace_directory_ = get_optional_string(runtime_config_group, trace_dir_key);
+        metrics_directory_ = get_optional_string(runtime_config_group, metrics_dir_key);
+    }
+
+    // UNITY_SCOPES_CAPTURE_DIR env var can be used to switch on traffic capture without changing Runtime.ini
+    char const* capture_dir_override = getenv("UNITY_SCOPES_CAPTURE_DIR");
+    if (capture_dir_override && *capture_dir_override != '\0')
+    {
+        capture_directory_ = capture_dir_override;
+    }
+
+    // Likewise, UNITY_SCOPES_TRACE_DIR switches on tracing. Because the registry passes its environment
+    // to the scopes it starts, setting it for the registry and the client traces all processes.
+    char const* trace_dir_override = getenv("UNITY_SCOPES_TRACE_DIR");
+    if (trace_dir_override && *trace_dir_override != '\0')
+    {
+        trace_directory_ = trace_dir_override;
+    }
+
+    // UNITY_SCOPES_METRICS_DIR makes each scope process serve its metrics on a socket in that directory.
+    char const* metrics_dir_override = getenv("UNITY_SCOPES_METRICS_DIR");
+    if (metrics_dir_override && *metrics_dir_override != '\0')
+    {
+        metrics_directory_ = metrics_dir_override;
     }
 
     KnownEntries const known_entries = {
@@ -167,10 +203,14 @@ RuntimeConfig::RuntimeConfig(string const& configfile) :
                                                 default_middleware_ + default_middleware_configfile_key,
                                                 reap_expiry_key,
                                                 reap_interval_key,
+                                                deadline_margin_key,
                                                 cache_dir_key,
                                                 app_dir_key,
                                                 config_dir_key,
-                                                trace_channels_key
+                                                trace_channels_key,
+                                                capture_dir_key,
+                                                trace_dir_key,
+                                                metrics_dir_key
                                              }
                                           }
                                        };
@@ -221,6 +261,11 @@ int RuntimeConfig::reap_interval() const
     return reap_interval_;
 }
 
+int RuntimeConfig::deadline_margin() const
+{
+    return deadline_margin_;
+}
+
 string RuntimeConfig::cache_directory() const
 {
     return cache_directory_;
@@ -241,6 +286,21 @@ vector<string> RuntimeConfig::trace_channels() const
     return trace_channels_;
 }
 
+string RuntimeConfig::capture_directory() const
+{
+    return capture_directory_;
+}
+
+string RuntimeConfig::trace_directory() const
+{
+    return trace_directory_;
+}
+
+string RuntimeConfig::metrics_directory() const
+{
+    return metrics_directory_;
+}
+
 string RuntimeConfig::default_cache_directory()
 {
     char const* home = getenv("HOME");
@@ -29,6 +29,7 @@
 #include <unity/scopes/internal/ScopeConfig.h>
 #include <unity/scopes/internal/ScopeObject.h>
 #include <unity/scopes/internal/SettingsDB.h>
+#include <unity/scopes/internal/TrafficCapture.h>
 #include <unity/scopes/internal/UniqueID.h>
 #include <unity/scopes/internal/Utils.h>
 #include <unity/scopes/ScopeBase.h>
@@ -100,6 +101,7 @@ RuntimeImpl::RuntimeImpl(string const& scope_id, string const& configfile)
         registry_identity_ = config.registry_identity();
         reap_expiry_ = config.reap_expiry();
         reap_interval_ = config.reap_interval();
+        deadline_margin_ = config.deadline_margin();
         ss_configfile_ = config.ss_configfile();
         ss_registry_identity_ = config.ss_registry_identity();
 
@@ -126,6 +128,36 @@ RuntimeImpl::RuntimeImpl(string const& scope_id, string const& configfile)
         cache_dir_ = config.cache_directory();
         app_dir_ = config.app_directory();
         config_dir_ = config.config_directory();
+        capture_dir_ = config.capture_directory();
+
+        // Tracing is best-effort: if we can't open the trace file, we run without it.
+        if (!config.trace_directory().empty())
+        {
+            try
+            {
+                trace_log_.reset(new TraceLog(config.trace_directory(), log_file_basename, logger()));
+            }
+            catch (std::exception const& e)
+            {
+                logger()(LoggerSeverity::Warning) << "cannot trace requests: " << e.what();
+            }
+        }
+
+        // Likewise for metrics. Clients don't serve their metrics; the registry serves the
+        // metrics of all processes (see MetricsServer.h).
+        if (!config.metrics_directory().empty() && !scope_id.empty())
+        {
+            try
+            {
+                metrics_server_.reset(new MetricsServer(config.metrics_directory() + "/" + scope_id_ + ".sock",
+                                                        scope_id_ == registry_identity_,
+                                                        logger()));
+            }
+            catch (std::exception const& e)
+            {
+                logger()(LoggerSeverity::Warning) << "cannot serve metrics: " << e.what();
+            }
+        }
     }
     catch (unity::Exception const&)
     {
@@ -161,6 +193,19 @@ RuntimeImpl::UPtr RuntimeImpl::create(string const& scope_id, string const& conf
 
 void RuntimeImpl::destroy()
 {
+    // Stop the deadline monitor first, without holding the lock: the callback for an
+    // expired deadline cancels a query, which can call back into the run time.
+    // Once destroyed, the monitor rejects new deadlines.
+    DeadlineMonitor::SPtr deadline_monitor;
+    {
+        lock_guard<mutex> lock(mutex_);
+        deadline_monitor = deadline_monitor_;
+    }
+    if (deadline_monitor)
+    {
+        deadline_monitor->destroy();
+    }
+
     lock_guard<mutex> lock(mutex_);
 
     if (destroyed_)
@@ -169,6 +214,8 @@ void RuntimeImpl::destroy()
     }
     destroyed_ = true;
 
+    metrics_server_.reset();
+
     // Stop the reaper. Any ReplyObject instances that may still
     // be hanging around will be cleaned up when the server side
     // is shut down.
@@ -270,6 +317,22 @@ Reaper::SPtr RuntimeImpl::reply_reaper() const
     return reply_reaper_;
 }
 
+DeadlineMonitor::SPtr RuntimeImpl::deadline_monitor() const
+{
+    // Created lazily, when the first query with a deadline arrives.
+    lock_guard<mutex> lock(mutex_);
+    if (!deadline_monitor_)
+    {
+        deadline_monitor_ = DeadlineMonitor::create();
+    }
+    return deadline_monitor_;
+}
+
+chrono::milliseconds RuntimeImpl::deadline_margin() const
+{
+    return chrono::milliseconds(deadline_margin_);  // Immutable
+}
+
 void RuntimeImpl::waiter_thread(ThreadSafeQueue<std::future<void>>::SPtr const& queue) const noexcept
 {
     for (;;)
@@ -309,6 +372,11 @@ internal::Logger& RuntimeImpl::logger() const
     return *logger_;
 }
 
+TraceLog* RuntimeImpl::trace_log() const
+{
+    return trace_log_.get();
+}
+
 namespace
 {
 
@@ -345,13 +413,38 @@ private:
 void RuntimeImpl::run_scope(ScopeBase* scope_base,
                             string const& scope_ini_file,
                             std::promise<void> ready_promise)
+{
+    do_run_scope(scope_base, scope_id_, scope_ini_file, false, move(ready_promise));
+}
+
+void RuntimeImpl::host_scope(ScopeBase* scope_base,
+                             string const& scope_id,
+                             string const& scope_ini_file,
+                             std::promise<void> ready_promise)
+{
+    if (scope_id.empty())
+    {
+        throw InvalidArgumentException("Runtime::host_scope(): scope_id cannot be empty");
+    }
+    // A hosted scope gets its own scope adapter, but shares the middleware (and with it
+    // the zmq context and invocation pools) with the other scopes in the process. An idle
+    // timeout on any adapter shuts down the entire middleware, so hosted scopes never time
+    // out; the host process runs until it is told to stop.
+    do_run_scope(scope_base, scope_id, scope_ini_file, true, move(ready_promise));
+}
+
+void RuntimeImpl::do_run_scope(ScopeBase* scope_base,
+                               string const& scope_id,
+                               string const& scope_ini_file,
+                               bool hosted,
+                               std::promise<void> ready_promise)
 {
     if (!scope_base)
     {
         throw InvalidArgumentException("Runtime::run_scope(): scope_base cannot be nullptr");
     }
 
-    // Create a middleware for this scope.
+    // Create a middleware for this scope. Hosted scopes share the middleware of the run time.
     RegistryConfig reg_conf(registry_identity_, registry_configfile_);
     auto mw = factory()->create(scope_id_, reg_conf.mw_kind(), reg_conf.mw_configfile());
 
@@ -360,10 +453,10 @@ void RuntimeImpl::run_scope(ScopeBase* scope_base,
 
     {
         // Try to open the scope settings database, if any.
-        string config_dir = config_dir_ + "/" + scope_id_;
+        string config_dir = config_dir_ + "/" + scope_id;
         string settings_db = config_dir + "/settings.ini";
 
-        string settings_schema = scope_dir.native() + "/" + scope_id_ + "-settings.ini";
+        string settings_schema = scope_dir.native() + "/" + scope_id + "-settings.ini";
 
         boost::system::error_code ec;
         if (boost::filesystem::exists(settings_schema, ec) && boost::filesystem::file_size(settings_schema) > 0)
@@ -384,25 +477,25 @@ void RuntimeImpl::run_scope(ScopeBase* scope_base,
     }
 
     scope_base->p->set_registry(registry_);
-    scope_base->p->set_cache_directory(find_cache_dir());
-    scope_base->p->set_app_directory(find_app_dir());
-    scope_base->p->set_tmp_directory(find_tmp_dir());
+    scope_base->p->set_cache_directory(find_cache_dir(scope_id));
+    scope_base->p->set_app_directory(find_app_dir(scope_id));
+    scope_base->p->set_tmp_directory(find_tmp_dir(scope_id));
 
     // TODO: redirect log messages to scope-specific file.
 
     try
     {
-        scope_base->start(scope_id_);
+        scope_base->start(scope_id);
     }
     catch (...)
     {
-        throw unity::ResourceException("Scope " + scope_id_ +": exception from start()");
+        throw unity::ResourceException("Scope " + scope_id +": exception from start()");
     }
 
     exception_ptr ep;  // Stores any exceptions that happen from now on.
 
     // Ensure the scope gets stopped.
-    auto call_stop = [this, &ep](ScopeBase *scope_base)
+    auto call_stop = [&scope_id, &ep](ScopeBase *scope_base)
     {
         try
         {
@@ -410,7 +503,7 @@ void RuntimeImpl::run_scope(ScopeBase* scope_base,
         }
         catch (...)
         {
-            unity::ResourceException ex("Scope " + scope_id_ +": exception from stop()");
+            unity::ResourceException ex("Scope " + scope_id +": exception from stop()");
             ep = make_exception_ptr(ex);
         }
     };
@@ -425,6 +518,22 @@ void RuntimeImpl::run_scope(ScopeBase* scope_base,
     auto run_future = std::async(launch::async, [scope_base] { scope_base->run(); });
     this_thread::yield();
 
+    // Traffic capture is best-effort: if we can't open the capture file, the scope runs without it.
+    TrafficCapture::SPtr capture;
+    if (!capture_dir_.empty())
+    {
+        string const capture_file = capture_dir_ + "/" + scope_id + ".capture";
+        try
+        {
+            capture = make_shared<TrafficCapture>(capture_file, logger());
+        }
+        catch (std::exception const& e)
+        {
+            logger()(LoggerSeverity::Warning) << "Scope " << scope_id << ": cannot capture traffic to "
+                                              << capture_file << ": " << e.what();
+        }
+    }
+
     try
     {
         // Create a servant for the scope and register the servant.
@@ -432,21 +541,22 @@ void RuntimeImpl::run_scope(ScopeBase* scope_base,
         {
             // Check if this scope has requested debug mode, if so, disable the idle timeout
             ScopeConfig scope_config(scope_ini_file);
-            int idle_timeout_ms = scope_config.debug_mode() ? -1 : scope_config.idle_timeout() * 1000;
+            int idle_timeout_ms = (hosted || scope_config.debug_mode()) ? -1 : scope_config.idle_timeout() * 1000;
             auto scope = unique_ptr<internal::ScopeObject>(new internal::ScopeObject(scope_base,
-                                                                                     scope_config.debug_mode()));
-            mw->add_scope_object(scope_id_, move(scope), idle_timeout_ms);
+                                                                                     scope_config.debug_mode(),
+                                                                                     capture));
+            mw->add_scope_object(scope_id, move(scope), idle_timeout_ms);
         }
         else
         {
-            auto scope = unique_ptr<internal::ScopeObject>(new internal::ScopeObject(scope_base));
-            mw->add_scope_object(scope_id_, move(scope));
+            auto scope = unique_ptr<internal::ScopeObject>(new internal::ScopeObject(scope_base, false, capture));
+            mw->add_scope_object(scope_id, move(scope));
         }
 
         // Inform the registry that this scope is now ready to process requests
         {
             auto reg_state_receiver = mw->create_registry_state_receiver_proxy("StateReceiver");
-            reg_state_receiver->push_state(scope_id_, StateReceiverObject::State::ScopeReady);
+            reg_state_receiver->push_state(scope_id, StateReceiverObject::State::ScopeReady);
         }
 
         promise.set_value();
@@ -455,16 +565,16 @@ void RuntimeImpl::run_scope(ScopeBase* scope_base,
 
         {
             // mw is now shut down, so we need a separate one to send the state update to the registry.
-            auto sd_runtime = create(scope_id_ + "-shutdown", runtime_configfile_);
-            auto sd_mw = sd_runtime->factory()->find(scope_id_ + "-shutdown", reg_conf.mw_kind());
+            auto sd_runtime = create(scope_id + "-shutdown", runtime_configfile_);
+            auto sd_mw = sd_runtime->factory()->find(scope_id + "-shutdown", reg_conf.mw_kind());
             auto reg_state_receiver = sd_mw->create_registry_state_receiver_proxy("StateReceiver");
             // Inform the registry that this scope is shutting down
-            reg_state_receiver->push_state(scope_id_, StateReceiverObject::State::ScopeStopping);
+            reg_state_receiver->push_state(scope_id, StateReceiverObject::State::ScopeStopping);
         }
     }
     catch (...)
     {
-        unity::ResourceException ex("Scope " + scope_id_ +": failure during initialization");
+        unity::ResourceException ex("Scope " + scope_id +": failure during initialization");
         ex.remember(ep);  // ep will still be nullptr if something other than stop() threw.
         ep = make_exception_ptr(ex);
     }
@@ -475,7 +585,7 @@ void RuntimeImpl::run_scope(ScopeBase* scope_base,
     }
     catch (...)
     {
-        unity::ResourceException ex("Scope " + scope_id_ +": exception from run()");
+        unity::ResourceException ex("Scope " + scope_id +": exception from run()");
         ep = ex.remember(ep);
     }
 
@@ -517,12 +627,12 @@ string RuntimeImpl::proxy_to_string(ObjectProxy const& proxy) const
 
 string RuntimeImpl::cache_directory() const
 {
-    return find_cache_dir();
+    return find_cache_dir(scope_id_);
 }
 
 string RuntimeImpl::tmp_directory() const
 {
-    return find_tmp_dir();
+    return find_tmp_dir(scope_id_);
 }
 
 string RuntimeImpl::config_directory() const
@@ -575,7 +685,7 @@ string RuntimeImpl::confinement_type() const
     return confined() ? "leaf-net" : "unconfined";
 }
 
-string RuntimeImpl::find_cache_dir() const
+string RuntimeImpl::find_cache_dir(string const& id) const
 {
     // Create the cache_dir_/<confinement-type>/<id> directories if they don't exist.
     string dir = cache_dir_ + "/" + confinement_type();
@@ -584,15 +694,15 @@ string RuntimeImpl::find_cache_dir() const
         make_directories(dir, 0700);
     }
     // A confined scope is allowed to create this dir.
-    dir += "/" + demangled_id(scope_id_);
+    dir += "/" + demangled_id(id);
     make_directories(dir, 0700);
     return dir;
 }
 
-string RuntimeImpl::find_app_dir() const
+string RuntimeImpl::find_app_dir(string const& id) const
 {
     // Create the app_dir_/<id> directories if they don't exist.
-    string dir = app_dir_ + "/" + demangled_id(scope_id_);
+    string dir = app_dir_ + "/" + demangled_id(id);
     if (!confined())  // Avoid apparmor noise
     {
         make_directories(dir, 0700);
@@ -616,7 +726,7 @@ string RuntimeImpl::find_log_dir(string const& id) const
     return dir;
 }
 
-string RuntimeImpl::find_tmp_dir() const
+string RuntimeImpl::find_tmp_dir(string const& id) const
 {
     // Set tmp dir.
     // We need to create any directories under /run/user/<uid> because they might not
@@ -628,7 +738,7 @@ string RuntimeImpl::find_tmp_dir() const
         make_directories(dir, 0700);
     }
     // A confined scope is allowed to create this dir.
-    dir += "/" + scope_id_;  // Not demangled, use the real scope ID.
+    dir += "/" + id;  // Not demangled, use the real scope ID.
     make_directories(dir, 0700);
     return dir;
 }
@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/ScopeCatalog.h>
+
+#include <unity/scopes/internal/VariantBinary.h>
+
+#include <unity/UnityExceptions.h>
+#include <unity/util/ResourcePtr.h>
+
+#include <cassert>
+#include <cstring>
+#include <functional>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace unity::util;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+char const magic[4] = { 'U', 'S', 'C', 'C' };
+uint32_t const format_version = 1;
+
+size_t const header_size = sizeof(magic) + sizeof(uint32_t) + sizeof(uint64_t) + 2 * sizeof(uint32_t);
+size_t const index_record_size = 4 * sizeof(uint32_t);
+
+struct IndexRecord
+{
+    uint32_t id_offset;
+    uint32_t id_len;
+    uint32_t data_offset;
+    uint32_t data_len;
+};
+
+} // namespace
+
+constexpr uint32_t ScopeCatalog::Complete;
+
+void ScopeCatalog::write(string const& path, uint64_t version, uint32_t flags, EntryMap const& entries)
+{
+    // Data area first, so we know the offsets for the index.
+    size_t const data_start = header_size + entries.size() * index_record_size;
+    vector<IndexRecord> index;
+    index.reserve(entries.size());
+    string data;
+    for (auto const& e : entries)  // EntryMap is ordered, so the index ends up sorted by id.
+    {
+        IndexRecord r;
+        r.id_offset = data_start + data.size();
+        r.id_len = e.first.size();
+        data.append(e.first);
+        r.data_offset = data_start + data.size();
+        variant_to_binary(Variant(e.second), data);
+        r.data_len = data_start + data.size() - r.data_offset;
+        index.push_back(r);
+    }
+
+    string buf;
+    buf.reserve(data_start + data.size());
+    buf.append(magic, sizeof(magic));
+    binary_put(buf, format_version);
+    binary_put(buf, version);
+    binary_put(buf, flags);
+    binary_put(buf, static_cast<uint32_t>(entries.size()));
+    for (auto const& r : index)
+    {
+        binary_put(buf, r.id_offset);
+        binary_put(buf, r.id_len);
+        binary_put(buf, r.data_offset);
+        binary_put(buf, r.data_len);
+    }
+    buf.append(data);
+
+    // Write to a temporary file and rename it into place. That way, readers either
+    // see the old or the new catalog, and existing mappings of the old catalog stay intact.
+    string const tmp_path = path + ".tmp";
+    {
+        ResourcePtr<int, function<void(int)>> fd(::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644),
+                                                 [](int fd)
+                                                 {
+                                                     if (fd != -1)
+                                                     {
+                                                         ::close(fd);
+                                                     }
+                                                 });
+        if (fd.get() == -1)
+        {
+            throw FileException("ScopeCatalog::write(): cannot open " + tmp_path, errno);
+        }
+        char const* p = buf.data();
+        size_t remaining = buf.size();
+        while (remaining > 0)
+        {
+            ssize_t n = ::write(fd.get(), p, remaining);
+            if (n == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                int err = errno;
+                ::unlink(tmp_path.c_str());
+                throw FileException("ScopeCatalog::write(): cannot write " + tmp_path, err);
+            }
+            p += n;
+            remaining -= n;
+        }
+    }
+    if (::rename(tmp_path.c_str(), path.c_str()) == -1)
+    {
+        int err = errno;
+        ::unlink(tmp_path.c_str());
+        throw FileException("ScopeCatalog::write(): cannot rename " + tmp_path + " to " + path, err);
+    }
+}
+
+ScopeCatalog::UPtr ScopeCatalog::open(string const& path)
+{
+    ResourcePtr<int, function<void(int)>> fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC),
+                                             [](int fd)
+                                             {
+                                                 if (fd != -1)
+                                                 {
+                                                     ::close(fd);
+                                                 }
+                                             });
+    if (fd.get() == -1)
+    {
+        throw FileException("ScopeCatalog::open(): cannot open " + path, errno);
+    }
+
+    struct stat st;
+    if (::fstat(fd.get(), &st) == -1)
+    {
+        throw FileException("ScopeCatalog::open(): cannot stat " + path, errno);
+    }
+    size_t length = st.st_size;
+    if (length < header_size)
+    {
+        throw ResourceException("ScopeCatalog::open(): " + path + ": file too short");
+    }
+
+    void* addr = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd.get(), 0);
+    if (addr == MAP_FAILED)
+    {
+        throw FileException("ScopeCatalog::open(): cannot map " + path, errno);
+    }
+    // The mapping stays valid after the file descriptor is closed.
+
+    return UPtr(new ScopeCatalog(path, addr, length));
+}
+
+ScopeCatalog::ScopeCatalog(string const& path, void* addr, size_t length)
+    : path_(path)
+    , addr_(addr)
+    , length_(length)
+    , base_(static_cast<char const*>(addr))
+{
+    try
+    {
+        BinaryDecoder d(base_, base_ + length_);
+        char m[sizeof(magic)];
+        for (auto& c : m)
+        {
+            c = d.get<char>();
+        }
+        if (memcmp(m, magic, sizeof(magic)) != 0)
+        {
+            throw ResourceException("ScopeCatalog::open(): " + path_ + ": bad magic number");
+        }
+        uint32_t fv = d.get<uint32_t>();
+        if (fv != format_version)
+        {
+            throw ResourceException("ScopeCatalog::open(): " + path_ + ": unsupported format version "
+                                    + std::to_string(fv));
+        }
+        version_ = d.get<uint64_t>();
+        flags_ = d.get<uint32_t>();
+        count_ = d.get<uint32_t>();
+        if ((length_ - header_size) / index_record_size < count_)
+        {
+            throw ResourceException("ScopeCatalog::open(): " + path_ + ": truncated index");
+        }
+    }
+    catch (...)
+    {
+        ::munmap(addr_, length_);
+        throw;
+    }
+}
+
+ScopeCatalog::~ScopeCatalog()
+{
+    ::munmap(addr_, length_);
+}
+
+uint64_t ScopeCatalog::version() const noexcept
+{
+    return version_;
+}
+
+bool ScopeCatalog::is_complete() const noexcept
+{
+    return (flags_ & Complete) != 0;
+}
+
+size_t ScopeCatalog::size() const noexcept
+{
+    return count_;
+}
+
+bool ScopeCatalog::find(string const& scope_id, VariantMap& entry) const
+{
+    // Binary search over the sorted index, comparing the ids in place.
+    uint32_t lo = 0;
+    uint32_t hi = count_;
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        BinaryDecoder d(base_ + header_size + mid * index_record_size, base_ + length_);
+        uint32_t id_offset = d.get<uint32_t>();
+        uint32_t id_len = d.get<uint32_t>();
+        if (id_offset > length_ || length_ - id_offset < id_len)
+        {
+            throw ResourceException("ScopeCatalog::find(): " + path_ + ": corrupt index");
+        }
+        int cmp = scope_id.compare(0, string::npos, base_ + id_offset, id_len);
+        if (cmp == 0)
+        {
+            entry = entry_at(mid);
+            return true;
+        }
+        if (cmp < 0)
+        {
+            hi = mid;
+        }
+        else
+        {
+            lo = mid + 1;
+        }
+    }
+    return false;
+}
+
+ScopeCatalog::EntryMap ScopeCatalog::entries() const
+{
+    EntryMap m;
+    for (uint32_t i = 0; i < count_; ++i)
+    {
+        m.emplace_hint(m.end(), id_at(i), entry_at(i));
+    }
+    return m;
+}
+
+string ScopeCatalog::id_at(uint32_t index) const
+{
+    assert(index < count_);
+    BinaryDecoder d(base_ + header_size + index * index_record_size, base_ + length_);
+    uint32_t id_offset = d.get<uint32_t>();
+    uint32_t id_len = d.get<uint32_t>();
+    if (id_offset > length_ || length_ - id_offset < id_len)
+    {
+        throw ResourceException("ScopeCatalog: " + path_ + ": corrupt index");
+    }
+    return string(base_ + id_offset, id_len);
+}
+
+VariantMap ScopeCatalog::entry_at(uint32_t index) const
+{
+    assert(index < count_);
+    BinaryDecoder d(base_ + header_size + index * index_record_size + 2 * sizeof(uint32_t), base_ + length_);
+    uint32_t data_offset = d.get<uint32_t>();
+    uint32_t data_len = d.get<uint32_t>();
+    if (data_offset > length_ || length_ - data_offset < data_len)
+    {
+        throw ResourceException("ScopeCatalog: " + path_ + ": corrupt index");
+    }
+    BinaryDecoder entry(base_ + data_offset, base_ + data_offset + data_len);
+    if (entry.get<uint8_t>() != Variant::Dict)
+    {
+        throw ResourceException("ScopeCatalog: " + path_ + ": catalog entry is not a dictionary");
+    }
+    return entry.get_dict();
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
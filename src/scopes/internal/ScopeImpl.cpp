@@ -27,6 +27,7 @@
 #include <unity/scopes/internal/QueryCtrlImpl.h>
 #include <unity/scopes/internal/ResultImpl.h>
 #include <unity/scopes/internal/ResultReplyObject.h>
+#include <unity/scopes/internal/TraceContext.h>
 #include <unity/scopes/SearchMetadata.h>
 #include <unity/UnityExceptions.h>
 
@@ -95,7 +96,8 @@ QueryCtrlProxy ScopeImpl::search(std::string const& query_string,
                                  std::unique_ptr<Variant> user_data,
                                  SearchMetadata const& metadata,
                                  SearchQueryBaseImpl::History const& history,
-                                 SearchListenerBase::SPtr const& reply)
+                                 SearchListenerBase::SPtr const& reply,
+                                 ReplyObject::TimingsSink const& timings_sink)
 {
     CannedQuery query(scope_id_, query_string, department_id);
     query.set_filter_state(filter_state);
@@ -103,7 +105,7 @@ QueryCtrlProxy ScopeImpl::search(std::string const& query_string,
     {
         query.set_user_data(*user_data);
     }
-    return search(query, metadata, history, reply);
+    return search(query, metadata, history, reply, timings_sink);
 }
 
 QueryCtrlProxy ScopeImpl::search(std::string const& query_string,
@@ -122,7 +124,8 @@ QueryCtrlProxy ScopeImpl::search(std::string const& query_string,
 QueryCtrlProxy ScopeImpl::search(CannedQuery const& query,
                                  SearchMetadata const& metadata,
                                  SearchQueryBaseImpl::History const& history,
-                                 SearchListenerBase::SPtr const& reply)
+                                 SearchListenerBase::SPtr const& reply,
+                                 ReplyObject::TimingsSink const& timings_sink)
 {
     if (reply == nullptr)
     {
@@ -130,6 +133,11 @@ QueryCtrlProxy ScopeImpl::search(CannedQuery const& query,
     }
 
     ReplyObject::SPtr ro(make_shared<ResultReplyObject>(reply, runtime_, to_string(), metadata.cardinality(), fwd()->debug_mode()));
+    ro->set_origin_scope_id(scope_id_);
+    if (timings_sink)
+    {
+        ro->set_timings_sink(timings_sink);
+    }
     MWReplyProxy rp = fwd()->mw_base()->add_reply_object(ro);
 
     // "Fake" QueryCtrlProxy that doesn't have a real MWQueryCtrlProxy yet.
@@ -175,6 +183,7 @@ QueryCtrlProxy ScopeImpl::search(CannedQuery const& query,
             auto new_proxy = dynamic_pointer_cast<MWQueryCtrl>(real_ctrl->proxy());
             assert(new_proxy);
             ctrl->set_proxy(new_proxy);
+            ro->query_sent();
         }
         catch (std::exception const& e)
         {
@@ -189,8 +198,8 @@ QueryCtrlProxy ScopeImpl::search(CannedQuery const& query,
     };
 
     // Send the blocking twoway request asynchronously via the async invocation pool. The waiter thread
-    // waits on the future, so it gets cleaned up.
-    auto future = runtime_->async_pool()->submit(send_search);
+    // waits on the future, so it gets cleaned up. The request stays in the caller's trace (if any).
+    auto future = runtime_->async_pool()->submit(with_trace_context(send_search));
     runtime_->future_queue()->push(move(future));
     return ctrl;
 }
@@ -205,24 +214,30 @@ QueryCtrlProxy ScopeImpl::activate(Result const& result,
     }
 
     ReplyObject::SPtr ro(make_shared<ActivationReplyObject>(reply, runtime_, to_string(), fwd()->debug_mode()));
+    ro->set_origin_scope_id(scope_id_);
     MWReplyProxy rp = fwd()->mw_base()->add_reply_object(ro);
 
     shared_ptr<QueryCtrlImpl> ctrl = make_shared<QueryCtrlImpl>(nullptr, rp);
 
     auto impl = dynamic_pointer_cast<ScopeImpl>(shared_from_this());
 
-    auto send_activate = [impl, result, metadata, rp, ro, ctrl]() -> void
+    string const my_id = runtime_->scope_id();
+    auto send_activate = [my_id, impl, result, metadata, rp, ro, ctrl]() -> void
     {
         try
         {
+            VariantMap context;
+            context["client_id"] = my_id;
             auto real_ctrl = dynamic_pointer_cast<QueryCtrlImpl>(impl->fwd()->activate(result.p->activation_target(),
                                                                                        metadata.serialize(),
+                                                                                       context,
                                                                                        rp));
             assert(real_ctrl);
 
             auto new_proxy = dynamic_pointer_cast<MWQueryCtrl>(real_ctrl->proxy());
             assert(new_proxy);
             ctrl->set_proxy(new_proxy);
+            ro->query_sent();
         }
         catch (std::exception const& e)
         {
@@ -236,7 +251,7 @@ QueryCtrlProxy ScopeImpl::activate(Result const& result,
         }
     };
 
-    auto future = runtime_->async_pool()->submit(send_activate);
+    auto future = runtime_->async_pool()->submit(with_trace_context(send_activate));
     runtime_->future_queue()->push(move(future));
     return ctrl;
 }
@@ -253,6 +268,7 @@ QueryCtrlProxy ScopeImpl::perform_action(Result const& result,
     }
 
     ReplyObject::SPtr ro(make_shared<ActivationReplyObject>(reply, runtime_, to_string(), fwd()->debug_mode()));
+    ro->set_origin_scope_id(scope_id_);
     MWReplyProxy rp = fwd()->mw_base()->add_reply_object(ro);
 
     shared_ptr<QueryCtrlImpl> ctrl = make_shared<QueryCtrlImpl>(nullptr, rp);
@@ -274,6 +290,7 @@ QueryCtrlProxy ScopeImpl::perform_action(Result const& result,
             auto new_proxy = dynamic_pointer_cast<MWQueryCtrl>(real_ctrl->proxy());
             assert(new_proxy);
             ctrl->set_proxy(new_proxy);
+            ro->query_sent();
         }
         catch (std::exception const& e)
         {
@@ -287,7 +304,7 @@ QueryCtrlProxy ScopeImpl::perform_action(Result const& result,
         }
     };
 
-    auto future = runtime_->async_pool()->submit(send_perform_action);
+    auto future = runtime_->async_pool()->submit(with_trace_context(send_perform_action));
     runtime_->future_queue()->push(move(future));
     return ctrl;
 }
@@ -302,24 +319,30 @@ QueryCtrlProxy ScopeImpl::preview(Result const& result,
     }
 
     ReplyObject::SPtr ro(make_shared<PreviewReplyObject>(reply, runtime_, to_string(), fwd()->debug_mode()));
+    ro->set_origin_scope_id(scope_id_);
     MWReplyProxy rp = fwd()->mw_base()->add_reply_object(ro);
 
     shared_ptr<QueryCtrlImpl> ctrl = make_shared<QueryCtrlImpl>(nullptr, rp);
 
     auto impl = dynamic_pointer_cast<ScopeImpl>(shared_from_this());
 
-    auto send_preview = [impl, result, hints, rp, ro, ctrl]() -> void
+    string const my_id = runtime_->scope_id();
+    auto send_preview = [my_id, impl, result, hints, rp, ro, ctrl]() -> void
     {
         try
         {
+            VariantMap context;
+            context["client_id"] = my_id;
             auto real_ctrl = dynamic_pointer_cast<QueryCtrlImpl>(impl->fwd()->preview(result.p->activation_target(),
                                                                                       hints.serialize(),
+                                                                                      context,
                                                                                       rp));
             assert(real_ctrl);
 
             auto new_proxy = dynamic_pointer_cast<MWQueryCtrl>(real_ctrl->proxy());
             assert(new_proxy);
             ctrl->set_proxy(new_proxy);
+            ro->query_sent();
         }
         catch (std::exception const& e)
         {
@@ -333,7 +356,7 @@ QueryCtrlProxy ScopeImpl::preview(Result const& result,
         }
     };
 
-    auto future = runtime_->async_pool()->submit(send_preview);
+    auto future = runtime_->async_pool()->submit(with_trace_context(send_preview));
     runtime_->future_queue()->push(move(future));
     return ctrl;
 }
@@ -349,6 +372,7 @@ QueryCtrlProxy ScopeImpl::activate_result_action(Result const& result,
     }
 
     ReplyObject::SPtr ro(make_shared<ActivationReplyObject>(reply, runtime_, to_string(), fwd()->debug_mode()));
+    ro->set_origin_scope_id(scope_id_);
     MWReplyProxy rp = fwd()->mw_base()->add_reply_object(ro);
 
     shared_ptr<QueryCtrlImpl> ctrl = make_shared<QueryCtrlImpl>(nullptr, rp);
@@ -369,6 +393,7 @@ QueryCtrlProxy ScopeImpl::activate_result_action(Result const& result,
             auto new_proxy = dynamic_pointer_cast<MWQueryCtrl>(real_ctrl->proxy());
             assert(new_proxy);
             ctrl->set_proxy(new_proxy);
+            ro->query_sent();
         }
         catch (std::exception const& e)
         {
@@ -382,7 +407,7 @@ QueryCtrlProxy ScopeImpl::activate_result_action(Result const& result,
         }
     };
 
-    auto future = runtime_->async_pool()->submit(send_activate_action);
+    auto future = runtime_->async_pool()->submit(with_trace_context(send_activate_action));
     runtime_->future_queue()->push(move(future));
     return ctrl;
 }
@@ -29,6 +29,7 @@
 #include <unity/scopes/internal/ScopeBaseImpl.h>
 #include <unity/scopes/internal/SearchMetadataImpl.h>
 #include <unity/scopes/internal/SearchQueryBaseImpl.h>
+#include <unity/scopes/internal/lttng/UnityScopes_tp.h>
 #include <unity/scopes/ScopeBase.h>
 #include <unity/UnityExceptions.h>
 
@@ -48,9 +49,21 @@ namespace scopes
 namespace internal
 {
 
-ScopeObject::ScopeObject(ScopeBase* scope_base, bool debug_mode) :
+namespace
+{
+
+string client_id_of(VariantMap const& context)
+{
+    auto const it = context.find("client_id");
+    return it != context.end() ? it->second.get_string() : "";
+}
+
+} // namespace
+
+ScopeObject::ScopeObject(ScopeBase* scope_base, bool debug_mode, TrafficCapture::SPtr const& capture) :
     scope_base_(scope_base),
-    debug_mode_(debug_mode)
+    debug_mode_(debug_mode),
+    capture_(capture)
 {
     assert(scope_base);
 }
@@ -95,6 +108,8 @@ MWQueryCtrlProxy ScopeObject::query(MWReplyProxy const& reply,
         mw_base->runtime()->logger()() << msg;
         throw ResourceException(msg);
     }
+    simple_tracepoint(unity_scopes, query_created,
+                      reply->identity().c_str(), mw_base->runtime()->scope_id().c_str(), method.c_str());
 
     MWQueryCtrlProxy ctrl_proxy;
     try
@@ -154,10 +169,16 @@ MWQueryCtrlProxy ScopeObject::search(CannedQuery const& q,
                                      MWReplyProxy const& reply,
                                      InvokeInfo const& info)
 {
+    if (capture_)
+    {
+        capture_->record(TrafficCapture::Kind::Search,
+                         client_id_of(context),
+                         VariantMap{ { "query", Variant(q.serialize()) }, { "metadata", Variant(hints.serialize()) } });
+    }
     return query(reply,
                  info.mw,
                  "search",
-                 [&q, &hints, &context, this]() -> SearchQueryBase::UPtr {
+                 [&q, &hints, &context, &reply, this]() -> SearchQueryBase::UPtr {
                       auto search_query = this->scope_base_->search(q, hints);
                       search_query->set_department_id(q.department_id());
 
@@ -191,19 +212,61 @@ MWQueryCtrlProxy ScopeObject::search(CannedQuery const& q,
                          sqb->set_history(history);
                       }
 
+                      // Lets the query pass the timings of its subsearches to the client.
+                      sqb->set_mw_reply(reply);
+
                       return search_query;
                  },
-                 [&reply, &hints, this](QueryBase::SPtr query_base, MWQueryCtrlProxy ctrl_proxy) -> QueryObjectBase::SPtr {
-                     return make_shared<QueryObject>(query_base, hints.cardinality(), reply, ctrl_proxy);
+                 [&reply, &hints, &info, this](QueryBase::SPtr query_base, MWQueryCtrlProxy ctrl_proxy) -> QueryObjectBase::SPtr {
+                     auto qo = make_shared<QueryObject>(query_base, hints.cardinality(), reply, ctrl_proxy);
+                     if (hints.has_deadline())
+                     {
+                         // Cancel the query once its deadline expires. The middleware
+                         // outlives the monitor and the async pool, so it is safe to capture it.
+                         // The cancellation runs on the async pool, so a slow cancelled()
+                         // method cannot hold up the monitor and the other queries' deadlines.
+                         weak_ptr<QueryObject> weak_qo(qo);
+                         MiddlewareBase* mw = info.mw;
+                         auto cb = [weak_qo, mw]
+                         {
+                             auto expire = [weak_qo, mw]
+                             {
+                                 auto const qo = weak_qo.lock();
+                                 if (qo)
+                                 {
+                                     string const id;
+                                     qo->deadline_expired(InvokeInfo{ id, mw });
+                                 }
+                             };
+                             try
+                             {
+                                 auto future = mw->runtime()->async_pool()->submit(expire);
+                                 mw->runtime()->future_queue()->push(move(future));
+                             }
+                             catch (std::exception const&)
+                             {
+                                 // The run time is shutting down, and the query with it.
+                             }
+                         };
+                         qo->set_deadline_item(mw->runtime()->deadline_monitor()->add(hints.deadline(), cb));
+                     }
+                     return qo;
                  }
     );
 }
 
 MWQueryCtrlProxy ScopeObject::activate(Result const& result,
                                        ActionMetadata const& hints,
+                                       VariantMap const& context,
                                        MWReplyProxy const& reply,
                                        InvokeInfo const& info)
 {
+    if (capture_)
+    {
+        capture_->record(TrafficCapture::Kind::Activate,
+                         client_id_of(context),
+                         VariantMap{ { "result", Variant(result.serialize()) }, { "metadata", Variant(hints.serialize()) } });
+    }
     return query(reply,
                  info.mw,
                  "activate",
@@ -261,9 +324,16 @@ MWQueryCtrlProxy ScopeObject::activate_result_action(Result const& result,
 
 MWQueryCtrlProxy ScopeObject::preview(Result const& result,
                                       ActionMetadata const& hints,
+                                      VariantMap const& context,
                                       MWReplyProxy const& reply,
                                       InvokeInfo const& info)
 {
+    if (capture_)
+    {
+        capture_->record(TrafficCapture::Kind::Preview,
+                         client_id_of(context),
+                         VariantMap{ { "result", Variant(result.serialize()) }, { "metadata", Variant(hints.serialize()) } });
+    }
     return query(reply,
                  info.mw,
                  "preview",
@@ -22,6 +22,8 @@
 
 #include <unity/UnityExceptions.h>
 
+#include <algorithm>
+
 namespace unity
 {
 
@@ -31,6 +33,19 @@ namespace scopes
 namespace internal
 {
 
+namespace
+{
+
+// The deadline travels as a hint, so it survives being forwarded by a scope that
+// does not know about deadlines.
+const std::string deadline_hint = "deadline";
+
+// Largest number of milliseconds since the epoch that system_clock can represent.
+const int64_t max_deadline_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                    std::chrono::system_clock::duration::max()).count();
+
+} // namespace
+
 SearchMetadataImpl::SearchMetadataImpl(std::string const& locale, std::string const& form_factor)
     : QueryMetadataImpl(locale, form_factor),
       cardinality_(0)
@@ -130,6 +145,44 @@ bool SearchMetadataImpl::is_aggregated() const
     return bool(aggregated_keywords_);
 }
 
+void SearchMetadataImpl::set_deadline(std::chrono::system_clock::time_point deadline)
+{
+    auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline.time_since_epoch()).count();
+    set_hint(deadline_hint, Variant(int64_t(ms)));
+}
+
+std::chrono::system_clock::time_point SearchMetadataImpl::deadline() const
+{
+    if (!has_deadline())
+    {
+        throw NotFoundException("SearchMetadata::deadline()", deadline_hint);
+    }
+    Variant const& v = hint(deadline_hint);
+    int64_t ms = v.which() == Variant::Int ? v.get_int() : v.get_int64_t();
+    ms = std::max(std::min(ms, max_deadline_ms), int64_t(0));
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+}
+
+bool SearchMetadataImpl::has_deadline() const
+{
+    if (!contains_hint(deadline_hint))
+    {
+        return false;
+    }
+    auto const type = hint(deadline_hint).which();
+    return type == Variant::Int64 || type == Variant::Int;
+}
+
+std::chrono::milliseconds SearchMetadataImpl::remaining_time() const
+{
+    if (!has_deadline())
+    {
+        throw NotFoundException("SearchMetadata::remaining_time()", deadline_hint);
+    }
+    auto const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline() - std::chrono::system_clock::now());
+    return std::max(remaining, std::chrono::milliseconds(0));
+}
+
 std::string SearchMetadataImpl::metadata_type() const
 {
     static const std::string t("search_metadata");
@@ -20,6 +20,7 @@
 #include <unity/scopes/internal/SearchQueryBaseImpl.h>
 
 #include <unity/scopes/internal/DfltConfig.h>
+#include <unity/scopes/internal/MWReply.h>
 #include <unity/scopes/internal/QueryCtrlImpl.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
 #include <unity/scopes/internal/ScopeImpl.h>
@@ -32,6 +33,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 
 namespace unity
 {
@@ -48,6 +50,7 @@ SearchQueryBaseImpl::SearchQueryBaseImpl(CannedQuery const& query, SearchMetadat
     : QueryBaseImpl(),
       canned_query_(query),
       search_metadata_(metadata),
+      trace_context_(TraceContext::current()),
       valid_(true)
 {
 }
@@ -80,12 +83,40 @@ QueryCtrlProxy SearchQueryBaseImpl::subsearch(ScopeProxy const& scope,
         throw InvalidArgumentException("QueryBase::subsearch(): reply cannot be nullptr");
     }
 
+    // scope_impl can be nullptr if we use a mock scope: TypedScopeFixture<testing::Scope>
+    // If so, we call the normal search without passing the history through because
+    // we don't need loop detection for mock scopes.
+    auto scope_impl = dynamic_pointer_cast<ScopeImpl>(scope);
+
+    // The child gets its own copy of the metadata; the caller's metadata stays as it is.
+    SearchMetadata child_metadata(metadata);
+
+    // Pass our deadline on to the child, brought forward by the margin for this hop.
+    // If the aggregator set an earlier deadline for the child itself, that one wins.
+    if (search_metadata_.has_deadline())
+    {
+        auto const margin = scope_impl ? scope_impl->runtime()->deadline_margin()
+                                       : chrono::milliseconds(DFLT_DEADLINE_MARGIN);
+        auto deadline = search_metadata_.deadline() - margin;
+        if (child_metadata.has_deadline())
+        {
+            deadline = min(deadline, child_metadata.deadline());
+        }
+        child_metadata.set_deadline(deadline);
+    }
+
     VariantMap details;
     details["query_string"] = query_string;
     details["department_id"] = department_id;
     details["filter_state"] = filter_state.serialize();
     details["user_data"] = user_data ? *user_data : Variant();
-    details["metadata"] = metadata.serialize();
+    // The deadline shrinks with every hop, so it is left out of the details.
+    // Otherwise, a query that loops would never arrive with the same details twice.
+    VariantMap loop_metadata = child_metadata.serialize();
+    VariantMap loop_hints = loop_metadata["hints"].get_dict();
+    loop_hints.erase("deadline");
+    loop_metadata["hints"] = loop_hints;
+    details["metadata"] = loop_metadata;
     auto query_ctrl = check_for_query_loop(scope, reply, move(details));
     if (query_ctrl)
     {
@@ -93,26 +124,46 @@ QueryCtrlProxy SearchQueryBaseImpl::subsearch(ScopeProxy const& scope,
     }
 
     // Insert the keywords used to aggregated this child scope into its search metadata
-    const_cast<SearchMetadata&>(metadata).set_aggregated_keywords(keywords);
+    child_metadata.set_aggregated_keywords(keywords);
 
-    // scope_impl can be nullptr if we use a mock scope: TypedScopeFixture<testing::Scope>
-    // If so, we call the normal search without passing the history through because
-    // we don't need loop detection for mock scopes.
-    auto scope_impl = dynamic_pointer_cast<ScopeImpl>(scope);
+    // The subsearch belongs to the trace of this query, whichever thread the scope calls us from.
+    TraceScope trace_scope(trace_context_);
+
+    if (child_metadata.has_deadline() && child_metadata.remaining_time() == chrono::milliseconds(0))
+    {
+        // No point in sending the query, the child would cancel it straight away.
+        reply->finished(CompletionDetails(CompletionDetails::Cancelled, "query deadline expired"));
+        return make_shared<QueryCtrlImpl>(nullptr, nullptr);  // Dummy proxy in already-cancelled state
+    }
     if (scope_impl)
     {
         // TODO: HACK: Strip location info from metadata if the child isn't allowed to see it.
         //             We need to remove this once a scope is able to do this itself.
-        SearchMetadata clean_metadata = filter_metadata(scope_impl, metadata);
+        SearchMetadata clean_metadata = filter_metadata(scope_impl, child_metadata);
+
+        // The child's timings are passed to our client with our own timings.
+        weak_ptr<MWReply> mw_reply;
+        {
+            lock_guard<mutex> lock(mutex_);
+            mw_reply = mw_reply_;
+        }
+        auto timings_sink = [mw_reply](QueryTimings const& timings)
+        {
+            auto const r = mw_reply.lock();
+            if (r)
+            {
+                r->add_subquery_timings(timings);
+            }
+        };
 
         query_ctrl = scope_impl->search(query_string, department_id, filter_state, std::move(user_data), clean_metadata,
-                                        history_, reply);
+                                        history_, reply, timings_sink);
     }
     else
     {
         query_ctrl = user_data ?
-                         scope->search(query_string, department_id, filter_state, *user_data, metadata, reply) :
-                         scope->search(query_string, department_id, filter_state, metadata, reply);
+                         scope->search(query_string, department_id, filter_state, *user_data, child_metadata, reply) :
+                         scope->search(query_string, department_id, filter_state, child_metadata, reply);
     }
 
     lock_guard<mutex> lock(mutex_);
@@ -163,6 +214,12 @@ void SearchQueryBaseImpl::set_history(History const& h)
     history_ = h;
 }
 
+void SearchQueryBaseImpl::set_mw_reply(MWReplyProxy const& reply)
+{
+    lock_guard<mutex> lock(mutex_);
+    mw_reply_ = reply;
+}
+
 bool SearchQueryBaseImpl::valid() const
 {
     lock_guard<mutex> lock(mutex_);
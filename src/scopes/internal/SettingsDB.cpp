@@ -27,7 +27,11 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 
+#include <map>
+#include <set>
+
 #include <fcntl.h>
+#include <sys/inotify.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -80,6 +84,134 @@ static FileLock unix_lock(string const& path)
 
 static const char* GROUP_NAME = "General";
 
+// Tracks changes to settings DBs with a single inotify instance that is shared by all
+// SettingsDB instances in the process. We watch the directory rather than the DB itself
+// because the DB may not exist yet, and may be replaced by rename.
+//
+// There is no thread reading the events. Instead, the pending events are drained by whichever
+// SettingsDB asks for the change count of its DB. Because the kernel queues the events before
+// the writer's system call returns, a reader that checks after a write completes is
+// guaranteed to see that write.
+
+class DirWatches final
+{
+public:
+    NONCOPYABLE(DirWatches);
+
+    static DirWatches& instance()
+    {
+        // Intentionally leaked, so SettingsDB instances with static storage duration can
+        // still remove their watches.
+        static DirWatches* watches = new DirWatches;
+        return *watches;
+    }
+
+    // Returns the watch descriptor for dir, or -1 if dir cannot be watched.
+    int add(string const& dir)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        if (fd_ == -1)
+        {
+            return -1;
+        }
+        int wd = ::inotify_add_watch(fd_, dir.c_str(),
+                                     IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MODIFY
+                                     | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+        if (wd != -1)
+        {
+            ++ref_counts_[wd];
+        }
+        return wd;
+    }
+
+    void remove(int wd)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        auto it = ref_counts_.find(wd);
+        if (it == ref_counts_.end() || --it->second > 0)
+        {
+            return;
+        }
+        ref_counts_.erase(it);
+        if (dead_watches_.erase(wd) == 0)
+        {
+            ::inotify_rm_watch(fd_, wd);
+        }
+        auto first = change_counts_.lower_bound(make_pair(wd, string()));
+        auto last = first;
+        while (last != change_counts_.end() && last->first.first == wd)
+        {
+            ++last;
+        }
+        change_counts_.erase(first, last);
+    }
+
+    // Sets generation to a value that changes whenever the file with the given name in the
+    // watched directory changes. Returns false if the watch is no longer valid, in which case
+    // the caller must remove() it.
+    bool generation(int wd, string const& name, uint64_t& generation)
+    {
+        lock_guard<mutex> lock(mutex_);
+
+        drain();
+        if (dead_watches_.find(wd) != dead_watches_.end())
+        {
+            return false;
+        }
+        auto it = change_counts_.find(make_pair(wd, name));
+        generation = overflows_ + (it == change_counts_.end() ? 0 : it->second);
+        return true;
+    }
+
+private:
+    DirWatches()
+        : fd_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+        , overflows_(0)
+    {
+    }
+
+    // Called with mutex_ locked.
+    void drain()
+    {
+        alignas(struct inotify_event) char buf[4096];
+        ssize_t len;
+        while ((len = ::read(fd_, buf, sizeof(buf))) > 0)
+        {
+            for (char const* p = buf; p < buf + len; )
+            {
+                auto event = reinterpret_cast<struct inotify_event const*>(p);
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    // We lost events, so we don't know what changed.
+                    ++overflows_;
+                }
+                else if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT))
+                {
+                    if (ref_counts_.find(event->wd) != ref_counts_.end())
+                    {
+                        dead_watches_.insert(event->wd);
+                    }
+                }
+                else if (event->len > 0)
+                {
+                    auto it = change_counts_.insert(make_pair(make_pair(event->wd, string(event->name)), 0)).first;
+                    ++it->second;
+                }
+                p += sizeof(struct inotify_event) + event->len;
+            }
+        }
+    }
+
+    int fd_;
+    mutex mutex_;
+    map<int, int> ref_counts_;                   // Number of SettingsDB instances per watch
+    set<int> dead_watches_;                      // Watches removed by the kernel
+    map<pair<int, string>, uint64_t> change_counts_;
+    uint64_t overflows_;
+};
+
 }  // namespace
 
 SettingsDB::UPtr SettingsDB::create_from_ini_file(string const& db_path, string const& ini_file_path)
@@ -117,6 +249,9 @@ SettingsDB::UPtr SettingsDB::create_from_schema(string const& db_path, SettingsS
 
 SettingsDB::SettingsDB(string const& db_path, SettingsSchema const& schema)
     : db_path_(db_path)
+    , watch_(-1)
+    , generation_(0)
+    , snapshot_valid_(false)
     , last_write_time_nsec_(-1)
     , last_write_time_sec_(-1)
     , last_write_inode_(0)
@@ -128,6 +263,18 @@ SettingsDB::SettingsDB(string const& db_path, SettingsSchema const& schema)
     {
         def_map_.emplace(make_pair(d.get_dict()["id"].get_string(), d));
     }
+
+    boost::filesystem::path path(db_path_);
+    db_dir_ = path.has_parent_path() ? path.parent_path().native() : ".";
+    db_name_ = path.filename().native();
+}
+
+SettingsDB::~SettingsDB()
+{
+    if (watch_ != -1)
+    {
+        DirWatches::instance().remove(watch_);
+    }
 }
 
 // Called once for each setting. We are lenient when parsing
@@ -136,7 +283,7 @@ SettingsDB::SettingsDB(string const& db_path, SettingsSchema const& schema)
 // It is up to the writer of the DB to ensure that the DB contents
 // match the schema.
 
-void SettingsDB::process_doc_(string const& id, IniParser const& p)
+void SettingsDB::process_doc_(string const& id, IniParser const& p, VariantMap& values)
 {
     auto def = def_map_.find(id);
 
@@ -151,18 +298,18 @@ void SettingsDB::process_doc_(string const& id, IniParser const& p)
     {
         if (type == "boolean")
         {
-            values_[id] = Variant(p.get_boolean(GROUP_NAME, id));
+            values[id] = Variant(p.get_boolean(GROUP_NAME, id));
         }
         else if (type == "list")
         {
-            values_[id] = Variant(p.get_int(GROUP_NAME, id));
+            values[id] = Variant(p.get_int(GROUP_NAME, id));
         }
         else if (type == "number")
         {
             string value = p.get_string(GROUP_NAME, id);
             try
             {
-                values_[id] = Variant(stod(value));
+                values[id] = Variant(stod(value));
             }
             catch (invalid_argument const&)
             {
@@ -170,7 +317,7 @@ void SettingsDB::process_doc_(string const& id, IniParser const& p)
         }
         else if (type == "string")
         {
-            values_[id] = Variant(p.get_string(GROUP_NAME, id));
+            values[id] = Variant(p.get_string(GROUP_NAME, id));
         }
     }
     catch (LogicException const&)
@@ -178,8 +325,13 @@ void SettingsDB::process_doc_(string const& id, IniParser const& p)
     }
 }
 
+// Called with mutex_ locked. Re-reads the DB if it was modified since we last read it,
+// and replaces the snapshot in values_. If the DB cannot be read, the previous snapshot
+// (or the defaults) stays in place and snapshot_valid_ is cleared, so we try again next time.
+
 void SettingsDB::process_all_docs()
 {
+    snapshot_valid_ = false;
     try
     {
         struct stat st;
@@ -195,7 +347,7 @@ void SettingsDB::process_all_docs()
                 {
                     // We re-establish the defaults and re-read everything. We need to put the defaults back because
                     // settings may have been deleted from the database.
-                    set_defaults();
+                    VariantMap values = defaults();
 
                     try
                     {
@@ -205,7 +357,7 @@ void SettingsDB::process_all_docs()
                         {
                             auto keys = p.get_keys(GROUP_NAME);
                             for (auto const& key : keys) {
-                                process_doc_(key, p);
+                                process_doc_(key, p, values);
                             }
                         }
                     }
@@ -218,17 +370,21 @@ void SettingsDB::process_all_docs()
                         throw ResourceException(e.what());
                     }
 
+                    values_ = make_shared<VariantMap const>(move(values));
                     last_write_time_nsec_ = st.st_mtim.tv_nsec;
                     last_write_time_sec_ = st.st_mtim.tv_sec;
                     last_write_inode_ = st.st_ino;
-
-                    return;
                 }
+                snapshot_valid_ = true;
             }
         }
         else
         {
-            set_defaults();
+            values_ = make_shared<VariantMap const>(defaults());
+            last_write_time_nsec_ = -1;
+            last_write_time_sec_ = -1;
+            last_write_inode_ = 0;
+            snapshot_valid_ = true;
         }
     }
     catch (FileException const& e)
@@ -244,15 +400,15 @@ void SettingsDB::process_all_docs()
 
     // Only set default values if we don't have some values already; we might have failed because
     // of a temporary issue and therefore we want to present most recent cached settings.
-    if (values_.size() == 0)
+    if (!values_)
     {
-        set_defaults();
+        values_ = make_shared<VariantMap const>(defaults());
     }
 }
 
-void SettingsDB::set_defaults()
+VariantMap SettingsDB::defaults() const
 {
-    values_.clear();
+    VariantMap values;
     for (auto const& f : definitions_)
     {
         auto def = f.get_dict();
@@ -260,15 +416,52 @@ void SettingsDB::set_defaults()
         Variant const default_value = def["defaultValue"];
         if (!default_value.is_null())
         {
-            values_[id] = default_value;
+            values[id] = default_value;
+        }
+    }
+    return values;
+}
+
+// Called with mutex_ locked. Returns true if values_ still reflects the contents of the DB.
+// If we can't watch the DB directory (because it doesn't exist yet, or we are out of watches),
+// we fall back to checking the DB on every call.
+
+bool SettingsDB::snapshot_is_current()
+{
+    auto& watches = DirWatches::instance();
+
+    if (watch_ != -1)
+    {
+        uint64_t generation;
+        if (watches.generation(watch_, db_name_, generation))
+        {
+            bool current = snapshot_valid_ && generation == generation_;
+            generation_ = generation;
+            return current;
         }
+        watches.remove(watch_);
+        watch_ = -1;
     }
+
+    // The watch must be in place before we read the DB, so we can't miss an update.
+    watch_ = watches.add(db_dir_);
+    if (watch_ != -1 && !watches.generation(watch_, db_name_, generation_))
+    {
+        watches.remove(watch_);
+        watch_ = -1;
+    }
+    return false;
 }
 
 VariantMap SettingsDB::settings()
 {
-    process_all_docs();
-    return values_;
+    lock_guard<mutex> lock(mutex_);
+
+    if (!snapshot_is_current())
+    {
+        process_all_docs();
+    }
+    return *values_;
 }
 
 }  // namespace internal
@@ -18,6 +18,7 @@
 
 #include <unity/scopes/internal/ThreadPool.h>
 
+#include <unity/scopes/internal/Metrics.h>
 #include <unity/UnityExceptions.h>
 
 #include <cassert>
@@ -33,6 +34,34 @@ namespace scopes
 namespace internal
 {
 
+namespace
+{
+
+// The metrics are for all pools in the process. busy_threads / threads is the pool saturation.
+
+struct PoolMetrics
+{
+    Counter& tasks;
+    Gauge& queued_tasks;
+    Gauge& busy_threads;
+    Gauge& threads;
+};
+
+PoolMetrics& metrics()
+{
+    static MetricsRegistry& r = MetricsRegistry::instance();
+    static PoolMetrics m =
+    {
+        r.counter("unity_scopes_threadpool_tasks_total", "Tasks submitted to thread pools"),
+        r.gauge("unity_scopes_threadpool_queued_tasks", "Tasks waiting for a pool thread"),
+        r.gauge("unity_scopes_threadpool_busy_threads", "Pool threads that are running a task"),
+        r.gauge("unity_scopes_threadpool_threads", "Pool threads")
+    };
+    return m;
+}
+
+} // namespace
+
 ThreadPool::ThreadPool(int num_threads)
     : queue_(new TaskQueue)
     , state_(Created)
@@ -58,6 +87,7 @@ ThreadPool::ThreadPool(int num_threads)
         }
         throw ResourceException("ThreadPool(): exception during pool creation");
     }
+    metrics().threads.inc(num_threads);
 }
 
 ThreadPool::~ThreadPool()
@@ -100,6 +130,8 @@ void ThreadPool::destroy() noexcept
     {
         threads[i].join();
     }
+    metrics().threads.dec(threads.size());
+    metrics().queued_tasks.dec(queue_->size());  // Tasks that will never run
 
     lock_guard<mutex> lock(mutex_);
     state_ = Destroyed;
@@ -152,10 +184,24 @@ void ThreadPool::run()
         {
             return; // wait_and_pop() throws if the queue is destroyed while threads are blocked on it.
         }
+        metrics().queued_tasks.dec();
+        metrics().busy_threads.inc();
         task();
+        metrics().busy_threads.dec();
     }
 }
 
+void ThreadPool::task_queued() noexcept
+{
+    metrics().tasks.inc();
+    metrics().queued_tasks.inc();
+}
+
+void ThreadPool::task_not_queued() noexcept
+{
+    metrics().queued_tasks.dec();
+}
+
 } // namespace internal
 
 } // namespace scopes
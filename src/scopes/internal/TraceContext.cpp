@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/TraceContext.h>
+
+#include <random>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+thread_local TraceContext current_context = { 0, 0, 0 };
+
+uint64_t new_id()
+{
+    thread_local mt19937_64 engine{ random_device()() };
+    uint64_t id;
+    do
+    {
+        id = engine();
+    }
+    while (id == 0);  // Zero means "not traced"
+    return id;
+}
+
+} // namespace
+
+TraceContext TraceContext::child() const
+{
+    if (!traced())
+    {
+        return TraceContext{ 0, 0, 0 };
+    }
+    return TraceContext{ trace_id, new_id(), span_id };
+}
+
+TraceContext TraceContext::root()
+{
+    return TraceContext{ new_id(), new_id(), 0 };
+}
+
+TraceContext TraceContext::current() noexcept
+{
+    return current_context;
+}
+
+TraceScope::TraceScope(TraceContext const& ctx) noexcept
+    : saved_(current_context)
+{
+    current_context = ctx;
+}
+
+TraceScope::~TraceScope()
+{
+    current_context = saved_;
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
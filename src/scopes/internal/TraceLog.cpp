@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/TraceLog.h>
+
+#include <unity/scopes/internal/Logger.h>
+#include <unity/scopes/internal/safe_strerror.h>
+#include <unity/scopes/internal/VariantJson.h>
+#include <unity/UnityExceptions.h>
+
+#include <cerrno>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+string hex(uint64_t id)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(id));
+    return buf;
+}
+
+bool write_all(int fd, string const& buf)
+{
+    char const* p = buf.data();
+    size_t len = buf.size();
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+} // namespace
+
+TraceLog::TraceLog(string const& dir, string const& process, Logger& logger)
+    : path_(dir + "/" + process + "-" + to_string(getpid()) + ".trace")
+    , process_(process)
+    , logger_(logger)
+{
+    fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ == -1)
+    {
+        throw FileException("TraceLog(): cannot open " + path_, errno);
+    }
+}
+
+TraceLog::~TraceLog()
+{
+    if (fd_ != -1)
+    {
+        ::close(fd_);
+    }
+}
+
+string TraceLog::path() const
+{
+    return path_;
+}
+
+void TraceLog::record(TraceContext const& ctx,
+                      string const& name,
+                      string const& target,
+                      chrono::system_clock::time_point start,
+                      chrono::steady_clock::duration duration) noexcept
+{
+    try
+    {
+        auto const ts = chrono::duration_cast<chrono::microseconds>(start.time_since_epoch()).count();
+        auto const dur = chrono::duration_cast<chrono::microseconds>(duration).count();
+
+        // A VariantMap would sort the keys; we keep trace and span first so records are easy to scan.
+        string buf;
+        buf.reserve(256);
+        buf += "{\"trace\":\"" + hex(ctx.trace_id) + "\"";
+        buf += ",\"span\":\"" + hex(ctx.span_id) + "\"";
+        buf += ",\"parent\":\"" + hex(ctx.parent_id) + "\"";
+        buf += ",\"name\":";
+        string_to_json(name, buf);
+        buf += ",\"target\":";
+        string_to_json(target, buf);
+        buf += ",\"process\":";
+        string_to_json(process_, buf);
+        buf += ",\"pid\":" + to_string(getpid());
+        buf += ",\"tid\":" + to_string(syscall(SYS_gettid));
+        buf += ",\"ts\":" + to_string(ts);
+        buf += ",\"dur\":" + to_string(dur);
+        buf += "}\n";
+
+        lock_guard<mutex> lock(mutex_);
+        if (fd_ == -1)
+        {
+            return;  // Trace stopped after an earlier error
+        }
+        if (!write_all(fd_, buf))
+        {
+            int const err = errno;
+            ::close(fd_);
+            fd_ = -1;
+            logger_(LoggerSeverity::Error) << "TraceLog: cannot write " << path_ << ": "
+                                           << safe_strerror(err) << ", tracing stopped";
+        }
+    }
+    catch (std::exception const& e)
+    {
+        logger_(LoggerSeverity::Error) << "TraceLog: cannot record span: " << e.what();
+    }
+    catch (...)
+    {
+        logger_(LoggerSeverity::Error) << "TraceLog: cannot record span: unknown exception";
+    }
+}
+
+TraceSpan::TraceSpan(TraceLog* log, TraceContext const& ctx, string const& name, string const& target)
+    : log_(log)
+    , ctx_(!ctx.traced() && log ? TraceContext::root() : ctx)
+    , scope_(ctx_)
+{
+    if (log_)
+    {
+        name_ = name;
+        target_ = target;
+        start_ = chrono::system_clock::now();
+        steady_start_ = chrono::steady_clock::now();
+    }
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (log_)
+    {
+        log_->record(ctx_, name_, target_, start_, chrono::steady_clock::now() - steady_start_);
+    }
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/TrafficCapture.h>
+
+#include <unity/scopes/internal/Logger.h>
+#include <unity/scopes/internal/safe_strerror.h>
+#include <unity/scopes/internal/VariantBinary.h>
+#include <unity/UnityExceptions.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+char const magic[4] = { 'U', 'S', 'T', 'C' };
+uint32_t const format_version = 1;
+size_t const header_size = sizeof(magic) + sizeof(uint32_t);
+
+string header()
+{
+    string buf(magic, sizeof(magic));
+    binary_put(buf, format_version);
+    return buf;
+}
+
+bool write_all(int fd, string const& buf)
+{
+    char const* p = buf.data();
+    size_t len = buf.size();
+    while (len > 0)
+    {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+} // namespace
+
+TrafficCapture::TrafficCapture(string const& path, Logger& logger)
+    : path_(path)
+    , logger_(logger)
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ == -1)
+    {
+        throw FileException("TrafficCapture(): cannot open " + path, errno);
+    }
+
+    try
+    {
+        struct stat st;
+        if (::fstat(fd_, &st) == -1)
+        {
+            throw FileException("TrafficCapture(): cannot stat " + path, errno);
+        }
+        if (st.st_size == 0)
+        {
+            if (!write_all(fd_, header()))
+            {
+                throw FileException("TrafficCapture(): cannot write " + path, errno);
+            }
+        }
+        else
+        {
+            char buf[header_size];
+            if (::pread(fd_, buf, sizeof(buf), 0) != static_cast<ssize_t>(sizeof(buf))
+                || string(buf, sizeof(buf)) != header())
+            {
+                throw ResourceException("TrafficCapture(): " + path + " is not a capture file");
+            }
+        }
+    }
+    catch (...)
+    {
+        ::close(fd_);
+        throw;
+    }
+}
+
+TrafficCapture::~TrafficCapture()
+{
+    if (fd_ != -1)
+    {
+        ::close(fd_);
+    }
+}
+
+void TrafficCapture::record(Kind kind, string const& client_id, VariantMap const& request) noexcept
+{
+    try
+    {
+        auto const usecs = chrono::duration_cast<chrono::microseconds>(
+                               chrono::system_clock::now().time_since_epoch()).count();
+
+        string buf;
+        binary_put(buf, uint32_t(0));  // Placeholder for the length
+        binary_put(buf, static_cast<uint8_t>(kind));
+        binary_put(buf, static_cast<int64_t>(usecs));
+        binary_put_string(buf, client_id);
+        variant_to_binary(Variant(request), buf);
+        uint32_t const len = buf.size() - sizeof(uint32_t);
+        memcpy(&buf[0], &len, sizeof(len));
+
+        lock_guard<mutex> lock(mutex_);
+        if (fd_ == -1)
+        {
+            return;  // Capture stopped after an earlier error
+        }
+        if (!write_all(fd_, buf))
+        {
+            int const err = errno;
+            ::close(fd_);
+            fd_ = -1;
+            logger_(LoggerSeverity::Error) << "TrafficCapture: cannot write " << path_ << ": "
+                                           << safe_strerror(err) << ", capture stopped";
+        }
+    }
+    catch (std::exception const& e)
+    {
+        logger_(LoggerSeverity::Error) << "TrafficCapture: cannot record request: " << e.what();
+    }
+    catch (...)
+    {
+        logger_(LoggerSeverity::Error) << "TrafficCapture: cannot record request: unknown exception";
+    }
+}
+
+vector<TrafficCapture::Record> TrafficCapture::read(string const& path)
+{
+    ifstream in(path, ios::binary);
+    if (!in)
+    {
+        throw FileException("TrafficCapture::read(): cannot open " + path, errno);
+    }
+    stringstream ss;
+    ss << in.rdbuf();
+    string const contents = ss.str();
+
+    if (contents.compare(0, header_size, header()) != 0)
+    {
+        throw ResourceException("TrafficCapture::read(): " + path + " is not a capture file");
+    }
+
+    vector<Record> records;
+    size_t pos = header_size;
+    while (contents.size() - pos >= sizeof(uint32_t))
+    {
+        uint32_t len;
+        memcpy(&len, contents.data() + pos, sizeof(len));
+        pos += sizeof(len);
+        if (contents.size() - pos < len)
+        {
+            break;  // Partial last record
+        }
+        BinaryDecoder r(contents.data() + pos, contents.data() + pos + len);
+        pos += len;
+
+        try
+        {
+            Record rec;
+            uint8_t const kind = r.get<uint8_t>();
+            if (kind > static_cast<uint8_t>(Kind::Activate))
+            {
+                throw ResourceException("invalid request kind " + std::to_string(kind));
+            }
+            rec.kind = static_cast<Kind>(kind);
+            rec.time = chrono::system_clock::time_point(chrono::microseconds(r.get<int64_t>()));
+            rec.client_id = r.get_string();
+            if (r.get<uint8_t>() != Variant::Dict)
+            {
+                throw ResourceException("request is not a dictionary");
+            }
+            rec.request = r.get_dict();
+            records.push_back(move(rec));
+        }
+        catch (unity::Exception const&)
+        {
+            ResourceException ex("TrafficCapture::read(): " + path + ": corrupt record "
+                                 + std::to_string(records.size()));
+            ex.remember(current_exception());
+            throw ex;
+        }
+    }
+    return records;
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
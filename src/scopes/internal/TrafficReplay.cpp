@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/TrafficReplay.h>
+
+#include <unity/scopes/internal/ActionMetadataImpl.h>
+#include <unity/scopes/internal/CannedQueryImpl.h>
+#include <unity/scopes/internal/ResultImpl.h>
+#include <unity/scopes/internal/SearchMetadataImpl.h>
+#include <unity/scopes/ActivationListenerBase.h>
+#include <unity/scopes/PreviewListenerBase.h>
+#include <unity/scopes/Scope.h>
+#include <unity/scopes/SearchListenerBase.h>
+#include <unity/UnityExceptions.h>
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+typedef chrono::steady_clock Clock;
+
+// Shared by replay_traffic() and the listeners. A listener can outlive the
+// call if its request times out, so it keeps the state alive.
+
+struct ReplayState
+{
+    mutex mtx;
+    condition_variable cond;
+    size_t outstanding = 0;
+    map<TrafficCapture::Kind, size_t> outstanding_by_kind;
+    bool closed = false;  // Set once replay_traffic() has stopped waiting
+    ReplayReport report;
+
+    void failed(TrafficCapture::Kind kind)
+    {
+        lock_guard<mutex> lock(mtx);
+        ++report[kind].failed;
+    }
+
+    void sent(TrafficCapture::Kind kind)
+    {
+        lock_guard<mutex> lock(mtx);
+        ++outstanding;
+        ++outstanding_by_kind[kind];
+    }
+
+    void finished(TrafficCapture::Kind kind, Clock::time_point start, CompletionDetails const& details)
+    {
+        auto const latency = chrono::duration_cast<chrono::microseconds>(Clock::now() - start);
+        lock_guard<mutex> lock(mtx);
+        if (closed)
+        {
+            return;  // Already counted as timed out
+        }
+        auto& l = report[kind];
+        if (details.status() == CompletionDetails::OK)
+        {
+            l.sample.push_back(latency);
+        }
+        else
+        {
+            ++l.failed;
+        }
+        --outstanding_by_kind[kind];
+        if (--outstanding == 0)
+        {
+            cond.notify_all();
+        }
+    }
+};
+
+template<typename Base>
+class ReplayListener : public Base
+{
+public:
+    ReplayListener(shared_ptr<ReplayState> const& state, TrafficCapture::Kind kind)
+        : state_(state)
+        , kind_(kind)
+        , start_(Clock::now())
+    {
+    }
+
+    virtual void finished(CompletionDetails const& details) override
+    {
+        state_->finished(kind_, start_, details);
+    }
+
+private:
+    shared_ptr<ReplayState> const state_;
+    TrafficCapture::Kind const kind_;
+    Clock::time_point const start_;
+};
+
+class SearchReplayListener : public ReplayListener<SearchListenerBase>
+{
+public:
+    using ReplayListener<SearchListenerBase>::ReplayListener;
+
+    virtual void push(CategorisedResult) override
+    {
+    }
+};
+
+class PreviewReplayListener : public ReplayListener<PreviewListenerBase>
+{
+public:
+    using ReplayListener<PreviewListenerBase>::ReplayListener;
+
+    virtual void push(ColumnLayoutList const&) override
+    {
+    }
+
+    virtual void push(PreviewWidgetList const&) override
+    {
+    }
+
+    virtual void push(string const&, Variant const&) override
+    {
+    }
+};
+
+typedef ReplayListener<ActivationListenerBase> ActivationReplayListener;
+
+VariantMap dict_member(VariantMap const& m, string const& key)
+{
+    auto const it = m.find(key);
+    if (it == m.end() || it->second.which() != Variant::Dict)
+    {
+        throw unity::InvalidArgumentException("replay_traffic(): captured request without \"" + key + "\"");
+    }
+    return it->second.get_dict();
+}
+
+// Decodes a captured request. The returned function sends it.
+
+function<void()> prepare(ScopeProxy const& scope,
+                         TrafficCapture::Record const& rec,
+                         shared_ptr<ReplayState> const& state)
+{
+    switch (rec.kind)
+    {
+        case TrafficCapture::Kind::Search:
+        {
+            auto const query = CannedQueryImpl::create(dict_member(rec.request, "query"));
+            auto const metadata = SearchMetadataImpl::create(dict_member(rec.request, "metadata"));
+            auto const kind = rec.kind;
+            auto const time = rec.time;
+            return [scope, query, metadata, state, kind, time]
+            {
+                SearchMetadata md(metadata);
+                if (md.has_deadline())
+                {
+                    md.set_deadline(chrono::system_clock::now() + (md.deadline() - time));
+                }
+                scope->search(query.query_string(),
+                              query.department_id(),
+                              query.filter_state(),
+                              md,
+                              make_shared<SearchReplayListener>(state, kind));
+            };
+        }
+        case TrafficCapture::Kind::Preview:
+        {
+            auto const result = ResultImpl::create_result(dict_member(rec.request, "result"));
+            auto const metadata = ActionMetadataImpl::create(dict_member(rec.request, "metadata"));
+            auto const kind = rec.kind;
+            return [scope, result, metadata, state, kind]
+            {
+                scope->preview(result, metadata, make_shared<PreviewReplayListener>(state, kind));
+            };
+        }
+        case TrafficCapture::Kind::Activate:
+        {
+            auto const result = ResultImpl::create_result(dict_member(rec.request, "result"));
+            auto const metadata = ActionMetadataImpl::create(dict_member(rec.request, "metadata"));
+            auto const kind = rec.kind;
+            return [scope, result, metadata, state, kind]
+            {
+                scope->activate(result, metadata, make_shared<ActivationReplayListener>(state, kind));
+            };
+        }
+    }
+    throw unity::InvalidArgumentException("replay_traffic(): invalid request kind");  // LCOV_EXCL_LINE
+}
+
+} // namespace
+
+ReplayReport replay_traffic(ScopeProxy const& scope,
+                            vector<TrafficCapture::Record> const& records,
+                            double speed,
+                            chrono::milliseconds timeout)
+{
+    if (!scope)
+    {
+        throw unity::InvalidArgumentException("replay_traffic(): scope proxy cannot be null");
+    }
+    if (speed < 0)
+    {
+        throw unity::InvalidArgumentException("replay_traffic(): speed must be >= 0");
+    }
+
+    auto state = make_shared<ReplayState>();
+    auto const start = Clock::now();
+    for (auto const& rec : records)
+    {
+        if (speed > 0)
+        {
+            chrono::duration<double> const offset = rec.time - records.front().time;
+            this_thread::sleep_until(start + chrono::duration_cast<Clock::duration>(offset / speed));
+        }
+        function<void()> request;
+        try
+        {
+            request = prepare(scope, rec, state);
+        }
+        catch (std::exception const&)
+        {
+            state->failed(rec.kind);  // Malformed record
+            continue;
+        }
+
+        state->sent(rec.kind);
+        try
+        {
+            request();
+        }
+        catch (std::exception const& e)
+        {
+            state->finished(rec.kind, Clock::now(), CompletionDetails(CompletionDetails::Error, e.what()));
+        }
+    }
+
+    unique_lock<mutex> lock(state->mtx);
+    state->cond.wait_for(lock, timeout, [&state]{ return state->outstanding == 0; });
+    state->closed = true;
+    for (auto const& o : state->outstanding_by_kind)
+    {
+        state->report[o.first].failed += o.second;
+    }
+    return state->report;
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
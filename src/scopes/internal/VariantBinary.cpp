@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/VariantBinary.h>
+
+#include <unity/UnityExceptions.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+void binary_put_string(string& buf, string const& s)
+{
+    binary_put(buf, static_cast<uint32_t>(s.size()));
+    buf.append(s);
+}
+
+void variant_to_binary(Variant const& v, string& buf)
+{
+    binary_put(buf, static_cast<uint8_t>(v.which()));
+    switch (v.which())
+    {
+        case Variant::Null:
+        {
+            break;
+        }
+        case Variant::Int:
+        {
+            binary_put(buf, static_cast<int32_t>(v.get_int()));
+            break;
+        }
+        case Variant::Int64:
+        {
+            binary_put(buf, static_cast<int64_t>(v.get_int64_t()));
+            break;
+        }
+        case Variant::Bool:
+        {
+            binary_put(buf, static_cast<uint8_t>(v.get_bool()));
+            break;
+        }
+        case Variant::Double:
+        {
+            binary_put(buf, v.get_double());
+            break;
+        }
+        case Variant::String:
+        {
+            binary_put_string(buf, v.get_string());
+            break;
+        }
+        case Variant::Dict:
+        {
+            auto const dict = v.get_dict();
+            binary_put(buf, static_cast<uint32_t>(dict.size()));
+            for (auto const& pair : dict)
+            {
+                binary_put_string(buf, pair.first);
+                variant_to_binary(pair.second, buf);
+            }
+            break;
+        }
+        case Variant::Array:
+        {
+            auto const arr = v.get_array();
+            binary_put(buf, static_cast<uint32_t>(arr.size()));
+            for (auto const& elmt : arr)
+            {
+                variant_to_binary(elmt, buf);
+            }
+            break;
+        }
+        default:
+        {
+            assert(false);  // LCOV_EXCL_LINE
+        }
+    }
+}
+
+BinaryDecoder::BinaryDecoder(char const* begin, char const* end)
+    : p_(begin)
+    , end_(end)
+{
+}
+
+string BinaryDecoder::get_string()
+{
+    uint32_t len = get<uint32_t>();
+    check(len);
+    string s(p_, len);
+    p_ += len;
+    return s;
+}
+
+Variant BinaryDecoder::get_variant()
+{
+    switch (get<uint8_t>())
+    {
+        case Variant::Null:
+        {
+            return Variant();
+        }
+        case Variant::Int:
+        {
+            return Variant(static_cast<int>(get<int32_t>()));
+        }
+        case Variant::Int64:
+        {
+            return Variant(get<int64_t>());
+        }
+        case Variant::Bool:
+        {
+            return Variant(get<uint8_t>() != 0);
+        }
+        case Variant::Double:
+        {
+            return Variant(get<double>());
+        }
+        case Variant::String:
+        {
+            return Variant(get_string());
+        }
+        case Variant::Dict:
+        {
+            return Variant(get_dict());
+        }
+        case Variant::Array:
+        {
+            uint32_t count = get<uint32_t>();
+            VariantArray arr;
+            arr.reserve(std::min<size_t>(count, end_ - p_));
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                arr.push_back(get_variant());
+            }
+            return Variant(arr);
+        }
+        default:
+        {
+            throw ResourceException("BinaryDecoder: invalid variant type");
+        }
+    }
+}
+
+VariantMap BinaryDecoder::get_dict()
+{
+    uint32_t count = get<uint32_t>();
+    VariantMap dict;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        string key = get_string();
+        dict.emplace(move(key), get_variant());
+    }
+    return dict;
+}
+
+size_t BinaryDecoder::remaining() const noexcept
+{
+    return end_ - p_;
+}
+
+void BinaryDecoder::check(size_t len) const
+{
+    if (static_cast<size_t>(end_ - p_) < len)
+    {
+        throw ResourceException("BinaryDecoder: truncated data");
+    }
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -0,0 +1,755 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/VariantJson.h>
+
+#include <unity/scopes/internal/VariantImpl.h>
+#include <unity/UnityExceptions.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <locale.h>
+
+using namespace std;
+
+namespace unity
+{
+
+namespace scopes
+{
+
+namespace internal
+{
+
+namespace
+{
+
+// Strings are scanned eight bytes at a time, using the usual bit tricks to find
+// out whether a word contains a byte of interest. This works on all architectures
+// we build for, without needing separate code paths for each instruction set.
+
+uint64_t const ones = 0x0101010101010101ULL;
+uint64_t const highs = 0x8080808080808080ULL;
+
+inline uint64_t has_zero_byte(uint64_t w)
+{
+    return (w - ones) & ~w & highs;
+}
+
+inline uint64_t has_byte(uint64_t w, unsigned char c)
+{
+    return has_zero_byte(w ^ (ones * c));
+}
+
+inline uint64_t has_byte_less_than(uint64_t w, unsigned char c)  // c must be <= 128
+{
+    return (w - ones * c) & ~w & highs;
+}
+
+// Returns the number of bytes at the start of [p, end) that need no special treatment,
+// that is, that are neither quote nor backslash and, if with_control is set, no control characters.
+
+size_t plain_prefix(char const* p, char const* end, bool with_control)
+{
+    char const* const start = p;
+    while (end - p >= 8)
+    {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        uint64_t special = has_byte(w, '"') | has_byte(w, '\\');
+        if (with_control)
+        {
+            special |= has_byte_less_than(w, 0x20);
+        }
+        if (special)
+        {
+            break;
+        }
+        p += 8;
+    }
+    while (p < end)
+    {
+        unsigned char c = *p;
+        if (c == '"' || c == '\\' || (with_control && c < 0x20))
+        {
+            break;
+        }
+        ++p;
+    }
+    return p - start;
+}
+
+// strtod() and snprintf() use the decimal point of the current locale, but JSON always uses '.'.
+// We switch the calling thread to the C locale for the duration of the conversion.
+
+class CLocale final
+{
+public:
+    CLocale()
+        : prev_(uselocale(c_locale()))
+    {
+    }
+
+    ~CLocale()
+    {
+        uselocale(prev_);
+    }
+
+private:
+    static locale_t c_locale()
+    {
+        static locale_t const loc = newlocale(LC_ALL_MASK, "C", static_cast<locale_t>(0));
+        return loc;
+    }
+
+    locale_t prev_;
+};
+
+//-- Writer
+
+void append_string(string const& str, string& out)
+{
+    out += '"';
+    char const* p = str.data();
+    char const* const end = p + str.size();
+    while (p < end)
+    {
+        size_t n = plain_prefix(p, end, true);
+        out.append(p, n);
+        p += n;
+        if (p == end)
+        {
+            break;
+        }
+        unsigned char c = *p++;
+        switch (c)
+        {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\b':
+                out += "\\b";
+                break;
+            case '\f':
+                out += "\\f";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+            {
+                char buf[8];
+                snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+                break;
+            }
+        }
+    }
+    out += '"';
+}
+
+void append_int(int64_t val, string& out)
+{
+    char buf[24];
+    char* p = buf + sizeof(buf);
+    uint64_t u = val < 0 ? 0 - static_cast<uint64_t>(val) : static_cast<uint64_t>(val);
+    do
+    {
+        *--p = static_cast<char>('0' + u % 10);
+        u /= 10;
+    }
+    while (u != 0);
+    if (val < 0)
+    {
+        *--p = '-';
+    }
+    out.append(p, buf + sizeof(buf) - p);
+}
+
+void append_double(double val, string& out)
+{
+    if (!std::isfinite(val))
+    {
+        out += "null";  // JSON cannot represent infinity or NaN.
+        return;
+    }
+
+    // Use the shortest of the two precisions that round-trips.
+    char buf[32];
+    {
+        CLocale c_locale;
+        snprintf(buf, sizeof(buf), "%.15g", val);
+        if (strtod(buf, nullptr) != val)
+        {
+            snprintf(buf, sizeof(buf), "%.17g", val);
+        }
+    }
+    out += buf;
+    if (!strpbrk(buf, ".eE"))
+    {
+        out += ".0";  // Make sure the value is parsed as a double again.
+    }
+}
+
+class Writer : public boost::static_visitor<>
+{
+public:
+    explicit Writer(string& out)
+        : out_(out)
+    {
+    }
+
+    void operator()(NullVariant const&) const
+    {
+        out_ += "null";
+    }
+
+    void operator()(int val) const
+    {
+        append_int(val, out_);
+    }
+
+    void operator()(int64_t val) const
+    {
+        append_int(val, out_);
+    }
+
+    void operator()(bool val) const
+    {
+        out_ += val ? "true" : "false";
+    }
+
+    void operator()(string const& val) const
+    {
+        append_string(val, out_);
+    }
+
+    void operator()(double val) const
+    {
+        append_double(val, out_);
+    }
+
+    void operator()(VariantMap const& vm) const
+    {
+        out_ += '{';
+        bool first = true;
+        for (auto const& pair : vm)
+        {
+            if (!first)
+            {
+                out_ += ',';
+            }
+            first = false;
+            append_string(pair.first, out_);
+            out_ += ':';
+            boost::apply_visitor(*this, VariantImpl::get(pair.second).v);
+        }
+        out_ += '}';
+    }
+
+    void operator()(VariantArray const& va) const
+    {
+        out_ += '[';
+        bool first = true;
+        for (auto const& v : va)
+        {
+            if (!first)
+            {
+                out_ += ',';
+            }
+            first = false;
+            boost::apply_visitor(*this, VariantImpl::get(v).v);
+        }
+        out_ += ']';
+    }
+
+private:
+    string& out_;
+};
+
+//-- Parser
+
+class Parser
+{
+public:
+    Parser(char const* data, size_t length)
+        : begin_(data)
+        , p_(data)
+        , end_(data + length)
+    {
+    }
+
+    Variant parse()
+    {
+        skip_whitespace();
+        if (p_ == end_)
+        {
+            throw unity::ResourceException("json_to_variant(): empty string is not a valid JSON");
+        }
+        Variant v = parse_value(0);
+        skip_whitespace();
+        if (p_ != end_)
+        {
+            error("unexpected data after JSON value");
+        }
+        return v;
+    }
+
+private:
+    static int const max_depth = 512;  // Protects the stack against malicious input
+
+    [[noreturn]] void error(char const* msg) const
+    {
+        throw unity::ResourceException("json_to_variant(): parse error at offset "
+                                       + std::to_string(p_ - begin_) + ": " + msg);
+    }
+
+    void skip_whitespace()
+    {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\n' || *p_ == '\r' || *p_ == '\t'))
+        {
+            ++p_;
+        }
+    }
+
+    void expect(char c)
+    {
+        skip_whitespace();
+        if (p_ == end_ || *p_ != c)
+        {
+            char msg[] = "expected 'x'";
+            msg[10] = c;
+            error(msg);
+        }
+        ++p_;
+    }
+
+    void expect_literal(char const* literal, size_t length)
+    {
+        if (size_t(end_ - p_) < length || memcmp(p_, literal, length) != 0)
+        {
+            error("invalid literal");
+        }
+        p_ += length;
+    }
+
+    Variant parse_value(int depth)
+    {
+        if (p_ == end_)
+        {
+            error("unexpected end of input");
+        }
+        switch (*p_)
+        {
+            case '{':
+                return parse_object(depth + 1);
+            case '[':
+                return parse_array(depth + 1);
+            case '"':
+            {
+                Variant v;
+                string str;
+                parse_string(str);
+                VariantImpl::get(v).v = std::move(str);
+                return v;
+            }
+            case 't':
+                expect_literal("true", 4);
+                return Variant(true);
+            case 'f':
+                expect_literal("false", 5);
+                return Variant(false);
+            case 'n':
+                expect_literal("null", 4);
+                return Variant();
+            default:
+                return parse_number();
+        }
+    }
+
+    Variant parse_object(int depth)
+    {
+        if (depth > max_depth)
+        {
+            error("nesting too deep");
+        }
+        ++p_;  // Skip '{'
+
+        Variant v;
+        auto& impl = VariantImpl::get(v).v;
+        impl = VariantMap();
+        auto& vm = boost::get<VariantMap>(impl);
+
+        skip_whitespace();
+        if (p_ < end_ && *p_ == '}')
+        {
+            ++p_;
+            return v;
+        }
+        string key;
+        while (true)
+        {
+            if (p_ == end_ || *p_ != '"')
+            {
+                error("expected member name");
+            }
+            key.clear();
+            parse_string(key);
+            expect(':');
+            skip_whitespace();
+            Variant value = parse_value(depth);
+
+            // As with JsonCppNode, if a name appears more than once, the last value wins.
+            auto it = vm.lower_bound(key);
+            if (it != vm.end() && it->first == key)
+            {
+                it->second = std::move(value);
+            }
+            else
+            {
+                vm.emplace_hint(it, std::move(key), std::move(value));
+            }
+
+            skip_whitespace();
+            if (p_ < end_ && *p_ == ',')
+            {
+                ++p_;
+                skip_whitespace();
+                continue;
+            }
+            expect('}');
+            return v;
+        }
+    }
+
+    Variant parse_array(int depth)
+    {
+        if (depth > max_depth)
+        {
+            error("nesting too deep");
+        }
+        ++p_;  // Skip '['
+
+        Variant v;
+        auto& impl = VariantImpl::get(v).v;
+        impl = VariantArray();
+        auto& va = boost::get<VariantArray>(impl);
+
+        skip_whitespace();
+        if (p_ < end_ && *p_ == ']')
+        {
+            ++p_;
+            return v;
+        }
+        while (true)
+        {
+            va.push_back(parse_value(depth));
+            skip_whitespace();
+            if (p_ < end_ && *p_ == ',')
+            {
+                ++p_;
+                skip_whitespace();
+                continue;
+            }
+            expect(']');
+            return v;
+        }
+    }
+
+    // Appends the string at p_ (which must point at the opening quote) to out.
+    void parse_string(string& out)
+    {
+        ++p_;  // Skip '"'
+        while (true)
+        {
+            size_t n = plain_prefix(p_, end_, false);
+            out.append(p_, n);
+            p_ += n;
+            if (p_ == end_)
+            {
+                error("unterminated string");
+            }
+            if (*p_++ == '"')
+            {
+                return;
+            }
+            // Escape sequence
+            if (p_ == end_)
+            {
+                error("unterminated string");
+            }
+            char c = *p_++;
+            switch (c)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    out += c;
+                    break;
+                case 'b':
+                    out += '\b';
+                    break;
+                case 'f':
+                    out += '\f';
+                    break;
+                case 'n':
+                    out += '\n';
+                    break;
+                case 'r':
+                    out += '\r';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case 'u':
+                    parse_unicode_escape(out);
+                    break;
+                default:
+                    --p_;
+                    error("invalid escape sequence");
+            }
+        }
+    }
+
+    unsigned int parse_hex4()
+    {
+        if (end_ - p_ < 4)
+        {
+            error("invalid unicode escape");
+        }
+        unsigned int val = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = *p_++;
+            val <<= 4;
+            if (c >= '0' && c <= '9')
+            {
+                val |= c - '0';
+            }
+            else if (c >= 'a' && c <= 'f')
+            {
+                val |= c - 'a' + 10;
+            }
+            else if (c >= 'A' && c <= 'F')
+            {
+                val |= c - 'A' + 10;
+            }
+            else
+            {
+                error("invalid unicode escape");
+            }
+        }
+        return val;
+    }
+
+    // Called with p_ just past "\u". Unpaired surrogates are replaced with U+FFFD.
+    void parse_unicode_escape(string& out)
+    {
+        unsigned int cp = parse_hex4();
+        if (cp >= 0xD800 && cp <= 0xDBFF)
+        {
+            if (end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u')
+            {
+                char const* save = p_;
+                p_ += 2;
+                unsigned int low = parse_hex4();
+                if (low >= 0xDC00 && low <= 0xDFFF)
+                {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                else
+                {
+                    p_ = save;
+                    cp = 0xFFFD;
+                }
+            }
+            else
+            {
+                cp = 0xFFFD;
+            }
+        }
+        else if (cp >= 0xDC00 && cp <= 0xDFFF)
+        {
+            cp = 0xFFFD;
+        }
+
+        if (cp < 0x80)
+        {
+            out += static_cast<char>(cp);
+        }
+        else if (cp < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool at_digit() const
+    {
+        return p_ < end_ && *p_ >= '0' && *p_ <= '9';
+    }
+
+    Variant parse_number()
+    {
+        char const* const start = p_;
+        bool const negative = *p_ == '-';
+        if (negative)
+        {
+            ++p_;
+        }
+        if (!at_digit())
+        {
+            p_ = start;
+            error("unexpected character");
+        }
+
+        // Integer part, accumulated as we go in case this turns out to be an integer.
+        uint64_t mag = 0;
+        bool overflow = false;
+        if (*p_ == '0')
+        {
+            ++p_;
+        }
+        else
+        {
+            while (at_digit())
+            {
+                unsigned int digit = *p_++ - '0';
+                if (mag > (UINT64_MAX - digit) / 10)
+                {
+                    overflow = true;
+                }
+                mag = mag * 10 + digit;
+            }
+        }
+
+        bool is_integer = true;
+        if (p_ < end_ && *p_ == '.')
+        {
+            ++p_;
+            if (!at_digit())
+            {
+                error("invalid number");
+            }
+            while (at_digit())
+            {
+                ++p_;
+            }
+            is_integer = false;
+        }
+        if (p_ < end_ && (*p_ == 'e' || *p_ == 'E'))
+        {
+            ++p_;
+            if (p_ < end_ && (*p_ == '+' || *p_ == '-'))
+            {
+                ++p_;
+            }
+            if (!at_digit())
+            {
+                error("invalid number");
+            }
+            while (at_digit())
+            {
+                ++p_;
+            }
+            is_integer = false;
+        }
+
+        if (is_integer && !overflow)
+        {
+            uint64_t const limit = negative ? uint64_t(INT64_MAX) + 1 : uint64_t(INT64_MAX);
+            if (mag <= limit)
+            {
+                int64_t val = negative ? static_cast<int64_t>(0 - mag) : static_cast<int64_t>(mag);
+                if (val >= INT32_MIN && val <= INT32_MAX)
+                {
+                    return Variant(static_cast<int>(val));
+                }
+                return Variant(val);
+            }
+        }
+
+        // The input is not necessarily NUL-terminated, so strtod() gets a copy.
+        string const number(start, p_);
+        CLocale c_locale;
+        return Variant(strtod(number.c_str(), nullptr));
+    }
+
+    char const* const begin_;
+    char const* p_;
+    char const* const end_;
+};
+
+}  // namespace
+
+void variant_to_json(Variant const& var, string& out)
+{
+    boost::apply_visitor(Writer(out), VariantImpl::get(var).v);
+}
+
+string variant_to_json(Variant const& var)
+{
+    string json;
+    variant_to_json(var, json);
+    return json;
+}
+
+void string_to_json(string const& str, string& out)
+{
+    append_string(str, out);
+}
+
+Variant json_to_variant(char const* data, size_t length)
+{
+    return Parser(data, length).parse();
+}
+
+Variant json_to_variant(string const& json)
+{
+    return json_to_variant(json.data(), json.size());
+}
+
+} // namespace internal
+
+} // namespace scopes
+
+} // namespace unity
@@ -20,12 +20,19 @@
 
 #include <unity/UnityExceptions.h>
 
+#include <core/net/http/header.h>
 #include <core/net/http/streaming_client.h>
 #include <core/net/http/streaming_request.h>
 #include <core/net/http/response.h>
 #include <core/net/http/status.h>
 
+#include <strings.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <set>
 #include <unordered_map>
 
 namespace net = core::net;
@@ -98,12 +105,129 @@ struct CancellationRegistry
     std::mutex guard;
     std::unordered_map<unsigned int, std::shared_ptr<Cancelable>> store;
 };
+
+// Passes the response body to the line_data callback, decoded according to the response's
+// Content-Encoding. net-cpp hands us the response headers only once the body is complete,
+// so if the request accepts a content coding other than identity, the body is held back
+// until then. Otherwise, it streams straight through. Bodies with a content coding we don't
+// know are passed on unchanged. An empty string marks the end of the body. If the body cannot
+// be decoded, neither the body nor the end marker are passed on.
+class BodyDecoder
+{
+public:
+    BodyDecoder(std::function<void(std::string const&)> const& line_data, bool may_be_encoded)
+        : line_data_(line_data)
+        , may_be_encoded_(may_be_encoded)
+    {
+    }
+
+    BodyDecoder(BodyDecoder const&) = delete;
+    BodyDecoder& operator=(BodyDecoder const&) = delete;
+
+    void operator()(std::string const& data)
+    {
+        if (may_be_encoded_)
+        {
+            body_ += data;
+        }
+        else
+        {
+            line_data_(data);
+        }
+    }
+
+    // Returns false if the body is corrupt or truncated.
+    bool finish(std::string const& content_encoding)
+    {
+        if (may_be_encoded_)
+        {
+            bool ok = true;
+            std::string coding = content_encoding;
+            coding.erase(0, coding.find_first_not_of(" \t"));
+            coding.erase(coding.find_last_not_of(" \t") + 1);
+            if (strcasecmp(coding.c_str(), "gzip") == 0 || strcasecmp(coding.c_str(), "x-gzip") == 0)
+            {
+                ok = inflate_body(15 + 16);  // Maximum window size, gzip header
+            }
+            else if (strcasecmp(coding.c_str(), "deflate") == 0)
+            {
+                // "deflate" means zlib format, but some servers send raw deflate data.
+                ok = inflate_body(15) || inflate_body(-15);
+            }
+            else
+            {
+                line_data_(body_);  // identity, or a coding we don't know
+            }
+            body_.clear();
+            if (!ok)
+            {
+                return false;
+            }
+        }
+        line_data_("");
+        return true;
+    }
+
+private:
+    // Passes the inflated body on. Returns false without passing anything on if the
+    // body is not in the format selected by window_bits, or is corrupt.
+    bool inflate_body(int window_bits)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(stream));
+        if (inflateInit2(&stream, window_bits) != Z_OK)
+        {
+            return false;
+        }
+
+        std::string inflated;
+        char out[16 * 1024];
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body_.data()));
+        stream.avail_in = static_cast<uInt>(body_.size());
+        int rc;
+        do
+        {
+            stream.next_out = reinterpret_cast<Bytef*>(out);
+            stream.avail_out = sizeof(out);
+            rc = inflate(&stream, Z_NO_FLUSH);
+            inflated.append(out, sizeof(out) - stream.avail_out);
+        }
+        while (rc == Z_OK);
+        inflateEnd(&stream);
+
+        if (rc != Z_STREAM_END)
+        {
+            return false;
+        }
+        line_data_(inflated);
+        return true;
+    }
+
+    std::function<void(std::string const&)> line_data_;
+    bool may_be_encoded_;
+    std::string body_;
+};
+
+std::string header_value(unity::scopes::internal::smartscopes::HttpHeaders const& headers, std::string const& name)
+{
+    for (auto const& hdr : headers)
+    {
+        if (strcasecmp(hdr.first.c_str(), name.c_str()) == 0)
+        {
+            return hdr.second;
+        }
+    }
+    return "";
+}
+
 }
 
-HttpClientNetCpp::HttpClientNetCpp(unsigned int no_reply_timeout)
+HttpClientNetCpp::HttpClientNetCpp(unsigned int no_reply_timeout, unsigned int max_concurrent_requests)
     : no_reply_timeout{no_reply_timeout},
+      max_concurrent_requests{max_concurrent_requests},
       client{http::make_streaming_client()},
-      worker([this]() { client->run(); })
+      worker([this]() { client->run(); }),
+      active_requests{0}
 {
 }
 
@@ -115,6 +239,15 @@ HttpClientNetCpp::~HttpClientNetCpp()
     {
         worker.join();
     }
+
+    // Requests that never got started won't complete now.
+    std::lock_guard<std::mutex> lock(requests_mutex);
+    for (auto& request : pending_requests)
+    {
+        unity::ResourceException e("HTTP request not started: client was destroyed");
+        request.promise->set_exception(std::make_exception_ptr(e));
+    }
+    pending_requests.clear();
 }
 
 HttpResponseHandle::SPtr HttpClientNetCpp::get(std::string const& request_url,
@@ -129,6 +262,10 @@ HttpResponseHandle::SPtr HttpClientNetCpp::get(std::string const& request_url,
     }
     http_config.header = http_header;
 
+    // Without Accept-Encoding, the server sends the body as is, and we can stream it.
+    auto const accept_encoding = header_value(headers, "Accept-Encoding");
+    bool const may_be_encoded = !accept_encoding.empty() && strcasecmp(accept_encoding.c_str(), "identity") != 0;
+
     auto request = client->streaming_get(http_config);
     request->set_timeout(std::chrono::milliseconds{no_reply_timeout});
 
@@ -136,46 +273,110 @@ HttpResponseHandle::SPtr HttpClientNetCpp::get(std::string const& request_url,
     std::shared_future<void> future(promise->get_future());
 
     auto id_and_cancelable = CancellationRegistry::instance().add();
+    auto decoder = std::make_shared<BodyDecoder>(line_data, may_be_encoded);
+    auto info = std::make_shared<HttpResponseInfo>();
 
-    request->async_execute(
-                http::Request::Handler()
-                    .on_progress([id_and_cancelable](const http::Request::Progress&)
-                    {
-                        return id_and_cancelable.second->is_cancelled() ?
-                                    http::Request::Progress::Next::abort_operation :
-                                    http::Request::Progress::Next::continue_operation;
-                    })
-                    .on_response([line_data, promise](const http::Response& response)
-                    {
-                        if (response.status != http::Status::ok)
+    // The worker thread, which runs these callbacks, is joined before we are destroyed,
+    // so capturing this is safe.
+    auto start = [this, request, id_and_cancelable, decoder, promise, info]()
+    {
+        request->async_execute(
+                    http::Request::Handler()
+                        .on_progress([id_and_cancelable](const http::Request::Progress&)
                         {
-                            std::ostringstream msg;
-                            msg << "HTTP request failed with: " << response.status << std::endl << response.body;
-                            unity::ResourceException e(msg.str());
-
-                            promise->set_exception(std::make_exception_ptr(e));
-                        }
-                        else
+                            return id_and_cancelable.second->is_cancelled() ?
+                                        http::Request::Progress::Next::abort_operation :
+                                        http::Request::Progress::Next::continue_operation;
+                        })
+                        .on_response([this, decoder, promise, info](const http::Response& response)
                         {
-                            // call line_data with empty string to signal end of chunked data
-                            line_data("");
-                            promise->set_value();
-                        }
-                    })
-                    .on_error([promise](const net::Error& e)
+                            info->status = static_cast<unsigned int>(response.status);
+                            response.header.enumerate([info](std::string const& key, std::set<std::string> const& values)
+                            {
+                                for (auto const& value : values)
+                                {
+                                    info->headers.push_back(std::make_pair(key, value));
+                                }
+                            });
+
+                            if (response.status == http::Status::not_modified)
+                            {
+                                promise->set_value();
+                            }
+                            else if (response.status != http::Status::ok)
+                            {
+                                std::ostringstream msg;
+                                msg << "HTTP request failed with: " << response.status << std::endl << response.body;
+                                unity::ResourceException e(msg.str());
+
+                                promise->set_exception(std::make_exception_ptr(e));
+                            }
+                            else
+                            {
+                                // call line_data with empty string to signal end of chunked data
+                                auto const content_encoding = header_value(info->headers, "Content-Encoding");
+                                if (decoder->finish(content_encoding))
+                                {
+                                    promise->set_value();
+                                }
+                                else
+                                {
+                                    unity::ResourceException e("HTTP response body could not be decoded (Content-Encoding: "
+                                                               + content_encoding + ")");
+                                    promise->set_exception(std::make_exception_ptr(e));
+                                }
+                            }
+                            request_finished();
+                        })
+                        .on_error([this, promise](const net::Error& e)
+                        {
+                            unity::ResourceException re(e.what());
+                            promise->set_exception(std::make_exception_ptr(re));
+                            request_finished();
+                        }),
+                    [decoder](const std::string& const_data)
                     {
-                        unity::ResourceException re(e.what());
-                        promise->set_exception(std::make_exception_ptr(re));
-                    }),
-                [line_data](const std::string& const_data)
-                {
-                    line_data(const_data);
-                });
+                        (*decoder)(const_data);
+                    });
+    };
+    start_or_queue(PendingRequest{start, promise});
 
     return std::make_shared<HttpResponseHandle>(
                 shared_from_this(),
                 id_and_cancelable.first,
-                future);
+                future,
+                info);
+}
+
+void HttpClientNetCpp::start_or_queue(PendingRequest request)
+{
+    {
+        std::lock_guard<std::mutex> lock(requests_mutex);
+        if (max_concurrent_requests != 0 && active_requests >= max_concurrent_requests)
+        {
+            pending_requests.push_back(std::move(request));
+            return;
+        }
+        ++active_requests;
+    }
+    request.start();
+}
+
+void HttpClientNetCpp::request_finished()
+{
+    std::function<void()> next;
+    {
+        std::lock_guard<std::mutex> lock(requests_mutex);
+        if (pending_requests.empty())
+        {
+            --active_requests;
+            return;
+        }
+        // Hand our slot straight to the oldest queued request.
+        next = std::move(pending_requests.front().start);
+        pending_requests.pop_front();
+    }
+    next();
 }
 
 void HttpClientNetCpp::cancel_get(unsigned int id)
@@ -41,6 +41,7 @@ namespace
 {
     const string ss_config_group = "Smartscopes";
     const string http_reply_timeout_key = "Http.Reply.Timeout";
+    const string http_max_concurrent_requests_key = "Http.MaxConcurrentRequests";
     const string reg_refresh_rate_key = "Registry.Refresh.Rate";
     const string reg_refresh_fail_timeout_key = "Registry.Refresh.Fail.Timeout";
     const string scope_identity_key = "Scope.Identity";
@@ -52,6 +53,7 @@ SSConfig::SSConfig(string const& configfile) :
     if (configfile.empty())
     {
         http_reply_timeout_ = DFLT_SS_HTTP_TIMEOUT;
+        http_max_concurrent_requests_ = DFLT_SS_HTTP_MAX_CONCURRENT;
         reg_refresh_rate_ = DFLT_SS_REG_REFRESH_RATE;
         reg_refresh_fail_timeout_ = DFLT_SS_REG_REFRESH_FAIL_TIMEOUT;
         scope_identity_ = DFLT_SS_SCOPE_IDENTITY;
@@ -65,6 +67,15 @@ SSConfig::SSConfig(string const& configfile) :
                      http_reply_timeout_key + ": value must be 10 - 60");
         }
 
+        http_max_concurrent_requests_ = get_optional_int(ss_config_group,
+                                                         http_max_concurrent_requests_key,
+                                                         DFLT_SS_HTTP_MAX_CONCURRENT);
+        if (http_max_concurrent_requests_ < 0)
+        {
+            throw_ex("Illegal value (" + to_string(http_max_concurrent_requests_) + ") for " +
+                     http_max_concurrent_requests_key + ": value must be >= 0");
+        }
+
         reg_refresh_rate_ = get_optional_int(ss_config_group, reg_refresh_rate_key, DFLT_SS_REG_REFRESH_RATE);
         if (reg_refresh_rate_ < 60)
         {
@@ -88,6 +99,7 @@ SSConfig::SSConfig(string const& configfile) :
                                           {  ss_config_group,
                                              {
                                                 http_reply_timeout_key,
+                                                http_max_concurrent_requests_key,
                                                 reg_refresh_rate_key,
                                                 reg_refresh_fail_timeout_key,
                                                 scope_identity_key,
@@ -106,6 +118,11 @@ int SSConfig::http_reply_timeout() const
     return http_reply_timeout_;
 }
 
+int SSConfig::http_max_concurrent_requests() const
+{
+    return http_max_concurrent_requests_;
+}
+
 int SSConfig::reg_refresh_rate() const
 {
     return reg_refresh_rate_;
@@ -30,6 +30,8 @@
 #include <unity/scopes/ScopeExceptions.h>
 #include <unity/UnityExceptions.h>
 
+#include <cassert>
+
 namespace unity
 {
 
@@ -48,7 +50,8 @@ SSRegistryObject::SSRegistryObject(MiddlewareBase::SPtr middleware,
                                    std::string const& sss_url,
                                    bool caching_enabled)
     : ssclient_(std::make_shared<SmartScopesClient>(
-                    std::make_shared<HttpClientNetCpp>(ss_config.http_reply_timeout() * 1000),  // need millisecs
+                    std::make_shared<HttpClientNetCpp>(ss_config.http_reply_timeout() * 1000,  // need millisecs
+                                                       ss_config.http_max_concurrent_requests()),
                     std::make_shared<JsonCppNode>(),
                     middleware->runtime(),
                     sss_url))
@@ -138,6 +141,43 @@ MetadataMap SSRegistryObject::list() const
     return scopes_;
 }
 
+MetadataMap SSRegistryObject::find_by_keywords(std::set<std::string> const& keywords) const
+{
+    std::lock_guard<std::mutex> lock(scopes_mutex_);
+
+    MetadataMap matching_scopes;
+    for (auto const& id : keyword_index_.find(keywords))
+    {
+        auto it = scopes_.find(id);
+        assert(it != scopes_.end());
+        matching_scopes.emplace(*it);
+    }
+    return matching_scopes;
+}
+
+MetadataMap SSRegistryObject::children_of(std::string const& scope_id) const
+{
+    ScopeMetadata aggregator = get_metadata(scope_id);  // Throws NotFoundException if scope doesn't exist.
+
+    MetadataMap children;
+    if (aggregator.is_aggregator())
+    {
+        children = find_by_keywords(aggregator.keywords());
+    }
+
+    std::lock_guard<std::mutex> lock(scopes_mutex_);
+    for (auto const& id : aggregator.child_scope_ids())
+    {
+        auto it = scopes_.find(id);
+        if (it != scopes_.end())
+        {
+            children.emplace(*it);
+        }
+    }
+    children.erase(scope_id);
+    return children;
+}
+
 ObjectProxy SSRegistryObject::locate(std::string const& identity)
 {
     // Smart Scopes are not fork and execed, so we simply return the proxy here
@@ -219,11 +259,14 @@ void SSRegistryObject::refresh_thread()
 void SSRegistryObject::get_remote_scopes()
 {
     std::vector<RemoteScope> remote_scopes;
+    bool unchanged = false;
 
     try
     {
-        // request remote scopes from smart scopes client
-        if (ssclient_->get_remote_scopes(remote_scopes, locale_, caching_enabled_))
+        // request remote scopes from smart scopes client (only conditionally
+        // if we have a catalog to fall back on)
+        if (ssclient_->get_remote_scopes(remote_scopes, locale_, caching_enabled_,
+                                         remote_scopes_.empty() ? nullptr : &unchanged))
         {
             next_refresh_timeout_ = regular_refresh_timeout_;
         }
@@ -239,6 +282,12 @@ void SSRegistryObject::get_remote_scopes()
         throw;
     }
 
+    if (unchanged)
+    {
+        // Same catalog as last time, nothing to do.
+        return;
+    }
+
     bool changed = false;
     MetadataMap new_scopes_;
     std::map<std::string, std::string> new_base_urls_;
@@ -246,6 +295,20 @@ void SSRegistryObject::get_remote_scopes()
     // loop through all available scopes and add() each visible scope
     for (RemoteScope const& scope : remote_scopes)
     {
+        // Reuse the existing metadata if the scope hasn't changed since the last refresh.
+        // scopes_ is only ever modified by this thread, so we can read it without locking.
+        auto prev = remote_scopes_.find(scope.id);
+        if (prev != remote_scopes_.end() && prev->second == scope)
+        {
+            auto it = scopes_.find(scope.id);
+            if (it != scopes_.end())
+            {
+                add(scope, it->second, new_scopes_, new_base_urls_);
+                continue;
+            }
+        }
+        changed = true;
+
         try
         {
             // construct a ScopeMetadata with remote scope info
@@ -365,8 +428,7 @@ void SSRegistryObject::get_remote_scopes()
 
         // check if base urls or list of available scopes has changed.
         // the urls is a map of (string, string), so rely on == operator.
-        // when comparing scopes maps, only check if scope ids are same, i.e.
-        // changes to scope metadata attributes are not detected.
+        // changes to scope metadata attributes were detected above.
         if (new_base_urls_ != base_urls_ ||
             new_scopes_.size() != scopes_.size())
         {
@@ -387,6 +449,18 @@ void SSRegistryObject::get_remote_scopes()
         // replace current collection of remote scopes
         base_urls_ = new_base_urls_;
         scopes_ = new_scopes_;
+        keyword_index_.clear();
+        for (auto const& p : scopes_)
+        {
+            keyword_index_.add(p.first, p.second.keywords());
+        }
+    }
+
+    remote_scopes_.clear();
+    for (auto& scope : remote_scopes)
+    {
+        auto id = scope.id;
+        remote_scopes_[id] = std::move(scope);
     }
 
     if (changed && publisher_)
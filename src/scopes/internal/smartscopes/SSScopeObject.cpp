@@ -83,6 +83,7 @@ MWQueryCtrlProxy SSScopeObject::search(CannedQuery const& q,
 
 MWQueryCtrlProxy SSScopeObject::activate(Result const& result,
                                          ActionMetadata const& hints,
+                                         VariantMap const& /* context */,
                                          MWReplyProxy const& reply,
                                          InvokeInfo const& info)
 {
@@ -125,6 +126,7 @@ MWQueryCtrlProxy SSScopeObject::activate_result_action(Result const& result,
 
 MWQueryCtrlProxy SSScopeObject::preview(Result const& result,
                                         ActionMetadata const& hints,
+                                        VariantMap const& /* context */,
                                         MWReplyProxy const& reply,
                                         InvokeInfo const& info)
 {
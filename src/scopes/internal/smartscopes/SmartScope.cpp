@@ -132,10 +132,9 @@ void SmartQuery::run(SearchReplyProxy const& reply)
             res.set_uri(result.uri);
             res["result_json"] = result.json;
 
-            auto other_params = result.other_params;
-            for (auto& param : other_params)
+            for (auto const& param : result.other_params)
             {
-                res[param.first] = param.second->to_variant();
+                res[param.first] = param.second;
             }
 
             reply->push(res);
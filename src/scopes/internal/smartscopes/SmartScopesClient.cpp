@@ -20,6 +20,7 @@
 #include <unity/scopes/internal/FilterBaseImpl.h>
 #include <unity/scopes/internal/FilterStateImpl.h>
 #include <unity/scopes/internal/FilterGroupImpl.h>
+#include <unity/scopes/internal/JsonCppNode.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
 #include <unity/scopes/internal/smartscopes/SmartScopesClient.h>
 #include <unity/scopes/internal/Utils.h>
@@ -30,6 +31,9 @@
 
 #include <algorithm>
 #include <array>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <future>
@@ -37,6 +41,9 @@
 #include <map>
 #include <sstream>
 
+#include <strings.h>
+#include <unistd.h>
+
 static std::string homedir()
 {
     static const char* home = getenv("HOME");
@@ -53,12 +60,150 @@ static const std::string c_search_resource = "/search";
 static const std::string c_preview_resource = "/preview";
 
 static const std::string c_scopes_cache_dir = homedir() + "/.cache/unity-scopes/";
-static const std::string c_scopes_cache_filename = "remote-scopes.json";
+static const std::string c_scopes_cache_filename = "remote-scopes.cache";
+static const std::string c_legacy_scopes_cache_filename = "remote-scopes.json";
+static const char c_cache_magic[4] = { 'U', 'S', 'R', 'S' };
+static const uint32_t c_cache_version = 2;  // Version 1 stored a std::hash of the catalog, which isn't stable
 static const std::string c_partner_id_file = "/custom/partner-id";
 
 using namespace unity::scopes;
 using namespace unity::scopes::internal::smartscopes;
 
+namespace
+{
+
+// 64-bit FNV-1a. Unlike std::hash, the result is the same across builds
+// and library versions, so we can store it in the cache.
+uint64_t fnv1a_hash(std::string const& str)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : str)
+    {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+void write_u32(std::ostream& out, uint32_t v)
+{
+    out.write(reinterpret_cast<char const*>(&v), sizeof(v));
+}
+
+void write_u64(std::ostream& out, uint64_t v)
+{
+    out.write(reinterpret_cast<char const*>(&v), sizeof(v));
+}
+
+void write_string(std::ostream& out, std::string const& str)
+{
+    write_u32(out, static_cast<uint32_t>(str.size()));
+    out.write(str.data(), str.size());
+}
+
+void write_optional_string(std::ostream& out, std::shared_ptr<std::string> const& str)
+{
+    write_u32(out, str ? 1 : 0);
+    if (str)
+    {
+        write_string(out, *str);
+    }
+}
+
+uint32_t read_u32(std::istream& in)
+{
+    uint32_t v;
+    if (!in.read(reinterpret_cast<char*>(&v), sizeof(v)))
+    {
+        throw unity::ResourceException("unexpected end of file");
+    }
+    return v;
+}
+
+uint64_t read_u64(std::istream& in)
+{
+    uint64_t v;
+    if (!in.read(reinterpret_cast<char*>(&v), sizeof(v)))
+    {
+        throw unity::ResourceException("unexpected end of file");
+    }
+    return v;
+}
+
+// Reads a count of elements that take at least element_size bytes each in a stream of size bytes.
+// Checking the count against the rest of the stream means that a corrupt count cannot make
+// us allocate more memory than the size of the file.
+
+uint32_t read_count(std::istream& in, std::streamoff size, std::streamoff element_size)
+{
+    uint32_t const count = read_u32(in);
+    std::streamoff const pos = in.tellg();
+    if (pos < 0 || count > (size - pos) / element_size)
+    {
+        throw unity::ResourceException("count exceeds file size");
+    }
+    return count;
+}
+
+std::string read_string(std::istream& in, std::streamoff size)
+{
+    std::string str(read_count(in, size, 1), '\0');
+    if (!str.empty() && !in.read(&str[0], str.size()))
+    {
+        throw unity::ResourceException("unexpected end of file");
+    }
+    return str;
+}
+
+std::shared_ptr<std::string> read_optional_string(std::istream& in, std::streamoff size)
+{
+    return read_u32(in) != 0 ? std::make_shared<std::string>(read_string(in, size)) : nullptr;
+}
+
+std::string header_value(HttpHeaders const& headers, std::string const& name)
+{
+    for (auto const& header : headers)
+    {
+        if (strcasecmp(header.first.c_str(), name.c_str()) == 0)
+        {
+            return header.second;
+        }
+    }
+    return std::string();
+}
+
+bool same_value(std::shared_ptr<std::string> const& a, std::shared_ptr<std::string> const& b)
+{
+    return a ? b && *a == *b : !b;
+}
+
+} // namespace
+
+//-- RemoteScope
+
+bool RemoteScope::operator==(RemoteScope const& other) const
+{
+    return id == other.id
+           && name == other.name
+           && description == other.description
+           && author == other.author
+           && base_url == other.base_url
+           && same_value(icon, other.icon)
+           && same_value(art, other.art)
+           && (appearance ? other.appearance && *appearance == *other.appearance : !other.appearance)
+           && same_value(settings, other.settings)
+           && (needs_location_data ? other.needs_location_data && *needs_location_data == *other.needs_location_data
+                                   : !other.needs_location_data)
+           && invisible == other.invisible
+           && version == other.version
+           && keywords == other.keywords;
+}
+
+bool RemoteScope::operator!=(RemoteScope const& other) const
+{
+    return !(*this == other);
+}
+
 //-- SearchHandle
 
 SearchHandle::SearchHandle(unsigned int search_id, SmartScopesClient::SPtr ssc)
@@ -105,6 +250,212 @@ void PreviewHandle::cancel_preview()
     ssc_->cancel_query(preview_id_);
 }
 
+//-- JsonLineParser
+
+namespace
+{
+
+// Helpers to locate a value in JSON text that is known to be well-formed (because
+// it was parsed successfully already).
+
+char const* skip_whitespace(char const* p, char const* end)
+{
+    while (p < end && std::isspace(static_cast<unsigned char>(*p)))
+    {
+        ++p;
+    }
+    return p;
+}
+
+// p points at the opening quote. Returns the position following the closing quote.
+char const* skip_string(char const* p, char const* end)
+{
+    for (++p; p < end; ++p)
+    {
+        if (*p == '\\')
+        {
+            ++p;
+        }
+        else if (*p == '"')
+        {
+            return p + 1;
+        }
+    }
+    return end;
+}
+
+// p points at the start of a value. Returns the position following the value
+// (possibly including trailing whitespace for scalars).
+char const* skip_value(char const* p, char const* end)
+{
+    int depth = 0;
+    while (p < end)
+    {
+        switch (*p)
+        {
+            case '"':
+            {
+                p = skip_string(p, end);
+                if (depth == 0)
+                {
+                    return p;
+                }
+                continue;
+            }
+            case '{':
+            case '[':
+            {
+                ++depth;
+                break;
+            }
+            case '}':
+            case ']':
+            {
+                if (depth == 0)
+                {
+                    return p;
+                }
+                if (--depth == 0)
+                {
+                    return p + 1;
+                }
+                break;
+            }
+            case ',':
+            {
+                if (depth == 0)
+                {
+                    return p;
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+        ++p;
+    }
+    return end;
+}
+
+// Returns the text of the value of the top-level member with the given name in the JSON
+// object [begin, end), exactly as it appears in the input, or the empty string if
+// there is no such member.
+std::string raw_member(char const* begin, char const* end, std::string const& name)
+{
+    auto p = skip_whitespace(begin, end);
+    if (p == end || *p != '{')
+    {
+        return std::string();
+    }
+    ++p;
+    while (true)
+    {
+        p = skip_whitespace(p, end);
+        if (p == end || *p != '"')
+        {
+            return std::string();
+        }
+        auto key_begin = p + 1;
+        p = skip_string(p, end);
+        auto key_end = p - 1;
+        p = skip_whitespace(p, end);
+        if (p == end || *p != ':')
+        {
+            return std::string();
+        }
+        auto value_begin = skip_whitespace(p + 1, end);
+        p = skip_value(value_begin, end);
+        if (name.compare(0, std::string::npos, key_begin, static_cast<std::size_t>(key_end - key_begin)) == 0)
+        {
+            auto value_end = p;
+            while (value_end > value_begin && std::isspace(static_cast<unsigned char>(value_end[-1])))
+            {
+                --value_end;
+            }
+            return std::string(value_begin, value_end);
+        }
+        p = skip_whitespace(p, end);
+        if (p == end || *p != ',')
+        {
+            return std::string();
+        }
+        ++p;
+    }
+}
+
+} // namespace
+
+void JsonLineParser::consume(std::string const& chunk,
+                             LineHandler const& line_handler,
+                             std::function<void(std::string const&)> const& error_handler)
+{
+    // According to the docs, we expect:
+    // The response will have Content-Type
+    // application/json, it will be a chunked response, in practice a series of
+    // “\r\n” delimited lines, each containing one JSON object, with the
+    // possible forms, matching what currently can be pushed into a reply in the
+    // new scopes API
+    static constexpr const char separator{'\n'};
+
+    if (chunk.empty())
+    {
+        // End of stream
+        parse_line(leftover_.data(), leftover_.data() + leftover_.size(), line_handler, error_handler);
+        leftover_.clear();
+        return;
+    }
+
+    // Only copy the chunk if we have part of a line left over from the previous one.
+    char const* data = chunk.data();
+    char const* end = data + chunk.size();
+    if (!leftover_.empty())
+    {
+        auto first_separator = std::find(data, end, separator);
+        leftover_.append(data, first_separator);
+        if (first_separator == end)
+        {
+            return;
+        }
+        parse_line(leftover_.data(), leftover_.data() + leftover_.size(), line_handler, error_handler);
+        leftover_.clear();
+        data = first_separator + 1;
+    }
+
+    // Parse complete lines in place
+    for (auto line_end = std::find(data, end, separator); line_end != end; line_end = std::find(data, end, separator))
+    {
+        parse_line(data, line_end, line_handler, error_handler);
+        data = line_end + 1;
+    }
+
+    leftover_.assign(data, end);
+}
+
+void JsonLineParser::parse_line(char const* begin,
+                                char const* end,
+                                LineHandler const& line_handler,
+                                std::function<void(std::string const&)> const& error_handler)
+{
+    if (std::all_of(begin, end, [](char c) { return std::isspace(static_cast<unsigned char>(c)); }))
+    {
+        return;
+    }
+
+    try
+    {
+        // The root node is handed to line_handler as is, rather than via get_node(), which would copy it.
+        auto root_node = std::make_shared<JsonCppNode>();
+        root_node->read_json(begin, static_cast<std::size_t>(end - begin));
+        line_handler(root_node, begin, end);
+    }
+    catch (std::exception const& e)
+    {
+        error_handler(e.what());
+    }
+}
+
 //-- SmartScopesClient
 
 SmartScopesClient::SmartScopesClient(HttpClientInterface::SPtr http_client,
@@ -163,10 +514,24 @@ std::string SmartScopesClient::url()
 }
 
 // returns false if cache used
-bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scopes, std::string const& locale, bool caching_enabled)
+bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scopes,
+                                          std::string const& locale,
+                                          bool caching_enabled,
+                                          bool* unchanged)
 {
     std::string response_str;
-    bool using_cache = false;
+
+    if (unchanged)
+    {
+        *unchanged = false;
+    }
+
+    // We can ask for a conditional fetch if the caller already has the catalog,
+    // or if we can hand out the cached copy of the catalog.
+    bool const same_catalog = catalog_.valid && catalog_.locale == locale;
+    bool const caller_has_catalog = same_catalog && unchanged && catalog_.returned;
+    bool const can_use_cache = caching_enabled && have_latest_cache_ && !cached_scopes_.empty();
+    bool const conditional = same_catalog && (caller_has_catalog || can_use_cache);
 
     try
     {
@@ -200,6 +565,19 @@ bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scope
                       << partner_file_ << ": " << e.what();
         }
 
+        // The catalog is large and we read it in one piece anyway, so it is worth compressing.
+        // (Search and preview results stream in, so we don't ask for compression for those.)
+        headers.push_back(std::make_pair("Accept-Encoding", "gzip, deflate"));
+
+        if (conditional && !catalog_.etag.empty())
+        {
+            headers.push_back(std::make_pair("If-None-Match", catalog_.etag));
+        }
+        if (conditional && !catalog_.last_modified.empty())
+        {
+            headers.push_back(std::make_pair("If-Modified-Since", catalog_.last_modified));
+        }
+
         std::mutex reponse_mutex;
         HttpResponseHandle::SPtr response = http_client_->get(remote_scopes_uri.str(), [&response_str, &reponse_mutex](std::string const& replyLine)
         {
@@ -209,6 +587,41 @@ bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scope
 
         response->get();
 
+        if (response->info().status == 304)
+        {
+            if (!conditional)
+            {
+                throw ResourceException("unexpected \"304 Not Modified\" response");
+            }
+            logger_(LoggerSeverity::Info) << "SmartScopesClient.get_remote_scopes(): Remote scopes not modified";
+            if (caller_has_catalog)
+            {
+                *unchanged = true;
+            }
+            else
+            {
+                remote_scopes = cached_scopes_;
+                catalog_.returned = true;
+            }
+            return true;
+        }
+
+        // Content hash, for servers that don't support conditional requests.
+        auto hash = fnv1a_hash(locale + '\n' + response_str);
+        if (caller_has_catalog && hash == catalog_.hash)
+        {
+            logger_(LoggerSeverity::Info) << "SmartScopesClient.get_remote_scopes(): Remote scopes unchanged";
+            *unchanged = true;
+            return true;
+        }
+
+        catalog_.valid = false;
+        catalog_.returned = false;
+        catalog_.locale = locale;
+        catalog_.hash = hash;
+        catalog_.etag = header_value(response->info().headers, "ETag");
+        catalog_.last_modified = header_value(response->info().headers, "Last-Modified");
+
         logger_(LoggerSeverity::Info) << "SmartScopesClient.get_remote_scopes(): Remote scopes:\n" << response_str;
     }
     catch (std::exception const& e)
@@ -220,13 +633,14 @@ bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scope
         {
             logger_() << "SmartScopesClient.get_remote_scopes(): Using remote scopes from cache";
 
-            response_str = read_cache();
-            if (response_str.empty())
+            if (!read_cache() || cached_scopes_.empty())
             {
                 throw ResourceException("SmartScopesClient.get_remote_scopes(): Remote scopes cache is empty");
             }
 
-            using_cache = true;
+            remote_scopes = cached_scopes_;
+            logger_(LoggerSeverity::Info) << "SmartScopesClient.get_remote_scopes(): Retrieved remote scopes from cache";
+            return false;
         }
         else
         {
@@ -234,14 +648,9 @@ bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scope
         }
     }
 
-    JsonNodeInterface::SPtr root_node;
-    JsonNodeInterface::SPtr child_node;
-
     try
     {
-        std::lock_guard<std::mutex> lock(json_node_mutex_);
-        json_node_->read_json(response_str);
-        root_node = json_node_->get_node();
+        remote_scopes = parse_remote_scopes(response_str);
     }
     catch (std::exception const& e)
     {
@@ -250,7 +659,48 @@ bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scope
         throw;
     }
 
-    remote_scopes.clear();
+    if (remote_scopes.empty())
+    {
+        logger_() << "SmartScopesClient.get_remote_scopes(): No valid remote scopes retrieved from uri: "
+                  << url_ << c_remote_scopes_resource;
+    }
+    else
+    {
+        catalog_.valid = true;
+        catalog_.returned = true;
+
+        if (caching_enabled)
+        {
+            have_latest_cache_ = false;
+            try
+            {
+                write_cache(remote_scopes);
+            }
+            catch (std::exception const& e)
+            {
+                logger_() << "SmartScopesClient.get_remote_scopes(): Failed to write to cache file: "
+                          << c_scopes_cache_dir << c_scopes_cache_filename << ": " << e.what();
+            }
+        }
+
+        logger_(LoggerSeverity::Info) << "SmartScopesClient.get_remote_scopes(): Retrieved remote scopes from uri: "
+                                      << url_ << c_remote_scopes_resource;
+    }
+
+    return true;
+}
+
+std::vector<RemoteScope> SmartScopesClient::parse_remote_scopes(std::string const& json)
+{
+    JsonNodeInterface::SPtr root_node;
+    JsonNodeInterface::SPtr child_node;
+    {
+        std::lock_guard<std::mutex> lock(json_node_mutex_);
+        json_node_->read_json(json);
+        root_node = json_node_->get_node();
+    }
+
+    std::vector<RemoteScope> remote_scopes;
     for (int i = 0; i < root_node->size(); ++i)
     {
         RemoteScope scope;
@@ -359,35 +809,7 @@ bool SmartScopesClient::get_remote_scopes(std::vector<RemoteScope>& remote_scope
         }
     }
 
-    if (remote_scopes.empty())
-    {
-        logger_() << "SmartScopesClient.get_remote_scopes(): No valid remote scopes retrieved from uri: "
-                  << url_ << c_remote_scopes_resource;
-    }
-    else if (!using_cache)
-    {
-        if (caching_enabled)
-        {
-            try
-            {
-                write_cache(response_str);
-            }
-            catch (std::exception const& e)
-            {
-                logger_() << "SmartScopesClient.get_remote_scopes(): Failed to write to cache file: "
-                          << c_scopes_cache_dir << c_scopes_cache_filename << ": " << e.what();
-            }
-        }
-
-        logger_(LoggerSeverity::Info) << "SmartScopesClient.get_remote_scopes(): Retrieved remote scopes from uri: "
-                                      << url_ << c_remote_scopes_resource;
-    }
-    else
-    {
-        logger_(LoggerSeverity::Info) << "SmartScopesClient.get_remote_scopes(): Retrieved remote scopes from cache";
-    }
-
-    return !using_cache;
+    return remote_scopes;
 }
 
 SearchHandle::UPtr SmartScopesClient::search(SearchReplyHandler& handler,
@@ -462,24 +884,18 @@ SearchHandle::UPtr SmartScopesClient::search(SearchReplyHandler& handler,
         headers.push_back(std::make_pair("User-Agent", user_agent_hdr));
     }
 
-    auto tmp_data = std::make_shared<std::string>();
-    query_results_[search_id] = http_client_->get(search_uri.str(), [this, tmp_data, &handler](std::string const& chunk)
+    auto parser = std::make_shared<JsonLineParser>();
+    query_results_[search_id] = http_client_->get(search_uri.str(), [this, parser, &handler](std::string const& chunk)
     {
-        // prepend any leftover data from the previous handle_chunk call
-        std::string data = *tmp_data + (chunk.empty() ? "\n" : chunk);
-
-        // store the leftover data from the handle_chunk call into tmp_data
-        *tmp_data = handle_chunk(data, [this, &handler](const std::string& line)
-        {
-            try
-            {
-                handle_line(line, handler);
-            }
-            catch (unity::Exception const& e)
-            {
-                logger_() << "SmartScopesClient.search(): Failed to parse line: " << e.what();
-            }
-        });
+        parser->consume(chunk,
+                        [this, &handler](JsonNodeInterface::SPtr const& root_node, char const* begin, char const* end)
+                        {
+                            handle_line(root_node, begin, end, handler);
+                        },
+                        [this](std::string const& error)
+                        {
+                            logger_() << "SmartScopesClient.search(): Failed to parse line: " << error;
+                        });
     }, headers);
 
     return SearchHandle::UPtr(new SearchHandle(search_id, shared_from_this()));
@@ -536,74 +952,26 @@ PreviewHandle::UPtr SmartScopesClient::preview(PreviewReplyHandler const& handle
 
     logger_(LoggerSeverity::Info) << "SmartScopesClient.preview(): GET " << preview_uri.str();
 
-    auto tmp_data = std::make_shared<std::string>();
-    query_results_[preview_id] = http_client_->get(preview_uri.str(), [this, tmp_data, handler](std::string const& chunk)
+    auto parser = std::make_shared<JsonLineParser>();
+    query_results_[preview_id] = http_client_->get(preview_uri.str(), [this, parser, handler](std::string const& chunk)
     {
-        // prepend any leftover data from the previous handle_chunk call
-        std::string data = *tmp_data + (chunk.empty() ? "\n" : chunk);
-
-        // store the leftover data from the handle_chunk call into tmp_data
-        *tmp_data = handle_chunk(data, [this, handler](const std::string& line)
-        {
-            try
-            {
-                handle_line(line, handler);
-            }
-            catch (unity::Exception const& e)
-            {
-                logger_() << "SmartScopesClient.preview(): Failed to parse line: " << e.what();
-            }
-        });
+        parser->consume(chunk,
+                        [this, handler](JsonNodeInterface::SPtr const& root_node, char const*, char const*)
+                        {
+                            handle_line(root_node, handler);
+                        },
+                        [this](std::string const& error)
+                        {
+                            logger_() << "SmartScopesClient.preview(): Failed to parse line: " << error;
+                        });
     }, headers);
 
     return PreviewHandle::UPtr(new PreviewHandle(preview_id, shared_from_this()));
 }
 
-std::string SmartScopesClient::handle_chunk(const std::string& chunk, std::function<void(const std::string&)> line_handler)
+void SmartScopesClient::handle_line(JsonNodeInterface::SPtr const& root_node, PreviewReplyHandler const& handler)
 {
-    // According to the docs, we expect:
-    // The response will have Content-Type
-    // application/json, it will be a chunked response, in practice a series of
-    // “\r\n” delimited lines, each containing one JSON object, with the
-    // possible forms, matching what currently can be pushed into a reply in the
-    // new scopes API
-    static constexpr const char separator{'\n'};
-
-    // read data line-by-line calling line_handler() for each
-    auto newline_pos = 0;
-    auto endline_pos = chunk.find(separator);
-    while (endline_pos != std::string::npos)
-    {
-        try
-        {
-            line_handler(chunk.substr(newline_pos, endline_pos - newline_pos));
-        }
-        catch (std::exception const &e)
-        {
-            logger_() << "SmartScopesClient.handle_chunk(): Failed to parse line: " << e.what();
-        }
-        newline_pos = endline_pos + 1;
-        endline_pos = chunk.find(separator, newline_pos);
-    }
-
-    // return the leftover data
-    return chunk.substr(newline_pos, chunk.size() - newline_pos);
-}
-
-void SmartScopesClient::handle_line(std::string const& json, PreviewReplyHandler const& handler)
-{
-    if (json.empty())
-    {
-        return;
-    }
-
-    JsonNodeInterface::SPtr root_node;
     JsonNodeInterface::SPtr child_node;
-    {
-        std::lock_guard<std::mutex> lock(json_node_mutex_);
-        json_node_->read_json(json);
-        root_node = json_node_->get_node();
-    }
 
     if (root_node->has_node("columns"))
     {
@@ -643,22 +1011,13 @@ void SmartScopesClient::handle_line(std::string const& json, PreviewReplyHandler
     }
 }
 
-void SmartScopesClient::handle_line(std::string const& json, SearchReplyHandler& handler)
+void SmartScopesClient::handle_line(JsonNodeInterface::SPtr const& root_node,
+                                    char const* begin,
+                                    char const* end,
+                                    SearchReplyHandler& handler)
 {
-    if (json.empty())
-    {
-        return;
-    }
-
-    JsonNodeInterface::SPtr root_node;
     JsonNodeInterface::SPtr child_node;
 
-    {
-        std::lock_guard<std::mutex> lock(json_node_mutex_);
-        json_node_->read_json(json);
-        root_node = json_node_->get_node();
-    }
-
     if (root_node->has_node("category"))
     {
         child_node = root_node->get_node("category");
@@ -688,26 +1047,23 @@ void SmartScopesClient::handle_line(std::string const& json, SearchReplyHandler&
     }
     else if (root_node->has_node("result"))
     {
-        child_node = root_node->get_node("result");
+        // Convert the result to a variant in a single pass over the parsed tree, and keep
+        // the original text for result_json instead of serializing the result again.
         SearchResult result;
-        result.json = child_node->to_json_string();
+        result.json = raw_member(begin, end, "result");
+        result.other_params = root_node->get_node("result")->to_variant().get_dict();
 
-        std::vector<std::string> members = child_node->member_names();
-        for (auto& member : members)
+        auto it = result.other_params.find("uri");
+        if (it != result.other_params.end())
         {
-            if (member == "uri")
-            {
-                result.uri = child_node->get_node(member)->as_string();
-            }
-            else if (member == "cat_id")
-            {
-                std::string category = child_node->get_node(member)->as_string();
-                result.category_id = category;
-            }
-            else
-            {
-                result.other_params[member] = child_node->get_node(member);
-            }
+            result.uri = it->second.get_string();
+            result.other_params.erase(it);
+        }
+        it = result.other_params.find("cat_id");
+        if (it != result.other_params.end())
+        {
+            result.category_id = it->second.get_string();
+            result.other_params.erase(it);
         }
         handler.result_handler(result);
     }
@@ -906,43 +1262,175 @@ void SmartScopesClient::cancel_query(unsigned int query_id)
     }
 }
 
-void SmartScopesClient::write_cache(std::string const& scopes_json)
+// The cache is a compact binary file, so the proxy can start up without having to parse JSON.
+// All integers are stored in host byte order; the cache is not meant to be portable.
+
+void SmartScopesClient::write_cache(std::vector<RemoteScope> const& remote_scopes)
 {
     // make cache directory (fails silently if already exists)
     make_directories(c_scopes_cache_dir, 0755);
 
-    // open cache for output
-    std::ofstream cache_file(c_scopes_cache_dir + c_scopes_cache_filename);
+    std::ostringstream out;
+    out.write(c_cache_magic, sizeof(c_cache_magic));
+    write_u32(out, c_cache_version);
+    write_u64(out, catalog_.hash);
+    write_string(out, catalog_.locale);
+    write_string(out, catalog_.etag);
+    write_string(out, catalog_.last_modified);
+    write_u32(out, static_cast<uint32_t>(remote_scopes.size()));
+    for (auto const& scope : remote_scopes)
+    {
+        write_string(out, scope.id);
+        write_string(out, scope.name);
+        write_string(out, scope.description);
+        write_string(out, scope.author);
+        write_string(out, scope.base_url);
+        write_optional_string(out, scope.icon);
+        write_optional_string(out, scope.art);
+        std::shared_ptr<std::string> appearance;
+        if (scope.appearance)
+        {
+            appearance = std::make_shared<std::string>(Variant(*scope.appearance).serialize_json());
+        }
+        write_optional_string(out, appearance);
+        write_optional_string(out, scope.settings);
+        write_u32(out, scope.needs_location_data ? (*scope.needs_location_data ? 2 : 1) : 0);
+        write_u32(out, scope.invisible ? 1 : 0);
+        write_u32(out, static_cast<uint32_t>(scope.version));
+        write_u32(out, static_cast<uint32_t>(scope.keywords.size()));
+        for (auto const& keyword : scope.keywords)
+        {
+            write_string(out, keyword);
+        }
+    }
 
-    if (!cache_file.fail())
+    // Write to a temporary file and rename, so a crash can't leave a truncated cache behind.
+    std::string const path = c_scopes_cache_dir + c_scopes_cache_filename;
+    std::string const tmp_path = path + ".tmp";
     {
-        cache_file << scopes_json;
+        std::ofstream cache_file(tmp_path, std::ios::binary | std::ios::trunc);
+        if (cache_file.fail())
+        {
+            return;
+        }
+        auto const data = out.str();
+        cache_file.write(data.data(), data.size());
         cache_file.close();
-
-        cached_scopes_ = scopes_json;
-        have_latest_cache_ = true;
+        if (cache_file.fail())
+        {
+            ::unlink(tmp_path.c_str());
+            return;
+        }
     }
+    if (::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        ::unlink(tmp_path.c_str());
+        return;
+    }
+
+    // The JSON cache written by earlier versions is superseded now.
+    ::unlink((c_scopes_cache_dir + c_legacy_scopes_cache_filename).c_str());
+
+    cached_scopes_ = remote_scopes;
+    have_latest_cache_ = true;
 }
 
-std::string SmartScopesClient::read_cache()
+bool SmartScopesClient::read_cache()
 {
     if (have_latest_cache_)
     {
-        return cached_scopes_;
+        return true;
     }
 
-    // open cache for input
-    std::ifstream cache_file(c_scopes_cache_dir + c_scopes_cache_filename);
-
+    std::ifstream cache_file(c_scopes_cache_dir + c_scopes_cache_filename, std::ios::binary);
     if (!cache_file.fail())
     {
-        cached_scopes_ = std::string((std::istreambuf_iterator<char>(cache_file)),
-                                      std::istreambuf_iterator<char>());
+        try
+        {
+            char magic[sizeof(c_cache_magic)];
+            if (!cache_file.read(magic, sizeof(magic)) || memcmp(magic, c_cache_magic, sizeof(magic)) != 0)
+            {
+                throw ResourceException("bad magic number");
+            }
+            if (read_u32(cache_file) != c_cache_version)
+            {
+                throw ResourceException("unsupported version");
+            }
+
+            auto const pos = cache_file.tellg();
+            std::streamoff const size = cache_file.seekg(0, std::ios::end).tellg();
+            cache_file.seekg(pos);
 
-        have_latest_cache_ = true;
+            CatalogInfo catalog;
+            catalog.hash = read_u64(cache_file);
+            catalog.locale = read_string(cache_file, size);
+            catalog.etag = read_string(cache_file, size);
+            catalog.last_modified = read_string(cache_file, size);
+
+            // Each scope has five strings, four optional strings and four numbers,
+            // each of which takes at least four bytes.
+            std::vector<RemoteScope> remote_scopes(read_count(cache_file, size, 13 * 4));
+            for (auto& scope : remote_scopes)
+            {
+                scope.id = read_string(cache_file, size);
+                scope.name = read_string(cache_file, size);
+                scope.description = read_string(cache_file, size);
+                scope.author = read_string(cache_file, size);
+                scope.base_url = read_string(cache_file, size);
+                scope.icon = read_optional_string(cache_file, size);
+                scope.art = read_optional_string(cache_file, size);
+                auto appearance = read_optional_string(cache_file, size);
+                if (appearance)
+                {
+                    scope.appearance = std::make_shared<VariantMap>(Variant::deserialize_json(*appearance).get_dict());
+                }
+                scope.settings = read_optional_string(cache_file, size);
+                auto needs_location_data = read_u32(cache_file);
+                if (needs_location_data != 0)
+                {
+                    scope.needs_location_data = std::make_shared<bool>(needs_location_data == 2);
+                }
+                scope.invisible = read_u32(cache_file) != 0;
+                scope.version = static_cast<int>(read_u32(cache_file));
+                auto num_keywords = read_count(cache_file, size, 4);
+                for (uint32_t i = 0; i < num_keywords; ++i)
+                {
+                    scope.keywords.insert(read_string(cache_file, size));
+                }
+            }
+
+            catalog.valid = true;
+            catalog_ = catalog;
+            cached_scopes_ = std::move(remote_scopes);
+            have_latest_cache_ = true;
+            return true;
+        }
+        catch (std::exception const& e)
+        {
+            logger_() << "SmartScopesClient.read_cache(): ignoring invalid cache file "
+                      << c_scopes_cache_dir << c_scopes_cache_filename << ": " << e.what();
+        }
+    }
+
+    // Fall back to the JSON cache written by earlier versions.
+    std::ifstream legacy_file(c_scopes_cache_dir + c_legacy_scopes_cache_filename);
+    if (!legacy_file.fail())
+    {
+        try
+        {
+            cached_scopes_ = parse_remote_scopes(std::string((std::istreambuf_iterator<char>(legacy_file)),
+                                                             std::istreambuf_iterator<char>()));
+            have_latest_cache_ = true;
+            return true;
+        }
+        catch (std::exception const& e)
+        {
+            logger_() << "SmartScopesClient.read_cache(): ignoring invalid cache file "
+                      << c_scopes_cache_dir << c_legacy_scopes_cache_filename << ": " << e.what();
+        }
     }
 
-    return cached_scopes_;
+    return false;
 }
 
 std::string SmartScopesClient::stringify_settings(VariantMap const& settings)
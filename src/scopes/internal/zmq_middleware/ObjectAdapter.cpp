@@ -18,7 +18,9 @@
 
 #include <unity/scopes/internal/zmq_middleware/ObjectAdapter.h>
 
+#include <unity/scopes/internal/Metrics.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
+#include <unity/scopes/internal/lttng/UnityScopes_tp.h>
 #include <unity/scopes/internal/zmq_middleware/ServantBase.h>
 #include <unity/scopes/internal/zmq_middleware/StopPublisher.h>
 #include <unity/scopes/internal/zmq_middleware/Util.h>
@@ -56,6 +58,34 @@ namespace
 
 char const* pump_suffix = "-pump";
 
+struct DispatchMetrics
+{
+    Counter& requests;
+    Counter& bad_requests;
+    Counter& bytes;
+    Histogram& duration;
+};
+
+DispatchMetrics make_dispatch_metrics(string const& labels)
+{
+    auto& r = MetricsRegistry::instance();
+    return DispatchMetrics
+    {
+        r.counter("unity_scopes_adapter_requests_total", "Requests dispatched to servants", labels),
+        r.counter("unity_scopes_adapter_bad_requests_total",
+                  "Requests with an invalid header or for a non-existent object", labels),
+        r.counter("unity_scopes_adapter_received_bytes_total", "Bytes received by object adapters", labels),
+        r.histogram("unity_scopes_adapter_dispatch_duration_seconds", "Time spent in servant dispatch", labels)
+    };
+}
+
+DispatchMetrics& dispatch_metrics(RequestMode m)
+{
+    static DispatchMetrics twoway = make_dispatch_metrics("mode=\"twoway\"");
+    static DispatchMetrics oneway = make_dispatch_metrics("mode=\"oneway\"");
+    return m == RequestMode::Twoway ? twoway : oneway;
+}
+
 }  // namespace
 
 ObjectAdapter::ObjectAdapter(ZmqMiddleware& mw, string const& name, string const& endpoint, RequestMode m,
@@ -283,6 +313,55 @@ shared_ptr<ServantBase> ObjectAdapter::find_dflt_servant(std::string const& cate
     return shared_ptr<ServantBase>();
 }
 
+shared_ptr<ServantBase> ObjectAdapter::find_local(string const& id) const
+{
+    {
+        lock_guard<mutex> lock(state_mutex_);
+        if (state_ != Active)
+        {
+            return nullptr;
+        }
+    }
+    return find(id);
+}
+
+void ObjectAdapter::invoke_local(function<void()> f)
+{
+    ThreadPool* pool;
+    {
+        lock_guard<mutex> lock(state_mutex_);
+        if (state_ != Active)
+        {
+            throw MiddlewareException("ObjectAdapter::invoke_local(): adapter is not active (adapter: " + name_ + ")");
+        }
+        if (!local_invoker_)
+        {
+            local_invoker_.reset(new ThreadPool(1));
+        }
+        pool = local_invoker_.get();
+    }
+    try
+    {
+        if (pool_size_ == 1)
+        {
+            auto call = make_shared<function<void()>>(move(f));
+            pool->submit([this, call]
+            {
+                lock_guard<mutex> lock(serial_dispatch_mutex_);
+                (*call)();
+            });
+        }
+        else
+        {
+            pool->submit(move(f));
+        }
+    }
+    catch (std::runtime_error const&)
+    {
+        throw MiddlewareException("ObjectAdapter::invoke_local(): adapter is shutting down (adapter: " + name_ + ")");
+    }
+}
+
 void ObjectAdapter::activate()
 {
     unique_lock<mutex> lock(state_mutex_);
@@ -603,13 +682,16 @@ void ObjectAdapter::pump(std::promise<void> ready)
                 backend.send(client_address, zmqpp::socket::send_more);
                 backend.send("", zmqpp::socket::send_more);
                 int flag;
+                size_t size = 0;
                 do
                 {
                     string buf;
                     frontend.receive(buf);
+                    size += buf.size();
                     flag = frontend.has_more_parts() ? zmqpp::socket::send_more : zmqpp::socket::normal;
                     backend.send(buf, flag);
                 } while (flag == zmqpp::socket::send_more);
+                simple_tracepoint(unity_scopes, adapter_queue, name_.c_str(), size, ready_workers.size());
             }
             if (shutting_down)
             {
@@ -700,11 +782,18 @@ void ObjectAdapter::dispatch(zmqpp::socket& pump, string const& client_address)
     Current current;
     ZmqReceiver receiver(pump);
     unique_ptr<capnp::SegmentArrayMessageReader> message;
+    size_t size = 0;
+    auto& metrics = dispatch_metrics(mode_);
 
     try
     {
         // Unmarshal the type-independent part of the message (id, category, operation name, mode).
         auto segments = receiver.receive();
+        for (auto const& s : segments)
+        {
+            size += s.size() * sizeof(capnp::word);
+        }
+        metrics.bytes.inc(size);
         message.reset(new capnp::SegmentArrayMessageReader(segments));
         req = message->getRoot<capnproto::Request>();
 
@@ -712,11 +801,13 @@ void ObjectAdapter::dispatch(zmqpp::socket& pump, string const& client_address)
         current.id = req.getId().cStr();
         current.category = req.getCat().cStr();
         current.op_name = req.getOpName().cStr();
+        current.trace = TraceContext{ req.getTraceId(), req.getSpanId(), req.getParentSpanId() };
         auto mode = req.getMode();
         if (current.id.empty() || current.op_name.empty() ||
             (mode != capnproto::RequestMode::TWOWAY && mode != capnproto::RequestMode::ONEWAY))
         {
             // Something is wrong with the request header.
+            metrics.bad_requests.inc();
             if (mode_ == RequestMode::Twoway)
             {
                 pump.send(client_address, zmqpp::socket::send_more);
@@ -735,6 +826,7 @@ void ObjectAdapter::dispatch(zmqpp::socket& pump, string const& client_address)
         auto expected_mode = mode_ == RequestMode::Twoway ? capnproto::RequestMode::TWOWAY : capnproto::RequestMode::ONEWAY;
         if (mode != expected_mode) // Can't do oneway on a twoway adapter and vice-versa.
         {
+            metrics.bad_requests.inc();
             if (mode_ == RequestMode::Twoway)
             {
                 pump.send(client_address, zmqpp::socket::send_more);
@@ -757,6 +849,7 @@ void ObjectAdapter::dispatch(zmqpp::socket& pump, string const& client_address)
     catch (std::exception const& e)
     {
         // We get here if header unmarshaling failed.
+        metrics.bad_requests.inc();
         ostringstream s;
         s << "ObjectAdapter: error unmarshaling request header "
           << "(id: " << current.id << ", adapter: " << name_ << ", op: " << current.op_name << "): " << e.what();
@@ -788,6 +881,7 @@ void ObjectAdapter::dispatch(zmqpp::socket& pump, string const& client_address)
 
     if (!servant)
     {
+        metrics.bad_requests.inc();
         if (mode_ == RequestMode::Twoway)
         {
             pump.send(client_address, zmqpp::socket::send_more);
@@ -805,7 +899,21 @@ void ObjectAdapter::dispatch(zmqpp::socket& pump, string const& client_address)
     capnp::MallocMessageBuilder b;
     auto r = b.initRoot<capnproto::Response>();
     trace_dispatch(current);
-    servant->safe_dispatch_(current, in_params, r); // noexcept
+    simple_tracepoint(unity_scopes, adapter_dispatch_start,
+                      name_.c_str(), current.id.c_str(), current.op_name.c_str(), size);
+    metrics.requests.inc();
+    auto const start = chrono::steady_clock::now();
+    {
+        unique_lock<mutex> lock(serial_dispatch_mutex_, defer_lock);
+        if (pool_size_ == 1)
+        {
+            lock.lock();  // Local invocations must not run concurrently with this one.
+        }
+        servant->safe_dispatch_(current, in_params, r); // noexcept
+    }
+    metrics.duration.record(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start));
+    simple_tracepoint(unity_scopes, adapter_dispatch_end,
+                      name_.c_str(), current.id.c_str(), current.op_name.c_str());
     if (mode_ == RequestMode::Twoway)
     {
         logger()(LoggerChannel::IPC) << decode_status(b.getRoot<capnproto::Response>());
@@ -818,6 +926,15 @@ void ObjectAdapter::dispatch(zmqpp::socket& pump, string const& client_address)
 void ObjectAdapter::cleanup()
 {
     join_with_all_threads();
+    ThreadPool* local_invoker;
+    {
+        lock_guard<mutex> lock(state_mutex_);
+        local_invoker = local_invoker_.get();  // No new pool can be created once we are no longer active.
+    }
+    if (local_invoker)
+    {
+        local_invoker->destroy_once_empty();  // Local invocations that are already queued still run.
+    }
     {
         // Need a full fence here to make sure this thread sees up-to-date
         // memory for servants_ and dflt_servants_.
@@ -856,6 +973,11 @@ unity::scopes::internal::Logger& ObjectAdapter::logger() const
     return mw_.runtime() ? mw_.runtime()->logger() : *test_logger_;
 }
 
+TraceLog* ObjectAdapter::trace_log() const
+{
+    return mw_.runtime() ? mw_.runtime()->trace_log() : nullptr;
+}
+
 void ObjectAdapter::trace_dispatch(Current const& c)
 {
     logger()(LoggerChannel::IPC)
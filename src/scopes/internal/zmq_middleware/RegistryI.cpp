@@ -58,6 +58,8 @@ interface Registry
 {
     ScopeMetadata get_metadata(string scope_id) throws NotFoundException;
     MetadataMap list();
+    MetadataMap find_by_keywords(set<string> keywords);
+    MetadataMap children_of(string scope_id) throws NotFoundException;
     ObjectProxy locate(string identity) throws NotFoundException, RegistryException;
 };
 
@@ -66,9 +68,29 @@ interface Registry
 using namespace std;
 namespace ph = std::placeholders;
 
+namespace
+{
+
+void to_metadata_dict(MetadataMap const& metadata_map, capnproto::ValueDict::Builder& b)
+{
+    auto dict = b.initPairs(metadata_map.size());
+    int i = 0;
+    for (auto& pair : metadata_map)
+    {
+        dict[i].setName(pair.first.c_str());        // Scope ID
+        auto md = dict[i].initValue().initDictVal();
+        to_value_dict(pair.second.serialize(), md); // Scope metadata
+        ++i;
+    }
+}
+
+} // namespace
+
 RegistryI::RegistryI(RegistryObjectBase::SPtr const& ro) :
     ServantBase(ro, { { "get_metadata", bind(&RegistryI::get_metadata_, this, ph::_1, ph::_2, ph::_3) },
                       { "list", bind(&RegistryI::list_, this, ph::_1, ph::_2, ph::_3) },
+                      { "find_by_keywords", bind(&RegistryI::find_by_keywords_, this, ph::_1, ph::_2, ph::_3) },
+                      { "children_of", bind(&RegistryI::children_of_, this, ph::_1, ph::_2, ph::_3) },
                       { "locate", bind(&RegistryI::locate_, this, ph::_1, ph::_2, ph::_3) },
                       { "is_scope_running", bind(&RegistryI::is_scope_running_, this, ph::_1, ph::_2, ph::_3) } })
 
@@ -110,14 +132,48 @@ void RegistryI::list_(Current const&,
     auto metadata_map = delegate->list();
     r.setStatus(capnproto::ResponseStatus::SUCCESS);
     auto list_response = r.initPayload().getAs<capnproto::Registry::ListResponse>();
-    auto dict = list_response.initReturnValue().initPairs(metadata_map.size());
-    int i = 0;
-    for (auto& pair : metadata_map)
+    auto dict = list_response.initReturnValue();
+    to_metadata_dict(metadata_map, dict);
+}
+
+void RegistryI::find_by_keywords_(Current const&,
+                                  capnp::AnyPointer::Reader& in_params,
+                                  capnproto::Response::Builder& r)
+{
+    auto req = in_params.getAs<capnproto::Registry::FindByKeywordsRequest>();
+    set<string> keywords;
+    for (auto const& k : req.getKeywords())
     {
-        dict[i].setName(pair.first.c_str());        // Scope ID
-        auto md = dict[i].initValue().initDictVal();
-        to_value_dict(pair.second.serialize(), md); // Scope metadata
-        ++i;
+        keywords.insert(k.cStr());
+    }
+    auto delegate = dynamic_pointer_cast<RegistryObjectBase>(del());
+    auto metadata_map = delegate->find_by_keywords(keywords);
+    r.setStatus(capnproto::ResponseStatus::SUCCESS);
+    auto find_response = r.initPayload().getAs<capnproto::Registry::FindByKeywordsResponse>();
+    auto dict = find_response.initReturnValue();
+    to_metadata_dict(metadata_map, dict);
+}
+
+void RegistryI::children_of_(Current const&,
+                             capnp::AnyPointer::Reader& in_params,
+                             capnproto::Response::Builder& r)
+{
+    auto req = in_params.getAs<capnproto::Registry::ChildrenOfRequest>();
+    string scope_id = req.getIdentity().cStr();
+    auto delegate = dynamic_pointer_cast<RegistryObjectBase>(del());
+    try
+    {
+        auto metadata_map = delegate->children_of(scope_id);
+        r.setStatus(capnproto::ResponseStatus::SUCCESS);
+        auto children_of_response = r.initPayload().getAs<capnproto::Registry::ChildrenOfResponse>().initResponse();
+        auto dict = children_of_response.initReturnValue();
+        to_metadata_dict(metadata_map, dict);
+    }
+    catch (NotFoundException const& e)
+    {
+        r.setStatus(capnproto::ResponseStatus::USER_EXCEPTION);
+        auto children_of_response = r.initPayload().getAs<capnproto::Registry::ChildrenOfResponse>().initResponse();
+        children_of_response.initNotFoundException().setIdentity(e.name().c_str());
     }
 }
 
@@ -19,6 +19,9 @@
 #include <unity/scopes/internal/zmq_middleware/ReplyI.h>
 
 #include <scopes/internal/zmq_middleware/capnproto/Reply.capnp.h>
+#include <unity/scopes/internal/CompletionDetailsImpl.h>
+#include <unity/scopes/internal/lttng/UnityScopes_tp.h>
+#include <unity/scopes/internal/ReplyObject.h>
 #include <unity/scopes/internal/zmq_middleware/ObjectAdapter.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqReply.h>
 #include <unity/scopes/internal/zmq_middleware/VariantConverter.h>
@@ -50,6 +53,19 @@ interface Reply
 using namespace std;
 namespace ph = std::placeholders;
 
+namespace
+{
+
+// Returns the id of the scope the query was sent to, if known.
+
+string origin_scope_id(ReplyObjectBase const* ro)
+{
+    auto reply_object = dynamic_cast<ReplyObject const*>(ro);
+    return reply_object ? reply_object->origin_scope_id() : string();
+}
+
+}
+
 ReplyI::ReplyI(ReplyObjectBase::SPtr const& ro) :
     ServantBase(ro, { { "push", bind(&ReplyI::push_, this, ph::_1, ph::_2, ph::_3) },
                       { "finished", bind(&ReplyI::finished_, this, ph::_1, ph::_2, ph::_3) },
@@ -61,17 +77,21 @@ ReplyI::~ReplyI()
 {
 }
 
-void ReplyI::push_(Current const&,
+void ReplyI::push_(Current const& current,
                    capnp::AnyPointer::Reader& in_params,
                    capnproto::Response::Builder&)
 {
     auto req = in_params.getAs<capnproto::Reply::PushRequest>();
     auto result = req.getResult();
     auto delegate = dynamic_pointer_cast<ReplyObjectBase>(del());
+    simple_tracepoint(unity_scopes, reply_arrived,
+                      current.id.c_str(),
+                      origin_scope_id(delegate.get()).c_str(),
+                      req.totalSize().wordCount * sizeof(capnp::word));
     delegate->push(to_variant_map(result));
 }
 
-void ReplyI::finished_(Current const&,
+void ReplyI::finished_(Current const& current,
                        capnp::AnyPointer::Reader& in_params,
                        capnproto::Response::Builder&)
 {
@@ -106,7 +126,32 @@ void ReplyI::finished_(Current const&,
             status = CompletionDetails::Error; // LCOV_EXCL_LINE
         }
     }
-    delegate->finished(CompletionDetails(status, msg));
+
+    QueryTimingsImpl timings;
+    timings.set_scope_id(req.getScopeId().cStr());
+    if (req.getRunStart() != 0)
+    {
+        timings.set_run_start_time(chrono::system_clock::time_point(chrono::microseconds(req.getRunStart())));
+    }
+    timings.set_byte_count(req.getPushBytes());
+    if (req.hasSubqueries())
+    {
+        auto const subqueries = to_variant_map(req.getSubqueries());
+        auto const it = subqueries.find("subqueries");
+        if (it != subqueries.end())
+        {
+            for (auto const& sq : it->second.get_array())
+            {
+                timings.add_subquery(QueryTimingsImpl::create(sq.get_dict()));
+            }
+        }
+    }
+
+    CompletionDetails details(status, msg);
+    CompletionDetailsImpl::impl(details)->set_timings(timings);
+
+    simple_tracepoint(unity_scopes, reply_finished, current.id.c_str(), status);
+    delegate->finished(details);
 }
 
 void ReplyI::info_(Current const&,
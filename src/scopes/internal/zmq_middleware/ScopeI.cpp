@@ -131,8 +131,10 @@ void ScopeI::activate_(Current const& current,
                                            proxy.getCategory().cStr()));
     auto delegate = dynamic_pointer_cast<ScopeObjectBase>(del());
     assert(delegate);
+    auto context = to_variant_map(req.getContext());
     auto ctrl_proxy = dynamic_pointer_cast<ZmqQueryCtrl>(delegate->activate(result,
                                                                             metadata,
+                                                                            context,
                                                                             reply_proxy,
                                                                             to_info(current)));
     assert(ctrl_proxy);
@@ -189,8 +191,10 @@ void ScopeI::preview_(Current const& current,
                                            proxy.getCategory().cStr()));
     auto delegate = dynamic_pointer_cast<ScopeObjectBase>(del());
     assert(delegate);
+    auto context = to_variant_map(req.getContext());
     auto ctrl_proxy = dynamic_pointer_cast<ZmqQueryCtrl>(delegate->preview(result,
                                                                            metadata,
+                                                                           context,
                                                                            reply_proxy,
                                                                            to_info(current)));
     assert(ctrl_proxy);
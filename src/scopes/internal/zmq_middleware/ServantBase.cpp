@@ -18,6 +18,7 @@
 
 #include <unity/scopes/internal/zmq_middleware/ServantBase.h>
 
+#include <unity/scopes/internal/TraceLog.h>
 #include <unity/scopes/internal/zmq_middleware/ObjectAdapter.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqException.h>
 #include <unity/Exception.h>
@@ -67,6 +68,11 @@ void ServantBase::dispatch_(Current const& current,
         return;
     }
     auto dispatch_func = it->second;
+
+    // The request's span becomes the current context while we dispatch, so any requests
+    // the servant sends (from this thread) become its children.
+    TraceSpan span(current.adapter ? current.adapter->trace_log() : nullptr, current.trace, current.op_name, current.id);
+
     dispatch_func(current, in_params, r);
 }
 
@@ -20,6 +20,7 @@
 
 #include <unity/scopes/internal/DfltConfig.h>
 #include <unity/scopes/ScopeExceptions.h>
+#include <unity/UnityExceptions.h>
 
 #include <stdlib.h>
 #include <unistd.h>
@@ -45,6 +46,7 @@ namespace
     const string child_scopes_timeout_key = "ChildScopes.Timeout";
     const string registry_endpoint_dir_key = "Registry.EndpointDir";
     const string ss_registry_endpoint_dir_key = "Smartscopes.Registry.EndpointDir";
+    const string direct_dispatch_key = "DirectDispatch";
 }
 
 ZmqConfig::ZmqConfig(string const& configfile) :
@@ -100,6 +102,18 @@ ZmqConfig::ZmqConfig(string const& configfile) :
     registry_endpoint_dir_ = get_optional_string(zmq_config_group, registry_endpoint_dir_key);
     ss_registry_endpoint_dir_ = get_optional_string(zmq_config_group, ss_registry_endpoint_dir_key);
 
+    direct_dispatch_ = true;
+    if (parser())
+    {
+        try
+        {
+            direct_dispatch_ = parser()->get_boolean(zmq_config_group, direct_dispatch_key);
+        }
+        catch (LogicException const&)
+        {
+        }
+    }
+
     KnownEntries const known_entries = {
                                           {  zmq_config_group,
                                              {
@@ -109,7 +123,8 @@ ZmqConfig::ZmqConfig(string const& configfile) :
                                                 registry_timeout_key,
                                                 child_scopes_timeout_key,
                                                 registry_endpoint_dir_key,
-                                                ss_registry_endpoint_dir_key
+                                                ss_registry_endpoint_dir_key,
+                                                direct_dispatch_key
                                              }
                                           }
                                        };
@@ -155,6 +170,11 @@ string ZmqConfig::ss_registry_endpoint_dir() const
     return ss_registry_endpoint_dir_;
 }
 
+bool ZmqConfig::direct_dispatch() const
+{
+    return direct_dispatch_;
+}
+
 } // namespace internal
 
 } // namespace scopes
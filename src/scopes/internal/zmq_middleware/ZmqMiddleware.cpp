@@ -68,6 +68,7 @@ char const* reply_suffix = "-r";     // Appended to server_name_ to create reply
 char const* state_suffix = "-s";     // Appended to server_name_ to create state adapter name
 char const* registry_suffix = "-R";  // Appended to server_name_ to create registry (or SS registry) adapter name
 char const* publisher_suffix = "-p"; // Appended to publisher_id to create a publisher endpoint
+char const* catalog_suffix = "-catalog"; // Appended to registry id to create the scope catalog file name
 
 char const* query_category = "Query";       // query adapter category name
 char const* ctrl_category = "QueryCtrl";    // control adapter category name
@@ -76,6 +77,22 @@ char const* state_category = "State";       // state adapter category name
 char const* scope_category = "Scope";       // scope adapter category name
 char const* registry_category = "Registry"; // registry adapter category name
 
+// All ipc adapters created by any middleware in this process, indexed by endpoint,
+// so a proxy can find out whether its target lives in the same process.
+// (Endpoints are unique because zmq does not allow two sockets to bind to the same ipc endpoint.)
+
+struct LocalAdapters
+{
+    mutex m;
+    map<string, weak_ptr<ObjectAdapter>> adapters;
+};
+
+LocalAdapters& local_adapters()
+{
+    static auto la = new LocalAdapters;  // Never deleted, so it outlives middlewares destroyed during static destruction.
+    return *la;
+}
+
 // Create a directory with the given mode if it doesn't exist yet.
 
 void create_dir(string const& dir, mode_t mode)
@@ -107,6 +124,7 @@ ZmqMiddleware::ZmqMiddleware(string const& server_name, RuntimeImpl* runtime, st
         locate_timeout_ = config.locate_timeout();
         registry_timeout_ = config.registry_timeout();
         child_scopes_timeout_ = config.child_scopes_timeout();
+        direct_dispatch_ = config.direct_dispatch();
         public_endpoint_dir_ = config.endpoint_dir();
         private_endpoint_dir_ = public_endpoint_dir_ + "/priv";
         registry_endpoint_dir_ = public_endpoint_dir_;
@@ -686,7 +704,9 @@ MWScopeProxy ZmqMiddleware::add_scope_object(string const& identity, ScopeObject
     try
     {
         shared_ptr<ScopeI> si(make_shared<ScopeI>(scope));
-        auto adapter = find_adapter(server_name_, private_endpoint_dir_, scope_category, idle_timeout);
+        // The adapter is named after the scope, not the server, so a process hosting
+        // several scopes has a separate endpoint for each of them.
+        auto adapter = find_adapter(identity, private_endpoint_dir_, scope_category, idle_timeout);
         function<void()> df;
         auto p = safe_add(df, adapter, identity, si);
         scope->set_disconnect_function(df);
@@ -775,6 +795,15 @@ std::string ZmqMiddleware::get_query_ctrl_endpoint()
     return "ipc://" + private_endpoint_dir_ + "/" +  server_name_ + ctrl_suffix;
 }
 
+std::string ZmqMiddleware::get_registry_catalog_path()
+{
+    if (registry_identity_.empty())
+    {
+        return "";
+    }
+    return registry_endpoint_dir_ + "/" + registry_identity_ + catalog_suffix;
+}
+
 zmqpp::context* ZmqMiddleware::context() const noexcept
 {
     return const_cast<zmqpp::context*>(&context_);
@@ -819,6 +848,28 @@ int64_t ZmqMiddleware::child_scopes_timeout() const noexcept
     return child_scopes_timeout_;
 }
 
+bool ZmqMiddleware::direct_dispatch() const noexcept
+{
+    return direct_dispatch_;
+}
+
+shared_ptr<ObjectAdapter> ZmqMiddleware::find_local_adapter(string const& endpoint)
+{
+    auto& la = local_adapters();
+    lock_guard<mutex> lock(la.m);
+    auto it = la.adapters.find(endpoint);
+    if (it == la.adapters.end())
+    {
+        return nullptr;
+    }
+    auto adapter = it->second.lock();
+    if (!adapter)
+    {
+        la.adapters.erase(it);
+    }
+    return adapter;
+}
+
 ObjectProxy ZmqMiddleware::make_typed_proxy(string const& endpoint,
                                             string const& identity,
                                             string const& category,
@@ -932,6 +983,12 @@ shared_ptr<ObjectAdapter> ZmqMiddleware::find_adapter(string const& name, string
 
     auto a = make_shared<ObjectAdapter>(*this, name, endpoint, mode, pool_size, idle_timeout);
     am_[name] = a;
+    if (category != query_category)
+    {
+        auto& la = local_adapters();
+        lock_guard<mutex> lock(la.m);
+        la.adapters[endpoint] = a;
+    }
     return a;
 }
 
@@ -18,7 +18,10 @@
 
 #include <unity/scopes/internal/zmq_middleware/ZmqObjectProxy.h>
 
+#include <unity/scopes/internal/Metrics.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
+#include <unity/scopes/internal/TraceContext.h>
+#include <unity/scopes/internal/zmq_middleware/ObjectAdapter.h>
 #include <unity/scopes/internal/zmq_middleware/Util.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqException.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqReceiver.h>
@@ -48,6 +51,34 @@ namespace
 {
     // this mutex protects all members of all ZmqObjectProxies
     std::mutex shared_mutex;
+
+    // Invocations that go over the wire (not those that are dispatched directly to a local servant).
+
+    struct InvocationMetrics
+    {
+        Counter& twoway;
+        Counter& oneway;
+        Counter& oneway_dropped;
+        Counter& timeouts;
+        Histogram& twoway_duration;
+    };
+
+    InvocationMetrics& metrics()
+    {
+        static MetricsRegistry& r = MetricsRegistry::instance();
+        static char const* const help = "Remote invocations sent by proxies";
+        static InvocationMetrics m =
+        {
+            r.counter("unity_scopes_invocations_total", help, "mode=\"twoway\""),
+            r.counter("unity_scopes_invocations_total", help, "mode=\"oneway\""),
+            r.counter("unity_scopes_oneway_invocations_dropped_total",
+                      "Oneway invocations discarded because the peer was not there"),
+            r.counter("unity_scopes_invocation_timeouts_total", "Twoway invocations that timed out"),
+            r.histogram("unity_scopes_twoway_invocation_duration_seconds",
+                        "Round-trip time of twoway invocations that did not time out")
+        };
+        return m;
+    }
 }
 
 ZmqObjectProxy::ZmqObjectProxy(ZmqMiddleware* mw_base,
@@ -161,6 +192,12 @@ capnproto::Request::Builder ZmqObjectProxy::make_request_(capnp::MessageBuilder&
     request.setOpName(operation_name.c_str());
     request.setId(identity_.c_str());
     request.setCat(category_.c_str());
+
+    // The request is a new span within the calling thread's trace (if any).
+    auto const ctx = TraceContext::current().child();
+    request.setTraceId(ctx.trace_id);
+    request.setSpanId(ctx.span_id);
+    request.setParentSpanId(ctx.parent_id);
     return request;
 }
 
@@ -178,14 +215,51 @@ void ZmqObjectProxy::invoke_oneway_(capnp::MessageBuilder& request)
     ZmqSender sender(*s);
     auto segments = request.getSegmentsForOutput();
     trace_request_(request);
+    metrics().oneway.inc();
     if (!sender.send(segments, ZmqSender::DontWait))
     {
         // If there is nothing at the other end, discard the message and trash the socket.
+        metrics().oneway_dropped.inc();
         pool.remove(endpoint_);
         return;
     }
 }
 
+// Returns the servant for this proxy if it lives in the same process (and direct dispatch
+// is enabled), so the caller can bypass marshaling and zmq. Returns nullptr otherwise,
+// in which case the caller must use the normal invocation path. The adapter is remembered,
+// so repeated calls do not have to search the process-wide adapter directory again.
+
+shared_ptr<ServantBase> ZmqObjectProxy::find_local_servant_(shared_ptr<ObjectAdapter>& adapter) const
+{
+    if (!mw_base()->direct_dispatch())
+    {
+        return nullptr;
+    }
+    {
+        lock_guard<mutex> lock(local_adapter_mutex_);
+        adapter = local_adapter_.lock();
+    }
+    if (!adapter)
+    {
+        adapter = ZmqMiddleware::find_local_adapter(endpoint());
+        if (!adapter)
+        {
+            return nullptr;
+        }
+        lock_guard<mutex> lock(local_adapter_mutex_);
+        local_adapter_ = adapter;
+    }
+    auto servant = adapter->find_local(identity());
+    if (!servant)
+    {
+        // The adapter may have been shut down. Look it up again next time.
+        lock_guard<mutex> lock(local_adapter_mutex_);
+        local_adapter_.reset();
+    }
+    return servant;
+}
+
 ZmqObjectProxy::TwowayOutParams ZmqObjectProxy::invoke_twoway_(capnp::MessageBuilder& request)
 {
     return invoke_twoway_(request, timeout_, mw_base()->locate_timeout());
@@ -214,6 +288,11 @@ ZmqObjectProxy::TwowayOutParams ZmqObjectProxy::invoke_twoway_(capnp::MessageBui
     {
         try
         {
+            // We are usually called by a pool thread, so we take the trace context for
+            // the locate() from the caller's span in the request.
+            auto const r = request.getRoot<capnproto::Request>();
+            TraceScope trace_scope(TraceContext{ r.getTraceId(), r.getParentSpanId(), 0 });
+
             ObjectProxy new_proxy;
             new_proxy = registry_proxy->locate(identity(), locate_timeout);
 
@@ -270,6 +349,8 @@ ZmqObjectProxy::TwowayOutParams ZmqObjectProxy::invoke_twoway__(capnp::MessageBu
     ZmqSender sender(s);
     auto segments = request.getSegmentsForOutput();
     trace_request_(request);
+    metrics().twoway.inc();
+    auto const start = chrono::steady_clock::now();
     sender.send(segments);
 
     zmqpp::poller p;
@@ -286,6 +367,7 @@ ZmqObjectProxy::TwowayOutParams ZmqObjectProxy::invoke_twoway__(capnp::MessageBu
 
     if (!p.has_input(s))
     {
+        metrics().timeouts.inc();
         string op_name = request.getRoot<capnproto::Request>().getOpName().cStr();
         throw TimeoutException("Request timed out after " + std::to_string(timeout) + " milliseconds (endpoint = " +
                                endpoint + ", op = " + op_name + ")");
@@ -297,6 +379,7 @@ ZmqObjectProxy::TwowayOutParams ZmqObjectProxy::invoke_twoway__(capnp::MessageBu
     out_params.receiver.reset(new ZmqReceiver(s));
     auto params = out_params.receiver->receive();
     out_params.reader.reset(new capnp::SegmentArrayMessageReader(params));
+    metrics().twoway_duration.record(chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start));
     trace_reply_(request, *out_params.reader);
     return out_params;
     // Outgoing twoway socket closed here.
@@ -44,6 +44,26 @@ namespace internal
 namespace zmq_middleware
 {
 
+namespace
+{
+
+MetadataMap to_metadata_map(capnproto::ValueDict::Reader const& dict, MiddlewareBase* mw)
+{
+    auto list = dict.getPairs();
+    MetadataMap sm;
+    for (size_t i = 0; i < list.size(); ++i)
+    {
+        string scope_id = list[i].getName();
+        VariantMap m = to_variant_map(list[i].getValue().getDictVal());
+        unique_ptr<ScopeMetadataImpl> smdi(new ScopeMetadataImpl(m, mw));
+        ScopeMetadata d(ScopeMetadataImpl::create(move(smdi)));
+        sm.emplace(make_pair(move(scope_id), move(d)));
+    }
+    return sm;
+}
+
+} // namespace
+
 /*
 
 interface Scope;
@@ -59,6 +79,8 @@ interface Registry
 {
     ScopeMetadata get_metadata(string scope_id) throws NotFoundException;
     MetadataMap list();
+    MetadataMap find_by_keywords(set<string> keywords);
+    MetadataMap children_of(string scope_id) throws NotFoundException;
     ObjectProxy locate(string identity) throws NotFoundException, RegistryException;
 };
 
@@ -128,17 +150,63 @@ MetadataMap ZmqRegistry::list()
     throw_if_runtime_exception(response);
 
     auto list_response = response.getPayload().getAs<capnproto::Registry::ListResponse>();
-    auto list = list_response.getReturnValue().getPairs();
-    MetadataMap sm;
-    for (size_t i = 0; i < list.size(); ++i)
+    return to_metadata_map(list_response.getReturnValue(), mw_base());
+}
+
+MetadataMap ZmqRegistry::find_by_keywords(std::set<std::string> const& keywords)
+{
+    capnp::MallocMessageBuilder request_builder;
+    auto request = make_request_(request_builder, "find_by_keywords");
+    auto in_params = request.initInParams().getAs<capnproto::Registry::FindByKeywordsRequest>();
+    auto kw = in_params.initKeywords(keywords.size());
+    int i = 0;
+    for (auto const& k : keywords)
     {
-        string scope_id = list[i].getName();
-        VariantMap m = to_variant_map(list[i].getValue().getDictVal());
-        unique_ptr<ScopeMetadataImpl> smdi(new ScopeMetadataImpl(m, mw_base()));
-        ScopeMetadata d(ScopeMetadataImpl::create(move(smdi)));
-        sm.emplace(make_pair(move(scope_id), move(d)));
+        kw.set(i++, k.c_str());
+    }
+
+    // Registry operations can be slow during start-up of the phone
+    int64_t timeout = mw_base()->registry_timeout();
+    auto future = mw_base()->twoway_pool()->submit([&] { return this->invoke_twoway_(request_builder, timeout); });
+    auto out_params = future.get();
+    auto response = out_params.reader->getRoot<capnproto::Response>();
+    throw_if_runtime_exception(response);
+
+    auto find_response = response.getPayload().getAs<capnproto::Registry::FindByKeywordsResponse>();
+    return to_metadata_map(find_response.getReturnValue(), mw_base());
+}
+
+MetadataMap ZmqRegistry::children_of(std::string const& scope_id)
+{
+    capnp::MallocMessageBuilder request_builder;
+    auto request = make_request_(request_builder, "children_of");
+    auto in_params = request.initInParams().getAs<capnproto::Registry::ChildrenOfRequest>();
+    in_params.setIdentity(scope_id.c_str());
+
+    // Registry operations can be slow during start-up of the phone
+    int64_t timeout = mw_base()->registry_timeout();
+    auto future = mw_base()->twoway_pool()->submit([&] { return this->invoke_twoway_(request_builder, timeout); });
+    auto out_params = future.get();
+    auto response = out_params.reader->getRoot<capnproto::Response>();
+    throw_if_runtime_exception(response);
+
+    auto children_of_response = response.getPayload().getAs<capnproto::Registry::ChildrenOfResponse>().getResponse();
+    switch (children_of_response.which())
+    {
+        case capnproto::Registry::ChildrenOfResponse::Response::RETURN_VALUE:
+        {
+            return to_metadata_map(children_of_response.getReturnValue(), mw_base());
+        }
+        case capnproto::Registry::ChildrenOfResponse::Response::NOT_FOUND_EXCEPTION:
+        {
+            auto ex = children_of_response.getNotFoundException();
+            throw NotFoundException("Registry::children_of(): no such scope", ex.getIdentity().cStr());
+        }
+        default:
+        {
+            throw MiddlewareException("Registry::children_of(): unknown user exception");
+        }
     }
-    return sm;
 }
 
 ObjectProxy ZmqRegistry::locate(std::string const& identity, int64_t timeout)
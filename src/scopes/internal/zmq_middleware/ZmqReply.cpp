@@ -17,8 +17,16 @@
  */
 
 #include <unity/scopes/internal/zmq_middleware/ZmqReply.h>
-#include <unity/scopes/internal/zmq_middleware/VariantConverter.h>
+
 #include <scopes/internal/zmq_middleware/capnproto/Reply.capnp.h>
+#include <unity/scopes/internal/CompletionDetailsImpl.h>
+#include <unity/scopes/internal/lttng/UnityScopes_tp.h>
+#include <unity/scopes/internal/ReplyObjectBase.h>
+#include <unity/scopes/internal/RuntimeImpl.h>
+#include <unity/scopes/internal/TraceLog.h>
+#include <unity/scopes/internal/zmq_middleware/ObjectAdapter.h>
+#include <unity/scopes/internal/zmq_middleware/ServantBase.h>
+#include <unity/scopes/internal/zmq_middleware/VariantConverter.h>
 
 using namespace std;
 
@@ -44,10 +52,24 @@ interface Reply
 
 */
 
+namespace
+{
+
+// Returns the id of the scope that is sending the reply.
+
+string scope_id_of(ZmqMiddleware const* mw)
+{
+    auto rt = mw->runtime();
+    return rt ? rt->scope_id() : string();
+}
+
+}
+
 ZmqReply::ZmqReply(ZmqMiddleware* mw_base, string const& endpoint, string const& identity, string const& category) :
     MWObjectProxy(mw_base),
     ZmqObjectProxy(mw_base, endpoint, identity, category, RequestMode::Oneway),
-    MWReply(mw_base)
+    MWReply(mw_base),
+    is_local_(false)
 {
 }
 
@@ -57,6 +79,12 @@ ZmqReply::~ZmqReply()
 
 void ZmqReply::push(VariantMap const& result)
 {
+    if (invoke_local_("push", [result](ReplyObjectBase& ro) { ro.push(result); }))
+    {
+        simple_tracepoint(unity_scopes, reply_push, identity().c_str(), scope_id_of(mw_base()).c_str(), 0);
+        return;
+    }
+
     capnp::MallocMessageBuilder request_builder;
     auto request = make_request_(request_builder, "push");
     auto in_params = request.initInParams().getAs<capnproto::Reply::PushRequest>();
@@ -64,12 +92,33 @@ void ZmqReply::push(VariantMap const& result)
     auto resultBuilder = in_params.getResult();
     to_value_dict(result, resultBuilder);
 
+    simple_tracepoint(unity_scopes, reply_push,
+                      identity().c_str(),
+                      scope_id_of(mw_base()).c_str(),
+                      in_params.asReader().totalSize().wordCount * sizeof(capnp::word));
+
+    size_t bytes = 0;
+    for (auto const& s : request_builder.getSegmentsForOutput())
+    {
+        bytes += s.size() * sizeof(capnp::word);
+    }
+    add_push_bytes(bytes);
+
     auto future = mw_base()->oneway_pool()->submit([&] { return this->invoke_oneway_(request_builder); });
     future.get();
 }
 
 void ZmqReply::finished(CompletionDetails const& details)
 {
+    auto const timings = this->timings();
+
+    CompletionDetails local_details(details);
+    CompletionDetailsImpl::impl(local_details)->set_timings(timings);
+    if (invoke_local_("finished", [local_details](ReplyObjectBase& ro) { ro.finished(local_details); }))
+    {
+        return;
+    }
+
     capnp::MallocMessageBuilder request_builder;
     auto request = make_request_(request_builder, "finished");
     auto in_params = request.initInParams().getAs<capnproto::Reply::FinishedRequest>();
@@ -100,12 +149,36 @@ void ZmqReply::finished(CompletionDetails const& details)
     in_params.setStatus(s);
     in_params.setMessage(details.message());
 
+    in_params.setScopeId(timings.scope_id());
+    if (timings.run_start_time() != chrono::system_clock::time_point())
+    {
+        auto const since_epoch = timings.run_start_time().time_since_epoch();
+        in_params.setRunStart(chrono::duration_cast<chrono::microseconds>(since_epoch).count());
+    }
+    in_params.setPushBytes(timings.byte_count());
+    auto const subqueries = timings.subqueries();
+    if (!subqueries.empty())
+    {
+        VariantArray va;
+        for (auto const& sq : subqueries)
+        {
+            va.push_back(Variant(QueryTimingsImpl::serialize(sq)));
+        }
+        auto subqueries_builder = in_params.initSubqueries();
+        to_value_dict(VariantMap{ { "subqueries", Variant(va) } }, subqueries_builder);
+    }
+
     auto future = mw_base()->oneway_pool()->submit([&] { return this->invoke_oneway_(request_builder); });
     future.get();
 }
 
 void ZmqReply::info(OperationInfo const& op_info)
 {
+    if (invoke_local_("info", [op_info](ReplyObjectBase& ro) { ro.info(op_info); }))
+    {
+        return;
+    }
+
     capnp::MallocMessageBuilder request_builder;
     auto request = make_request_(request_builder, "info");
     auto in_params = request.initInParams().getAs<capnproto::Reply::InfoRequest>();
@@ -117,6 +190,60 @@ void ZmqReply::info(OperationInfo const& op_info)
     future.get();
 }
 
+// If the reply object lives in this process, queues the invocation on the reply adapter's
+// local invoker thread and returns true. Like a oneway invocation via zmq, the call returns
+// without waiting for the reply object, and invocations arrive in the order they were sent.
+// Returns false if the invocation must be sent via zmq.
+//
+// The decision is made on the first invocation and sticks for the lifetime of the proxy,
+// so push(), info() and finished() for a query never take different paths (which could
+// reorder them). If the reply object or its adapter have gone away since, the invocation
+// is discarded, just as a oneway invocation via zmq is discarded if nothing is listening.
+
+bool ZmqReply::invoke_local_(string const& op_name, function<void(ReplyObjectBase&)> f)
+{
+    call_once(local_once_, [this]
+    {
+        shared_ptr<ObjectAdapter> adapter;
+        if (auto servant = find_local_servant_(adapter))
+        {
+            auto delegate = dynamic_pointer_cast<ReplyObjectBase>(servant->del());
+            assert(delegate);
+            reply_adapter_ = adapter;
+            reply_object_ = delegate;
+            is_local_ = true;
+        }
+    });
+    if (!is_local_)
+    {
+        return false;
+    }
+
+    auto adapter = reply_adapter_.lock();
+    auto delegate = reply_object_.lock();
+    if (!adapter || !delegate)
+    {
+        return true;
+    }
+    try
+    {
+        auto call = make_shared<function<void(ReplyObjectBase&)>>(move(f));  // Avoids copying the arguments again
+        auto const trace = TraceContext::current().child();
+        TraceLog* const log = adapter->trace_log();
+        string const id = identity();
+        adapter->invoke_local([delegate, call, log, trace, op_name, id]
+        {
+            TraceSpan span(log, trace, op_name, id);
+            (*call)(*delegate);
+        });
+    }
+    catch (MiddlewareException const&)
+    {
+        // The adapter is shutting down, so the invocation is discarded.
+    }
+    return true;
+}
+
 } // namespace zmq_middleware
 
 } // namespace internal
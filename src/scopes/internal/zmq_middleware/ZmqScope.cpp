@@ -20,9 +20,17 @@
 
 #include <scopes/internal/zmq_middleware/capnproto/Scope.capnp.h>
 #include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/internal/ActionMetadataImpl.h>
+#include <unity/scopes/internal/InvokeInfo.h>
 #include <unity/scopes/internal/QueryCtrlImpl.h>
+#include <unity/scopes/internal/ResultImpl.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
 #include <unity/scopes/internal/ScopeMetadataImpl.h>
+#include <unity/scopes/internal/ScopeObjectBase.h>
+#include <unity/scopes/internal/SearchMetadataImpl.h>
+#include <unity/scopes/internal/TraceLog.h>
+#include <unity/scopes/internal/zmq_middleware/ObjectAdapter.h>
+#include <unity/scopes/internal/zmq_middleware/ServantBase.h>
 #include <unity/scopes/internal/zmq_middleware/VariantConverter.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqException.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqQueryCtrl.h>
@@ -84,8 +92,19 @@ QueryCtrlProxy ZmqScope::search(CannedQuery const& query,
                                 VariantMap const& context,
                                 MWReplyProxy const& reply)
 {
-    capnp::MallocMessageBuilder request_builder;
     auto reply_proxy = dynamic_pointer_cast<ZmqReply>(reply);
+
+    shared_ptr<ObjectAdapter> adapter;
+    if (auto servant = find_local_servant_(adapter))
+    {
+        return invoke_local_(servant, adapter, reply_proxy, "search",
+                             [=](ScopeObjectBase& so, MWReplyProxy const& r, InvokeInfo const& info)
+                             {
+                                 return so.search(query, SearchMetadataImpl::create(hints), context, r, info);
+                             });
+    }
+
+    capnp::MallocMessageBuilder request_builder;
     {
         auto request = make_request_(request_builder, "search");
         auto in_params = request.initInParams().getAs<capnproto::Scope::CreateQueryRequest>();
@@ -115,10 +134,28 @@ QueryCtrlProxy ZmqScope::search(CannedQuery const& query,
     return make_shared<QueryCtrlImpl>(p, reply_proxy);
 }
 
-QueryCtrlProxy ZmqScope::activate(VariantMap const& result, VariantMap const& hints, MWReplyProxy const& reply)
+QueryCtrlProxy ZmqScope::activate(VariantMap const& result,
+                                  VariantMap const& hints,
+                                  VariantMap const& context,
+                                  MWReplyProxy const& reply)
 {
-    capnp::MallocMessageBuilder request_builder;
     auto reply_proxy = dynamic_pointer_cast<ZmqReply>(reply);
+
+    shared_ptr<ObjectAdapter> adapter;
+    if (auto servant = find_local_servant_(adapter))
+    {
+        return invoke_local_(servant, adapter, reply_proxy, "activate",
+                             [=](ScopeObjectBase& so, MWReplyProxy const& r, InvokeInfo const& info)
+                             {
+                                 return so.activate(ResultImpl::create_result(result),
+                                                    ActionMetadataImpl::create(hints),
+                                                    context,
+                                                    r,
+                                                    info);
+                             });
+    }
+
+    capnp::MallocMessageBuilder request_builder;
     {
         auto request = make_request_(request_builder, "activate");
         auto in_params = request.initInParams().getAs<capnproto::Scope::ActivationRequest>();
@@ -129,6 +166,8 @@ QueryCtrlProxy ZmqScope::activate(VariantMap const& result, VariantMap const& hi
         auto p = in_params.initReplyProxy();
         p.setEndpoint(reply_proxy->endpoint().c_str());
         p.setIdentity(reply_proxy->identity().c_str());
+        auto d = in_params.initContext();
+        to_value_dict(context, d);
     }
 
     auto future = mw_base()->twoway_pool()->submit([&] { return this->invoke_scope_(request_builder); });
@@ -148,8 +187,24 @@ QueryCtrlProxy ZmqScope::activate(VariantMap const& result, VariantMap const& hi
 QueryCtrlProxy ZmqScope::perform_action(VariantMap const& result,
         VariantMap const& hints, std::string const& widget_id, std::string const& action_id, MWReplyProxy const& reply)
 {
-    capnp::MallocMessageBuilder request_builder;
     auto reply_proxy = dynamic_pointer_cast<ZmqReply>(reply);
+
+    shared_ptr<ObjectAdapter> adapter;
+    if (auto servant = find_local_servant_(adapter))
+    {
+        return invoke_local_(servant, adapter, reply_proxy, "perform_action",
+                             [=](ScopeObjectBase& so, MWReplyProxy const& r, InvokeInfo const& info)
+                             {
+                                 return so.perform_action(ResultImpl::create_result(result),
+                                                          ActionMetadataImpl::create(hints),
+                                                          widget_id,
+                                                          action_id,
+                                                          r,
+                                                          info);
+                             });
+    }
+
+    capnp::MallocMessageBuilder request_builder;
     {
         auto request = make_request_(request_builder, "perform_action");
         auto in_params = request.initInParams().getAs<capnproto::Scope::ActionActivationRequest>();
@@ -183,8 +238,23 @@ QueryCtrlProxy ZmqScope::activate_result_action(VariantMap const& result,
         std::string const& action_id,
         MWReplyProxy const& reply)
 {
-    capnp::MallocMessageBuilder request_builder;
     auto reply_proxy = dynamic_pointer_cast<ZmqReply>(reply);
+
+    shared_ptr<ObjectAdapter> adapter;
+    if (auto servant = find_local_servant_(adapter))
+    {
+        return invoke_local_(servant, adapter, reply_proxy, "activate_result_action",
+                             [=](ScopeObjectBase& so, MWReplyProxy const& r, InvokeInfo const& info)
+                             {
+                                 return so.activate_result_action(ResultImpl::create_result(result),
+                                                                  ActionMetadataImpl::create(hints),
+                                                                  action_id,
+                                                                  r,
+                                                                  info);
+                             });
+    }
+
+    capnp::MallocMessageBuilder request_builder;
     {
         auto request = make_request_(request_builder, "activate_result_action");
         auto in_params = request.initInParams().getAs<capnproto::Scope::ResultActionActivationRequest>();
@@ -212,10 +282,28 @@ QueryCtrlProxy ZmqScope::activate_result_action(VariantMap const& result,
     return make_shared<QueryCtrlImpl>(p, reply_proxy);
 }
 
-QueryCtrlProxy ZmqScope::preview(VariantMap const& result, VariantMap const& hints, MWReplyProxy const& reply)
+QueryCtrlProxy ZmqScope::preview(VariantMap const& result,
+                                 VariantMap const& hints,
+                                 VariantMap const& context,
+                                 MWReplyProxy const& reply)
 {
-    capnp::MallocMessageBuilder request_builder;
     auto reply_proxy = dynamic_pointer_cast<ZmqReply>(reply);
+
+    shared_ptr<ObjectAdapter> adapter;
+    if (auto servant = find_local_servant_(adapter))
+    {
+        return invoke_local_(servant, adapter, reply_proxy, "preview",
+                             [=](ScopeObjectBase& so, MWReplyProxy const& r, InvokeInfo const& info)
+                             {
+                                 return so.preview(ResultImpl::create_result(result),
+                                                   ActionMetadataImpl::create(hints),
+                                                   context,
+                                                   r,
+                                                   info);
+                             });
+    }
+
+    capnp::MallocMessageBuilder request_builder;
     {
         auto request = make_request_(request_builder, "preview");
         auto in_params = request.initInParams().getAs<capnproto::Scope::PreviewRequest>();
@@ -226,6 +314,8 @@ QueryCtrlProxy ZmqScope::preview(VariantMap const& result, VariantMap const& hin
         auto p = in_params.initReplyProxy();
         p.setEndpoint(reply_proxy->endpoint().c_str());
         p.setIdentity(reply_proxy->identity().c_str());
+        auto d = in_params.initContext();
+        to_value_dict(context, d);
     }
 
     auto future = mw_base()->twoway_pool()->submit([&] { return this->invoke_scope_(request_builder); });
@@ -363,6 +453,73 @@ ZmqObjectProxy::TwowayOutParams ZmqScope::invoke_scope_(capnp::MessageBuilder& i
     return this->invoke_twoway_(in_params, timeout);
 }
 
+// Dispatches a query-creating operation directly to a scope servant in this process.
+// The scope sees the same things as for a remote invocation: the call runs on the scope
+// adapter's invoker thread, serialized with the remote invocations, the reply proxy and InvokeInfo refer to the scope's own middleware, the caller
+// gets a TimeoutException if the scope does not respond in time, and any exception from
+// the scope arrives at the caller as a MiddlewareException. The task owns copies of its
+// arguments because it may still be running after a timeout.
+
+QueryCtrlProxy ZmqScope::invoke_local_(shared_ptr<ServantBase> const& servant,
+                                       shared_ptr<ObjectAdapter> const& adapter,
+                                       ZmqReplyProxy const& reply_proxy,
+                                       string const& op_name,
+                                       LocalInvocation f)
+{
+    auto delegate = dynamic_pointer_cast<ScopeObjectBase>(servant->del());
+    assert(delegate);
+
+    MiddlewareBase* server_mw = adapter->mw();
+    MWReplyProxy server_reply(new ZmqReply(adapter->mw(),
+                                           reply_proxy->endpoint(),
+                                           reply_proxy->identity(),
+                                           reply_proxy->target_category()));
+    string const id = identity();
+    auto invocation = make_shared<LocalInvocation>(move(f));
+    auto const trace = TraceContext::current().child();
+    TraceLog* const log = adapter->trace_log();
+
+    MWQueryCtrlProxy ctrl;
+    try
+    {
+        auto task = make_shared<packaged_task<MWQueryCtrlProxy()>>(
+            [delegate, server_reply, server_mw, id, invocation, log, trace, op_name]
+            {
+                TraceSpan span(log, trace, op_name, id);
+                return (*invocation)(*delegate, server_reply, InvokeInfo{ id, server_mw });
+            });
+        auto future = task->get_future();
+        adapter->invoke_local([task] { (*task)(); });
+        int64_t t = delegate->debug_mode() ? -1 : timeout();
+        if (t != -1 && future.wait_for(chrono::milliseconds(t)) != future_status::ready)
+        {
+            throw TimeoutException("Request timed out after " + std::to_string(t) + " milliseconds (endpoint = " +
+                                   endpoint() + ", op = " + op_name + ")");
+        }
+        ctrl = future.get();
+    }
+    catch (TimeoutException const&)
+    {
+        throw;
+    }
+    catch (std::exception const& e)
+    {
+        throw MiddlewareException(e.what());
+    }
+    catch (...)
+    {
+        throw MiddlewareException("unknown exception");
+    }
+
+    auto ctrl_proxy = dynamic_pointer_cast<ZmqQueryCtrl>(ctrl);
+    assert(ctrl_proxy);
+    ZmqQueryCtrlProxy p(new ZmqQueryCtrl(mw_base(),
+                                         ctrl_proxy->endpoint(),
+                                         ctrl_proxy->identity(),
+                                         ctrl_proxy->target_category()));
+    return make_shared<QueryCtrlImpl>(p, reply_proxy);
+}
+
 } // namespace zmq_middleware
 
 } // namespace internal
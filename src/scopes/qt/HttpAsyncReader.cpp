@@ -19,6 +19,8 @@
 #include <unity/scopes/qt/HttpAsyncReader.h>
 #include <core/net/uri.h>
 
+#include <poll.h>
+
 namespace http = core::net::http;
 using namespace unity::scopes::qt;
 
@@ -36,6 +38,7 @@ public:
                       client_->run();
                   }}
         , cancelled_(false)
+        , cancel_fd_(-1)
     {
     }
 
@@ -53,6 +56,8 @@ public:
     std::thread worker_;
 
     std::atomic<bool> cancelled_;
+
+    std::atomic<int> cancel_fd_;
 };
 
 HttpAsyncReader::HttpAsyncReader()
@@ -67,8 +72,22 @@ HttpAsyncReader::~HttpAsyncReader()
 core::net::http::Request::Progress::Next HttpAsyncReader::progress_report(
     core::net::http::Request::Progress const&) const
 {
-    return p_->cancelled_ ? http::Request::Progress::Next::abort_operation :
-                            http::Request::Progress::Next::continue_operation;
+    if (p_->cancelled_)
+    {
+        return http::Request::Progress::Next::abort_operation;
+    }
+    int fd = p_->cancel_fd_;
+    if (fd != -1)
+    {
+        // Progress is reported frequently while a transfer is active, so a non-blocking
+        // check is enough to abort soon after the fd becomes readable.
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        if (::poll(&pfd, 1, 0) == 1)
+        {
+            return http::Request::Progress::Next::abort_operation;
+        }
+    }
+    return http::Request::Progress::Next::continue_operation;
 }
 
 void HttpAsyncReader::async_execute(core::net::http::Request::Handler const& handler, std::string const& uri) const
@@ -82,6 +101,11 @@ void HttpAsyncReader::async_execute(core::net::http::Request::Handler const& han
 }
 /// @endcond
 
+void HttpAsyncReader::set_cancel_fd(int fd)
+{
+    p_->cancel_fd_ = fd;
+}
+
 std::string HttpAsyncReader::get_uri(std::string const& host,
                                      std::vector<std::pair<std::string, std::string>> const& parameters) const
 {
@@ -29,10 +29,28 @@
 #include <boost/archive/xml_oarchive.hpp>
 
 #include <iostream>
+#include <stdexcept>
 
 namespace
 {
 constexpr const char* name_for_seconds{"seconds"};
+
+bool equal(const unity::scopes::testing::Benchmark::CounterResult::Counter& lhs,
+           const unity::scopes::testing::Benchmark::CounterResult::Counter& rhs)
+{
+    return lhs.available == rhs.available &&
+            lhs.mean == rhs.mean &&
+            lhs.std_dev == rhs.std_dev;
+}
+
+bool equal(const unity::scopes::testing::Benchmark::LoadResult::Percentiles& lhs,
+           const unity::scopes::testing::Benchmark::LoadResult::Percentiles& rhs)
+{
+    return lhs.p50 == rhs.p50 &&
+            lhs.p90 == rhs.p90 &&
+            lhs.p99 == rhs.p99 &&
+            lhs.p999 == rhs.p999;
+}
 }
 
 namespace boost
@@ -82,6 +100,29 @@ void serialize(
     ar & boost::serialization::make_nvp("second", pair.second);
 }
 
+template<class Archive>
+void serialize(
+        Archive & ar,
+        unity::scopes::testing::Benchmark::LoadResult::Percentiles& percentiles,
+        const unsigned int)
+{
+    ar & boost::serialization::make_nvp("p50", percentiles.p50);
+    ar & boost::serialization::make_nvp("p90", percentiles.p90);
+    ar & boost::serialization::make_nvp("p99", percentiles.p99);
+    ar & boost::serialization::make_nvp("p999", percentiles.p999);
+}
+
+template<class Archive>
+void serialize(
+        Archive & ar,
+        unity::scopes::testing::Benchmark::CounterResult::Counter& counter,
+        const unsigned int)
+{
+    ar & boost::serialization::make_nvp("available", counter.available);
+    ar & boost::serialization::make_nvp("mean", counter.mean);
+    ar & boost::serialization::make_nvp("std_dev", counter.std_dev);
+}
+
 template<class Archive>
 void serialize(Archive & ar, unity::scopes::testing::Benchmark::Result& result, const unsigned int)
 {
@@ -95,6 +136,30 @@ void serialize(Archive & ar, unity::scopes::testing::Benchmark::Result& result,
     ar & boost::serialization::make_nvp("timing.sample", result.timing.sample);
     ar & boost::serialization::make_nvp("timing.histogram", result.timing.histogram);
 }
+
+template<class Archive>
+void serialize(Archive & ar, unity::scopes::testing::Benchmark::LoadResult& result, const unsigned int)
+{
+    ar & boost::serialization::make_nvp("result", result.result);
+    ar & boost::serialization::make_nvp("client_count", result.client_count);
+    ar & boost::serialization::make_nvp("duration", result.duration);
+    ar & boost::serialization::make_nvp("completed", result.completed);
+    ar & boost::serialization::make_nvp("failed", result.failed);
+    ar & boost::serialization::make_nvp("throughput", result.throughput);
+    ar & boost::serialization::make_nvp("latency", result.latency);
+    ar & boost::serialization::make_nvp("time_to_first_result", result.time_to_first_result);
+}
+
+template<class Archive>
+void serialize(Archive & ar, unity::scopes::testing::Benchmark::CounterResult& result, const unsigned int)
+{
+    ar & boost::serialization::make_nvp("result", result.result);
+    ar & boost::serialization::make_nvp("cycles", result.cycles);
+    ar & boost::serialization::make_nvp("instructions", result.instructions);
+    ar & boost::serialization::make_nvp("cache_misses", result.cache_misses);
+    ar & boost::serialization::make_nvp("context_switches", result.context_switches);
+    ar & boost::serialization::make_nvp("page_faults", result.page_faults);
+}
 } // namespace boost
 } // namespace serialization
 
@@ -146,6 +211,102 @@ void unity::scopes::testing::Benchmark::Result::save_to(std::ostream& out)
     }
 }
 
+void unity::scopes::testing::Benchmark::LoadResult::load_from_xml(std::istream& in)
+{
+    try
+    {
+        boost::archive::xml_iarchive ia(in);
+        ia >> boost::serialization::make_nvp("load_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::LoadResult::load_from_xml: "} + e.what());
+    }
+}
+
+void unity::scopes::testing::Benchmark::LoadResult::save_to_xml(std::ostream& out)
+{
+    try
+    {
+        boost::archive::xml_oarchive oa(out);
+        oa << boost::serialization::make_nvp("load_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::LoadResult::save_to_xml: "} + e.what());
+    }
+}
+
+void unity::scopes::testing::Benchmark::LoadResult::load_from(std::istream& in)
+{
+    try
+    {
+        boost::archive::text_iarchive ia(in);
+        ia >> boost::serialization::make_nvp("load_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::LoadResult::load_from: "} + e.what());
+    }
+}
+
+void unity::scopes::testing::Benchmark::LoadResult::save_to(std::ostream& out)
+{
+    try
+    {
+        boost::archive::text_oarchive oa(out);
+        oa << boost::serialization::make_nvp("load_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::LoadResult::save_to: "} + e.what());
+    }
+}
+
+void unity::scopes::testing::Benchmark::CounterResult::load_from_xml(std::istream& in)
+{
+    try
+    {
+        boost::archive::xml_iarchive ia(in);
+        ia >> boost::serialization::make_nvp("counter_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::CounterResult::load_from_xml: "} + e.what());
+    }
+}
+
+void unity::scopes::testing::Benchmark::CounterResult::save_to_xml(std::ostream& out)
+{
+    try
+    {
+        boost::archive::xml_oarchive oa(out);
+        oa << boost::serialization::make_nvp("counter_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::CounterResult::save_to_xml: "} + e.what());
+    }
+}
+
+void unity::scopes::testing::Benchmark::CounterResult::load_from(std::istream& in)
+{
+    try
+    {
+        boost::archive::text_iarchive ia(in);
+        ia >> boost::serialization::make_nvp("counter_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::CounterResult::load_from: "} + e.what());
+    }
+}
+
+void unity::scopes::testing::Benchmark::CounterResult::save_to(std::ostream& out)
+{
+    try
+    {
+        boost::archive::text_oarchive oa(out);
+        oa << boost::serialization::make_nvp("counter_result", *this);
+    } catch(const boost::archive::archive_exception& e)
+    {
+        throw std::runtime_error(std::string{"Benchmark::CounterResult::save_to: "} + e.what());
+    }
+}
+
 unity::scopes::testing::Sample::SizeType unity::scopes::testing::Benchmark::Result::Timing::get_size() const
 {
    return sample.size();
@@ -259,6 +420,41 @@ bool unity::scopes::testing::Benchmark::Result::Timing::is_significantly_slower_
             test_result.sample1_mean_gt_sample2_mean(alpha);
 }
 
+unity::scopes::testing::Benchmark::LoadResult unity::scopes::testing::Benchmark::for_query_load(
+        const std::shared_ptr<unity::scopes::ScopeBase>&,
+        unity::scopes::testing::Benchmark::LoadConfiguration)
+{
+    throw std::logic_error("unity::scopes::testing::Benchmark::for_query_load: not supported by this benchmark.");
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::Benchmark::for_query_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>&,
+        unity::scopes::testing::Benchmark::QueryConfiguration)
+{
+    throw std::logic_error("unity::scopes::testing::Benchmark::for_query_with_counters: not supported by this benchmark.");
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::Benchmark::for_preview_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>&,
+        unity::scopes::testing::Benchmark::PreviewConfiguration)
+{
+    throw std::logic_error("unity::scopes::testing::Benchmark::for_preview_with_counters: not supported by this benchmark.");
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::Benchmark::for_activation_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>&,
+        unity::scopes::testing::Benchmark::ActivationConfiguration)
+{
+    throw std::logic_error("unity::scopes::testing::Benchmark::for_activation_with_counters: not supported by this benchmark.");
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::Benchmark::for_action_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>&,
+        unity::scopes::testing::Benchmark::ActionConfiguration)
+{
+    throw std::logic_error("unity::scopes::testing::Benchmark::for_action_with_counters: not supported by this benchmark.");
+}
+
 bool unity::scopes::testing::operator==(const unity::scopes::testing::Benchmark::Result& lhs, const unity::scopes::testing::Benchmark::Result& rhs)
 {
     return lhs.sample_size == rhs.sample_size &&
@@ -279,3 +475,61 @@ std::ostream& unity::scopes::testing::operator<<(std::ostream& out, const unity:
 
     return out;
 }
+
+bool unity::scopes::testing::operator==(const unity::scopes::testing::Benchmark::LoadResult& lhs, const unity::scopes::testing::Benchmark::LoadResult& rhs)
+{
+    return lhs.result == rhs.result &&
+            lhs.client_count == rhs.client_count &&
+            lhs.duration == rhs.duration &&
+            lhs.completed == rhs.completed &&
+            lhs.failed == rhs.failed &&
+            lhs.throughput == rhs.throughput &&
+            equal(lhs.latency, rhs.latency) &&
+            equal(lhs.time_to_first_result, rhs.time_to_first_result);
+}
+
+std::ostream& unity::scopes::testing::operator<<(std::ostream& out, const unity::scopes::testing::Benchmark::LoadResult& result)
+{
+    out << "{"
+        << "clients: " << result.client_count << ", "
+        << "throughput: " << result.throughput << " [1/s], "
+        << "completed: " << result.completed << ", "
+        << "failed: " << result.failed << ", "
+        << "p50: " << result.latency.p50.count() << " [s], "
+        << "p99: " << result.latency.p99.count() << " [s], "
+        << "ttfr p50: " << result.time_to_first_result.p50.count() << " [s], "
+        << "result: " << result.result
+        << "}";
+
+    return out;
+}
+
+bool unity::scopes::testing::operator==(const unity::scopes::testing::Benchmark::CounterResult& lhs, const unity::scopes::testing::Benchmark::CounterResult& rhs)
+{
+    return lhs.result == rhs.result &&
+            equal(lhs.cycles, rhs.cycles) &&
+            equal(lhs.instructions, rhs.instructions) &&
+            equal(lhs.cache_misses, rhs.cache_misses) &&
+            equal(lhs.context_switches, rhs.context_switches) &&
+            equal(lhs.page_faults, rhs.page_faults);
+}
+
+std::ostream& unity::scopes::testing::operator<<(std::ostream& out, const unity::scopes::testing::Benchmark::CounterResult& result)
+{
+    typedef std::pair<const char*, const unity::scopes::testing::Benchmark::CounterResult::Counter*> NamedCounter;
+
+    out << "{";
+    for (const auto& c : {NamedCounter{"cycles", &result.cycles},
+                          NamedCounter{"instructions", &result.instructions},
+                          NamedCounter{"cache-misses", &result.cache_misses},
+                          NamedCounter{"context-switches", &result.context_switches},
+                          NamedCounter{"page-faults", &result.page_faults}})
+    {
+        if (!c.second->available)
+            continue;
+        out << c.first << ": " << c.second->mean << " (σ: " << c.second->std_dev << "), ";
+    }
+    out << "result: " << result.result << "}";
+
+    return out;
+}
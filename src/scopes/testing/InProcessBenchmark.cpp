@@ -37,12 +37,23 @@
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/variance.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <mutex>
+#include <stdexcept>
 #include <thread>
 #include <unordered_map>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 namespace acc = boost::accumulators;
 
@@ -53,6 +64,9 @@ constexpr static const int metadata_idx = 1;
 constexpr static const int widget_idx = 2;
 constexpr static const int action_idx = 3;
 
+typedef std::chrono::high_resolution_clock Clock;
+typedef unity::scopes::testing::Benchmark::Result::Timing::Seconds Resolution;
+
 struct ObjectImpl : public virtual unity::scopes::Object
 {
     std::string endpoint() override
@@ -194,8 +208,13 @@ struct DevNullSearchReply : public unity::scopes::SearchReply, public WaitableRe
         return category_registry.lookup_category(id);
     }
 
+    // Time at which the first result was pushed, zero if there were no results.
+    std::atomic<Clock::rep> first_result{0};
+
     bool push(unity::scopes::CategorisedResult const&) override
     {
+        Clock::rep none = 0;
+        first_result.compare_exchange_strong(none, Clock::now().time_since_epoch().count());
         return true;
     }
 
@@ -219,9 +238,6 @@ struct DevNullSearchReply : public unity::scopes::SearchReply, public WaitableRe
     }
 };
 
-typedef std::chrono::high_resolution_clock Clock;
-typedef unity::scopes::testing::Benchmark::Result::Timing::Seconds Resolution;
-
 typedef acc::accumulator_set<
     Resolution::rep,
     acc::stats<
@@ -276,25 +292,167 @@ void fill_results_from_statistics(unity::scopes::testing::Benchmark::Result& res
         static_cast<Resolution::rep>(std::sqrt(acc::variance(stats)))
     };
 }
+
+// Nearest-rank percentiles. Sorts the sample.
+unity::scopes::testing::Benchmark::LoadResult::Percentiles percentiles_of(std::vector<Resolution>& sample)
+{
+    unity::scopes::testing::Benchmark::LoadResult::Percentiles p;
+    if (sample.empty())
+        return p;
+
+    std::sort(sample.begin(), sample.end());
+    auto at = [&sample](double q)
+    {
+        auto rank = static_cast<std::size_t>(std::ceil(q * sample.size()));
+        return sample[rank == 0 ? 0 : rank - 1];
+    };
+    p.p50 = at(0.5);
+    p.p90 = at(0.9);
+    p.p99 = at(0.99);
+    p.p999 = at(0.999);
+    return p;
 }
 
-/// @cond
+// Samples performance counters for each trial. The counters cover the calling thread and
+// any threads it creates. Each counter is opened on its own, so we measure whatever subset
+// the kernel grants us and report the remaining counters as unavailable.
+class PerfCounters
+{
+public:
+    typedef unity::scopes::testing::Benchmark::CounterResult Counters;
 
-unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_query(
+    explicit PerfCounters(bool enabled)
+    {
+        if (!enabled)
+            return;
+
+        open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, &Counters::cycles);
+        open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, &Counters::instructions);
+        open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, &Counters::cache_misses);
+        open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, &Counters::context_switches);
+        open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, &Counters::page_faults);
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    ~PerfCounters()
+    {
+        for (const auto& e : events_)
+            ::close(e.fd);
+    }
+
+    void start()
+    {
+        for (const auto& e : events_)
+        {
+            ::ioctl(e.fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(e.fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    void stop()
+    {
+        for (auto& e : events_)
+        {
+            ::ioctl(e.fd, PERF_EVENT_IOC_DISABLE, 0);
+
+            // Value, time enabled, time running.
+            std::uint64_t values[3];
+            if (::read(e.fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)))
+                continue;
+
+            double value = values[0];
+            // If the kernel multiplexed the hardware counters, extrapolate to the full trial.
+            if (values[2] > 0 && values[2] < values[1])
+                value *= static_cast<double>(values[1]) / values[2];
+            e.sample.push_back(value);
+        }
+    }
+
+    void fill_results(Counters& counters) const
+    {
+        for (const auto& e : events_)
+        {
+            if (e.sample.empty())
+                continue;
+
+            double sum = 0;
+            for (auto v : e.sample)
+                sum += v;
+            double mean = sum / e.sample.size();
+            double sq_sum = 0;
+            for (auto v : e.sample)
+                sq_sum += (v - mean) * (v - mean);
+
+            auto& counter = counters.*e.counter;
+            counter.available = true;
+            counter.mean = mean;
+            counter.std_dev = std::sqrt(sq_sum / e.sample.size());
+        }
+    }
+
+private:
+    struct Event
+    {
+        Counters::Counter Counters::* counter;
+        int fd;
+        std::vector<double> sample;
+    };
+
+    void open(std::uint32_t type, std::uint64_t config, Counters::Counter Counters::* counter)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = ::syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        if (fd < 0)
+        {
+            // With perf_event_paranoid >= 2, we may only count events in user space.
+            attr.exclude_kernel = 1;
+            fd = ::syscall(__NR_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+        }
+        if (fd < 0)
+            return;  // Not permitted, not supported by the (virtual) CPU, or blocked by seccomp.
+
+        events_.push_back(Event{counter, fd, {}});
+    }
+
+    std::vector<Event> events_;
+};
+
+// What one load client observed during the measurement interval.
+struct ClientLog
+{
+    std::vector<Resolution> latency;
+    std::vector<Resolution> time_to_first_result;
+    std::size_t failed{0};
+};
+
+void query_trials(
         const std::shared_ptr<unity::scopes::ScopeBase>& scope,
-        unity::scopes::testing::Benchmark::QueryConfiguration config)
+        const unity::scopes::testing::Benchmark::QueryConfiguration& config,
+        PerfCounters& counters,
+        unity::scopes::testing::Benchmark::Result& benchmark_result)
 {
     Statistics stats(
                 acc::tag::density::num_bins = config.trial_configuration.statistics_configuration.histogram_bin_count,
                 acc::tag::density::cache_size = 10);
 
-    unity::scopes::testing::Benchmark::Result benchmark_result;
     benchmark_result.timing.sample.resize(config.trial_configuration.trial_count);
 
     for (unsigned int i = 0; i < config.trial_configuration.trial_count; i++)
     {
         DevNullSearchReply search_reply;
 
+        counters.start();
         auto before = Clock::now();
         {
             auto sample = config.sampler();
@@ -312,6 +470,7 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
                 throw std::runtime_error("Query did not complete within the specified timeout interval.");
         }
         auto after = Clock::now();
+        counters.stop();
 
         auto duration = std::chrono::duration_cast<Resolution>(after - before);
         stats(duration.count());
@@ -319,24 +478,25 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
     }
 
     fill_results_from_statistics(benchmark_result, stats);
-    return benchmark_result;
 }
 
-unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_preview(
+void preview_trials(
         const std::shared_ptr<unity::scopes::ScopeBase>& scope,
-        unity::scopes::testing::Benchmark::PreviewConfiguration config)
+        const unity::scopes::testing::Benchmark::PreviewConfiguration& config,
+        PerfCounters& counters,
+        unity::scopes::testing::Benchmark::Result& benchmark_result)
 {
     Statistics stats(
                 acc::tag::density::num_bins = config.trial_configuration.statistics_configuration.histogram_bin_count,
                 acc::tag::density::cache_size = 10);
 
-    unity::scopes::testing::Benchmark::Result benchmark_result;
     benchmark_result.timing.sample.resize(config.trial_configuration.trial_count);
 
     for (unsigned int i = 0; i < config.trial_configuration.trial_count; i++)
     {
             DevNullPreviewReply preview_reply;
 
+            counters.start();
             auto before = Clock::now();
             {
                 auto sample = config.sampler();
@@ -354,6 +514,7 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
                     throw std::runtime_error("Preview did not complete within the specified timeout interval.");
             }
             auto after = Clock::now();
+            counters.stop();
 
             auto duration = std::chrono::duration_cast<Resolution>(after - before);
             stats(duration.count());
@@ -361,22 +522,23 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
     }
 
     fill_results_from_statistics(benchmark_result, stats);
-    return benchmark_result;
 }
 
-unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_activation(
+void activation_trials(
         const std::shared_ptr<unity::scopes::ScopeBase>& scope,
-        unity::scopes::testing::Benchmark::ActivationConfiguration config)
+        const unity::scopes::testing::Benchmark::ActivationConfiguration& config,
+        PerfCounters& counters,
+        unity::scopes::testing::Benchmark::Result& benchmark_result)
 {
     Statistics stats(
                 acc::tag::density::num_bins = config.trial_configuration.statistics_configuration.histogram_bin_count,
                 acc::tag::density::cache_size = 10);
 
-    unity::scopes::testing::Benchmark::Result benchmark_result;
     benchmark_result.timing.sample.resize(config.trial_configuration.trial_count);
 
     for (unsigned int i = 0; i < config.trial_configuration.trial_count; i++)
     {
+            counters.start();
             auto before = Clock::now();
             {
                 auto sample = config.sampler();
@@ -384,6 +546,7 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
                 (void) a->activate();
             }
             auto after = Clock::now();
+            counters.stop();
 
             auto duration = std::chrono::duration_cast<Resolution>(after - before);
             stats(duration.count());
@@ -391,22 +554,23 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
     }
 
     fill_results_from_statistics(benchmark_result, stats);
-    return benchmark_result;
 }
 
-unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_action(
+void action_trials(
         const std::shared_ptr<unity::scopes::ScopeBase>& scope,
-        unity::scopes::testing::Benchmark::ActionConfiguration config)
+        const unity::scopes::testing::Benchmark::ActionConfiguration& config,
+        PerfCounters& counters,
+        unity::scopes::testing::Benchmark::Result& benchmark_result)
 {
     Statistics stats(
                 acc::tag::density::num_bins = config.trial_configuration.statistics_configuration.histogram_bin_count,
                 acc::tag::density::cache_size = 10);
 
-    unity::scopes::testing::Benchmark::Result benchmark_result;
     benchmark_result.timing.sample.resize(config.trial_configuration.trial_count);
 
     for (unsigned int i = 0; i < config.trial_configuration.trial_count; i++)
     {
+            counters.start();
             auto before = Clock::now();
             {
                 auto sample = config.sampler();
@@ -417,6 +581,7 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
                 (void) a->activate();
             }
             auto after = Clock::now();
+            counters.stop();
 
             auto duration = std::chrono::duration_cast<Resolution>(after - before);
             stats(duration.count());
@@ -424,7 +589,221 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBench
     }
 
     fill_results_from_statistics(benchmark_result, stats);
+}
+}
+
+/// @cond
+
+unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_query(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::QueryConfiguration config)
+{
+    unity::scopes::testing::Benchmark::Result benchmark_result;
+    PerfCounters counters(false);
+    query_trials(scope, config, counters, benchmark_result);
+    return benchmark_result;
+}
 
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::InProcessBenchmark::for_query_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::QueryConfiguration config)
+{
+    PerfCounters counters(true);
+    unity::scopes::testing::Benchmark::CounterResult benchmark_result;
+    query_trials(scope, config, counters, benchmark_result.result);
+    counters.fill_results(benchmark_result);
+    return benchmark_result;
+}
+
+unity::scopes::testing::Benchmark::LoadResult unity::scopes::testing::InProcessBenchmark::for_query_load(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::LoadConfiguration config)
+{
+    if (!config.sampler)
+        throw std::logic_error("InProcessBenchmark::for_query_load: sampler must be set.");
+    if (config.client_count == 0)
+        throw std::logic_error("InProcessBenchmark::for_query_load: client_count must be > 0.");
+    if (config.target_qps < 0)
+        throw std::logic_error("InProcessBenchmark::for_query_load: target_qps must be >= 0.");
+    if (config.duration <= std::chrono::microseconds::zero())
+        throw std::logic_error("InProcessBenchmark::for_query_load: duration must be > 0.");
+
+    std::mutex sampler_guard;
+    std::vector<ClientLog> logs(config.client_count);
+    std::vector<std::thread> clients;
+
+    auto const start = Clock::now();
+    auto const measure_from = start + std::chrono::duration_cast<Clock::duration>(config.warm_up);
+    auto const stop_at = measure_from + std::chrono::duration_cast<Clock::duration>(config.duration);
+
+    // For an open loop, each client starts one query per interval. The schedules of the
+    // clients are staggered, so the queries are spread evenly.
+    auto const open_loop = config.target_qps > 0;
+    auto const interval = open_loop ?
+        std::chrono::duration_cast<Clock::duration>(Resolution{config.client_count / config.target_qps}) :
+        Clock::duration::zero();
+
+    for (std::size_t i = 0; i < config.client_count; i++)
+    {
+        clients.emplace_back([&, i]()
+        {
+            ClientLog& log = logs[i];
+            auto next = start + interval * i / config.client_count;
+
+            for (;;)
+            {
+                Clock::time_point scheduled;
+                if (open_loop)
+                {
+                    std::this_thread::sleep_until(next);
+                    scheduled = next;
+                    next += interval;
+                }
+                else
+                {
+                    scheduled = Clock::now();
+                }
+                if (scheduled >= stop_at)
+                    break;
+
+                // The reply stays alive until the scope lets go of its proxy, even if the query times out.
+                auto search_reply = std::make_shared<DevNullSearchReply>();
+                bool ok = false;
+                try
+                {
+                    std::pair<unity::scopes::CannedQuery, unity::scopes::SearchMetadata> sample = [&]()
+                    {
+                        std::lock_guard<std::mutex> lg(sampler_guard);
+                        return config.sampler();
+                    }();
+                    auto q = scope->search(sample.first, sample.second);
+                    q->run(unity::scopes::SearchReplyProxy
+                    {
+                        search_reply.get(),
+                        [search_reply](unity::scopes::SearchReply* r)
+                        {
+                            r->finished();
+                        }
+                    });
+                    ok = search_reply->wait_for_finished_for(config.per_query_timeout)
+                         && search_reply->is_finished_with_success();
+                }
+                catch (...)
+                {
+                }
+                auto after = Clock::now();
+
+                if (scheduled < measure_from)
+                    continue;  // Warming up
+                if (!ok)
+                {
+                    log.failed++;
+                    continue;
+                }
+                log.latency.push_back(std::chrono::duration_cast<Resolution>(after - scheduled));
+                auto first_result = search_reply->first_result.load();
+                if (first_result != 0)
+                {
+                    auto t = Clock::time_point{Clock::duration{first_result}};
+                    log.time_to_first_result.push_back(std::chrono::duration_cast<Resolution>(t - scheduled));
+                }
+            }
+        });
+    }
+    for (auto& client : clients)
+        client.join();
+
+    std::vector<Resolution> latency;
+    std::vector<Resolution> time_to_first_result;
+    unity::scopes::testing::Benchmark::LoadResult benchmark_result;
+    for (auto& log : logs)
+    {
+        latency.insert(latency.end(), log.latency.begin(), log.latency.end());
+        time_to_first_result.insert(time_to_first_result.end(),
+                                    log.time_to_first_result.begin(),
+                                    log.time_to_first_result.end());
+        benchmark_result.failed += log.failed;
+    }
+
+    Statistics stats(
+                acc::tag::density::num_bins = config.statistics_configuration.histogram_bin_count,
+                acc::tag::density::cache_size = 10);
+    for (const auto& duration : latency)
+        stats(duration.count());
+    if (!latency.empty())
+        fill_results_from_statistics(benchmark_result.result, stats);
+    benchmark_result.result.timing.sample = latency;
+
+    benchmark_result.client_count = config.client_count;
+    benchmark_result.duration = std::chrono::duration_cast<Resolution>(config.duration);
+    benchmark_result.completed = latency.size();
+    benchmark_result.throughput = latency.size() / benchmark_result.duration.count();
+    benchmark_result.latency = percentiles_of(latency);
+    benchmark_result.time_to_first_result = percentiles_of(time_to_first_result);
+
+    return benchmark_result;
+}
+
+unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_preview(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::PreviewConfiguration config)
+{
+    unity::scopes::testing::Benchmark::Result benchmark_result;
+    PerfCounters counters(false);
+    preview_trials(scope, config, counters, benchmark_result);
+    return benchmark_result;
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::InProcessBenchmark::for_preview_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::PreviewConfiguration config)
+{
+    PerfCounters counters(true);
+    unity::scopes::testing::Benchmark::CounterResult benchmark_result;
+    preview_trials(scope, config, counters, benchmark_result.result);
+    counters.fill_results(benchmark_result);
+    return benchmark_result;
+}
+
+unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_activation(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::ActivationConfiguration config)
+{
+    unity::scopes::testing::Benchmark::Result benchmark_result;
+    PerfCounters counters(false);
+    activation_trials(scope, config, counters, benchmark_result);
+    return benchmark_result;
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::InProcessBenchmark::for_activation_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::ActivationConfiguration config)
+{
+    PerfCounters counters(true);
+    unity::scopes::testing::Benchmark::CounterResult benchmark_result;
+    activation_trials(scope, config, counters, benchmark_result.result);
+    counters.fill_results(benchmark_result);
+    return benchmark_result;
+}
+
+unity::scopes::testing::Benchmark::Result unity::scopes::testing::InProcessBenchmark::for_action(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::ActionConfiguration config)
+{
+    unity::scopes::testing::Benchmark::Result benchmark_result;
+    PerfCounters counters(false);
+    action_trials(scope, config, counters, benchmark_result);
+    return benchmark_result;
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::InProcessBenchmark::for_action_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::ActionConfiguration config)
+{
+    PerfCounters counters(true);
+    unity::scopes::testing::Benchmark::CounterResult benchmark_result;
+    action_trials(scope, config, counters, benchmark_result.result);
+    counters.fill_results(benchmark_result);
     return benchmark_result;
 }
 
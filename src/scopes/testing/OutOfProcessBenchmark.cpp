@@ -21,10 +21,52 @@
 #include <core/posix/fork.h>
 
 #include <chrono>
+#include <functional>
 #include <iostream>
+#include <string>
 
 /// @cond
 
+namespace
+{
+
+// Runs trials in a child process and reads back the result that the child writes to its stdout.
+template<typename R>
+R run_in_child(std::string const& name, std::function<R()> const& trials)
+{
+    auto child = core::posix::fork([trials]()
+    {
+        trials().save_to(std::cout);
+        return core::posix::exit::Status::success;
+    },
+    core::posix::StandardStream::stdout);
+
+    R result;
+    result.load_from(child.cout());
+
+    auto wait_result = child.wait_for(core::posix::wait::Flags::untraced);
+
+    switch(wait_result.status)
+    {
+    case core::posix::wait::Result::Status::signaled:
+    case core::posix::wait::Result::Status::stopped:
+        throw std::runtime_error("unity::scopes::testing::Benchmark::" + name + ": "
+                                 "Trial terminated with error, bailing out now. "
+                                 "Please see the detailed error output and backtrace.");
+    default:
+        break;
+    }
+
+    if (wait_result.detail.if_exited.status != core::posix::exit::Status::success)
+        throw std::runtime_error("unity::scopes::testing::Benchmark::" + name + ": "
+                                 "Trial exited with failure, bailing out now. "
+                                 "Please see the detailed error output and backtrace.");
+
+    return result;
+}
+
+}
+
 unity::scopes::testing::Benchmark::Result unity::scopes::testing::OutOfProcessBenchmark::for_query(
         const std::shared_ptr<unity::scopes::ScopeBase>& scope,
         unity::scopes::testing::Benchmark::QueryConfiguration config)
@@ -60,6 +102,41 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::OutOfProcessBe
     return result;
 }
 
+unity::scopes::testing::Benchmark::LoadResult unity::scopes::testing::OutOfProcessBenchmark::for_query_load(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::LoadConfiguration config)
+{
+    auto child = core::posix::fork([this, config, scope]()
+    {
+        InProcessBenchmark::for_query_load(scope, config).save_to(std::cout);
+        return core::posix::exit::Status::success;
+    },
+    core::posix::StandardStream::stdout);
+
+    unity::scopes::testing::Benchmark::LoadResult result;
+    result.load_from(child.cout());
+
+    auto wait_result = child.wait_for(core::posix::wait::Flags::untraced);
+
+    switch(wait_result.status)
+    {
+    case core::posix::wait::Result::Status::signaled:
+    case core::posix::wait::Result::Status::stopped:
+        throw std::runtime_error("unity::scopes::testing::Benchmark::for_query_load: "
+                                 "Trial terminated with error, bailing out now. "
+                                 "Please see the detailed error output and backtrace.");
+    default:
+        break;
+    }
+
+    if (wait_result.detail.if_exited.status != core::posix::exit::Status::success)
+        throw std::runtime_error("unity::scopes::testing::Benchmark::for_query_load: "
+                                 "Trial exited with failure, bailing out now. "
+                                 "Please see the detailed error output and backtrace.");
+
+    return result;
+}
+
 unity::scopes::testing::Benchmark::Result unity::scopes::testing::OutOfProcessBenchmark::for_preview(
         const std::shared_ptr<unity::scopes::ScopeBase>& scope,
         unity::scopes::testing::Benchmark::PreviewConfiguration config)
@@ -165,4 +242,44 @@ unity::scopes::testing::Benchmark::Result unity::scopes::testing::OutOfProcessBe
     return result;
 }
 
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::OutOfProcessBenchmark::for_query_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::QueryConfiguration config)
+{
+    return run_in_child<CounterResult>("for_query_with_counters", [this, config, scope]()
+    {
+        return InProcessBenchmark::for_query_with_counters(scope, config);
+    });
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::OutOfProcessBenchmark::for_preview_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::PreviewConfiguration config)
+{
+    return run_in_child<CounterResult>("for_preview_with_counters", [this, config, scope]()
+    {
+        return InProcessBenchmark::for_preview_with_counters(scope, config);
+    });
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::OutOfProcessBenchmark::for_activation_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::ActivationConfiguration config)
+{
+    return run_in_child<CounterResult>("for_activation_with_counters", [this, config, scope]()
+    {
+        return InProcessBenchmark::for_activation_with_counters(scope, config);
+    });
+}
+
+unity::scopes::testing::Benchmark::CounterResult unity::scopes::testing::OutOfProcessBenchmark::for_action_with_counters(
+        const std::shared_ptr<unity::scopes::ScopeBase>& scope,
+        unity::scopes::testing::Benchmark::ActionConfiguration config)
+{
+    return run_in_child<CounterResult>("for_action_with_counters", [this, config, scope]()
+    {
+        return InProcessBenchmark::for_action_with_counters(scope, config);
+    });
+}
+
 /// @endcond
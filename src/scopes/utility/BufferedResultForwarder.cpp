@@ -64,6 +64,14 @@ from child B in a particular order, you must override
 to, for example, collapse categories received from a child into a single category, or otherwise buffer
 results yourself until you have established the order you need.
 
+A single slow child holds back the results of all forwarders that follow it in the chain. To bound
+the delay, you can give each forwarder a time budget. A forwarder that is not ready within its budget
+is demoted: its follower stops waiting for it, and its results are appended at the end, once the last
+forwarder in the chain is ready. The forwarder tells the client about this with an OperationInfo
+(OperationInfo::ResultsIncomplete). Forwarders with and without a budget can be mixed in the same chain.
+A budget is best derived from the time the client is prepared to wait, for example, from
+\link unity::scopes::SearchMetadata::remaining_time() SearchMetadata::remaining_time()\endlink.
+
 Note that buffering fundamentally conflicts with the need to render results as soon as possible. You should
 avoid buffering more data than absolutely necessary in order for the display to start updating as soon
 as possible after a query was sent.
@@ -129,6 +137,15 @@ BufferedResultForwarder::BufferedResultForwarder(unity::scopes::SearchReplyProxy
 {
 }
 
+BufferedResultForwarder::BufferedResultForwarder(unity::scopes::SearchReplyProxy const& upstream,
+                                                 std::chrono::milliseconds budget,
+                                                 std::string const& child_id,
+                                                 BufferedResultForwarder::SPtr const& next_forwarder)
+    : SearchListenerBase(),
+      p(new internal::BufferedResultForwarderImpl(upstream, next_forwarder, budget, child_id))
+{
+}
+
 /// @cond
 BufferedResultForwarder::~BufferedResultForwarder() = default;
 /// @endcond
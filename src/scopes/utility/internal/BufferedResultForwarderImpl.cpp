@@ -18,6 +18,8 @@
 
 #include <unity/scopes/utility/internal/BufferedResultForwarderImpl.h>
 #include <unity/scopes/utility/internal/BufferedSearchReplyImpl.h>
+#include <unity/scopes/internal/ThreadPool.h>
+#include <unity/scopes/OperationInfo.h>
 #include <unity/scopes/SearchReply.h>
 #include <unity/UnityExceptions.h>
 #include <cassert>
@@ -34,13 +36,55 @@ namespace utility
 namespace internal
 {
 
+using unity::scopes::internal::DeadlineMonitor;
+using unity::scopes::internal::ThreadPool;
+
+namespace
+{
+
+// Budgets for all forwarders in the process are tracked by a single monitor thread. The monitor
+// is deliberately leaked, so its thread is not joined during static destruction.
+
+DeadlineMonitor& budget_monitor()
+{
+    static auto monitor = new DeadlineMonitor::SPtr(DeadlineMonitor::create());
+    return **monitor;
+}
+
+// The expiry work sends an info message and may flush results of other forwarders, so it runs
+// on a pool thread instead of the monitor thread, where it would hold up the other budgets.
+
+ThreadPool& budget_pool()
+{
+    static auto pool = new ThreadPool::SPtr(std::make_shared<ThreadPool>(1));
+    return **pool;
+}
+
+} // namespace
+
+// Forwarders that missed their budget and became ready later wait here until the last forwarder
+// in the chain is ready; then their results are flushed in the order they became ready.
+
+struct BufferedResultForwarderImpl::Chain
+{
+    std::mutex mutex;
+    bool end_reached = false;
+    std::vector<std::shared_ptr<BufferedSearchReplyImpl>> late;
+};
+
 BufferedResultForwarderImpl::BufferedResultForwarderImpl(unity::scopes::SearchReplyProxy const& upstream,
-        unity::scopes::utility::BufferedResultForwarder::SPtr const& next_forwarder)
+        unity::scopes::utility::BufferedResultForwarder::SPtr const& next_forwarder,
+        std::chrono::milliseconds budget,
+        std::string const& child_id)
     : ready_(false),
       has_previous_(false),
       previous_ready_(false),
       upstream_(std::make_shared<internal::BufferedSearchReplyImpl>(upstream)),
-      next_(next_forwarder)
+      next_(next_forwarder),
+      budget_(budget),
+      child_id_(child_id),
+      late_(false),
+      passed_on_(false)
 {
     if (next_forwarder)
     {
@@ -48,6 +92,28 @@ BufferedResultForwarderImpl::BufferedResultForwarderImpl(unity::scopes::SearchRe
         {
             throw LogicException("The next forwarder has already been linked to another BufferedResultForwarder");
         }
+        chain_ = next_forwarder->p->chain_;  // Forwarders are created back to front
+    }
+    else
+    {
+        chain_ = std::make_shared<Chain>();
+    }
+
+    if (budget_ > std::chrono::milliseconds(0))
+    {
+        // The destructor cancels budget_item_ (waiting for a callback in progress) and then
+        // waits for the posted expiry work, so both can safely use this.
+        budget_item_ = budget_monitor().add(std::chrono::system_clock::now() + budget_,
+                                            [this]{ expiry_ = budget_pool().submit([this]{ budget_expired(); }); });
+    }
+}
+
+BufferedResultForwarderImpl::~BufferedResultForwarderImpl()
+{
+    budget_item_.reset();
+    if (expiry_.valid())
+    {
+        expiry_.wait();
     }
 }
 
@@ -73,12 +139,25 @@ void BufferedResultForwarderImpl::set_ready()
     // to be displayed (or the query has finished); set the 'ready' flag
     // and if previous forwarder is also ready, then push and disable
     // further buffering.
-    if (!ready_.exchange(true))
+    bool late;
+    bool flush;
     {
-        if (previous_ready_ || !has_previous_)
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ready_.exchange(true))
         {
-            flush_and_notify();
+            return;
         }
+        late = late_;
+        flush = previous_ready_ || !has_previous_;
+    }
+    if (late)
+    {
+        // We missed our budget and have given up our place in the chain already.
+        flush_late();
+    }
+    else if (flush)
+    {
+        flush_and_notify();
     }
 }
 
@@ -86,8 +165,20 @@ void BufferedResultForwarderImpl::notify_ready()
 {
     // we got notified that previous forwarder is ready;
     // if we are ready then notify following forwarder
-    previous_ready_ = true;
-    if (ready_)
+    // (if we missed our budget, we don't hold it back any longer).
+    bool late;
+    bool ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        previous_ready_ = true;
+        late = late_;
+        ready = ready_;
+    }
+    if (late)
+    {
+        pass_on();
+    }
+    else if (ready)
     {
         flush_and_notify();
     }
@@ -100,11 +191,76 @@ void BufferedResultForwarderImpl::flush_and_notify()
 
     buf->flush();
 
+    pass_on();
+}
+
+void BufferedResultForwarderImpl::pass_on()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (passed_on_)
+        {
+            return;
+        }
+        passed_on_ = true;
+    }
+
     // notify next forwarder that this one is ready
     if (next_)
     {
         next_->p->notify_ready();
+        return;
+    }
+
+    // We are the last forwarder, so results from late forwarders can go now.
+    std::vector<std::shared_ptr<BufferedSearchReplyImpl>> late;
+    {
+        std::lock_guard<std::mutex> lock(chain_->mutex);
+        chain_->end_reached = true;
+        late.swap(chain_->late);
+    }
+    for (auto const& buf : late)
+    {
+        buf->flush();
+    }
+}
+
+void BufferedResultForwarderImpl::budget_expired()
+{
+    bool pass;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ready_ || late_)
+        {
+            return;
+        }
+        late_ = true;
+        pass = previous_ready_ || !has_previous_;
     }
+
+    upstream_->info(OperationInfo(OperationInfo::ResultsIncomplete,
+                                  "BufferedResultForwarder: no results from \"" + child_id_ + "\" within "
+                                  + std::to_string(budget_.count()) + " ms, moving its results to the end"));
+    if (pass)
+    {
+        pass_on();
+    }
+}
+
+void BufferedResultForwarderImpl::flush_late()
+{
+    auto buf = std::dynamic_pointer_cast<internal::BufferedSearchReplyImpl>(upstream_);
+    assert(buf);
+
+    {
+        std::lock_guard<std::mutex> lock(chain_->mutex);
+        if (!chain_->end_reached)
+        {
+            chain_->late.push_back(buf);
+            return;
+        }
+    }
+    buf->flush();
 }
 
 void BufferedResultForwarderImpl::finished(CompletionDetails const&)
@@ -25,7 +25,11 @@
 #include "TestScope.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <chrono>
 #include <fstream>
+#include <thread>
+
+#include <sys/stat.h>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
@@ -305,3 +309,52 @@ TEST_F(ChildScopesTest, corrupted_config)
     EXPECT_EQ("ScopeC", return_list[2].id);
     EXPECT_TRUE(return_list[2].enabled);
 }
+
+TEST_F(ChildScopesTest, unchanged_config_not_rewritten)
+{
+    // Create an empty config directory for TestScope
+    remove_config_dir();
+    create_config_dir();
+
+    // Start TestScope
+    start_test_scope();
+
+    // 1st, 2nd, and 3rd TestScope::find_child_scopes() return "A,B,C", "D,A,B,C,E", and "D,A,B"
+    test_scope->child_scopes();
+    test_scope->child_scopes();
+    test_scope->child_scopes();
+
+    // Give the background write some time to finish
+    std::string const repo = TEST_RUNTIME_PATH "/TestScope/child-scopes.json";
+    struct stat before;
+    for (int i = 0; i < 50 && ::stat(repo.c_str(), &before) != 0; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    ASSERT_EQ(0, ::stat(repo.c_str(), &before));
+
+    // 4th TestScope::find_child_scopes() returns "D,A,B" again, so the repo must not be written
+    ChildScopeList return_list = test_scope->child_scopes();
+    ASSERT_EQ(3u, return_list.size());
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    struct stat after;
+    ASSERT_EQ(0, ::stat(repo.c_str(), &after));
+    EXPECT_EQ(before.st_ino, after.st_ino);
+    EXPECT_EQ(before.st_mtim.tv_sec, after.st_mtim.tv_sec);
+    EXPECT_EQ(before.st_mtim.tv_nsec, after.st_mtim.tv_nsec);
+
+    // Changes made to the repo by someone else are picked up
+    {
+        std::ofstream repo_file(repo);
+        repo_file << R"([{"id":"ScopeA","enabled":false}])";
+    }
+    return_list = test_scope->child_scopes();
+    ASSERT_EQ(3u, return_list.size());
+    EXPECT_EQ("ScopeD", return_list[0].id);
+    EXPECT_TRUE(return_list[0].enabled);
+    EXPECT_EQ("ScopeA", return_list[1].id);
+    EXPECT_FALSE(return_list[1].enabled);
+    EXPECT_EQ("ScopeB", return_list[2].id);
+    EXPECT_TRUE(return_list[2].enabled);
+}
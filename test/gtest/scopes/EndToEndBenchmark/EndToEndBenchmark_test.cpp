@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Measures queries end to end, through a private scoperegistry that starts the scopes
+// with scoperunner, and zmq between all processes. Unlike the testing::Benchmark classes,
+// which call the scope directly, this includes locate(), process start-up, and marshaling.
+//
+// Cold-start latency, warm-query latency, and push throughput are reported separately.
+// Each result is also saved as <name>.xml in the build directory, so it can be compared
+// with an earlier run with Benchmark::Result::Timing::is_significantly_slower_than_reference().
+
+#include <unity-scopes.h>
+#include <unity/scopes/testing/Benchmark.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace unity::scopes;
+
+namespace
+{
+
+typedef chrono::steady_clock Clock;
+typedef unity::scopes::testing::Benchmark::Result::Timing::Seconds Seconds;
+
+int const cold_start_trials = 5;
+int const warm_query_trials = 200;
+int const push_trials = 5;
+int const push_result_count = 2000;
+
+class Receiver : public SearchListenerBase
+{
+public:
+    Receiver()
+        : start_(Clock::now()),
+          query_complete_(false),
+          status_(CompletionDetails::OK),
+          result_count_(0)
+    {
+    }
+
+    virtual void push(CategorisedResult /* result */) override
+    {
+        lock_guard<mutex> lock(mutex_);
+        auto now = Clock::now();
+        if (result_count_++ == 0)
+        {
+            first_result_ = now;
+        }
+        last_result_ = now;
+    }
+
+    virtual void finished(CompletionDetails const& details) override
+    {
+        lock_guard<mutex> lock(mutex_);
+        finished_ = Clock::now();
+        status_ = details.status();
+        if (status_ != CompletionDetails::OK)
+        {
+            cerr << "query failed: " << details.message() << endl;
+        }
+        query_complete_ = true;
+        condvar_.notify_one();
+    }
+
+    bool wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        return condvar_.wait_for(lock, chrono::seconds(20), [this] { return query_complete_; })
+               && status_ == CompletionDetails::OK;
+    }
+
+    int result_count() const
+    {
+        lock_guard<mutex> lock(mutex_);
+        return result_count_;
+    }
+
+    Seconds time_to_first_result() const
+    {
+        lock_guard<mutex> lock(mutex_);
+        return chrono::duration_cast<Seconds>(first_result_ - start_);
+    }
+
+    Seconds time_to_finished() const
+    {
+        lock_guard<mutex> lock(mutex_);
+        return chrono::duration_cast<Seconds>(finished_ - start_);
+    }
+
+    Seconds push_duration() const
+    {
+        lock_guard<mutex> lock(mutex_);
+        return chrono::duration_cast<Seconds>(last_result_ - first_result_);
+    }
+
+private:
+    Clock::time_point const start_;
+    Clock::time_point first_result_;
+    Clock::time_point last_result_;
+    Clock::time_point finished_;
+    bool query_complete_;
+    CompletionDetails::CompletionStatus status_;
+    int result_count_;
+    mutable mutex mutex_;
+    condition_variable condvar_;
+};
+
+shared_ptr<Receiver> run_query(ScopeProxy const& proxy, string const& query_string)
+{
+    auto receiver = make_shared<Receiver>();
+    proxy->search(query_string, SearchMetadata("C", "phone"), receiver);
+    EXPECT_TRUE(receiver->wait_until_finished());
+    return receiver;
+}
+
+bool wait_until_stopped(RegistryProxy const& r, string const& scope_id)
+{
+    auto const give_up = Clock::now() + chrono::seconds(10);
+    while (r->is_scope_running(scope_id))
+    {
+        if (Clock::now() > give_up)
+        {
+            return false;
+        }
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    return true;
+}
+
+// Prints a summary of the sample and saves it as <name>.xml.
+
+void report(string const& name, vector<Seconds> sample)
+{
+    ASSERT_FALSE(sample.empty());
+
+    unity::scopes::testing::Benchmark::Result result;
+    result.sample_size = sample.size();
+    result.timing.sample = sample;
+
+    sort(sample.begin(), sample.end());
+    double sum = 0;
+    for (auto const& s : sample)
+    {
+        sum += s.count();
+    }
+    double const mean = sum / sample.size();
+    double sq_sum = 0;
+    for (auto const& s : sample)
+    {
+        sq_sum += (s.count() - mean) * (s.count() - mean);
+    }
+    result.timing.min = sample.front();
+    result.timing.max = sample.back();
+    result.timing.mean = Seconds{mean};
+    result.timing.std_dev = Seconds{sqrt(sq_sum / sample.size())};
+
+    auto percentile = [&sample](double q)
+    {
+        auto rank = static_cast<size_t>(ceil(q * sample.size()));
+        return sample[rank == 0 ? 0 : rank - 1].count() * 1000;
+    };
+    cout << name << ": n = " << sample.size()
+         << ", mean = " << mean * 1000 << " ms"
+         << ", p50 = " << percentile(0.5) << " ms"
+         << ", p99 = " << percentile(0.99) << " ms"
+         << ", max = " << result.timing.max.count() * 1000 << " ms" << endl;
+
+    ofstream out(TEST_RUNTIME_PATH "/" + name + ".xml");
+    result.save_to_xml(out);
+}
+
+} // namespace
+
+// Time for a query to a scope that is not running yet. This includes the locate() in the
+// registry, the exec of scoperunner, loading the scope library, and the start() method.
+
+TEST(EndToEndBenchmark, cold_start)
+{
+    Runtime::UPtr rt = Runtime::create(TEST_RUNTIME_FILE);
+    RegistryProxy r = rt->registry();
+    auto proxy = r->get_metadata("bench-cold").proxy();
+
+    vector<Seconds> first_result;
+    vector<Seconds> finished;
+    for (int i = 0; i < cold_start_trials; ++i)
+    {
+        // bench-cold has an idle timeout of one second.
+        ASSERT_TRUE(wait_until_stopped(r, "bench-cold"));
+
+        auto receiver = run_query(proxy, "results=1");
+        ASSERT_EQ(1, receiver->result_count());
+        first_result.push_back(receiver->time_to_first_result());
+        finished.push_back(receiver->time_to_finished());
+    }
+
+    report("cold-start-first-result", first_result);
+    report("cold-start-finished", finished);
+}
+
+// Round-trip time for a query with a single result to a scope that is running already.
+
+TEST(EndToEndBenchmark, warm_query)
+{
+    Runtime::UPtr rt = Runtime::create(TEST_RUNTIME_FILE);
+    RegistryProxy r = rt->registry();
+    auto proxy = r->get_metadata("bench-warm").proxy();
+
+    run_query(proxy, "results=1");  // Make sure the scope is running.
+
+    vector<Seconds> finished;
+    for (int i = 0; i < warm_query_trials; ++i)
+    {
+        auto receiver = run_query(proxy, "results=1");
+        ASSERT_EQ(1, receiver->result_count());
+        finished.push_back(receiver->time_to_finished());
+    }
+
+    report("warm-query", finished);
+}
+
+// Rate at which results arrive at the client while a scope pushes as fast as it can.
+
+TEST(EndToEndBenchmark, push_throughput)
+{
+    Runtime::UPtr rt = Runtime::create(TEST_RUNTIME_FILE);
+    RegistryProxy r = rt->registry();
+    auto proxy = r->get_metadata("bench-warm").proxy();
+
+    run_query(proxy, "results=1");  // Make sure the scope is running.
+
+    vector<Seconds> push_durations;
+    for (int i = 0; i < push_trials; ++i)
+    {
+        auto receiver = run_query(proxy, "results=" + to_string(push_result_count));
+        ASSERT_EQ(push_result_count, receiver->result_count());
+        push_durations.push_back(receiver->push_duration());
+        cout << "push throughput: " << (push_result_count - 1) / receiver->push_duration().count()
+             << " results/s" << endl;
+    }
+
+    report("push-" + to_string(push_result_count) + "-results", push_durations);
+}
+
+int main(int argc, char* argv[])
+{
+    ::testing::InitGoogleTest(&argc, argv);
+
+    int rc = 0;
+    auto rpid = fork();
+    if (rpid == 0)
+    {
+        const char* const args[] = {"scoperegistry [EndToEndBenchmark]", TEST_RUNTIME_FILE, nullptr};
+        if (execv(TEST_REGISTRY_PATH "/scoperegistry", const_cast<char* const*>(args)) < 0)
+        {
+            perror("Error starting scoperegistry:");
+        }
+        return 1;
+    }
+    else if (rpid > 0)
+    {
+        rc = RUN_ALL_TESTS();
+
+        kill(rpid, SIGTERM);
+        waitpid(rpid, nullptr, 0);
+    }
+    else
+    {
+        perror("Failed to fork:");
+    }
+
+    return rc;
+}
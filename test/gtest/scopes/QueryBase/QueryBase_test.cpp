@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/SearchMetadata.h>
+#include <unity/scopes/SearchQueryBase.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include <poll.h>
+
+using namespace std;
+using namespace unity::scopes;
+
+namespace
+{
+
+class TestQuery : public SearchQueryBase
+{
+public:
+    TestQuery()
+        : SearchQueryBase(CannedQuery("scope-A"), SearchMetadata("en", "phone"))
+        , cancelled_count_(0)
+    {
+    }
+
+    virtual void cancelled() override
+    {
+        ++cancelled_count_;
+    }
+
+    virtual void run(SearchReplyProxy const&) override
+    {
+    }
+
+    void cancel_query()
+    {
+        cancel();  // What the run-time does when the client cancels or the deadline expires
+    }
+
+    atomic_int cancelled_count_;
+};
+
+// Returns true if fd becomes readable within timeout_ms.
+
+bool readable(int fd, int timeout_ms)
+{
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, timeout_ms) == 1 && (pfd.revents & POLLIN);
+}
+
+} // namespace
+
+TEST(QueryBase, cancel_fd)
+{
+    TestQuery q;
+    int fd = q.cancel_fd();
+    EXPECT_GE(fd, 0);
+    EXPECT_EQ(fd, q.cancel_fd());  // Same fd every time
+    EXPECT_FALSE(readable(fd, 0));
+
+    // Cancel from another thread while we block in poll().
+    thread t([&q]
+    {
+        this_thread::sleep_for(chrono::milliseconds(100));
+        q.cancel_query();
+    });
+    EXPECT_TRUE(readable(fd, 5000));
+    t.join();
+    EXPECT_EQ(1, q.cancelled_count_);
+
+    // The fd stays readable, and cancelling again doesn't change that.
+    EXPECT_TRUE(readable(fd, 0));
+    q.cancel_query();
+    EXPECT_TRUE(readable(fd, 0));
+    EXPECT_EQ(fd, q.cancel_fd());
+}
+
+TEST(QueryBase, cancel_fd_after_cancel)
+{
+    // An fd created after the query was cancelled is readable immediately.
+    TestQuery q;
+    q.cancel_query();
+    EXPECT_EQ(1, q.cancelled_count_);
+    EXPECT_TRUE(readable(q.cancel_fd(), 0));
+}
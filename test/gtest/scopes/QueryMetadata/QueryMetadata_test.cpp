@@ -188,6 +188,33 @@ TEST(SearchMetadata, copy)
     }
 }
 
+TEST(SearchMetadata, deadline)
+{
+    SearchMetadata meta("pl", "phone");
+    EXPECT_FALSE(meta.has_deadline());
+    EXPECT_THROW(meta.deadline(), unity::scopes::NotFoundException);
+    EXPECT_THROW(meta.remaining_time(), unity::scopes::NotFoundException);
+
+    auto const deadline = std::chrono::system_clock::now() + std::chrono::seconds(10);
+    meta.set_deadline(deadline);
+    EXPECT_TRUE(meta.has_deadline());
+    EXPECT_EQ(std::chrono::time_point_cast<std::chrono::milliseconds>(deadline), meta.deadline());
+    EXPECT_GT(meta.remaining_time(), std::chrono::seconds(9));
+    EXPECT_LE(meta.remaining_time(), std::chrono::seconds(10));
+
+    // The deadline is carried as a hint, so it survives serialization.
+    SearchMetadata meta2 = SearchMetadataImpl::create(meta.serialize());
+    EXPECT_TRUE(meta2.contains_hint("deadline"));
+    EXPECT_EQ(meta.deadline(), meta2.deadline());
+
+    meta.set_deadline(std::chrono::system_clock::now() - std::chrono::seconds(1));
+    EXPECT_EQ(std::chrono::milliseconds(0), meta.remaining_time());
+
+    // A "deadline" hint that isn't an integer is not a deadline.
+    meta["deadline"] = "tomorrow";
+    EXPECT_FALSE(meta.has_deadline());
+}
+
 TEST(ActionMetadata, basic)
 {
     {
@@ -17,6 +17,7 @@
  */
 
 #include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/internal/ScopeCatalog.h>
 #include <unity/scopes/Registry.h>
 #include <unity/scopes/Runtime.h>
 #include <unity/scopes/ScopeExceptions.h>
@@ -35,6 +36,7 @@
 #include <fstream>
 #include <functional>
 #include <mutex>
+#include <set>
 #include <signal.h>
 #include <thread>
 #include <unistd.h>
@@ -162,6 +164,59 @@ TEST(Registry, metadata)
     EXPECT_FALSE(meta.is_aggregator());
 }
 
+TEST(Registry, find_by_keywords)
+{
+    Runtime::UPtr rt = Runtime::create(TEST_RUNTIME_FILE);
+    RegistryProxy r = rt->registry();
+
+    auto scopes = r->find_by_keywords({ "news" });
+    ASSERT_EQ(1u, scopes.size());
+    EXPECT_EQ("testscopeA", scopes.begin()->first);
+    EXPECT_EQ("testscopeA", scopes.begin()->second.scope_id());
+
+    scopes = r->find_by_keywords({ "no_such_keyword", "foo" });
+    ASSERT_EQ(1u, scopes.size());
+    EXPECT_EQ("testscopeA", scopes.begin()->first);
+
+    EXPECT_TRUE(r->find_by_keywords({ "no_such_keyword" }).empty());
+    EXPECT_TRUE(r->find_by_keywords({}).empty());
+}
+
+TEST(Registry, children_of)
+{
+    Runtime::UPtr rt = Runtime::create(TEST_RUNTIME_FILE);
+    RegistryProxy r = rt->registry();
+
+    // testscopeA is not a keyword aggregator, and its child scopes are not installed.
+    EXPECT_TRUE(r->children_of("testscopeA").empty());
+    EXPECT_TRUE(r->children_of("testscopeB").empty());
+
+    try
+    {
+        r->children_of("no_such_scope");
+        FAIL();
+    }
+    catch (NotFoundException const& e)
+    {
+        EXPECT_STREQ("unity::scopes::NotFoundException: Registry::children_of(): no such scope (name = no_such_scope)",
+                     e.what());
+    }
+}
+
+TEST(Registry, catalog_written_once_at_startup)
+{
+    // Make sure the registry has started.
+    Runtime::UPtr rt = Runtime::create(TEST_RUNTIME_FILE);
+    EXPECT_EQ(2u, rt->registry()->list().size());
+
+    // The registry writes the catalog once it has found all scopes, not once per scope.
+    // (The catalog lives in the endpoint directory set in Zmq.ini.)
+    auto catalog = internal::ScopeCatalog::open("/tmp/RegistryTest-catalog");
+    EXPECT_EQ(1u, catalog->version());
+    EXPECT_EQ(2u, catalog->size());
+    EXPECT_TRUE(catalog->is_complete());
+}
+
 TEST(Registry, desktop_dir_exists)
 {
     // Directory must have been created.
@@ -460,6 +515,118 @@ TEST(Registry, manually_started_scope)
     rt->destroy();
 }
 
+TEST(Registry, hosted_scopes)
+{
+    std::set<std::string> running;
+    std::mutex mutex;
+    std::condition_variable cond;
+
+    Runtime::UPtr rt = Runtime::create(TEST_RUNTIME_FILE);
+    RegistryProxy r = rt->registry();
+
+    // Install testscopeC twice, as testscopeC and testscopeE.
+    system::error_code ec;
+    for (std::string id : { "testscopeC", "testscopeE" })
+    {
+        std::string dir = TEST_RUNTIME_PATH "/scopes/" + id;
+        filesystem::create_directory(dir, ec);
+        ASSERT_EQ("Success", ec.message());
+        filesystem::copy(TEST_RUNTIME_PATH "/other_scopes/testscopeC/testscopeC.ini", dir + "/" + id + ".ini", ec);
+        ASSERT_EQ("Success", ec.message());
+        filesystem::copy(TEST_RUNTIME_PATH "/other_scopes/testscopeC/libtestscopeC.so", dir + "/lib" + id + ".so", ec);
+        ASSERT_EQ("Success", ec.message());
+    }
+
+    auto state_callback = [&running, &mutex, &cond](std::string const& id)
+    {
+        return [id, &running, &mutex, &cond](bool is_running)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (is_running)
+            {
+                running.insert(id);
+            }
+            else
+            {
+                running.erase(id);
+            }
+            cond.notify_one();
+        };
+    };
+    auto connC = r->set_scope_state_callback("testscopeC", state_callback("testscopeC"));
+    auto connE = r->set_scope_state_callback("testscopeE", state_callback("testscopeE"));
+
+    auto wait_for_running = [&running, &mutex, &cond](size_t n)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cond.wait_for(lock, wait_for_update_time, [&running, n] { return running.size() == n; });
+    };
+
+    // Wait for the registry to realize that there are new scopes.
+    auto const wait_time = std::chrono::seconds(5);
+    auto start_time = std::chrono::system_clock::now();
+    bool ok = false;
+    do
+    {
+        try
+        {
+            EXPECT_FALSE(r->is_scope_running("testscopeC"));
+            EXPECT_FALSE(r->is_scope_running("testscopeE"));
+            ok = true;
+        }
+        catch (NotFoundException const&)
+        {
+        }
+    }
+    while (!ok && std::chrono::system_clock::now() - start_time < wait_time);
+    EXPECT_TRUE(ok) << "new scopes not recognized after " << wait_time.count() << " seconds";
+
+    // Host both scopes in a single scoperunner.
+    auto host_pid = fork();
+    if (host_pid == 0)
+    {
+        const char* const args[] = {"scoperunner [Registry test]", TEST_RUNTIME_FILE,
+                                    TEST_RUNTIME_PATH "/scopes/testscopeC/testscopeC.ini",
+                                    TEST_RUNTIME_PATH "/scopes/testscopeE/testscopeE.ini",
+                                    nullptr};
+
+        if (execv(TEST_SCOPERUNNER_PATH "/scoperunner", const_cast<char* const*>(args)) < 0)
+        {
+            perror("Error starting scoperunner:");
+        }
+        exit(0);
+    }
+
+    // The registry records both hosted scopes as running, so it does not start them itself.
+    EXPECT_TRUE(wait_for_running(2));
+    EXPECT_TRUE(r->is_scope_running("testscopeC"));
+    EXPECT_TRUE(r->is_scope_running("testscopeE"));
+
+    // Both scopes are reachable through the registry.
+    for (std::string id : { "testscopeC", "testscopeE" })
+    {
+        auto receiver = std::make_shared<Receiver>();
+        r->get_metadata(id).proxy()->search("foo", SearchMetadata("C", "desktop"), receiver);
+        EXPECT_TRUE(receiver->wait_until_finished()) << id;
+    }
+
+    // Stopping the host stops both scopes.
+    kill(host_pid, SIGTERM);
+    int status;
+    waitpid(host_pid, &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(0, WEXITSTATUS(status));
+
+    EXPECT_TRUE(wait_for_running(0));
+    EXPECT_FALSE(r->is_scope_running("testscopeC"));
+    EXPECT_FALSE(r->is_scope_running("testscopeE"));
+
+    filesystem::remove_all(TEST_RUNTIME_PATH "/scopes/testscopeC", ec);
+    filesystem::remove_all(TEST_RUNTIME_PATH "/scopes/testscopeE", ec);
+
+    rt->destroy();
+}
+
 TEST(Registry, list_update_notify_before_click_folder_exists)
 {
     bool update_received;
@@ -708,6 +875,7 @@ int main(int argc, char **argv)
     system::error_code ec;
     filesystem::remove_all(TEST_RUNTIME_PATH "/applications", ec);
     filesystem::remove_all(TEST_RUNTIME_PATH "/scopes/testscopeC", ec);
+    filesystem::remove_all(TEST_RUNTIME_PATH "/scopes/testscopeE", ec);
     filesystem::remove_all(TEST_RUNTIME_PATH "/click",ec);
     filesystem::remove(TEST_RUNTIME_PATH "/scopes/testscopeD", ec);
     filesystem::remove_all(TEST_RUNTIME_PATH "/scopes/testfolder", ec);
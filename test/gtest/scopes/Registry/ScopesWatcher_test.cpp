@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <DirWatcher.h>
+#include <ScopesWatcher.h>
+
+#include <unity/scopes/internal/Executor.h>
+
+#include <boost/filesystem/operations.hpp>
+#include <core/posix/signal.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+using namespace boost;
+using namespace scoperegistry;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+std::string const watch_dir = TEST_RUNTIME_PATH "/watcher";
+
+auto const debounce_window = std::chrono::milliseconds(300);
+
+// Long enough for any pending event to have been delivered.
+auto const settle_time = std::chrono::milliseconds(1500);
+
+void write_file(std::string const& path, std::string const& contents)
+{
+    std::ofstream ofs(path);
+    ofs << contents;
+}
+
+void reset_dir(std::string const& dir)
+{
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+}
+
+// Records the events delivered by DirWatcher, optionally coalescing by parent directory.
+
+class TestWatcher : public DirWatcher
+{
+public:
+    struct Event
+    {
+        EventType type;
+        FileType file_type;
+        std::string path;
+        std::chrono::steady_clock::time_point time;
+    };
+
+    TestWatcher(Logger& logger, bool by_dir = false)
+        : DirWatcher(logger, debounce_window)
+        , by_dir_(by_dir)
+    {
+    }
+
+    ~TestWatcher()
+    {
+        cleanup();
+    }
+
+    // Waits until at least n events have been delivered, then waits (for the settle time) for
+    // more than n events and returns all events, so tests can check that no extra events turn up.
+    std::vector<Event> events(size_t n)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_for(lock, std::chrono::seconds(5), [this, n] { return events_.size() >= n; });
+        cond_.wait_for(lock, settle_time, [this, n] { return events_.size() > n; });
+        return events_;
+    }
+
+private:
+    std::string coalesce_key(std::string const& path) const override
+    {
+        return by_dir_ ? filesystem::path(path).parent_path().native() : path;
+    }
+
+    void watch_event(EventType type, FileType file_type, std::string const& path) override
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back(Event{ type, file_type, path, std::chrono::steady_clock::now() });
+        cond_.notify_all();
+    }
+
+    bool const by_dir_;
+    std::vector<Event> events_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+};
+
+std::shared_ptr<core::posix::ChildProcess::DeathObserver> death_observer()
+{
+    static std::shared_ptr<core::posix::ChildProcess::DeathObserver> observer;
+    if (!observer)
+    {
+        std::shared_ptr<core::posix::SignalTrap> trap(
+            core::posix::trap_signals_for_all_subsequent_threads({ core::posix::Signal::sig_chld }));
+        observer = std::move(core::posix::ChildProcess::DeathObserver::create_once_with_signal_trap(trap));
+    }
+    return observer;
+}
+
+// Records the .ini files (and their contents at the time) reported by ScopesWatcher.
+
+class IniRecorder
+{
+public:
+    IniRecorder()
+        : logger_("ScopesWatcher_test")
+        , registry_(std::make_shared<RegistryObject>(*death_observer(), std::make_shared<Executor>(), nullptr))
+        , watcher_(registry_,
+                   [this](std::pair<std::string, std::string> const& ini)
+                   {
+                       std::ifstream ifs(ini.second);
+                       std::string contents((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+                       std::lock_guard<std::mutex> lock(mutex_);
+                       inis_.push_back(std::make_pair(ini.first, contents));
+                       cond_.notify_all();
+                   },
+                   logger_)
+    {
+    }
+
+    void add_install_dir(std::string const& dir)
+    {
+        watcher_.add_install_dir(dir);
+    }
+
+    std::vector<std::pair<std::string, std::string>> inis(size_t n)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_for(lock, std::chrono::seconds(5), [this, n] { return inis_.size() >= n; });
+        cond_.wait_for(lock, settle_time, [this, n] { return inis_.size() > n; });
+        return inis_;
+    }
+
+private:
+    Logger logger_;
+    RegistryObject::SPtr registry_;
+    std::vector<std::pair<std::string, std::string>> inis_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    ScopesWatcher watcher_;
+};
+
+} // namespace
+
+TEST(DirWatcher, events_are_debounced)
+{
+    reset_dir(watch_dir);
+
+    Logger logger("DirWatcher_test");
+    TestWatcher watcher(logger);
+    watcher.add_watch(watch_dir);
+
+    // Each write produces an Added or Modified event. Nothing is delivered until
+    // the writes have stopped for the debounce window.
+    std::string const path = watch_dir + "/file";
+    for (int i = 0; i < 5; ++i)
+    {
+        write_file(path, std::to_string(i));
+        std::this_thread::sleep_for(debounce_window / 3);
+    }
+    auto last_write = std::chrono::steady_clock::now();
+    write_file(path, "last");
+
+    auto events = watcher.events(1);
+    ASSERT_EQ(1u, events.size());
+    EXPECT_EQ(DirWatcher::Added, events[0].type);
+    EXPECT_EQ(DirWatcher::File, events[0].file_type);
+    EXPECT_EQ(path, events[0].path);
+    EXPECT_GE(events[0].time - last_write, debounce_window);
+}
+
+TEST(DirWatcher, continuous_events_are_delivered_eventually)
+{
+    reset_dir(watch_dir);
+
+    Logger logger("DirWatcher_test");
+    TestWatcher watcher(logger);
+    watcher.add_watch(watch_dir);
+
+    // Keep writing for longer than the maximum hold-back time of ten debounce windows.
+    // The first event must be delivered while the writes are still going on.
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < 15 * debounce_window)
+    {
+        write_file(watch_dir + "/file", "x");
+        std::this_thread::sleep_for(debounce_window / 3);
+    }
+
+    auto events = watcher.events(1);
+    ASSERT_FALSE(events.empty());
+    EXPECT_LT(events[0].time - start, 12 * debounce_window);
+}
+
+TEST(DirWatcher, events_are_coalesced_by_key)
+{
+    reset_dir(watch_dir);
+
+    Logger logger("DirWatcher_test");
+
+    // By default, only events for the same path are coalesced.
+    {
+        TestWatcher watcher(logger);
+        watcher.add_watch(watch_dir);
+
+        write_file(watch_dir + "/a", "a");
+        write_file(watch_dir + "/b", "b");
+
+        auto events = watcher.events(2);
+        ASSERT_EQ(2u, events.size());
+        EXPECT_EQ(watch_dir + "/a", events[0].path);
+        EXPECT_EQ(watch_dir + "/b", events[1].path);
+    }
+
+    reset_dir(watch_dir);
+
+    // With the directory as the key, events for different files in the same directory are coalesced,
+    // unless something was removed in between.
+    {
+        TestWatcher watcher(logger, true);
+        watcher.add_watch(watch_dir);
+
+        write_file(watch_dir + "/a", "a");
+        write_file(watch_dir + "/b", "b");
+        filesystem::remove(watch_dir + "/a");
+        write_file(watch_dir + "/c", "c");
+        write_file(watch_dir + "/d", "d");
+
+        auto events = watcher.events(3);
+        ASSERT_EQ(3u, events.size());
+        EXPECT_EQ(DirWatcher::Added, events[0].type);
+        EXPECT_EQ(watch_dir + "/a", events[0].path);
+        EXPECT_EQ(DirWatcher::Removed, events[1].type);
+        EXPECT_EQ(watch_dir + "/a", events[1].path);
+        EXPECT_EQ(DirWatcher::Added, events[2].type);
+        EXPECT_EQ(watch_dir + "/c", events[2].path);
+    }
+}
+
+TEST(ScopesWatcher, installed_scope_is_reported_once)
+{
+    std::string const install_dir = watch_dir + "/scopes";
+    reset_dir(install_dir);
+
+    IniRecorder recorder;
+    recorder.add_install_dir(install_dir);
+
+    // Install the scope the way a package manager does: create the scope directory,
+    // then create the .ini file and write it in several pieces.
+    std::string const scope_dir = install_dir + "/scopeA";
+    filesystem::create_directory(scope_dir);
+    {
+        std::ofstream ofs(scope_dir + "/scopeA.ini");
+        ofs << "[ScopeConfig]\n" << std::flush;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        ofs << "DisplayName = A\n" << std::flush;
+    }
+
+    auto inis = recorder.inis(1);
+    ASSERT_EQ(1u, inis.size());
+    EXPECT_EQ("scopeA", inis[0].first);
+    EXPECT_EQ("[ScopeConfig]\nDisplayName = A\n", inis[0].second);
+
+    // Rewriting the .ini file several times in quick succession is reported once, with the final contents.
+    write_file(scope_dir + "/scopeA.ini", "[ScopeConfig]\nDisplayName = B\n");
+    write_file(scope_dir + "/scopeA.ini", "[ScopeConfig]\nDisplayName = C\n");
+
+    inis = recorder.inis(2);
+    ASSERT_EQ(2u, inis.size());
+    EXPECT_EQ("[ScopeConfig]\nDisplayName = C\n", inis[1].second);
+}
+
+TEST(ScopesWatcher, unchanged_ini_is_not_reported_again)
+{
+    std::string const install_dir = watch_dir + "/scopes";
+    reset_dir(install_dir);
+    std::string const scope_dir = install_dir + "/scopeA";
+    filesystem::create_directory(scope_dir);
+    std::string const ini = scope_dir + "/scopeA.ini";
+    write_file(ini, "[ScopeConfig]\nDisplayName = A\n");
+
+    IniRecorder recorder;
+    recorder.add_install_dir(install_dir);
+
+    // The existing scope is reported when the install dir is added.
+    auto inis = recorder.inis(1);
+    ASSERT_EQ(1u, inis.size());
+
+    // Touching or rewriting the file with the same contents is not reported.
+    write_file(ini, "[ScopeConfig]\nDisplayName = A\n");
+    inis = recorder.inis(1);
+    EXPECT_EQ(1u, inis.size());
+
+    // Changed contents are reported.
+    write_file(ini, "[ScopeConfig]\nDisplayName = B\n");
+    inis = recorder.inis(2);
+    ASSERT_EQ(2u, inis.size());
+    EXPECT_EQ("[ScopeConfig]\nDisplayName = B\n", inis[1].second);
+
+    // After the file was removed, the same contents are reported again.
+    filesystem::remove(ini);
+    std::this_thread::sleep_for(settle_time);
+    write_file(ini, "[ScopeConfig]\nDisplayName = B\n");
+    inis = recorder.inis(3);
+    ASSERT_EQ(3u, inis.size());
+    EXPECT_EQ("[ScopeConfig]\nDisplayName = B\n", inis[2].second);
+}
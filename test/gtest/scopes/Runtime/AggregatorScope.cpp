@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "AggregatorScope.h"
+
+#include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/ListenerBase.h>
+#include <unity/scopes/SearchReply.h>
+
+#include <condition_variable>
+#include <mutex>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace std;
+using namespace unity::scopes;
+
+namespace
+{
+
+class ChildReceiver : public SearchListenerBase
+{
+public:
+    virtual void push(CategorisedResult) override
+    {
+    }
+
+    virtual void finished(CompletionDetails const& details) override
+    {
+        EXPECT_EQ(CompletionDetails::OK, details.status());
+        lock_guard<mutex> lock(mutex_);
+        finished_ = true;
+        cond_.notify_all();
+    }
+
+    bool wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        return cond_.wait_for(lock, chrono::seconds(5), [this]{ return finished_; });
+    }
+
+private:
+    mutex mutex_;
+    condition_variable cond_;
+    bool finished_ = false;
+};
+
+class AggregatorQuery : public SearchQueryBase
+{
+public:
+    AggregatorQuery(CannedQuery const& query, SearchMetadata const& metadata, ScopeProxy const& child)
+        : SearchQueryBase(query, metadata)
+        , child_(child)
+    {
+    }
+
+    virtual void cancelled() override
+    {
+    }
+
+    virtual void run(SearchReplyProxy const& reply) override
+    {
+        auto receiver = make_shared<ChildReceiver>();
+        subsearch(child_, query().query_string(), receiver);
+        EXPECT_TRUE(receiver->wait_until_finished());
+
+        auto cat = reply->register_category("cat1", "Category 1", "");
+        CategorisedResult res(cat);
+        res.set_uri("uri");
+        res.set_title("title");
+        reply->push(res);
+    }
+
+private:
+    ScopeProxy child_;
+};
+
+}  // namespace
+
+AggregatorScope::AggregatorScope(ScopeProxy const& child)
+    : child_(child)
+{
+}
+
+SearchQueryBase::UPtr AggregatorScope::search(CannedQuery const& query, SearchMetadata const& metadata)
+{
+    return SearchQueryBase::UPtr(new AggregatorQuery(query, metadata, child_));
+}
+
+PreviewQueryBase::UPtr AggregatorScope::preview(Result const&, ActionMetadata const&)
+{
+    return nullptr;  // Not called
+}
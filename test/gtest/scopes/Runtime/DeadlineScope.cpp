@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DeadlineScope.h"
+
+#include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/ListenerBase.h>
+#include <unity/scopes/SearchReply.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace std;
+using namespace unity::scopes;
+
+namespace
+{
+
+atomic_int cancelled_count_(0);
+
+mutex child_mutex;
+string child_message;
+
+int64_t to_ms(chrono::system_clock::time_point t)
+{
+    return chrono::duration_cast<chrono::milliseconds>(t.time_since_epoch()).count();
+}
+
+class ChildReceiver : public SearchListenerBase
+{
+public:
+    ChildReceiver()
+        : child_deadline_(-1)
+    {
+    }
+
+    virtual void push(CategorisedResult result) override
+    {
+        lock_guard<mutex> lock(mutex_);
+        child_deadline_ = result["deadline"].get_int64_t();
+        cond_.notify_all();
+    }
+
+    virtual void finished(CompletionDetails const& details) override
+    {
+        EXPECT_EQ(CompletionDetails::Cancelled, details.status());
+        lock_guard<mutex> lock(child_mutex);
+        child_message = details.message();
+    }
+
+    int64_t wait_for_child_deadline()
+    {
+        unique_lock<mutex> lock(mutex_);
+        cond_.wait_for(lock, chrono::seconds(5), [this]{ return child_deadline_ != -1; });
+        return child_deadline_;
+    }
+
+private:
+    mutex mutex_;
+    condition_variable cond_;
+    int64_t child_deadline_;
+};
+
+class DeadlineQuery : public SearchQueryBase
+{
+public:
+    DeadlineQuery(CannedQuery const& query,
+                  SearchMetadata const& metadata,
+                  ScopeProxy const& child,
+                  chrono::milliseconds const& margin)
+        : SearchQueryBase(query, metadata)
+        , child_(child)
+        , margin_(margin)
+        , cancelled_(false)
+    {
+    }
+
+    virtual void cancelled() override
+    {
+        ++cancelled_count_;
+        lock_guard<mutex> lock(mutex_);
+        cancelled_ = true;
+        cond_.notify_all();
+    }
+
+    virtual void run(SearchReplyProxy const& reply) override
+    {
+        auto cat = reply->register_category("cat1", "Category 1", "");
+        CategorisedResult res(cat);
+        res.set_uri("uri");
+        res.set_title("title");
+        res["deadline"] = Variant(to_ms(search_metadata().deadline()));
+
+        if (child_)
+        {
+            auto receiver = make_shared<ChildReceiver>();
+            subsearch(child_, query().query_string(), receiver);
+            res["child_deadline"] = Variant(receiver->wait_for_child_deadline());
+            res["margin"] = Variant(int64_t(margin_.count()));
+        }
+        reply->push(res);
+
+        // We time out the wait because, otherwise, the scope's object adapter can't shut down
+        // and the test hangs forever. If this fails, the deadline did not cancel the query.
+        unique_lock<mutex> lock(mutex_);
+        EXPECT_TRUE(cond_.wait_for(lock, chrono::seconds(5), [this]{ return cancelled_; }));
+    }
+
+private:
+    ScopeProxy child_;
+    chrono::milliseconds margin_;
+    mutex mutex_;
+    condition_variable cond_;
+    bool cancelled_;
+};
+
+}  // namespace
+
+DeadlineScope::DeadlineScope(ScopeProxy const& child, chrono::milliseconds const& margin)
+    : child_(child)
+    , margin_(margin)
+{
+}
+
+SearchQueryBase::UPtr DeadlineScope::search(CannedQuery const& query, SearchMetadata const& metadata)
+{
+    return SearchQueryBase::UPtr(new DeadlineQuery(query, metadata, child_, margin_));
+}
+
+PreviewQueryBase::UPtr DeadlineScope::preview(Result const&, ActionMetadata const&)
+{
+    return nullptr;  // Not called
+}
+
+int DeadlineScope::cancelled_count()
+{
+    return cancelled_count_;
+}
+
+string DeadlineScope::child_finished_message()
+{
+    lock_guard<mutex> lock(child_mutex);
+    return child_message;
+}
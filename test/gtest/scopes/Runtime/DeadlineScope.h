@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/ScopeBase.h>
+
+#include <chrono>
+#include <string>
+
+// Without a child, each query pushes one result with the deadline it received and
+// then waits to be cancelled. With a child, each query forwards the query to the child
+// and pushes one result with its own deadline, the child's deadline, and the margin
+// for the hop to the child. Either way, the query runs longer than any deadline.
+
+class DeadlineScope : public unity::scopes::ScopeBase
+{
+public:
+    DeadlineScope(unity::scopes::ScopeProxy const& child = nullptr,
+                  std::chrono::milliseconds const& margin = std::chrono::milliseconds(0));
+
+    virtual unity::scopes::SearchQueryBase::UPtr search(unity::scopes::CannedQuery const&,
+                                                        unity::scopes::SearchMetadata const&) override;
+    virtual unity::scopes::PreviewQueryBase::UPtr preview(unity::scopes::Result const&,
+                                                          unity::scopes::ActionMetadata const&) override;
+
+    // Number of queries that had their cancelled() method called, across all instances.
+    static int cancelled_count();
+
+    // The message of the completion details that the aggregator received for the child query.
+    static std::string child_finished_message();
+
+private:
+    unity::scopes::ScopeProxy child_;
+    std::chrono::milliseconds margin_;
+};
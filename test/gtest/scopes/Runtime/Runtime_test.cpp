@@ -17,6 +17,8 @@
  */
 
 #include <unity/scopes/ActionMetadata.h>
+#include <unity/scopes/ActivationListenerBase.h>
+#include <unity/scopes/ActivationResponse.h>
 #include <unity/scopes/CategorisedResult.h>
 #include <unity/scopes/internal/MWScope.h>
 #include <unity/scopes/internal/RegistryObject.h>
@@ -33,6 +35,8 @@
 #include <gtest/gtest.h>
 #pragma GCC diagnostic pop
 
+#include "AggregatorScope.h"
+#include "DeadlineScope.h"
 #include "PusherScope.h"
 #include "SlowCreateScope.h"
 #include "TestScope.h"
@@ -125,6 +129,16 @@ public:
             EXPECT_EQ("Partial results returned due to poor internet connection.", details.info_list()[1].message());
         }
 
+        EXPECT_TRUE(details.has_timings());
+        auto const timings = details.timings();
+        EXPECT_EQ("TestScope", timings.scope_id());
+        EXPECT_EQ(1u, timings.result_count());
+        EXPECT_GT(timings.first_push().count(), 0);
+        EXPECT_LE(timings.first_push(), timings.last_push());
+        EXPECT_LE(timings.last_push(), timings.total());
+        EXPECT_LE(timings.send_time(), timings.total());
+        EXPECT_TRUE(timings.subqueries().empty());
+
         // Signal that the query has completed.
         unique_lock<mutex> lock(mutex_);
         query_complete_ = true;
@@ -213,6 +227,16 @@ public:
             EXPECT_EQ("Partial results returned due to inaccurate location data.", details.info_list()[1].message());
         }
 
+        EXPECT_TRUE(details.has_timings());
+        auto const timings = details.timings();
+        EXPECT_EQ("TestScope", timings.scope_id());
+        EXPECT_EQ(0u, timings.result_count());  // Widgets and attributes are not results
+        EXPECT_GT(timings.first_push().count(), 0);
+        EXPECT_LE(timings.first_push(), timings.last_push());
+        EXPECT_LE(timings.last_push(), timings.total());
+        EXPECT_LE(timings.send_time(), timings.total());
+        EXPECT_TRUE(timings.subqueries().empty());
+
         // Signal that the query has completed.
         unique_lock<mutex> lock(mutex_);
         query_complete_ = true;
@@ -390,6 +414,70 @@ TEST(Runtime, preview)
     }
 }
 
+class ActivationReceiver : public ActivationListenerBase
+{
+public:
+    virtual void activated(ActivationResponse const& response) override
+    {
+        EXPECT_EQ(ActivationResponse::NotHandled, response.status());
+    }
+
+    virtual void finished(CompletionDetails const& details) override
+    {
+        EXPECT_EQ(CompletionDetails::OK, details.status());
+
+        EXPECT_TRUE(details.has_timings());
+        auto const timings = details.timings();
+        EXPECT_EQ("TestScope", timings.scope_id());
+        EXPECT_EQ(0u, timings.result_count());
+        EXPECT_GT(timings.first_push().count(), 0);
+        EXPECT_EQ(timings.first_push(), timings.last_push());  // The response is the only push
+        EXPECT_LE(timings.last_push(), timings.total());
+        EXPECT_LE(timings.send_time(), timings.total());
+        EXPECT_TRUE(timings.subqueries().empty());
+
+        unique_lock<mutex> lock(mutex_);
+        query_complete_ = true;
+        cond_.notify_one();
+    }
+
+    void wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return this->query_complete_; });
+    }
+
+private:
+    bool query_complete_ = false;
+    mutex mutex_;
+    condition_variable cond_;
+};
+
+TEST(Runtime, activate)
+{
+    auto reg_rt = run_test_registry();
+
+    auto rt = internal::RuntimeImpl::create("", "Runtime.ini");
+    auto mw = rt->factory()->create("TestScope", "Zmq", "Zmq.ini");
+    mw->start();
+    auto proxy = mw->create_scope_proxy("TestScope");
+    auto scope = internal::ScopeImpl::create(proxy, "TestScope");
+
+    // run a query first, so we have a result to activate
+    auto receiver = make_shared<Receiver>();
+    auto ctrl = scope->search("test", SearchMetadata("pl", "phone"), receiver);
+    receiver->wait_until_finished();
+
+    auto result = receiver->last_result();
+    ASSERT_TRUE(result.get() != nullptr);
+
+    auto target = result->target_scope_proxy();
+    ASSERT_TRUE(target != nullptr);
+    auto activator = make_shared<ActivationReceiver>();
+    auto activate_ctrl = target->activate(*result, ActionMetadata("en", "phone"), activator);
+    activator->wait_until_finished();
+}
+
 TEST(Runtime, cardinality)
 {
     auto reg_rt = run_test_registry();
@@ -482,6 +570,193 @@ TEST(Runtime, early_cancel)
     this_thread::sleep_for(chrono::milliseconds(500));
 }
 
+class DeadlineReceiver : public SearchListenerBase
+{
+public:
+    DeadlineReceiver()
+        : query_complete_(false),
+          status_(CompletionDetails::OK),
+          deadline_(0),
+          child_deadline_(0),
+          margin_(0)
+    {
+    }
+
+    virtual void push(CategorisedResult result) override
+    {
+        lock_guard<mutex> lock(mutex_);
+        deadline_ = result["deadline"].get_int64_t();
+        child_deadline_ = result["child_deadline"].get_int64_t();
+        margin_ = result["margin"].get_int64_t();
+    }
+
+    virtual void finished(CompletionDetails const& details) override
+    {
+        unique_lock<mutex> lock(mutex_);
+        status_ = details.status();
+        message_ = details.message();
+        query_complete_ = true;
+        cond_.notify_one();
+    }
+
+    void wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return this->query_complete_; });
+    }
+
+    CompletionDetails::CompletionStatus status()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return status_;
+    }
+
+    string message()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return message_;
+    }
+
+    int64_t deadline()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return deadline_;
+    }
+
+    int64_t child_deadline()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return child_deadline_;
+    }
+
+    int64_t margin()
+    {
+        lock_guard<mutex> lock(mutex_);
+        return margin_;
+    }
+
+private:
+    bool query_complete_;
+    CompletionDetails::CompletionStatus status_;
+    string message_;
+    int64_t deadline_;
+    int64_t child_deadline_;
+    int64_t margin_;
+    mutex mutex_;
+    condition_variable cond_;
+};
+
+TEST(Runtime, deadline)
+{
+    auto reg_rt = run_test_registry();
+    auto rt = internal::RuntimeImpl::create("", "Runtime.ini");
+    auto mw = rt->factory()->create("DeadlineAggregator", "Zmq", "Zmq.ini");
+    mw->start();
+    auto proxy = mw->create_scope_proxy("DeadlineAggregator");
+    auto scope = internal::ScopeImpl::create(proxy, "DeadlineAggregator");
+
+    // The aggregator and its child both take longer than the deadline.
+    SearchMetadata metadata("unused", "unused");
+    auto const deadline = chrono::system_clock::now() + chrono::seconds(1);
+    metadata.set_deadline(deadline);
+    auto const deadline_ms = chrono::duration_cast<chrono::milliseconds>(deadline.time_since_epoch()).count();
+
+    auto receiver = make_shared<DeadlineReceiver>();
+    auto const start_time = chrono::steady_clock::now();
+    scope->search("test", metadata, receiver);
+    receiver->wait_until_finished();
+
+    // The scope cancelled the query when the deadline expired, instead of
+    // the query running into the five-second timeout in the scope.
+    EXPECT_LT(chrono::steady_clock::now() - start_time, chrono::seconds(4));
+    EXPECT_EQ(CompletionDetails::Cancelled, receiver->status());
+    EXPECT_EQ("query deadline expired", receiver->message());
+
+    // The aggregator got our deadline, and the child got it less the margin for the hop.
+    EXPECT_EQ(deadline_ms, receiver->deadline());
+    EXPECT_GT(receiver->margin(), 0);
+    EXPECT_EQ(deadline_ms - receiver->margin(), receiver->child_deadline());
+
+    // Both queries were cancelled. The child's own deadline expired first.
+    auto const stop_time = chrono::steady_clock::now() + chrono::seconds(2);
+    while (DeadlineScope::cancelled_count() < 2 && chrono::steady_clock::now() < stop_time)
+    {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    EXPECT_EQ(2, DeadlineScope::cancelled_count());
+    EXPECT_EQ("query deadline expired", DeadlineScope::child_finished_message());
+}
+
+class AggregatorReceiver : public SearchListenerBase
+{
+public:
+    virtual void push(CategorisedResult) override
+    {
+    }
+
+    virtual void finished(CompletionDetails const& details) override
+    {
+        unique_lock<mutex> lock(mutex_);
+        details_.reset(new CompletionDetails(details));
+        cond_.notify_one();
+    }
+
+    CompletionDetails wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return this->details_ != nullptr; });
+        return *details_;
+    }
+
+private:
+    unique_ptr<CompletionDetails> details_;
+    mutex mutex_;
+    condition_variable cond_;
+};
+
+TEST(Runtime, aggregator_timings)
+{
+    auto reg_rt = run_test_registry();
+    auto rt = internal::RuntimeImpl::create("", "Runtime.ini");
+    auto mw = rt->factory()->create("Aggregator", "Zmq", "Zmq.ini");
+    mw->start();
+    auto proxy = mw->create_scope_proxy("Aggregator");
+    auto scope = internal::ScopeImpl::create(proxy, "Aggregator");
+
+    auto receiver = make_shared<AggregatorReceiver>();
+    scope->search("test", SearchMetadata("pl", "phone"), receiver);
+    auto const details = receiver->wait_until_finished();
+    EXPECT_EQ(CompletionDetails::OK, details.status());
+
+    ASSERT_TRUE(details.has_timings());
+    auto const timings = details.timings();
+    EXPECT_EQ("Aggregator", timings.scope_id());
+    EXPECT_EQ(1u, timings.result_count());
+
+    // The aggregator waits for its child, so the child's timings arrive with the aggregator's.
+    auto const subqueries = timings.subqueries();
+    ASSERT_EQ(1u, subqueries.size());
+    auto const& child = subqueries[0];
+    EXPECT_EQ("TestScope", child.scope_id());
+    EXPECT_EQ(1u, child.result_count());
+    EXPECT_GT(child.first_push().count(), 0);
+    EXPECT_LE(child.first_push(), child.last_push());
+    EXPECT_LE(child.last_push(), child.total());
+    EXPECT_LE(child.total(), timings.total());
+    EXPECT_TRUE(child.subqueries().empty());
+}
+
+void aggregator_thread(Runtime::SPtr const& rt)
+{
+    auto client_rt = internal::RuntimeImpl::create("", "Runtime.ini");
+    auto mw = client_rt->factory()->create("AggregatorChild", "Zmq", "Zmq.ini");
+    mw->start();
+    auto child = internal::ScopeImpl::create(mw->create_scope_proxy("TestScope"), "TestScope");
+
+    AggregatorScope scope(child);
+    rt->run_scope(&scope, "");
+}
+
 void scope_thread(Runtime::SPtr const& rt)
 {
     TestScope scope;
@@ -500,6 +775,23 @@ void slow_create_thread(Runtime::SPtr const& rt)
     rt->run_scope(&scope, "");
 }
 
+void deadline_child_thread(Runtime::SPtr const& rt)
+{
+    DeadlineScope scope;
+    rt->run_scope(&scope, "");
+}
+
+void deadline_aggregator_thread(Runtime::SPtr const& rt)
+{
+    auto client_rt = internal::RuntimeImpl::create("", "Runtime.ini");
+    auto mw = client_rt->factory()->create("DeadlineChild", "Zmq", "Zmq.ini");
+    mw->start();
+    auto child = internal::ScopeImpl::create(mw->create_scope_proxy("DeadlineChild"), "DeadlineChild");
+
+    DeadlineScope scope(child, client_rt->deadline_margin());
+    rt->run_scope(&scope, "");
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -515,6 +807,15 @@ int main(int argc, char **argv)
     Runtime::SPtr scrt = move(Runtime::create_scope_runtime("SlowCreateScope", "Runtime.ini"));
     std::thread slow_create_t(slow_create_thread, scrt);
 
+    Runtime::SPtr dcrt = move(Runtime::create_scope_runtime("DeadlineChild", "Runtime.ini"));
+    std::thread deadline_child_t(deadline_child_thread, dcrt);
+
+    Runtime::SPtr dart = move(Runtime::create_scope_runtime("DeadlineAggregator", "Runtime.ini"));
+    std::thread deadline_aggregator_t(deadline_aggregator_thread, dart);
+
+    Runtime::SPtr art = move(Runtime::create_scope_runtime("Aggregator", "Runtime.ini"));
+    std::thread aggregator_t(aggregator_thread, art);
+
     // Give threads some time to bind to their endpoints, to avoid getting ObjectNotExistException
     // from a synchronous remote call.
     this_thread::sleep_for(chrono::milliseconds(500));
@@ -526,6 +827,9 @@ int main(int argc, char **argv)
 
     rc = RUN_ALL_TESTS();
 
+    art->destroy();
+    aggregator_t.join();
+
     srt->destroy();
     scope_t.join();
 
@@ -535,5 +839,11 @@ int main(int argc, char **argv)
     scrt->destroy();
     slow_create_t.join();
 
+    dart->destroy();
+    deadline_aggregator_t.join();
+
+    dcrt->destroy();
+    deadline_child_t.join();
+
     return rc;
 }
@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyntheticScope.h"
+
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/CategoryRenderer.h>
+#include <unity/scopes/Department.h>
+#include <unity/scopes/OptionSelectorFilter.h>
+#include <unity/scopes/Registry.h>
+#include <unity/scopes/ScopeExceptions.h>
+#include <unity/scopes/SearchListenerBase.h>
+#include <unity/scopes/SearchReply.h>
+#include <unity/UnityExceptions.h>
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#define EXPORT __attribute__ ((visibility ("default")))
+
+using namespace std;
+using namespace unity::scopes;
+
+namespace
+{
+
+int to_int(string const& key, string const& value)
+{
+    size_t end;
+    int n;
+    try
+    {
+        n = stoi(value, &end);
+    }
+    catch (std::exception const&)
+    {
+        end = 0;
+    }
+    if (end == 0 || end != value.size() || n < 0)
+    {
+        throw unity::InvalidArgumentException("SyntheticScope: invalid value for " + key + ": \"" + value + "\"");
+    }
+    return n;
+}
+
+double to_double(string const& key, string const& value)
+{
+    size_t end;
+    double d;
+    try
+    {
+        d = stod(value, &end);
+    }
+    catch (std::exception const&)
+    {
+        end = 0;
+    }
+    if (end == 0 || end != value.size() || d < 0 || d > 1)
+    {
+        throw unity::InvalidArgumentException("SyntheticScope: invalid value for " + key + ": \"" + value + "\"");
+    }
+    return d;
+}
+
+// Returns false if key is not one of our parameters.
+
+bool set_param(SyntheticConfig& c, string const& key, string const& value)
+{
+    static map<string, int SyntheticConfig::*> const int_params =
+    {
+        { "results", &SyntheticConfig::results },
+        { "categories", &SyntheticConfig::categories },
+        { "attrs", &SyntheticConfig::attrs },
+        { "attr_size", &SyntheticConfig::attr_size },
+        { "departments", &SyntheticConfig::departments },
+        { "filters", &SyntheticConfig::filters },
+        { "delay_ms", &SyntheticConfig::delay_ms },
+        { "burn_ms", &SyntheticConfig::burn_ms },
+        { "fanout", &SyntheticConfig::fanout },
+        { "child_results", &SyntheticConfig::child_results }
+    };
+
+    auto it = int_params.find(key);
+    if (it != int_params.end())
+    {
+        c.*(it->second) = to_int(key, value);
+    }
+    else if (key == "child")
+    {
+        c.child = value;
+    }
+    else if (key == "fail")
+    {
+        if (!value.empty() && value != "search" && value != "run")
+        {
+            throw unity::InvalidArgumentException("SyntheticScope: invalid value for fail: \"" + value + "\"");
+        }
+        c.fail = value;
+    }
+    else if (key == "fail_rate")
+    {
+        c.fail_rate = to_double(key, value);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+// SettingsDB returns every "number" setting as a Double, so a setting of 5 arrives as 5.0.
+
+string double_to_string(double d)
+{
+    if (d == floor(d) && d >= numeric_limits<int>::min() && d <= numeric_limits<int>::max())
+    {
+        return to_string(static_cast<int>(d));
+    }
+    return to_string(d);
+}
+
+bool should_fail(SyntheticConfig const& c, string const& where)
+{
+    if (c.fail != where)
+    {
+        return false;
+    }
+    static thread_local mt19937 gen{random_device{}()};
+    return uniform_real_distribution<>(0, 1)(gen) < c.fail_rate;
+}
+
+void burn_cpu(chrono::milliseconds duration)
+{
+    auto const end = chrono::steady_clock::now() + duration;
+    volatile unsigned long n = 0;
+    while (chrono::steady_clock::now() < end)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            n = n + i;
+        }
+    }
+}
+
+// Forwards the results of a subsearch. The reply completes once this
+// forwarder and the query itself have let go of it.
+
+class Forwarder : public SearchListenerBase
+{
+public:
+    Forwarder(SearchReplyProxy const& reply)
+        : reply_(reply)
+    {
+    }
+
+    virtual void push(CategorisedResult result) override
+    {
+        reply_->push(result);
+    }
+
+    virtual void finished(CompletionDetails const&) override
+    {
+        reply_.reset();
+    }
+
+private:
+    SearchReplyProxy reply_;
+};
+
+class SyntheticQuery : public SearchQueryBase
+{
+public:
+    SyntheticQuery(CannedQuery const& query,
+                   SearchMetadata const& metadata,
+                   SyntheticConfig const& config)
+        : SearchQueryBase(query, metadata),
+          config_(config)
+    {
+    }
+
+    virtual void cancelled() override
+    {
+    }
+
+    virtual void run(SearchReplyProxy const& reply) override
+    {
+        if (config_.burn_ms > 0)
+        {
+            burn_cpu(chrono::milliseconds(config_.burn_ms));
+        }
+
+        if (config_.departments > 0)
+        {
+            Department::SPtr root = Department::create("", query(), "All departments");
+            for (int i = 0; i < config_.departments; ++i)
+            {
+                CannedQuery q = query();
+                q.set_department_id("dept" + to_string(i));
+                Department::SCPtr dept = Department::create("dept" + to_string(i), q, "Department " + to_string(i));
+                root->add_subdepartment(dept);
+            }
+            reply->register_departments(root);
+        }
+
+        if (config_.filters > 0)
+        {
+            Filters filters;
+            for (int i = 0; i < config_.filters; ++i)
+            {
+                auto filter = OptionSelectorFilter::create("filter" + to_string(i), "Filter " + to_string(i));
+                filter->add_option("a", "Option A");
+                filter->add_option("b", "Option B");
+                filters.push_back(move(filter));
+            }
+            reply->push(filters);
+        }
+
+        for (int i = 0; i < config_.fanout; ++i)
+        {
+            auto child = registry_->get_metadata(config_.child).proxy();
+            subsearch(child, "results=" + to_string(config_.child_results), make_shared<Forwarder>(reply));
+        }
+
+        vector<Category::SCPtr> cats;
+        CategoryRenderer rdr;
+        for (int i = 0; i < max(config_.categories, 1); ++i)
+        {
+            auto id = "cat" + to_string(i);
+            auto cat = reply->lookup_category(id);
+            cats.push_back(cat ? cat : reply->register_category(id, "Category " + to_string(i), "", rdr));
+        }
+
+        string const attr_value(config_.attr_size, 'x');
+        for (int i = 0; i < config_.results; ++i)
+        {
+            if (config_.delay_ms > 0)
+            {
+                this_thread::sleep_for(chrono::milliseconds(config_.delay_ms));
+            }
+            if (i == config_.results / 2 && should_fail(config_, "run"))
+            {
+                throw unity::ResourceException("SyntheticScope: injected failure in run()");
+            }
+
+            CategorisedResult res(cats[i % cats.size()]);
+            res.set_uri("uri" + to_string(i));
+            res.set_title("title " + to_string(i));
+            res.set_art("art");
+            res.set_dnd_uri("dnd_uri");
+            for (int a = 0; a < config_.attrs; ++a)
+            {
+                res["attr" + to_string(a)] = attr_value;
+            }
+            if (!reply->push(res))
+            {
+                return;  // Cancelled, or cardinality limit reached
+            }
+        }
+    }
+
+    void set_registry(RegistryProxy const& registry)
+    {
+        registry_ = registry;
+    }
+
+private:
+    SyntheticConfig const config_;
+    RegistryProxy registry_;
+};
+
+} // namespace
+
+SyntheticConfig SyntheticConfig::parse(VariantMap const& settings, string const& query_string)
+{
+    SyntheticConfig c;
+
+    // Unknown settings are ignored, so a scope can have settings that aren't workload parameters.
+    for (auto const& s : settings)
+    {
+        switch (s.second.which())
+        {
+            case Variant::Int:
+                set_param(c, s.first, to_string(s.second.get_int()));
+                break;
+            case Variant::Double:
+                set_param(c, s.first, double_to_string(s.second.get_double()));
+                break;
+            case Variant::String:
+                set_param(c, s.first, s.second.get_string());
+                break;
+            default:
+                break;  // Not one of ours
+        }
+    }
+
+    istringstream is(query_string);
+    string param;
+    while (is >> param)
+    {
+        auto pos = param.find('=');
+        if (pos == string::npos)
+        {
+            throw unity::InvalidArgumentException("SyntheticScope: expected key=value: \"" + param + "\"");
+        }
+        auto const key = param.substr(0, pos);
+        if (!set_param(c, key, param.substr(pos + 1)))
+        {
+            throw unity::InvalidArgumentException("SyntheticScope: unknown parameter: \"" + key + "\"");
+        }
+    }
+
+    return c;
+}
+
+void SyntheticScope::start(string const& scope_id)
+{
+    scope_id_ = scope_id;
+}
+
+SearchQueryBase::UPtr SyntheticScope::search(CannedQuery const& q, SearchMetadata const& metadata)
+{
+    VariantMap s;
+    try
+    {
+        s = settings();
+    }
+    catch (unity::LogicException const&)
+    {
+        // Not running under the scopes run time.
+    }
+    auto config = SyntheticConfig::parse(s, q.query_string());
+    if (config.child.empty())
+    {
+        config.child = scope_id_;
+    }
+    if (should_fail(config, "search"))
+    {
+        throw unity::ResourceException("SyntheticScope: injected failure in search()");
+    }
+
+    unique_ptr<SyntheticQuery> query(new SyntheticQuery(q, metadata, config));
+    if (config.fanout > 0)
+    {
+        query->set_registry(registry());
+    }
+    return SearchQueryBase::UPtr(move(query));
+}
+
+PreviewQueryBase::UPtr SyntheticScope::preview(Result const&, ActionMetadata const&)
+{
+    return nullptr;
+}
+
+extern "C"
+{
+
+    EXPORT
+    unity::scopes::ScopeBase*
+    // cppcheck-suppress unusedFunction
+    UNITY_SCOPE_CREATE_FUNCTION()
+    {
+        return new SyntheticScope;
+    }
+
+    EXPORT
+    void
+    // cppcheck-suppress unusedFunction
+    UNITY_SCOPE_DESTROY_FUNCTION(unity::scopes::ScopeBase* scope_base)
+    {
+        delete scope_base;
+    }
+
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unity/scopes/ScopeBase.h>
+
+#include <string>
+
+// A scope for benchmarks and stress tests whose workload is configurable.
+//
+// The parameters are taken from the scope's settings first (if the scope directory contains
+// a settings schema that defines any of them), and then from the query string, which is a
+// space-separated list of key=value pairs, for example, "results=100 attrs=5 delay_ms=2".
+// An empty query string runs the defaults.
+//
+//   results        Number of results (default 20).
+//   categories     Number of categories; results are distributed round-robin (default 1).
+//   attrs          Number of extra string attributes per result (default 0).
+//   attr_size      Size in bytes of each extra attribute (default 16).
+//   departments    Number of sub-departments to register (default 0).
+//   filters        Number of option selector filters to push (default 0).
+//   delay_ms       Sleep before each result (default 0).
+//   burn_ms        CPU time to burn in run() before the first result (default 0).
+//   fanout         Number of subsearches whose results are forwarded (default 0).
+//   child          Scope ID for subsearches (default: this scope).
+//   child_results  Number of results requested from each child (default 20).
+//   fail           "search" or "run" to throw from search() or run() (default: no failure).
+//   fail_rate      Probability with which "fail" applies, from 0 to 1 (default 1).
+//
+// Use the same library under different scope IDs (with scope.so as the library name)
+// to build aggregation hierarchies.
+
+struct SyntheticConfig
+{
+    int results = 20;
+    int categories = 1;
+    int attrs = 0;
+    int attr_size = 16;
+    int departments = 0;
+    int filters = 0;
+    int delay_ms = 0;
+    int burn_ms = 0;
+    int fanout = 0;
+    std::string child;
+    int child_results = 20;
+    std::string fail;
+    double fail_rate = 1;
+
+    // Throws unity::InvalidArgumentException for unknown keys and bad values.
+    static SyntheticConfig parse(unity::scopes::VariantMap const& settings, std::string const& query_string);
+};
+
+class SyntheticScope : public unity::scopes::ScopeBase
+{
+public:
+    virtual void start(std::string const& scope_id) override;
+
+    virtual unity::scopes::SearchQueryBase::UPtr search(unity::scopes::CannedQuery const& q,
+                                                        unity::scopes::SearchMetadata const& metadata) override;
+
+    virtual unity::scopes::PreviewQueryBase::UPtr preview(unity::scopes::Result const& result,
+                                                          unity::scopes::ActionMetadata const& metadata) override;
+
+private:
+    std::string scope_id_;
+};
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SyntheticScope.h"
+
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/CategoryRenderer.h>
+#include <unity/scopes/SearchMetadata.h>
+#include <unity/scopes/testing/Category.h>
+#include <unity/scopes/testing/MockSearchReply.h>
+#include <unity/UnityExceptions.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace std;
+using namespace unity::scopes;
+using namespace ::testing;
+
+namespace
+{
+
+// Runs a query with the given query string against a mock reply.
+void run_query(SyntheticScope& scope, string const& query_string, unity::scopes::testing::MockSearchReply& reply)
+{
+    CannedQuery query("synthetic");
+    query.set_query_string(query_string);
+    auto q = scope.search(query, SearchMetadata("C", "phone"));
+    q->run(SearchReplyProxy(&reply, [](SearchReply*) {}));
+}
+
+Category::SCPtr make_category(string const& id, string const& title, string const& icon, CategoryRenderer const& rdr)
+{
+    return make_shared<unity::scopes::testing::Category>(id, title, icon, rdr);
+}
+
+} // namespace
+
+TEST(SyntheticConfig, defaults)
+{
+    auto c = SyntheticConfig::parse(VariantMap(), "");
+    EXPECT_EQ(20, c.results);
+    EXPECT_EQ(1, c.categories);
+    EXPECT_EQ(0, c.attrs);
+    EXPECT_EQ(16, c.attr_size);
+    EXPECT_EQ(0, c.fanout);
+    EXPECT_EQ("", c.child);
+    EXPECT_EQ("", c.fail);
+    EXPECT_EQ(1, c.fail_rate);
+}
+
+TEST(SyntheticConfig, query_string_overrides_settings)
+{
+    VariantMap settings;
+    settings["results"] = 5;
+    settings["attrs"] = 3;
+    settings["fail_rate"] = 0.5;
+    settings["child"] = "other";
+    settings["unrelated"] = true;  // Ignored
+
+    auto c = SyntheticConfig::parse(settings, "  results=7   delay_ms=2 fail=run ");
+    EXPECT_EQ(7, c.results);
+    EXPECT_EQ(3, c.attrs);
+    EXPECT_EQ(2, c.delay_ms);
+    EXPECT_EQ("other", c.child);
+    EXPECT_EQ("run", c.fail);
+    EXPECT_EQ(0.5, c.fail_rate);
+}
+
+// SettingsDB returns all numbers as Double.
+
+TEST(SyntheticConfig, double_settings)
+{
+    VariantMap settings;
+    settings["results"] = 5.0;
+    settings["delay_ms"] = 0.0;
+    settings["fail_rate"] = 0.25;
+    settings["unrelated_number"] = 3.5;   // Ignored
+    settings["unrelated_string"] = "x";   // Ignored
+
+    auto c = SyntheticConfig::parse(settings, "");
+    EXPECT_EQ(5, c.results);
+    EXPECT_EQ(0, c.delay_ms);
+    EXPECT_EQ(0.25, c.fail_rate);
+
+    settings["attrs"] = 2.5;  // Not an integer
+    EXPECT_THROW(SyntheticConfig::parse(settings, ""), unity::InvalidArgumentException);
+}
+
+TEST(SyntheticConfig, exceptions)
+{
+    EXPECT_THROW(SyntheticConfig::parse(VariantMap(), "results"), unity::InvalidArgumentException);
+    EXPECT_THROW(SyntheticConfig::parse(VariantMap(), "nosuchkey=1"), unity::InvalidArgumentException);
+    EXPECT_THROW(SyntheticConfig::parse(VariantMap(), "results=-1"), unity::InvalidArgumentException);
+    EXPECT_THROW(SyntheticConfig::parse(VariantMap(), "results=1x"), unity::InvalidArgumentException);
+    EXPECT_THROW(SyntheticConfig::parse(VariantMap(), "fail=sometimes"), unity::InvalidArgumentException);
+    EXPECT_THROW(SyntheticConfig::parse(VariantMap(), "fail_rate=2"), unity::InvalidArgumentException);
+}
+
+TEST(SyntheticScope, results)
+{
+    SyntheticScope scope;
+    NiceMock<unity::scopes::testing::MockSearchReply> reply;
+
+    ON_CALL(reply, push(Matcher<CategorisedResult const&>(_))).WillByDefault(Return(true));
+    EXPECT_CALL(reply, register_category(_, _, _, _)).Times(2).WillRepeatedly(Invoke(make_category));
+
+    vector<CategorisedResult> results;
+    EXPECT_CALL(reply, push(Matcher<CategorisedResult const&>(_)))
+        .Times(5)
+        .WillRepeatedly(Invoke([&results](CategorisedResult const& r) { results.push_back(r); return true; }));
+
+    run_query(scope, "results=5 categories=2 attrs=3 attr_size=100", reply);
+
+    ASSERT_EQ(5u, results.size());
+    EXPECT_EQ("cat0", results[0].category()->id());
+    EXPECT_EQ("cat1", results[1].category()->id());
+    for (auto const& r : results)
+    {
+        ASSERT_TRUE(r.contains("attr2"));
+        EXPECT_EQ(100u, r["attr2"].get_string().size());
+        EXPECT_FALSE(r.contains("attr3"));
+    }
+}
+
+TEST(SyntheticScope, departments_and_filters)
+{
+    SyntheticScope scope;
+    NiceMock<unity::scopes::testing::MockSearchReply> reply;
+
+    ON_CALL(reply, register_category(_, _, _, _)).WillByDefault(Invoke(make_category));
+    ON_CALL(reply, push(Matcher<CategorisedResult const&>(_))).WillByDefault(Return(true));
+
+    EXPECT_CALL(reply, register_departments(Truly([](Department::SCPtr const& d)
+    {
+        return d->subdepartments().size() == 3;
+    }))).Times(1);
+    EXPECT_CALL(reply, push(Matcher<Filters const&>(SizeIs(2)))).Times(1).WillOnce(Return(true));
+
+    run_query(scope, "results=1 departments=3 filters=2", reply);
+}
+
+TEST(SyntheticScope, failure_injection)
+{
+    SyntheticScope scope;
+    NiceMock<unity::scopes::testing::MockSearchReply> reply;
+
+    ON_CALL(reply, register_category(_, _, _, _)).WillByDefault(Invoke(make_category));
+    ON_CALL(reply, push(Matcher<CategorisedResult const&>(_))).WillByDefault(Return(true));
+
+    EXPECT_THROW(run_query(scope, "fail=search", reply), unity::ResourceException);
+
+    // Half the results are pushed before run() fails.
+    EXPECT_CALL(reply, push(Matcher<CategorisedResult const&>(_))).Times(5).WillRepeatedly(Return(true));
+    EXPECT_THROW(run_query(scope, "results=10 fail=run", reply), unity::ResourceException);
+
+    // With a rate of zero, nothing fails.
+    EXPECT_NO_THROW(run_query(scope, "results=0 fail=run fail_rate=0", reply));
+}
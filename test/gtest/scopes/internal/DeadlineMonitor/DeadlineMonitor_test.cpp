@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/DeadlineMonitor.h>
+
+#include <unity/UnityExceptions.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace std;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+chrono::system_clock::time_point in_ms(int ms)
+{
+    return chrono::system_clock::now() + chrono::milliseconds(ms);
+}
+
+} // namespace
+
+TEST(DeadlineMonitor, basic)
+{
+    auto m = DeadlineMonitor::create();
+    EXPECT_EQ(0u, m->size());
+
+    promise<void> p;
+    auto start = chrono::steady_clock::now();
+    auto item = m->add(in_ms(100), [&p]{ p.set_value(); });
+    EXPECT_EQ(1u, m->size());
+
+    auto f = p.get_future();
+    ASSERT_EQ(future_status::ready, f.wait_for(chrono::seconds(5)));
+    EXPECT_GE(chrono::steady_clock::now() - start, chrono::milliseconds(100));
+    EXPECT_EQ(0u, m->size());
+
+    item->cancel();  // No-op once the callback was made.
+}
+
+TEST(DeadlineMonitor, order)
+{
+    auto m = DeadlineMonitor::create();
+
+    mutex mtx;
+    vector<int> fired;
+    promise<void> done;
+    auto cb = [&](int n)
+    {
+        lock_guard<mutex> lock(mtx);
+        fired.push_back(n);
+        if (fired.size() == 3)
+        {
+            done.set_value();
+        }
+    };
+
+    // Added out of order, and one deadline that has passed already.
+    auto i1 = m->add(in_ms(200), [&]{ cb(3); });
+    auto i2 = m->add(in_ms(100), [&]{ cb(2); });
+    auto i3 = m->add(in_ms(-100), [&]{ cb(1); });
+
+    ASSERT_EQ(future_status::ready, done.get_future().wait_for(chrono::seconds(5)));
+    EXPECT_EQ((vector<int>{ 1, 2, 3 }), fired);
+}
+
+TEST(DeadlineMonitor, cancel)
+{
+    auto m = DeadlineMonitor::create();
+
+    atomic_int count(0);
+    auto i1 = m->add(in_ms(50), [&]{ ++count; });
+    auto i2 = m->add(in_ms(50), [&]{ ++count; });
+    {
+        auto i3 = m->add(in_ms(50), [&]{ ++count; });
+        EXPECT_EQ(3u, m->size());
+    }  // Destroying the item cancels it.
+    EXPECT_EQ(2u, m->size());
+    i1->cancel();
+    i1->cancel();  // Second cancel is a no-op.
+    EXPECT_EQ(1u, m->size());
+
+    this_thread::sleep_for(chrono::milliseconds(300));
+    EXPECT_EQ(1, count);
+}
+
+TEST(DeadlineMonitor, destroy)
+{
+    auto m = DeadlineMonitor::create();
+
+    atomic_int count(0);
+    auto item = m->add(in_ms(50), [&]{ ++count; });
+    m->destroy();
+    EXPECT_EQ(0u, m->size());
+    m->destroy();  // Second destroy is a no-op.
+
+    this_thread::sleep_for(chrono::milliseconds(100));
+    EXPECT_EQ(0, count);
+
+    try
+    {
+        m->add(in_ms(50), [&]{ ++count; });
+        FAIL();
+    }
+    catch (unity::LogicException const& e)
+    {
+        EXPECT_STREQ("unity::LogicException: DeadlineMonitor: cannot add item to destroyed monitor.", e.what());
+    }
+
+    // Item outlives its monitor.
+    m.reset();
+    item->cancel();
+}
+
+TEST(DeadlineMonitor, exceptions)
+{
+    auto m = DeadlineMonitor::create();
+
+    try
+    {
+        m->add(in_ms(50), nullptr);
+        FAIL();
+    }
+    catch (unity::InvalidArgumentException const& e)
+    {
+        EXPECT_STREQ("unity::InvalidArgumentException: DeadlineMonitor: invalid null callback passed to add().",
+                     e.what());
+    }
+
+    // A throwing callback doesn't stop the monitor.
+    promise<void> p;
+    auto i1 = m->add(in_ms(10), []{ throw 42; });
+    auto i2 = m->add(in_ms(20), [&p]{ p.set_value(); });
+    EXPECT_EQ(future_status::ready, p.get_future().wait_for(chrono::seconds(5)));
+}
+
+TEST(DeadlineMonitor, cancel_from_callback)
+{
+    auto m = DeadlineMonitor::create();
+
+    promise<void> p;
+    DeadlineItem::UPtr other = m->add(in_ms(1000), []{});
+    auto item = m->add(in_ms(10), [&]
+    {
+        other->cancel();
+        p.set_value();
+    });
+    ASSERT_EQ(future_status::ready, p.get_future().wait_for(chrono::seconds(5)));
+    EXPECT_EQ(0u, m->size());
+}
+
+TEST(DeadlineMonitor, cancel_waits_for_callback)
+{
+    auto m = DeadlineMonitor::create();
+
+    promise<void> started;
+    atomic_bool done(false);
+    auto item = m->add(in_ms(0), [&]
+    {
+        started.set_value();
+        this_thread::sleep_for(chrono::milliseconds(200));
+        done = true;
+    });
+    ASSERT_EQ(future_status::ready, started.get_future().wait_for(chrono::seconds(5)));
+
+    // The callback is running, so cancel() must not return until it has completed.
+    item->cancel();
+    EXPECT_TRUE(done);
+}
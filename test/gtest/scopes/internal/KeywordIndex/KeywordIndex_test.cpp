@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/KeywordIndex.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace unity::scopes::internal;
+using namespace std;
+
+TEST(KeywordIndex, find)
+{
+    KeywordIndex index;
+    EXPECT_TRUE(index.find({ "music" }).empty());
+
+    index.add("A", { "music", "news" });
+    index.add("B", { "music" });
+    index.add("C", {});
+
+    EXPECT_EQ((set<string>{ "A", "B" }), index.find({ "music" }));
+    EXPECT_EQ((set<string>{ "A" }), index.find({ "news" }));
+    EXPECT_EQ((set<string>{ "A", "B" }), index.find({ "news", "music", "video" }));
+    EXPECT_TRUE(index.find({ "video" }).empty());
+    EXPECT_TRUE(index.find({}).empty());
+}
+
+TEST(KeywordIndex, add_remove)
+{
+    KeywordIndex index;
+    index.add("A", { "music", "news" });
+    index.add("B", { "music" });
+
+    // Re-adding a scope replaces its keywords.
+    index.add("A", { "video" });
+    EXPECT_EQ((set<string>{ "B" }), index.find({ "music", "news" }));
+    EXPECT_EQ((set<string>{ "A" }), index.find({ "video" }));
+
+    index.remove("B");
+    EXPECT_TRUE(index.find({ "music" }).empty());
+    index.remove("B");  // No-op
+    index.remove("no_such_scope");  // No-op
+    EXPECT_EQ((set<string>{ "A" }), index.find({ "video" }));
+
+    index.clear();
+    EXPECT_TRUE(index.find({ "video" }).empty());
+}
@@ -0,0 +1,347 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/Metrics.h>
+#include <unity/scopes/internal/MetricsServer.h>
+
+#include <unity/scopes/internal/Logger.h>
+#include <unity/UnityExceptions.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace std;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+// Connects to path, sends request (if any), and returns everything the server sends back.
+
+string query(string const& path, string const& request)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_NE(-1, fd);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    EXPECT_EQ(0, connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+    if (!request.empty())
+    {
+        EXPECT_EQ(ssize_t(request.size()), write(fd, request.data(), request.size()));
+    }
+    shutdown(fd, SHUT_WR);
+
+    string reply;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+    {
+        reply.append(buf, n);
+    }
+    close(fd);
+    return reply;
+}
+
+// Returns a socket listening on path that never replies.
+
+int listen_on(string const& path)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    EXPECT_NE(-1, fd);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    unlink(path.c_str());
+    EXPECT_EQ(0, ::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+    EXPECT_EQ(0, listen(fd, 5));
+    return fd;
+}
+
+bool contains(string const& s, string const& sub)
+{
+    return s.find(sub) != string::npos;
+}
+
+} // namespace
+
+TEST(Counter, basic)
+{
+    Counter c;
+    EXPECT_EQ(0u, c.value());
+    c.inc();
+    c.inc(4);
+    EXPECT_EQ(5u, c.value());
+}
+
+TEST(Counter, threads)
+{
+    Counter c;
+    vector<thread> threads;
+    for (int i = 0; i < 20; ++i)  // More threads than shards
+    {
+        threads.emplace_back([&c]{ for (int j = 0; j < 10000; ++j) c.inc(); });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    EXPECT_EQ(200000u, c.value());
+}
+
+TEST(Gauge, basic)
+{
+    Gauge g;
+    EXPECT_EQ(0, g.value());
+    g.inc(3);
+    g.dec();
+    EXPECT_EQ(2, g.value());
+    g.dec(5);
+    EXPECT_EQ(-3, g.value());
+    g.set(42);
+    EXPECT_EQ(42, g.value());
+}
+
+TEST(Histogram, buckets)
+{
+    // Values below 8 have a bucket each.
+    for (uint64_t v = 0; v < 8; ++v)
+    {
+        EXPECT_EQ(int(v), Histogram::bucket_index(v));
+        EXPECT_EQ(v, Histogram::bucket_lower_bound(v));
+    }
+
+    // Above that, each power of two has eight buckets.
+    EXPECT_EQ(8, Histogram::bucket_index(8));
+    EXPECT_EQ(15, Histogram::bucket_index(15));
+    EXPECT_EQ(16, Histogram::bucket_index(16));
+    EXPECT_EQ(16, Histogram::bucket_index(17));
+    EXPECT_EQ(17, Histogram::bucket_index(18));
+    EXPECT_EQ(18u, Histogram::bucket_lower_bound(17));
+
+    // Every value lies within its bucket, and the bucket is no wider than 1/8 of the value.
+    for (uint64_t v : { 9ull, 100ull, 1000ull, 12345ull, 1000000ull, 987654321ull, (1ull << 39) + 1 })
+    {
+        int const i = Histogram::bucket_index(v);
+        uint64_t const lower = Histogram::bucket_lower_bound(i);
+        uint64_t const upper = Histogram::bucket_lower_bound(i + 1);
+        EXPECT_LE(lower, v);
+        EXPECT_LT(v, upper);
+        EXPECT_LE(upper - lower, v / 8);
+    }
+
+    // Very large values go into the last bucket.
+    EXPECT_EQ(Histogram::num_buckets - 1, Histogram::bucket_index(1ull << 40));
+    EXPECT_EQ(Histogram::num_buckets - 1, Histogram::bucket_index(~0ull));
+}
+
+TEST(Histogram, record)
+{
+    Histogram h;
+    EXPECT_EQ(0u, h.count());
+    EXPECT_EQ(0u, h.value_at_quantile(0.5));
+
+    for (int i = 1; i <= 100; ++i)
+    {
+        h.record(chrono::milliseconds(i));
+    }
+    h.record(chrono::microseconds(-5));  // Clamped to zero
+
+    EXPECT_EQ(101u, h.count());
+    EXPECT_EQ(5050000u, h.sum());
+    EXPECT_EQ(1u, h.count_below(1));
+    EXPECT_EQ(11u, h.count_below(10240));  // 10 ms lies in the bucket [9216, 10240)
+    EXPECT_EQ(1u, h.count_at_most(0));
+    EXPECT_EQ(1u, h.count_at_most(959));   // 1 ms lies in the bucket [960, 1024)
+    EXPECT_EQ(2u, h.count_at_most(1000));
+    EXPECT_EQ(11u, h.count_at_most(10000));
+
+    auto const median = h.value_at_quantile(0.5);
+    EXPECT_GE(median, 50000u);
+    EXPECT_LE(median, 50000u * 9 / 8);
+    auto const p99 = h.value_at_quantile(0.99);
+    EXPECT_GE(p99, 99000u);
+    EXPECT_LE(p99, 99000u * 9 / 8);
+}
+
+TEST(MetricsRegistry, registration)
+{
+    auto& r = MetricsRegistry::instance();
+
+    auto& c1 = r.counter("test_registration_total", "help");
+    auto& c2 = r.counter("test_registration_total", "help");
+    auto& c3 = r.counter("test_registration_total", "help", "kind=\"other\"");
+    EXPECT_EQ(&c1, &c2);
+    EXPECT_NE(&c1, &c3);
+
+    try
+    {
+        r.gauge("test_registration_total", "help");
+        FAIL();
+    }
+    catch (unity::LogicException const& e)
+    {
+        EXPECT_TRUE(contains(e.what(), "metric test_registration_total is registered already with a different type"))
+            << e.what();
+    }
+}
+
+TEST(MetricsRegistry, expose)
+{
+    auto& r = MetricsRegistry::instance();
+    r.counter("test_expose_total", "A counter", "op=\"a\"").inc(3);
+    r.counter("test_expose_total", "A counter", "op=\"b\"").inc();
+    r.gauge("test_expose_depth", "A gauge").set(-2);
+    auto& h = r.histogram("test_expose_seconds", "A histogram");
+    h.record(chrono::microseconds(3));
+    h.record(chrono::milliseconds(2));
+
+    string const text = r.expose();
+    EXPECT_TRUE(contains(text, "# HELP test_expose_total A counter\n"
+                               "# TYPE test_expose_total counter\n"
+                               "test_expose_total{op=\"a\"} 3\n"
+                               "test_expose_total{op=\"b\"} 1\n")) << text;
+    EXPECT_TRUE(contains(text, "# TYPE test_expose_depth gauge\n"
+                               "test_expose_depth -2\n")) << text;
+    EXPECT_TRUE(contains(text, "# TYPE test_expose_seconds histogram\n"
+                               "test_expose_seconds_bucket{le=\"1e-06\"} 0\n")) << text;
+    EXPECT_TRUE(contains(text, "test_expose_seconds_bucket{le=\"4e-06\"} 1\n")) << text;
+    EXPECT_TRUE(contains(text, "test_expose_seconds_bucket{le=\"0.004096\"} 2\n")) << text;
+    EXPECT_TRUE(contains(text, "test_expose_seconds_bucket{le=\"+Inf\"} 2\n"
+                               "test_expose_seconds_sum 0.002003\n"
+                               "test_expose_seconds_count 2\n")) << text;
+}
+
+TEST(MetricsRegistry, expose_bucket_bounds)
+{
+    auto& r = MetricsRegistry::instance();
+    auto& h = r.histogram("test_bounds_seconds", "A histogram");
+    h.record(chrono::microseconds(1));
+    h.record(chrono::microseconds(8));
+    h.record(chrono::microseconds(1024));
+    h.record(chrono::microseconds(2000));
+
+    // A value equal to the bound of a bucket is counted in that bucket.
+    string const text = r.expose();
+    EXPECT_TRUE(contains(text, "test_bounds_seconds_bucket{le=\"1e-06\"} 1\n")) << text;
+    EXPECT_TRUE(contains(text, "test_bounds_seconds_bucket{le=\"4e-06\"} 1\n")) << text;
+    EXPECT_TRUE(contains(text, "test_bounds_seconds_bucket{le=\"8e-06\"} 2\n")) << text;
+    EXPECT_TRUE(contains(text, "test_bounds_seconds_bucket{le=\"0.000512\"} 2\n")) << text;
+    EXPECT_TRUE(contains(text, "test_bounds_seconds_bucket{le=\"0.001024\"} 3\n")) << text;
+    EXPECT_TRUE(contains(text, "test_bounds_seconds_bucket{le=\"0.002048\"} 4\n")) << text;
+}
+
+TEST(MetricsServer, serve)
+{
+    Logger logger("Metrics_test");
+    MetricsRegistry::instance().counter("test_serve_total", "Served").inc(7);
+
+    string const path = TEST_DIR "/scope-A.sock";
+    MetricsServer server(path, false, logger);
+    EXPECT_EQ(path, server.path());
+    EXPECT_TRUE(contains(server.scrape(), "test_serve_total 7\n"));
+
+    // Plain text if the client doesn't send anything.
+    string reply = query(path, "");
+    EXPECT_TRUE(contains(reply, "# TYPE test_serve_total counter\ntest_serve_total 7\n")) << reply;
+    EXPECT_FALSE(contains(reply, "HTTP/"));
+
+    // HTTP response for a GET request.
+    reply = query(path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    EXPECT_EQ(0u, reply.find("HTTP/1.0 200 OK\r\n")) << reply;
+    EXPECT_TRUE(contains(reply, "\r\n\r\n# HELP ")) << reply;
+    EXPECT_TRUE(contains(reply, "test_serve_total 7\n")) << reply;
+
+    // Can't have two servers on the same socket.
+    try
+    {
+        MetricsServer server2(path, false, logger);
+        FAIL();
+    }
+    catch (unity::ResourceException const&)
+    {
+    }
+}
+
+TEST(MetricsServer, aggregate)
+{
+    Logger logger("Metrics_test");
+    MetricsRegistry::instance().counter("test_aggregate_total", "Aggregated", "op=\"x\"").inc(2);
+
+    // Whatever was left behind by a process that died is replaced.
+    string const reg_path = TEST_DIR "/registry.sock";
+    close(creat(reg_path.c_str(), 0600));
+
+    MetricsServer scope(TEST_DIR "/scope-B.sock", false, logger);
+    MetricsServer registry(reg_path, true, logger);
+
+    // Both servers are in this process, so each sample appears twice, once for each process label.
+    string const reply = query(reg_path, "");
+    EXPECT_TRUE(contains(reply, "# HELP test_aggregate_total Aggregated\n"
+                                "# TYPE test_aggregate_total counter\n")) << reply;
+    EXPECT_TRUE(contains(reply, "test_aggregate_total{op=\"x\",process=\"registry\"} 2\n")) << reply;
+    EXPECT_TRUE(contains(reply, "test_aggregate_total{op=\"x\",process=\"scope-B\"} 2\n")) << reply;
+
+    // Each family has a single header.
+    auto const first = reply.find("# HELP test_aggregate_total");
+    EXPECT_EQ(string::npos, reply.find("# HELP test_aggregate_total", first + 1)) << reply;
+}
+
+TEST(MetricsServer, stuck_processes)
+{
+    Logger logger("Metrics_test");
+    MetricsRegistry::instance().counter("test_stuck_total", "Stuck").inc();
+
+    string const dir = TEST_DIR "/stuck";
+    mkdir(dir.c_str(), 0700);
+    vector<int> fds;
+    for (int i = 0; i < 3; ++i)
+    {
+        fds.push_back(listen_on(dir + "/scope-" + to_string(i) + ".sock"));
+    }
+
+    // The stuck processes are waited for in parallel, so the scrape times out once.
+    MetricsServer registry(dir + "/registry.sock", true, logger);
+    auto const start = chrono::steady_clock::now();
+    string const text = registry.scrape();
+    auto const elapsed = chrono::steady_clock::now() - start;
+    EXPECT_TRUE(contains(text, "test_stuck_total{process=\"registry\"} 1\n")) << text;
+    EXPECT_FALSE(contains(text, "process=\"scope-0\"")) << text;
+    EXPECT_GE(elapsed, chrono::milliseconds(900));
+    EXPECT_LT(elapsed, chrono::milliseconds(2000));
+
+    for (int i = 0; i < 3; ++i)
+    {
+        close(fds[i]);
+        unlink((dir + "/scope-" + to_string(i) + ".sock").c_str());
+    }
+}
@@ -54,6 +54,7 @@ TEST_F(RuntimeConfigTest, basic)
     EXPECT_EQ(DFLT_MIDDLEWARE_INI, c.default_middleware_configfile());
     EXPECT_EQ(DFLT_REAP_EXPIRY, c.reap_expiry());
     EXPECT_EQ(DFLT_REAP_INTERVAL, c.reap_interval());
+    EXPECT_EQ(DFLT_DEADLINE_MARGIN, c.deadline_margin());
     EXPECT_TRUE(c.trace_channels().empty());
 }
 
@@ -68,6 +69,7 @@ TEST_F(RuntimeConfigTest, complete)
     EXPECT_EQ("Z.Config", c.default_middleware_configfile());
     EXPECT_EQ(500, c.reap_expiry());
     EXPECT_EQ(100, c.reap_interval());
+    EXPECT_EQ(20, c.deadline_margin());
     EXPECT_EQ("CacheD", c.cache_directory());
     EXPECT_EQ("AppD", c.app_directory());
     EXPECT_EQ("ConfigD", c.config_directory());
@@ -185,6 +187,18 @@ TEST_F(RuntimeConfigTest, exceptions)
                      e.what());
     }
 
+    try
+    {
+        RuntimeConfig c(TEST_DIR "/BadDeadlineMargin.ini");
+        FAIL();
+    }
+    catch (ConfigException const& e)
+    {
+        EXPECT_STREQ("unity::scopes::ConfigException: \"" TEST_DIR "/BadDeadlineMargin.ini\": Illegal value (-1) for "
+                     "Deadline.Margin: value must be >= 0",
+                     e.what());
+    }
+
     try
     {
         unsetenv("HOME");
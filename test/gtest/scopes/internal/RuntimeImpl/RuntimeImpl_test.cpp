@@ -16,6 +16,7 @@
  * Authored by: Michi Henning <michi.henning@canonical.com>
  */
 
+#include <unity/scopes/internal/MWScope.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
 #include <unity/scopes/ScopeExceptions.h>
 #include <unity/UnityExceptions.h>
@@ -251,6 +252,64 @@ TEST(RuntimeImpl, directories)
     }
 }
 
+TEST(RuntimeImpl, host_scope)
+{
+    string const rt_ini_file = TEST_DIR "/Runtime.ini";
+
+    // Two scopes hosted by the same run time must each get their own directories.
+    std::promise<void> promise1;
+    auto initialized1 = promise1.get_future();
+    std::promise<void> promise2;
+    auto initialized2 = promise2.get_future();
+
+    auto rt = move(RuntimeImpl::create("Host", rt_ini_file));
+    TestScope testscope1;
+    TestScope testscope2;
+    auto thread_done1 = std::async(launch::async, [&rt, &testscope1, &promise1]
+    {
+        rt->host_scope(&testscope1, "TestScope", TEST_DIR "/TestScope.ini", move(promise1));
+    });
+    auto thread_done2 = std::async(launch::async, [&rt, &testscope2, &promise2]
+    {
+        rt->host_scope(&testscope2, "TestScope_TestScope", TEST_DIR "/TestScope_TestScope.ini", move(promise2));
+    });
+
+    testscope1.wait_until_started();
+    testscope2.wait_until_started();
+
+    string tmpdir = "/run/user/" + to_string(geteuid()) + "/scopes/unconfined/";
+    EXPECT_EQ(tmpdir + "TestScope", testscope1.tmp_directory());
+    EXPECT_EQ(tmpdir + "TestScope_TestScope", testscope2.tmp_directory());
+    EXPECT_EQ(TEST_DIR "/cache_dir/unconfined/TestScope", testscope1.cache_directory());
+    EXPECT_EQ(TEST_DIR "/cache_dir/unconfined/TestScope_TestScope", testscope2.cache_directory());
+
+    // Both scopes are reachable via their own endpoint.
+    auto mw = rt->factory()->find("Host", "Zmq");
+    auto p1 = mw->create_scope_proxy("TestScope");
+    auto p2 = mw->create_scope_proxy("TestScope_TestScope");
+    EXPECT_FALSE(p1->debug_mode());
+    EXPECT_FALSE(p2->debug_mode());
+
+    initialized1.wait();
+    initialized2.wait();
+    rt->destroy();
+
+    thread_done1.get();
+    thread_done2.get();
+
+    try
+    {
+        rt = move(RuntimeImpl::create("Host", rt_ini_file));
+        TestScope testscope;
+        rt->host_scope(&testscope, "", TEST_DIR "/TestScope.ini");
+        FAIL();
+    }
+    catch (InvalidArgumentException const& e)
+    {
+        EXPECT_STREQ("unity::InvalidArgumentException: Runtime::host_scope(): scope_id cannot be empty", e.what());
+    }
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
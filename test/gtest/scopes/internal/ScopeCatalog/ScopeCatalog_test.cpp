@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/ScopeCatalog.h>
+
+#include <unity/UnityExceptions.h>
+
+#include <boost/filesystem.hpp>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <fstream>
+
+using namespace unity;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+using namespace std;
+
+namespace
+{
+
+string const catalog_path = TEST_DIR "/catalog";
+
+VariantMap make_entry(string const& id)
+{
+    VariantMap proxy;
+    proxy["identity"] = Variant(id);
+    proxy["endpoint"] = Variant("ipc:///tmp/" + id);
+
+    VariantArray keywords;
+    keywords.push_back(Variant("music"));
+    keywords.push_back(Variant("video"));
+
+    VariantMap m;
+    m["scope_id"] = Variant(id);
+    m["proxy"] = Variant(proxy);
+    m["display_name"] = Variant("display name " + id);
+    m["invisible"] = Variant(true);
+    m["version"] = Variant(3);
+    m["big"] = Variant(int64_t(1) << 40);
+    m["ratio"] = Variant(0.5);
+    m["nothing"] = Variant();
+    m["keywords"] = Variant(keywords);
+    return m;
+}
+
+} // namespace
+
+TEST(ScopeCatalog, empty)
+{
+    boost::filesystem::remove(catalog_path);
+
+    ScopeCatalog::write(catalog_path, 1, ScopeCatalog::Complete, ScopeCatalog::EntryMap());
+    auto cat = ScopeCatalog::open(catalog_path);
+    EXPECT_EQ(1u, cat->version());
+    EXPECT_TRUE(cat->is_complete());
+    EXPECT_EQ(0u, cat->size());
+    EXPECT_TRUE(cat->entries().empty());
+
+    VariantMap entry;
+    EXPECT_FALSE(cat->find("scope-A", entry));
+}
+
+TEST(ScopeCatalog, write_and_find)
+{
+    ScopeCatalog::EntryMap entries;
+    for (auto const& id : { "scope-C", "scope-A", "scope-B", "scope-AA" })
+    {
+        entries[id] = make_entry(id);
+    }
+    ScopeCatalog::write(catalog_path, 42, 0, entries);
+
+    auto cat = ScopeCatalog::open(catalog_path);
+    EXPECT_EQ(42u, cat->version());
+    EXPECT_FALSE(cat->is_complete());
+    EXPECT_EQ(4u, cat->size());
+
+    for (auto const& pair : entries)
+    {
+        VariantMap entry;
+        ASSERT_TRUE(cat->find(pair.first, entry));
+        EXPECT_EQ(pair.second, entry);
+    }
+
+    VariantMap entry;
+    EXPECT_FALSE(cat->find("", entry));
+    EXPECT_FALSE(cat->find("scope", entry));
+    EXPECT_FALSE(cat->find("scope-D", entry));
+
+    EXPECT_EQ(entries, cat->entries());
+}
+
+TEST(ScopeCatalog, replace_keeps_mapping)
+{
+    ScopeCatalog::EntryMap entries;
+    entries["scope-A"] = make_entry("scope-A");
+    ScopeCatalog::write(catalog_path, 1, ScopeCatalog::Complete, entries);
+    auto old_cat = ScopeCatalog::open(catalog_path);
+
+    entries.clear();
+    entries["scope-B"] = make_entry("scope-B");
+    ScopeCatalog::write(catalog_path, 2, ScopeCatalog::Complete, entries);
+    auto new_cat = ScopeCatalog::open(catalog_path);
+
+    // The old mapping still refers to the old catalog.
+    VariantMap entry;
+    EXPECT_EQ(1u, old_cat->version());
+    EXPECT_TRUE(old_cat->find("scope-A", entry));
+    EXPECT_FALSE(old_cat->find("scope-B", entry));
+
+    EXPECT_EQ(2u, new_cat->version());
+    EXPECT_FALSE(new_cat->find("scope-A", entry));
+    EXPECT_TRUE(new_cat->find("scope-B", entry));
+}
+
+TEST(ScopeCatalog, exceptions)
+{
+    boost::filesystem::remove(catalog_path);
+    try
+    {
+        ScopeCatalog::open(catalog_path);
+        FAIL();
+    }
+    catch (FileException const& e)
+    {
+        EXPECT_EQ(ENOENT, e.error());
+    }
+
+    {
+        ofstream f(catalog_path);
+        f << "short";
+    }
+    EXPECT_THROW(ScopeCatalog::open(catalog_path), ResourceException);
+
+    {
+        ofstream f(catalog_path);
+        f << "This is not a scope catalog file";
+    }
+    EXPECT_THROW(ScopeCatalog::open(catalog_path), ResourceException);
+
+    try
+    {
+        ScopeCatalog::write("/no_such_directory/catalog", 1, 0, ScopeCatalog::EntryMap());
+        FAIL();
+    }
+    catch (FileException const& e)
+    {
+        EXPECT_EQ(ENOENT, e.error());
+    }
+}
@@ -0,0 +1,446 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Micro-benchmarks for the code that runs once per result (or once per query) when
+// results, filters, departments, and metadata are marshaled.
+//
+// Each benchmark reports ns/op, allocations/op, and bytes allocated/op. The timing sample
+// is compared with <name>.baseline in $SERIALIZATION_BENCHMARK_BASELINE_DIR (the build
+// directory by default) and the test fails if it is significantly slower. If there is no
+// baseline yet, or if $SERIALIZATION_BENCHMARK_UPDATE_BASELINE is set, the current
+// sample becomes the new baseline.
+
+#include <unity/scopes/internal/CategorisedResultImpl.h>
+#include <unity/scopes/internal/CategoryRegistry.h>
+#include <unity/scopes/internal/DepartmentImpl.h>
+#include <unity/scopes/internal/FilterBaseImpl.h>
+#include <unity/scopes/internal/ResultImpl.h>
+#include <unity/scopes/internal/RuntimeImpl.h>
+#include <unity/scopes/internal/ScopeImpl.h>
+#include <unity/scopes/internal/ScopeMetadataImpl.h>
+#include <unity/scopes/internal/smartscopes/SmartScopesClient.h>
+#include <unity/scopes/internal/zmq_middleware/VariantConverter.h>
+#include <unity/scopes/internal/zmq_middleware/ZmqMiddleware.h>
+#include <scopes/internal/zmq_middleware/capnproto/ValueDict.capnp.h>
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/CategoryRenderer.h>
+#include <unity/scopes/Department.h>
+#include <unity/scopes/OptionSelectorFilter.h>
+#include <unity/scopes/RatingFilter.h>
+#include <unity/scopes/SwitchFilter.h>
+#include <unity/scopes/ValueSliderFilter.h>
+#include <unity/scopes/ValueSliderLabels.h>
+#include <unity/scopes/testing/Benchmark.h>
+#include <unity/scopes/testing/Statistics.h>
+
+#include <capnp/message.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+
+using namespace std;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+using namespace unity::scopes::internal::zmq_middleware;
+
+// Allocation counting. Only allocations made by the benchmarking thread while
+// counting_allocations is set are recorded.
+
+namespace
+{
+
+thread_local bool counting_allocations = false;
+thread_local size_t allocation_count = 0;
+thread_local size_t allocated_bytes = 0;
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    if (counting_allocations)
+    {
+        ++allocation_count;
+        allocated_bytes += size;
+    }
+    void* p = malloc(size == 0 ? 1 : size);
+    if (!p)
+    {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept
+{
+    free(p);
+}
+
+namespace
+{
+
+typedef chrono::steady_clock Clock;
+typedef unity::scopes::testing::Benchmark::Result::Timing::Seconds Seconds;
+
+string const runtime_ini = TEST_DIR "/Runtime.ini";
+string const zmq_ini = TEST_DIR "/Zmq.ini";
+
+size_t const trial_count = 25;
+auto const min_trial_duration = chrono::milliseconds(5);
+size_t const allocation_ops = 100;
+
+// A benchmark operation returns something that depends on its work, so the compiler
+// cannot optimize the work away.
+typedef function<size_t()> Operation;
+
+volatile size_t sink;
+
+string baseline_dir()
+{
+    char const* dir = getenv("SERIALIZATION_BENCHMARK_BASELINE_DIR");
+    return dir && *dir ? dir : TEST_DIR;
+}
+
+// A timing sample whose observations are the mean duration of an operation in each trial.
+
+unity::scopes::testing::Benchmark::Result measure(Operation const& op)
+{
+    // Find the number of operations per trial that takes long enough for the clock resolution not to matter.
+    size_t ops_per_trial = 1;
+    for (;;)
+    {
+        auto const start = Clock::now();
+        for (size_t i = 0; i < ops_per_trial; ++i)
+        {
+            sink = op();
+        }
+        if (Clock::now() - start >= min_trial_duration)
+        {
+            break;
+        }
+        ops_per_trial *= 2;
+    }
+
+    unity::scopes::testing::Benchmark::Result result;
+    result.sample_size = trial_count;
+    for (size_t t = 0; t < trial_count; ++t)
+    {
+        auto const start = Clock::now();
+        for (size_t i = 0; i < ops_per_trial; ++i)
+        {
+            sink = op();
+        }
+        result.timing.sample.push_back(chrono::duration_cast<Seconds>(Clock::now() - start) / ops_per_trial);
+    }
+
+    auto const& sample = result.timing.sample;
+    result.timing.min = *min_element(sample.begin(), sample.end());
+    result.timing.max = *max_element(sample.begin(), sample.end());
+    double sum = 0;
+    for (auto const& s : sample)
+    {
+        sum += s.count();
+    }
+    double const mean = sum / sample.size();
+    double sq_sum = 0;
+    for (auto const& s : sample)
+    {
+        sq_sum += (s.count() - mean) * (s.count() - mean);
+    }
+    result.timing.mean = Seconds{mean};
+    result.timing.std_dev = Seconds{sqrt(sq_sum / (sample.size() - 1))};
+    return result;
+}
+
+void run_benchmark(string const& name, Operation const& op)
+{
+    for (int i = 0; i < 100; ++i)  // Warm up caches and the allocator
+    {
+        sink = op();
+    }
+
+    allocation_count = 0;
+    allocated_bytes = 0;
+    counting_allocations = true;
+    for (size_t i = 0; i < allocation_ops; ++i)
+    {
+        sink = op();
+    }
+    counting_allocations = false;
+    double const allocs_per_op = double(allocation_count) / allocation_ops;
+    double const bytes_per_op = double(allocated_bytes) / allocation_ops;
+
+    auto result = measure(op);
+
+    cout << name << ": " << result.timing.mean.count() * 1e9 << " ns/op"
+         << " (std dev " << result.timing.std_dev.count() * 1e9 << " ns)"
+         << ", " << allocs_per_op << " allocs/op"
+         << ", " << bytes_per_op << " bytes/op" << endl;
+
+    string const baseline_path = baseline_dir() + "/" + name + ".baseline";
+    bool const update = getenv("SERIALIZATION_BENCHMARK_UPDATE_BASELINE") != nullptr;
+    ifstream in(baseline_path);
+    if (in && !update)
+    {
+        unity::scopes::testing::Benchmark::Result baseline;
+        baseline.load_from(in);
+
+        // Small differences are significant with this many operations, so we only fail for
+        // a slowdown that is both statistically significant and larger than 10%.
+        auto const t_test = unity::scopes::testing::StudentsTTest().two_independent_samples(baseline.timing,
+                                                                                           result.timing);
+        bool const slower = t_test.sample1_mean_lt_sample2_mean(0.01) ==
+                            unity::scopes::testing::HypothesisStatus::not_rejected &&
+                            result.timing.mean > baseline.timing.mean * 1.1;
+        EXPECT_FALSE(slower) << name << " is slower than its baseline: "
+                             << result.timing.mean.count() * 1e9 << " ns/op vs. "
+                             << baseline.timing.mean.count() * 1e9 << " ns/op (t = " << t_test.t << ")";
+        return;
+    }
+
+    ofstream out(baseline_path);
+    result.save_to(out);
+    EXPECT_TRUE(out.good()) << "cannot write " << baseline_path;
+}
+
+// A result with the kind of payload a typical online scope produces: the standard
+// attributes, a longer summary, tags, and a list of attribute widgets.
+
+CategorisedResult make_result(Category::SCPtr const& cat)
+{
+    CategorisedResult res(cat);
+    res.set_uri("https://www.example.com/products/item?id=4711&source=search");
+    res.set_title("Ultra-compact travel kettle, 0.5 litres");
+    res.set_art("https://images.example.com/thumbnails/4711-256x256.png");
+    res.set_dnd_uri("https://www.example.com/products/item?id=4711");
+    res["subtitle"] = "Kitchen & Home";
+    res["summary"] = string(400, 's');
+    res["price"] = 19.99;
+    res["rating"] = 4;
+    res["emblem"] = "https://images.example.com/emblems/prime.png";
+
+    VariantArray tags;
+    for (auto const& tag : { "kettle", "travel", "compact", "kitchen", "electric" })
+    {
+        tags.push_back(Variant(tag));
+    }
+    res["tags"] = tags;
+
+    VariantArray attributes;
+    for (auto const& value : { "★★★★☆", "Free delivery", "In stock" })
+    {
+        VariantMap attr;
+        attr["value"] = value;
+        attr["icon"] = "https://images.example.com/icons/attr.png";
+        attributes.push_back(Variant(attr));
+    }
+    res["attributes"] = attributes;
+    return res;
+}
+
+class SerializationBenchmark : public ::testing::Test
+{
+protected:
+    SerializationBenchmark()
+    {
+        cat_ = reg_.register_category("cat1", "Category 1", "icon", nullptr, CategoryRenderer());
+    }
+
+    CategoryRegistry reg_;
+    Category::SCPtr cat_;
+};
+
+} // namespace
+
+TEST_F(SerializationBenchmark, result_serialize)
+{
+    auto const res = make_result(cat_);
+    run_benchmark("result_serialize", [&res]
+    {
+        return res.serialize().size();
+    });
+}
+
+TEST_F(SerializationBenchmark, result_deserialize)
+{
+    auto const var = make_result(cat_).serialize();
+    run_benchmark("result_deserialize", [&var]
+    {
+        ResultImpl impl(var);
+        return impl.uri().size();
+    });
+}
+
+TEST_F(SerializationBenchmark, categorised_result_construct)
+{
+    auto const var = make_result(cat_).serialize();
+    run_benchmark("categorised_result_construct", [this, &var]
+    {
+        CategorisedResultImpl impl(reg_, var);
+        return impl.uri().size();
+    });
+}
+
+TEST_F(SerializationBenchmark, to_value_dict)
+{
+    auto const var = make_result(cat_).serialize();
+    run_benchmark("to_value_dict", [&var]
+    {
+        capnp::MallocMessageBuilder message;
+        auto builder = message.initRoot<capnproto::ValueDict>();
+        to_value_dict(var, builder);
+        return message.sizeInWords();
+    });
+}
+
+TEST_F(SerializationBenchmark, to_variant_map)
+{
+    capnp::MallocMessageBuilder message;
+    auto builder = message.initRoot<capnproto::ValueDict>();
+    to_value_dict(make_result(cat_).serialize(), builder);
+    auto const reader = message.getRoot<capnproto::ValueDict>().asReader();
+    run_benchmark("to_variant_map", [&reader]
+    {
+        return to_variant_map(reader).size();
+    });
+}
+
+TEST_F(SerializationBenchmark, serialize_json)
+{
+    Variant const var(make_result(cat_).serialize());
+    run_benchmark("serialize_json", [&var]
+    {
+        return var.serialize_json().size();
+    });
+}
+
+TEST_F(SerializationBenchmark, serialize_filters)
+{
+    Filters filters;
+    auto sort = OptionSelectorFilter::create("sort", "Sort by");
+    auto brand = OptionSelectorFilter::create("brand", "Brand", true);
+    for (int i = 0; i < 10; ++i)
+    {
+        brand->add_option("brand" + to_string(i), "Brand " + to_string(i));
+    }
+    sort->add_option("relevance", "Relevance");
+    sort->add_option("price", "Price");
+    sort->add_option("rating", "Rating");
+    filters.push_back(move(sort));
+    filters.push_back(move(brand));
+    filters.push_back(RatingFilter::create("rating", "Rating", 5));
+    filters.push_back(SwitchFilter::create("prime", "Free delivery"));
+    filters.push_back(ValueSliderFilter::create("price", 0, 500, 100, ValueSliderLabels("Free", "Any price")));
+
+    run_benchmark("serialize_filters", [&filters]
+    {
+        return FilterBaseImpl::serialize_filters(filters).size();
+    });
+}
+
+TEST_F(SerializationBenchmark, serialize_departments)
+{
+    CannedQuery const query("scope-id", "", "");
+    Department::SPtr root = Department::create("", query, "All departments");
+    for (int i = 0; i < 20; ++i)
+    {
+        auto const id = "dept" + to_string(i);
+        Department::SPtr dept = Department::create(id, query, "Department " + to_string(i));
+        dept->set_has_subdepartments();
+        root->add_subdepartment(dept);
+    }
+    Department::SCPtr const departments = root;
+
+    run_benchmark("serialize_departments", [&departments]
+    {
+        return DepartmentImpl::serialize_departments(departments).size();
+    });
+}
+
+TEST_F(SerializationBenchmark, scope_metadata_serialize)
+{
+    auto rt = RuntimeImpl::create("testscope", runtime_ini);
+    ZmqMiddleware mw("testscope", rt.get(), zmq_ini);
+
+    ScopeMetadataImpl mi(&mw);
+    mi.set_scope_id("scope_id");
+    mi.set_proxy(ScopeImpl::create(mw.create_scope_proxy("identity", "endpoint"), "scope_id"));
+    mi.set_display_name("Display name");
+    mi.set_description("A description of the scope that is a sentence or two long.");
+    mi.set_author("Canonical Ltd");
+    mi.set_art("/usr/share/unity/scopes/scope_id/art.png");
+    mi.set_icon("/usr/share/unity/scopes/scope_id/icon.png");
+    mi.set_search_hint("Search for things");
+    mi.set_scope_directory("/usr/share/unity/scopes/scope_id");
+    VariantMap appearance;
+    appearance["background"] = "color:///#ffffff";
+    appearance["foreground-color"] = "#333333";
+    appearance["logo-overlay-color"] = "#99ffffff";
+    mi.set_appearance_attributes(appearance);
+    mi.set_keywords({ "shopping", "products", "deals" });
+
+    run_benchmark("scope_metadata_serialize", [&mi]
+    {
+        return mi.serialize().size();
+    });
+}
+
+// The conversion of each line of a smart scopes search stream into a result, as
+// SmartScopesClient does it, using the results of a recorded stream.
+
+TEST_F(SerializationBenchmark, smartscopes_result)
+{
+    ifstream in(CORPUS_DIR "/search.jsonl");
+    ASSERT_TRUE(in.good());
+    vector<string> lines;
+    string line;
+    while (getline(in, line))
+    {
+        if (line.find("\"result\"") != string::npos)
+        {
+            lines.push_back(line + "\n");
+        }
+    }
+    ASSERT_FALSE(lines.empty());
+
+    smartscopes::JsonLineParser parser;
+    size_t next = 0;
+    size_t attr_count = 0;
+    auto line_handler = [&attr_count](JsonNodeInterface::SPtr const& root_node, char const*, char const*)
+    {
+        attr_count += root_node->get_node("result")->to_variant().get_dict().size();
+    };
+    auto error_handler = [](string const& msg)
+    {
+        FAIL() << msg;
+    };
+
+    run_benchmark("smartscopes_result", [&]
+    {
+        parser.consume(lines[next++ % lines.size()], line_handler, error_handler);
+        return attr_count;
+    });
+}
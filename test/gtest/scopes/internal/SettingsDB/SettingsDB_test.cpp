@@ -30,6 +30,7 @@
 #pragma GCC diagnostic pop
 
 #include <fcntl.h>
+#include <sys/stat.h>
 #include <ctime>
 #include <thread>
 
@@ -271,6 +272,43 @@ TEST(SettingsDB, delete_db)
     }
 }
 
+TEST(SettingsDB, db_dir_created_later)
+{
+    auto schema = TEST_SRC_DIR "/schema.ini";
+    string const db_dir = TEST_BIN_DIR "/settings_dir";
+    string const db_path = db_dir + "/settings.ini";
+
+    {
+        EXPECT_EQ(0, system(string("rm -rf " + db_dir).c_str()));
+        auto db = SettingsDB::create_from_ini_file(db_path, schema);
+
+        // Neither the db nor its directory exist, so default values are returned.
+        EXPECT_EQ(4u, db->settings().size());
+        EXPECT_EQ("London", db->settings()["locationSetting"].get_string());
+
+        // Create the directory and write the DB to a temporary file, then rename it into place.
+        ASSERT_EQ(0, ::mkdir(db_dir.c_str(), 0700));
+        string const tmp_path = db_dir + "/settings.ini.tmp";
+        EXPECT_EQ(0, system(string("cp " TEST_SRC_DIR "/db_location.ini " + tmp_path).c_str()));
+        ASSERT_EQ(0, ::rename(tmp_path.c_str(), db_path.c_str()));
+
+        EXPECT_EQ(4u, db->settings().size());
+        EXPECT_EQ("New York", db->settings()["locationSetting"].get_string());
+
+        // Replace the DB again.
+        EXPECT_EQ(0, system(string("cp " TEST_SRC_DIR "/db_location_munich.ini " + tmp_path).c_str()));
+        ASSERT_EQ(0, ::rename(tmp_path.c_str(), db_path.c_str()));
+
+        EXPECT_EQ(4u, db->settings().size());
+        EXPECT_EQ("Munich", db->settings()["locationSetting"].get_string());
+
+        // Remove the DB directory, default values should come back.
+        EXPECT_EQ(0, system(string("rm -rf " + db_dir).c_str()));
+        EXPECT_EQ(4u, db->settings().size());
+        EXPECT_EQ("London", db->settings()["locationSetting"].get_string());
+    }
+}
+
 TEST(SettingsDB, from_json_string)
 {
     char const* ok_schema = R"delimiter(
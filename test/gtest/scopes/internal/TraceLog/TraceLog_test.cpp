@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/TraceLog.h>
+
+#include <unity/scopes/internal/Logger.h>
+#include <unity/UnityExceptions.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <unistd.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace std;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+vector<string> read_lines(string const& path)
+{
+    vector<string> lines;
+    ifstream f(path);
+    string line;
+    while (getline(f, line))
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+string hex(uint64_t id)
+{
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(id));
+    return buf;
+}
+
+} // namespace
+
+TEST(TraceContext, basic)
+{
+    auto const none = TraceContext::current();
+    EXPECT_FALSE(none.traced());
+    EXPECT_FALSE(none.child().traced());
+
+    auto const root = TraceContext::root();
+    EXPECT_TRUE(root.traced());
+    EXPECT_NE(0u, root.span_id);
+    EXPECT_EQ(0u, root.parent_id);
+
+    auto const child = root.child();
+    EXPECT_EQ(root.trace_id, child.trace_id);
+    EXPECT_EQ(root.span_id, child.parent_id);
+    EXPECT_NE(root.span_id, child.span_id);
+
+    EXPECT_NE(root.trace_id, TraceContext::root().trace_id);
+}
+
+TEST(TraceContext, scope)
+{
+    auto const root = TraceContext::root();
+    {
+        TraceScope s(root);
+        EXPECT_EQ(root.span_id, TraceContext::current().span_id);
+
+        auto const child = root.child();
+        {
+            TraceScope s2(child);
+            EXPECT_EQ(child.span_id, TraceContext::current().span_id);
+        }
+        EXPECT_EQ(root.span_id, TraceContext::current().span_id);
+
+        // The context is per thread.
+        thread([]{ EXPECT_FALSE(TraceContext::current().traced()); }).join();
+
+        // with_trace_context() carries the context to another thread.
+        uint64_t id = 0;
+        auto f = with_trace_context([&id]{ id = TraceContext::current().span_id; });
+        thread(f).join();
+        EXPECT_EQ(root.span_id, id);
+    }
+    EXPECT_FALSE(TraceContext::current().traced());
+}
+
+TEST(TraceLog, record)
+{
+    ostringstream err;
+    Logger logger("TraceLog_test", err);
+    TraceLog log(TEST_DIR, "record", logger);
+    string const path = string(TEST_DIR) + "/record-" + to_string(getpid()) + ".trace";
+    EXPECT_EQ(path, log.path());
+    ::unlink(path.c_str());
+    TraceLog log2(TEST_DIR, "record", logger);  // Re-creates the file
+
+    auto const root = TraceContext::root();
+    TraceContext child;
+    {
+        TraceSpan span(&log2, root, "search", "some\"scope");
+        child = TraceContext::current().child();
+        TraceSpan span2(&log2, child, "push", "reply");
+    }
+    {
+        // No log: context is set, but nothing is recorded.
+        TraceSpan span(nullptr, root, "nothing", "nobody");
+        EXPECT_EQ(root.span_id, TraceContext::current().span_id);
+    }
+    {
+        // Untraced context with a log starts a new trace.
+        TraceSpan span(&log2, TraceContext(), "activate", "scope");
+        EXPECT_TRUE(TraceContext::current().traced());
+        EXPECT_NE(root.trace_id, TraceContext::current().trace_id);
+    }
+
+    auto const lines = read_lines(path);
+    ASSERT_EQ(3u, lines.size());
+
+    // Inner span completes first.
+    EXPECT_NE(string::npos, lines[0].find("\"span\":\"" + hex(child.span_id) + "\""));
+    EXPECT_NE(string::npos, lines[0].find("\"parent\":\"" + hex(root.span_id) + "\""));
+    EXPECT_NE(string::npos, lines[0].find("\"name\":\"push\""));
+
+    EXPECT_EQ(0u, lines[1].find("{\"trace\":\"" + hex(root.trace_id) + "\",\"span\":\"" + hex(root.span_id)
+                                + "\",\"parent\":\"0000000000000000\",\"name\":\"search\",\"target\":\"some\\\"scope\""
+                                + ",\"process\":\"record\",\"pid\":" + to_string(getpid())));
+    EXPECT_NE(string::npos, lines[2].find("\"name\":\"activate\""));
+    EXPECT_NE(string::npos, lines[2].find("\"parent\":\"0000000000000000\""));
+    EXPECT_TRUE(err.str().empty());
+}
+
+TEST(TraceLog, exceptions)
+{
+    ostringstream err;
+    Logger logger("TraceLog_test", err);
+    try
+    {
+        TraceLog log("/no_such_directory", "x", logger);
+        FAIL();
+    }
+    catch (unity::FileException const& e)
+    {
+        EXPECT_EQ(0u, string(e.what()).find("unity::FileException: TraceLog(): cannot open /no_such_directory/x-"));
+    }
+}
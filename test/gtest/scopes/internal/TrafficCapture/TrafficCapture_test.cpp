@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/internal/TrafficCapture.h>
+
+#include <unity/scopes/internal/Logger.h>
+#include <unity/UnityExceptions.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+using namespace std;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+string capture_file(string const& name)
+{
+    string const path = string(TEST_DIR) + "/" + name + ".capture";
+    ::unlink(path.c_str());
+    return path;
+}
+
+VariantMap search_request(string const& query_string)
+{
+    VariantMap query;
+    query["query_string"] = query_string;
+    VariantMap metadata;
+    metadata["cardinality"] = 10;
+    metadata["locale"] = "en";
+    VariantMap request;
+    request["query"] = query;
+    request["metadata"] = metadata;
+    return request;
+}
+
+} // namespace
+
+TEST(TrafficCapture, round_trip)
+{
+    auto const path = capture_file("round_trip");
+    ostringstream log;
+    Logger logger("test", log);
+
+    auto const before = chrono::system_clock::now();
+    {
+        TrafficCapture c(path, logger);
+        c.record(TrafficCapture::Kind::Search, "client", search_request("hello"));
+        c.record(TrafficCapture::Kind::Preview, "", VariantMap{ { "result", Variant(VariantMap{ { "uri", Variant("a") } }) } });
+        c.record(TrafficCapture::Kind::Activate, "", VariantMap());
+    }
+    auto const after = chrono::system_clock::now();
+
+    auto const records = TrafficCapture::read(path);
+    ASSERT_EQ(3u, records.size());
+
+    EXPECT_EQ(TrafficCapture::Kind::Search, records[0].kind);
+    EXPECT_EQ("client", records[0].client_id);
+    EXPECT_EQ(search_request("hello"), records[0].request);
+    EXPECT_LE(chrono::time_point_cast<chrono::microseconds>(before), records[0].time);
+    EXPECT_GE(after, records[0].time);
+
+    EXPECT_EQ(TrafficCapture::Kind::Preview, records[1].kind);
+    EXPECT_EQ("", records[1].client_id);
+    EXPECT_EQ("a", records[1].request.at("result").get_dict().at("uri").get_string());
+
+    EXPECT_EQ(TrafficCapture::Kind::Activate, records[2].kind);
+    EXPECT_TRUE(records[2].request.empty());
+
+    EXPECT_TRUE(log.str().empty());
+}
+
+TEST(TrafficCapture, append)
+{
+    auto const path = capture_file("append");
+    ostringstream log;
+    Logger logger("test", log);
+
+    {
+        TrafficCapture c(path, logger);
+        c.record(TrafficCapture::Kind::Search, "", search_request("one"));
+    }
+    {
+        TrafficCapture c(path, logger);  // Re-opening must not write a second header.
+        c.record(TrafficCapture::Kind::Search, "", search_request("two"));
+    }
+
+    auto const records = TrafficCapture::read(path);
+    ASSERT_EQ(2u, records.size());
+    EXPECT_EQ(search_request("one"), records[0].request);
+    EXPECT_EQ(search_request("two"), records[1].request);
+}
+
+TEST(TrafficCapture, partial_record)
+{
+    auto const path = capture_file("partial_record");
+    ostringstream log;
+    Logger logger("test", log);
+
+    {
+        TrafficCapture c(path, logger);
+        c.record(TrafficCapture::Kind::Search, "", search_request("one"));
+        c.record(TrafficCapture::Kind::Search, "", search_request("two"));
+    }
+
+    // Chop a few bytes off the end, as if the scope was killed while writing the second record.
+    ifstream in(path, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    in.close();
+    string contents = ss.str();
+    ASSERT_EQ(0, ::truncate(path.c_str(), contents.size() - 3));
+
+    auto const records = TrafficCapture::read(path);
+    ASSERT_EQ(1u, records.size());
+    EXPECT_EQ(search_request("one"), records[0].request);
+}
+
+TEST(TrafficCapture, exceptions)
+{
+    ostringstream log;
+    Logger logger("test", log);
+
+    try
+    {
+        TrafficCapture c(string(TEST_DIR) + "/no_such_dir/x.capture", logger);
+        FAIL();
+    }
+    catch (unity::FileException const& e)
+    {
+        EXPECT_NE(string::npos, string(e.what()).find("TrafficCapture(): cannot open"));
+    }
+
+    try
+    {
+        TrafficCapture::read(string(TEST_DIR) + "/no_such_file.capture");
+        FAIL();
+    }
+    catch (unity::FileException const& e)
+    {
+        EXPECT_NE(string::npos, string(e.what()).find("TrafficCapture::read(): cannot open"));
+    }
+
+    auto const path = capture_file("bad_header");
+    {
+        ofstream out(path);
+        out << "this is not a capture file";
+    }
+
+    try
+    {
+        TrafficCapture c(path, logger);
+        FAIL();
+    }
+    catch (unity::ResourceException const& e)
+    {
+        EXPECT_NE(string::npos, string(e.what()).find("is not a capture file"));
+    }
+
+    try
+    {
+        TrafficCapture::read(path);
+        FAIL();
+    }
+    catch (unity::ResourceException const& e)
+    {
+        EXPECT_NE(string::npos, string(e.what()).find("is not a capture file"));
+    }
+}
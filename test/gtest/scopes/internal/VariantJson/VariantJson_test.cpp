@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unity/scopes/internal/JsonCppNode.h>
+#include <unity/scopes/internal/VariantJson.h>
+#include <unity/UnityExceptions.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <clocale>
+#include <fstream>
+#include <sstream>
+
+using namespace std;
+using namespace unity;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+vector<string> read_corpus(string const& name)
+{
+    ifstream in(string(CORPUS_DIR) + "/" + name);
+    vector<string> docs;
+    string line;
+    while (getline(in, line))
+    {
+        if (!line.empty())
+        {
+            docs.push_back(line);
+        }
+    }
+    return docs;
+}
+
+}  // namespace
+
+TEST(VariantJson, scalars)
+{
+    EXPECT_EQ("null", variant_to_json(Variant()));
+    EXPECT_EQ("42", variant_to_json(Variant(42)));
+    EXPECT_EQ("-9223372036854775808", variant_to_json(Variant(INT64_MIN)));
+    EXPECT_EQ("10.5", variant_to_json(Variant(10.5)));
+    EXPECT_EQ("1.0", variant_to_json(Variant(1.0)));
+    EXPECT_EQ("0.1", variant_to_json(Variant(0.1)));
+    EXPECT_EQ("true", variant_to_json(Variant(true)));
+    EXPECT_EQ("\"hello\"", variant_to_json(Variant("hello")));
+
+    EXPECT_EQ(Variant::Int, json_to_variant("2147483647").which());
+    EXPECT_EQ(Variant::Int64, json_to_variant("2147483648").which());
+    EXPECT_EQ(INT64_MIN, json_to_variant("-9223372036854775808").get_int64_t());
+    EXPECT_EQ(Variant::Double, json_to_variant("9223372036854775808").which());
+    EXPECT_EQ(Variant::Double, json_to_variant("1.0").which());
+    EXPECT_EQ(-300.0, json_to_variant("-3e2").get_double());
+    EXPECT_TRUE(json_to_variant(" null ").is_null());
+}
+
+TEST(VariantJson, strings)
+{
+    string const s = "quote\" backslash\\ newline\n tab\t control\x01 utf8 \xc3\xa9";
+    auto const json = variant_to_json(Variant(s));
+    EXPECT_EQ("\"quote\\\" backslash\\\\ newline\\n tab\\t control\\u0001 utf8 \xc3\xa9\"", json);
+    EXPECT_EQ(s, json_to_variant(json).get_string());
+
+    string out = "prefix:";
+    string_to_json(s, out);
+    EXPECT_EQ("prefix:" + json, out);
+
+    // Escaped BMP character, surrogate pair, and an unpaired surrogate.
+    EXPECT_EQ("\xc3\xa9\xf0\x9f\x98\x80\xef\xbf\xbd\\/",
+              json_to_variant("\"\\u00e9\\ud83d\\ude00\\ud83d\\\\\\/\"").get_string());
+}
+
+TEST(VariantJson, containers)
+{
+    VariantMap inner;
+    inner["x"] = Variant();
+    inner["y"] = Variant(VariantArray{Variant(1), Variant("two"), Variant(3.5)});
+    VariantMap vm;
+    vm["b"] = Variant(inner);
+    vm["a"] = Variant(VariantArray());
+    vm["c"] = Variant(VariantMap());
+
+    auto const json = variant_to_json(Variant(vm));
+    EXPECT_EQ("{\"a\":[],\"b\":{\"x\":null,\"y\":[1,\"two\",3.5]},\"c\":{}}", json);
+    EXPECT_EQ(Variant(vm), json_to_variant(json));
+
+    // Whitespace is allowed between tokens, and the last duplicate member wins.
+    auto const v = json_to_variant(" { \"a\" : [ 1 , 2 ] ,\n\"a\":\t3 } ");
+    EXPECT_EQ(3, v.get_dict()["a"].get_int());
+
+    // Appends to the buffer.
+    string buf = "prefix ";
+    variant_to_json(Variant(VariantArray{Variant(true)}), buf);
+    EXPECT_EQ("prefix [true]", buf);
+}
+
+TEST(VariantJson, locale_independent)
+{
+    char const* locale = setlocale(LC_NUMERIC, "de_DE.UTF-8");
+    EXPECT_EQ("2.5", variant_to_json(Variant(2.5)));
+    EXPECT_EQ(2.5, json_to_variant("2.5").get_double());
+    if (locale)
+    {
+        setlocale(LC_NUMERIC, "C");
+    }
+}
+
+TEST(VariantJson, errors)
+{
+    for (auto const& json : { "", " ", "[1,]", "{\"a\":}", "{\"a\" 1}", "{a:1}", "01", "-", "1.", "1e",
+                              "tru", "\"abc", "\"\\x\"", "\"\\u12\"", "[1 2]", "[1", "{}}" })
+    {
+        try
+        {
+            json_to_variant(json);
+            FAIL() << "no exception for: " << json;
+        }
+        catch (ResourceException const& e)
+        {
+            EXPECT_TRUE(boost::starts_with(e.what(), "unity::ResourceException: json_to_variant(): ")) << e.what();
+        }
+    }
+
+    // Deeply nested input must not overflow the stack.
+    string deep(100000, '[');
+    EXPECT_THROW(json_to_variant(deep), ResourceException);
+}
+
+// Everything JsonCppNode can parse must give the same Variant with the native codec,
+// and the native codec must round-trip its own output.
+
+TEST(VariantJson, same_as_json_glib)
+{
+    vector<string> docs;
+    for (auto const& name : { "search.jsonl", "preview.jsonl", "remote-scopes.json" })
+    {
+        auto corpus = read_corpus(name);
+        docs.insert(docs.end(), corpus.begin(), corpus.end());
+    }
+    ASSERT_FALSE(docs.empty());
+
+    for (auto const& doc : docs)
+    {
+        Variant const expected = JsonCppNode(doc).to_variant();
+        Variant const v = json_to_variant(doc);
+        EXPECT_EQ(expected, v) << doc;
+        EXPECT_EQ(v, json_to_variant(variant_to_json(v))) << doc;
+        EXPECT_EQ(expected, JsonCppNode(variant_to_json(v)).to_variant()) << doc;
+    }
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/CompletionDetails.h>
+#include <unity/scopes/internal/lttng/UnityScopes_tp.h>
+#include <unity/scopes/internal/ReplyObjectBase.h>
+#include <unity/scopes/internal/RuntimeImpl.h>
+#include <unity/scopes/internal/zmq_middleware/ZmqMiddleware.h>
+#include <unity/scopes/internal/zmq_middleware/ZmqReply.h>
+
+#include <boost/regex.hpp>  // Use Boost implementation until http://gcc.gnu.org/bugzilla/show_bug.cgi?id=53631 is fixed.
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+using namespace std;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+using namespace unity::scopes::internal::zmq_middleware;
+
+namespace
+{
+
+class Receiver : public ReplyObjectBase
+{
+public:
+  virtual void push(VariantMap const&) noexcept override
+  {
+  }
+
+  virtual void finished(CompletionDetails const&) noexcept override
+  {
+    lock_guard<mutex> lock(mutex_);
+    finished_ = true;
+    cond_.notify_all();
+  }
+
+  virtual void info(OperationInfo const&) noexcept override
+  {
+  }
+
+  void wait_until_finished()
+  {
+    unique_lock<mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return finished_; });
+  }
+
+private:
+  bool finished_ = false;
+  mutex mutex_;
+  condition_variable cond_;
+};
+
+// Returns the size field of the first event with the given name and query id, or -1.
+
+long event_size(string const& trace, string const& event, string const& query_id)
+{
+  boost::regex r("unity_scopes:" + event + ":.*\\{ query_id = \"" + query_id + "\", scope_id = \"[^\"]*\", size = ([0-9]+) \\}");
+  boost::smatch m;
+  if (!boost::regex_search(trace, m, r))
+  {
+    return -1;
+  }
+  return stol(m[1]);
+}
+
+bool run(string const& cmd)
+{
+  return system(cmd.c_str()) == 0;
+}
+
+string const trace_dir = TEST_DIR "/lttng-trace";
+
+} // namespace
+
+// The unity_scopes events record the marshaled size of a push on both sides,
+// and reply_arrived carries the scope id.
+
+TEST(UnityScopesTracepoint, reply_events)
+{
+  dlopen( TRACEPOINT_LIB, RTLD_NOW );
+
+  // ensure that the LTTng session daemon is running in the background
+  // (this fails harmlessly if the daemon is already running)
+  run("lttng-sessiond -d");
+
+  ASSERT_TRUE(run("rm -R -f " + trace_dir));
+  if (!run("lttng create unity_scopes_session -o " + trace_dir))
+  {
+    // No session daemon, for example because we are running in a container.
+#ifdef GTEST_SKIP
+    GTEST_SKIP() << "cannot create an LTTng session";
+#else
+    cerr << "UnityScopesTracepoint: cannot create an LTTng session, skipping test" << endl;
+    return;
+#endif
+  }
+  ASSERT_TRUE(run("lttng enable-event 'unity_scopes:*' -s unity_scopes_session -u --loglevel=TRACE_DEBUG"));
+  ASSERT_TRUE(run("lttng start unity_scopes_session"));
+
+  simple_tracepoint( unity_scopes, reply_arrived, "some-query", "some-scope", 42 );
+
+  string query_id;
+  {
+    // Direct dispatch is disabled in Zmq.ini, so the push is marshaled and sent via zmq.
+    auto rt = RuntimeImpl::create("tracepoint-scope", TEST_DIR "/Runtime.ini");
+    ZmqMiddleware server_mw("tracepoint-server", rt.get(), TEST_DIR "/Zmq.ini");
+    ZmqMiddleware client_mw("tracepoint-client", rt.get(), TEST_DIR "/Zmq.ini");
+    server_mw.start();
+    client_mw.start();
+
+    auto receiver = make_shared<Receiver>();
+    auto client_reply = dynamic_pointer_cast<ZmqReply>(client_mw.add_reply_object(receiver));
+    ASSERT_TRUE(client_reply != nullptr);
+    query_id = client_reply->identity();
+
+    ZmqReply server_reply(&server_mw, client_reply->endpoint(), client_reply->identity(), client_reply->target_category());
+    VariantMap result;
+    result["uri"] = string(100, 'x');
+    server_reply.push(result);
+    server_reply.finished(CompletionDetails(CompletionDetails::OK));
+    receiver->wait_until_finished();
+
+    client_mw.stop();
+    server_mw.stop();
+    client_mw.wait_for_shutdown();
+    server_mw.wait_for_shutdown();
+  }
+
+  EXPECT_TRUE(run("lttng stop unity_scopes_session"));
+  EXPECT_TRUE(run("lttng view -t " + trace_dir + " > " + trace_dir + "/trace.txt"));
+  EXPECT_TRUE(run("lttng destroy unity_scopes_session"));
+
+  std::ifstream trace_file(trace_dir + "/trace.txt");
+  std::string trace((std::istreambuf_iterator<char>(trace_file)),
+                     std::istreambuf_iterator<char>());
+
+  EXPECT_NE( std::string::npos, trace.find("unity_scopes:reply_arrived:") );
+  EXPECT_NE( std::string::npos, trace.find("{ query_id = \"some-query\", scope_id = \"some-scope\", size = 42 }") );
+
+  // The size is the number of bytes on the wire, not the number of attributes.
+  auto push_size = event_size(trace, "reply_push", query_id);
+  auto arrived_size = event_size(trace, "reply_arrived", query_id);
+  EXPECT_GT( push_size, 100 );
+  EXPECT_EQ( push_size, arrived_size );
+  EXPECT_NE( std::string::npos, trace.find("{ query_id = \"" + query_id + "\", scope_id = \"tracepoint-scope\", size = ") );
+
+  EXPECT_NE( std::string::npos, trace.find("unity_scopes:reply_finished:") );
+}
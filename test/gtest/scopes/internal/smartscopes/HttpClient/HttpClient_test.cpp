@@ -18,6 +18,7 @@
 
 #include <unity/scopes/internal/smartscopes/HttpClientNetCpp.h>
 #include <unity/UnityExceptions.h>
+#include <unity/util/FileIO.h>
 
 #include "../RaiiServer.h"
 
@@ -28,6 +29,7 @@
 
 #include <memory>
 #include <thread>
+#include <vector>
 
 using namespace testing;
 using namespace unity::scopes::internal::smartscopes;
@@ -161,4 +163,93 @@ TEST_F(HttpClientTest, percent_encoding)
     EXPECT_EQ("%20%22%25%3C%3E%5C%5E%60%7B%7C%7D%21%2A%27%28%29%3B%3A%40%26%3D%2B%24%2C%2F%3F%23%5B%5D", encoded_str);
 }
 
+// Runs a GET against the replay server and returns the body passed to line_data.
+std::string replay_get(std::string const& path, HttpHeaders const& headers)
+{
+    RaiiServer server(REPLAY_SERVER_PATH, RECORDED_DIR);
+    HttpClientInterface::SPtr http_client(new HttpClientNetCpp(20000));
+
+    std::string response_str;
+    bool end_seen = false;
+    HttpResponseHandle::SPtr response = http_client->get(c_test_url + ":" + std::to_string(server.port_) + path,
+                                                         [&response_str, &end_seen](std::string const& s)
+                                                         {
+                                                             response_str += s;
+                                                             end_seen = s.empty();
+                                                         },
+                                                         headers);
+    response->wait();
+
+    EXPECT_NO_THROW(response->get());
+    EXPECT_TRUE(end_seen);
+    return response_str;
+}
+
+TEST(HttpClientReplay, uncompressed_stream)
+{
+    // Without Accept-Encoding, the replay server doesn't compress.
+    EXPECT_EQ(unity::util::read_text_file(RECORDED_DIR "/search.jsonl"), replay_get("/demo/search?q=x", {}));
+}
+
+TEST(HttpClientReplay, compressed_stream)
+{
+    auto const expected = unity::util::read_text_file(RECORDED_DIR "/search.jsonl");
+    EXPECT_EQ(expected, replay_get("/demo/search?q=x", { { "Accept-Encoding", "gzip" } }));
+    EXPECT_EQ(expected, replay_get("/demo/search?q=x", { { "Accept-Encoding", "deflate" } }));
+}
+
+TEST(HttpClientReplay, unknown_content_encoding)
+{
+    // A body with a content coding we don't know is passed on unchanged,
+    // as is a body that claims to be identity-coded.
+    auto const expected = unity::util::read_text_file(RECORDED_DIR "/search.jsonl");
+    EXPECT_EQ(expected, replay_get("/demo/search?q=x&content_encoding=br", { { "Accept-Encoding", "gzip, br" } }));
+    EXPECT_EQ(expected, replay_get("/demo/search?q=x&content_encoding=identity", { { "Accept-Encoding", "gzip" } }));
+}
+
+TEST(HttpClientReplay, truncated_compressed_stream)
+{
+    RaiiServer server(REPLAY_SERVER_PATH, RECORDED_DIR);
+    HttpClientInterface::SPtr http_client(new HttpClientNetCpp(20000));
+
+    for (auto const& encoding : { "gzip", "deflate" })
+    {
+        bool data_seen = false;
+        HttpResponseHandle::SPtr response = http_client->get(c_test_url + ":" + std::to_string(server.port_) +
+                                                             "/demo/search?q=x&truncate=1",
+                                                             [&data_seen](std::string const&)
+                                                             {
+                                                                 data_seen = true;
+                                                             },
+                                                             { { "Accept-Encoding", encoding } });
+        response->wait();
+
+        // Neither a partial body nor the end marker are passed on.
+        EXPECT_THROW(response->get(), unity::ResourceException);
+        EXPECT_FALSE(data_seen);
+    }
+}
+
+TEST(HttpClientReplay, max_concurrent_requests)
+{
+    RaiiServer server(REPLAY_SERVER_PATH, RECORDED_DIR);
+    HttpClientInterface::SPtr http_client(new HttpClientNetCpp(20000, 2));
+    auto const url = c_test_url + ":" + std::to_string(server.port_) + "/demo/preview?chunk_delay_ms=20";
+    auto const expected = unity::util::read_text_file(RECORDED_DIR "/preview.jsonl");
+
+    // Only two requests run at a time, the others are queued and must still complete.
+    std::vector<std::string> response_strs(5);
+    std::vector<HttpResponseHandle::SPtr> responses;
+    for (auto& str : response_strs)
+    {
+        responses.push_back(http_client->get(url, [&str](std::string const& s) { str += s; }));
+    }
+    for (size_t i = 0; i < responses.size(); ++i)
+    {
+        responses[i]->wait();
+        EXPECT_NO_THROW(responses[i]->get());
+        EXPECT_EQ(expected, response_strs[i]);
+    }
+}
+
 } // namespace
@@ -0,0 +1,157 @@
+#!/usr/bin/env python
+
+#
+# Copyright (C) 2016 Canonical Ltd
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3 as
+# published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+
+#
+# Loopback stand-in for the smart scopes server. It replays recorded
+# remote-scopes, search and preview streams from the directory given as
+# the first argument:
+#
+#   <dir>/remote-scopes.json  served for /remote-scopes
+#   <dir>/search.jsonl        served for any path ending in /search
+#   <dir>/preview.jsonl       served for any path ending in /preview
+#
+# Responses use HTTP/1.1 keep-alive and chunked transfer encoding, with one
+# chunk per line, and are gzip or deflate compressed if the client asks for it.
+# The optional query parameter chunk_delay_ms delays each chunk, to simulate
+# a slow network. The optional query parameter content_encoding sends the
+# body uncompressed, but with the given Content-Encoding. The optional query
+# parameter truncate cuts the compressed body in half. GET /stats returns the number of connections and requests
+# served so far, so clients can check that connections are being reused.
+#
+# The port number is printed on stdout once the server is listening.
+#
+
+import gzip
+import io
+import os
+import sys
+import threading
+import time
+import zlib
+
+try:
+    from BaseHTTPServer import BaseHTTPRequestHandler, HTTPServer
+    from SocketServer import ThreadingMixIn
+    from urlparse import urlparse, parse_qs
+except ImportError:
+    from http.server import BaseHTTPRequestHandler, HTTPServer
+    from socketserver import ThreadingMixIn
+    from urllib.parse import urlparse, parse_qs
+
+recording_dir = sys.argv[1] if len(sys.argv) > 1 and sys.argv[1] != '' else '.'
+
+stats_lock = threading.Lock()
+stats = {'connections': 0, 'requests': 0}
+
+def compress(data, encoding):
+    if encoding == 'gzip':
+        buf = io.BytesIO()
+        f = gzip.GzipFile(fileobj=buf, mode='wb')
+        f.write(data)
+        f.close()
+        return buf.getvalue()
+    return zlib.compress(data)
+
+class ReplayHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+
+    def setup(self):
+        BaseHTTPRequestHandler.setup(self)
+        with stats_lock:
+            stats['connections'] += 1
+
+    def log_message(self, format, *args):
+        pass
+
+    def recording(self, path):
+        if path == '/remote-scopes':
+            return 'remote-scopes.json'
+        if path.endswith('/search'):
+            return 'search.jsonl'
+        if path.endswith('/preview'):
+            return 'preview.jsonl'
+        return None
+
+    def do_GET(self):
+        with stats_lock:
+            stats['requests'] += 1
+            current_stats = '{"connections": %d, "requests": %d}' % (stats['connections'], stats['requests'])
+
+        url = urlparse(self.path)
+        params = parse_qs(url.query)
+        delay = float(params.get('chunk_delay_ms', ['0'])[0]) / 1000
+
+        if url.path == '/stats':
+            lines = [current_stats.encode('utf-8')]
+        else:
+            name = self.recording(url.path)
+            if name is None or not os.path.exists(os.path.join(recording_dir, name)):
+                body = b'no recording for ' + url.path.encode('utf-8')
+                self.send_response(404)
+                self.send_header('Content-Type', 'text/plain')
+                self.send_header('Content-Length', str(len(body)))
+                self.end_headers()
+                self.wfile.write(body)
+                return
+            with open(os.path.join(recording_dir, name), 'rb') as f:
+                lines = f.read().splitlines(True)
+
+        accept = self.headers.get('Accept-Encoding', '')
+        encoding = None
+        if 'gzip' in accept:
+            encoding = 'gzip'
+        elif 'deflate' in accept:
+            encoding = 'deflate'
+
+        self.send_response(200)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Transfer-Encoding', 'chunked')
+        if 'content_encoding' in params:
+            # Label the uncompressed body with the given content coding.
+            self.send_header('Content-Encoding', params['content_encoding'][0])
+        elif encoding:
+            self.send_header('Content-Encoding', encoding)
+            body = compress(b''.join(lines), encoding)
+            if 'truncate' in params:
+                body = body[:len(body) // 2]
+            lines = [body]
+        self.end_headers()
+
+        for line in lines:
+            if delay > 0:
+                time.sleep(delay)
+            self.wfile.write(('%x\r\n' % len(line)).encode('ascii') + line + b'\r\n')
+            self.wfile.flush()
+        self.wfile.write(b'0\r\n\r\n')
+        self.wfile.flush()
+
+class ThreadingServer(ThreadingMixIn, HTTPServer):
+    daemon_threads = True
+
+port = 1024
+httpd = None
+while httpd is None:
+    try:
+        httpd = ThreadingServer(('127.0.0.1', port), ReplayHandler)
+    except Exception:
+        port += 1
+
+print(str(port))
+sys.stdout.flush()
+
+httpd.serve_forever()
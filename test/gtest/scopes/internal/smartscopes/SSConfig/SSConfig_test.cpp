@@ -38,6 +38,7 @@ TEST(SSConfig, basic)
         // No config, defaults apply.
         SSConfig c("");
         EXPECT_EQ(DFLT_SS_HTTP_TIMEOUT, c.http_reply_timeout());
+        EXPECT_EQ(DFLT_SS_HTTP_MAX_CONCURRENT, c.http_max_concurrent_requests());
         EXPECT_EQ(DFLT_SS_REG_REFRESH_RATE, c.reg_refresh_rate());
         EXPECT_EQ(DFLT_SS_REG_REFRESH_FAIL_TIMEOUT, c.reg_refresh_fail_timeout());
         EXPECT_EQ(DFLT_SS_SCOPE_IDENTITY, c.scope_identity());
@@ -47,6 +48,7 @@ TEST(SSConfig, basic)
         // Values in configfile apply.
         SSConfig c(TEST_SSREGISTRY_PATH);
         EXPECT_EQ(2, c.http_reply_timeout());
+        EXPECT_EQ(3, c.http_max_concurrent_requests());
         EXPECT_EQ(77333, c.reg_refresh_rate());
         EXPECT_EQ(17, c.reg_refresh_fail_timeout());
         EXPECT_EQ("Fred", c.scope_identity());
@@ -28,8 +28,18 @@ def response(environ, start_response):
     global preview1_complete, outfile
     status = '200 OK'
     response_headers = [('Content-Type', 'application/json')]
+
+    if environ['PATH_INFO'] == '/remote-scopes':
+        etag = '"remote-scopes-1"'
+        response_headers.append(('ETag', etag))
+        if environ.get('HTTP_IF_NONE_MATCH', '') == etag:
+            status = '304 Not Modified'
+
     start_response(status, response_headers)
 
+    if status != '200 OK':
+        return []
+
     if outfile != '':
         f = open(outfile, 'a')
         if environ.has_key('HTTP_USER_AGENT'):
@@ -178,6 +178,30 @@ TEST_F(SmartScopesClientTest, remote_scopes)
     EXPECT_TRUE(grep_string("/remote-scopes : partner=Partner%20String"));
 }
 
+TEST_F(SmartScopesClientTest, remote_scopes_unchanged)
+{
+    std::vector<RemoteScope> scopes;
+    bool unchanged = true;
+
+    // the first request always returns the full catalog
+    EXPECT_TRUE(ssc_->get_remote_scopes(scopes, "", false, &unchanged));
+    EXPECT_FALSE(unchanged);
+    ASSERT_EQ(4u, scopes.size());
+
+    // the catalog hasn't changed since, so the server replies "304 Not Modified"
+    std::vector<RemoteScope> scopes2;
+    EXPECT_TRUE(ssc_->get_remote_scopes(scopes2, "", false, &unchanged));
+    EXPECT_TRUE(unchanged);
+    EXPECT_EQ(0u, scopes2.size());
+
+    // a different locale is a different catalog
+    EXPECT_TRUE(ssc_->get_remote_scopes(scopes2, "test_TEST", false, &unchanged));
+    EXPECT_FALSE(unchanged);
+    ASSERT_EQ(4u, scopes2.size());
+    EXPECT_TRUE(scopes[0] == scopes2[0]);
+    EXPECT_TRUE(scopes[3] == scopes2[3]);
+}
+
 TEST_F(SmartScopesClientTest, remote_scopes_no_partner)
 {
     std::vector<RemoteScope> scopes;
@@ -218,11 +242,13 @@ TEST_F(SmartScopesClientTest, search)
     ASSERT_EQ(1u, categories.size());
 
     EXPECT_EQ("URI", results[0].uri);
-    EXPECT_EQ(nullptr, results[0].other_params["dnd_uri"]);
-    EXPECT_EQ("Stuff", results[0].other_params["title"]->as_string());
-    EXPECT_EQ(nullptr, results[0].other_params["icon"]);
-    EXPECT_EQ("https://dash.ubuntu.com/imgs/amazon.png", results[0].other_params["art"]->as_string());
+    EXPECT_EQ(0u, results[0].other_params.count("dnd_uri"));
+    EXPECT_EQ("Stuff", results[0].other_params["title"].get_string());
+    EXPECT_EQ(0u, results[0].other_params.count("icon"));
+    EXPECT_EQ("https://dash.ubuntu.com/imgs/amazon.png", results[0].other_params["art"].get_string());
     EXPECT_EQ("cat1", results[0].category_id);
+    EXPECT_EQ("{\"cat_id\": \"cat1\", \"art\": \"https://dash.ubuntu.com/imgs/amazon.png\", \"uri\": \"URI\", \"title\": \"Stuff\"}",
+              results[0].json);
 
     EXPECT_EQ("cat1", categories[0]->id);
     EXPECT_EQ("Category 1", categories[0]->title);
@@ -230,17 +256,17 @@ TEST_F(SmartScopesClientTest, search)
     EXPECT_EQ("{}", categories[0]->renderer_template);
 
     EXPECT_EQ("URI2", results[1].uri);
-    EXPECT_EQ(nullptr, results[1].other_params["dnd_uri"]);
-    EXPECT_EQ("Things", results[1].other_params["title"]->as_string());
-    EXPECT_EQ("https://dash.ubuntu.com/imgs/google.png", results[1].other_params["icon"]->as_string());
-    EXPECT_EQ(nullptr, results[1].other_params["art"]);
+    EXPECT_EQ(0u, results[1].other_params.count("dnd_uri"));
+    EXPECT_EQ("Things", results[1].other_params["title"].get_string());
+    EXPECT_EQ("https://dash.ubuntu.com/imgs/google.png", results[1].other_params["icon"].get_string());
+    EXPECT_EQ(0u, results[1].other_params.count("art"));
     EXPECT_EQ("cat1", results[1].category_id);
 
     EXPECT_EQ("URI3", results[2].uri);
-    EXPECT_EQ(nullptr, results[2].other_params["dnd_uri"]);
-    EXPECT_EQ("Category Fail", results[2].other_params["title"]->as_string());
-    EXPECT_EQ(nullptr, results[2].other_params["icon"]);
-    EXPECT_EQ("https://dash.ubuntu.com/imgs/cat_fail.png", results[2].other_params["art"]->as_string());
+    EXPECT_EQ(0u, results[2].other_params.count("dnd_uri"));
+    EXPECT_EQ("Category Fail", results[2].other_params["title"].get_string());
+    EXPECT_EQ(0u, results[2].other_params.count("icon"));
+    EXPECT_EQ("https://dash.ubuntu.com/imgs/cat_fail.png", results[2].other_params["art"].get_string());
 
     // check departments
     EXPECT_TRUE(dept != nullptr);
@@ -376,7 +402,7 @@ TEST_F(SmartScopesClientTest, userAgentHeader)
     ASSERT_EQ(4u, results.size());
 
     // user agent string is expected in the result title
-    EXPECT_EQ("ThisIsUserAgentHeader", results[3].other_params["title"]->as_string());
+    EXPECT_EQ("ThisIsUserAgentHeader", results[3].other_params["title"].get_string());
 }
 
 TEST_F(SmartScopesClientTest, preview)
@@ -546,4 +572,42 @@ TEST_F(SmartScopesClientTest, reset_url)
     EXPECT_EQ("http://hello.com:2000/there", ssc_->url());
 }
 
+TEST(JsonLineParser, split_lines)
+{
+    JsonLineParser parser;
+    std::vector<std::string> ids;
+    std::vector<std::string> lines;
+    std::vector<std::string> errors;
+    auto line_handler = [&ids, &lines](JsonNodeInterface::SPtr const& node, char const* begin, char const* end)
+    {
+        ids.push_back(node->get_node("result")->get_node("id")->as_string());
+        lines.emplace_back(begin, end);
+    };
+    auto error_handler = [&errors](std::string const& error)
+    {
+        errors.push_back(error);
+    };
+
+    // Lines split across chunks, several lines in one chunk, blank lines,
+    // a malformed line, and an unterminated last line.
+    parser.consume("{\"result\": {\"id\": \"1\"}}\r\n{\"resu", line_handler, error_handler);
+    EXPECT_EQ(std::vector<std::string>{"1"}, ids);
+    parser.consume("lt\": {\"id\"", line_handler, error_handler);
+    parser.consume(": \"2\"}}\r\n\r\n{\"result\": {\"id\": \"3\"}}\n{bad\n", line_handler, error_handler);
+    EXPECT_EQ((std::vector<std::string>{"1", "2", "3"}), ids);
+    EXPECT_EQ(1u, errors.size());
+    parser.consume("{\"result\": {\"id\": \"4\"}}", line_handler, error_handler);
+    EXPECT_EQ(3u, ids.size());
+    parser.consume("", line_handler, error_handler);
+    EXPECT_EQ((std::vector<std::string>{"1", "2", "3", "4"}), ids);
+    EXPECT_EQ(1u, errors.size());
+
+    // Each handler call sees exactly the raw text of its line, without the '\n'.
+    EXPECT_EQ((std::vector<std::string>{"{\"result\": {\"id\": \"1\"}}\r",
+                                        "{\"result\": {\"id\": \"2\"}}\r",
+                                        "{\"result\": {\"id\": \"3\"}}",
+                                        "{\"result\": {\"id\": \"4\"}}"}),
+              lines);
+}
+
 } // namespace
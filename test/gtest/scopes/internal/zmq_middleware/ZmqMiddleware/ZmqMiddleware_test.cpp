@@ -18,16 +18,28 @@
 
 #include <unity/scopes/internal/zmq_middleware/ZmqMiddleware.h>
 
+#include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/internal/CompletionDetailsImpl.h>
 #include <unity/scopes/internal/RuntimeImpl.h>
 #include <unity/scopes/internal/MWObjectProxy.h>
+#include <unity/scopes/internal/MWQueryCtrl.h>
+#include <unity/scopes/internal/MWReply.h>
+#include <unity/scopes/internal/MWScope.h>
+#include <unity/scopes/internal/ReplyObjectBase.h>
 #include <unity/scopes/internal/zmq_middleware/ZmqObjectProxy.h>
+#include <unity/scopes/internal/zmq_middleware/ZmqReply.h>
 #include <unity/scopes/ScopeExceptions.h>
+#include <unity/scopes/SearchMetadata.h>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
 #include <gtest/gtest.h>
 #pragma GCC diagnostic pop
 
+#include <algorithm>
+#include <condition_variable>
+#include <thread>
+
 using namespace std;
 using namespace unity::scopes;
 using namespace unity::scopes::internal;
@@ -35,6 +47,7 @@ using namespace unity::scopes::internal::zmq_middleware;
 
 string const runtime_ini = TEST_DIR "/Runtime.ini";
 string const zmq_ini = TEST_DIR "/Zmq.ini";
+string const zmq_nodirect_ini = TEST_DIR "/ZmqNoDirect.ini";
 
 // Basic test.
 
@@ -433,6 +446,7 @@ public:
 
     virtual MWQueryCtrlProxy activate(Result const&,
                                       ActionMetadata const&,
+                                      VariantMap const&,
                                       MWReplyProxy const&,
                                       InvokeInfo const&) override
     {
@@ -460,6 +474,7 @@ public:
 
     virtual MWQueryCtrlProxy preview(Result const&,
                                      ActionMetadata const&,
+                                     VariantMap const&,
                                      MWReplyProxy const&,
                                      InvokeInfo const&) override
     {
@@ -525,3 +540,299 @@ TEST(ZmqMiddleware, shutdown_after_start_with_adapter)
     }
     mw.wait_for_shutdown();
 }
+
+class DirectScopeObject : public MyScopeObject
+{
+public:
+    virtual MWQueryCtrlProxy search(CannedQuery const&,
+                                    SearchMetadata const&,
+                                    VariantMap const&,
+                                    MWReplyProxy const& reply,
+                                    InvokeInfo const& info) override
+    {
+        id_ = info.id;
+        mw_ = info.mw;
+        thread_id_ = this_thread::get_id();
+        reply_mw_ = reply->mw_base();
+
+        VariantMap result;
+        result["n"] = 1;
+        reply->push(result);
+        result["n"] = 2;
+        reply->push(result);
+        reply->finished(CompletionDetails(CompletionDetails::OK));
+        return info.mw->create_query_ctrl_proxy("ctrl", "ipc:///tmp/ctrl");
+    }
+
+    string id_;
+    MiddlewareBase* mw_ = nullptr;
+    MiddlewareBase* reply_mw_ = nullptr;
+    thread::id thread_id_;
+};
+
+class DirectReplyObject : public ReplyObjectBase
+{
+public:
+    virtual void push(VariantMap const& result) noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        results_.push_back(result.at("n").get_int());
+        thread_id_ = this_thread::get_id();
+    }
+
+    virtual void finished(CompletionDetails const&) noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        finished_ = true;
+        cond_.notify_all();
+    }
+
+    virtual void info(OperationInfo const&) noexcept override
+    {
+    }
+
+    void wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return finished_; });
+    }
+
+    vector<int> results_;
+    thread::id thread_id_;
+    bool finished_ = false;
+    mutex mutex_;
+    condition_variable cond_;
+};
+
+// Invocations on a servant in the same process bypass zmq, but the servant sees the same
+// InvokeInfo and proxies it would see for a remote invocation.
+
+TEST(ZmqMiddleware, direct_dispatch)
+{
+    ZmqMiddleware server_mw("direct-server", nullptr, zmq_ini);
+    ZmqMiddleware client_mw("direct-client", nullptr, zmq_ini);
+    server_mw.start();
+    client_mw.start();
+
+    auto so = make_shared<DirectScopeObject>();
+    server_mw.add_scope_object("direct-scope", so, -1);
+
+    auto ro = make_shared<DirectReplyObject>();
+    auto reply = client_mw.add_reply_object(ro);
+
+    auto scope = client_mw.create_scope_proxy("direct-scope");
+    auto ctrl = scope->search(CannedQuery("direct-scope"),
+                              SearchMetadata("en", "phone").serialize(),
+                              VariantMap(),
+                              reply);
+    ASSERT_TRUE(ctrl != nullptr);
+    EXPECT_EQ("ctrl", ctrl->identity());
+
+    ro->wait_until_finished();
+    EXPECT_EQ(vector<int>({ 1, 2 }), ro->results_);  // Oneway invocations arrive in order
+
+    EXPECT_EQ("direct-scope", so->id_);
+    EXPECT_EQ(&server_mw, so->mw_);
+    EXPECT_EQ(&server_mw, so->reply_mw_);
+    EXPECT_NE(this_thread::get_id(), so->thread_id_);
+    EXPECT_NE(this_thread::get_id(), ro->thread_id_);
+
+    client_mw.stop();
+    server_mw.stop();
+    client_mw.wait_for_shutdown();
+    server_mw.wait_for_shutdown();
+}
+
+class SerialScopeObject : public MyScopeObject
+{
+public:
+    virtual MWQueryCtrlProxy search(CannedQuery const&,
+                                    SearchMetadata const&,
+                                    VariantMap const&,
+                                    MWReplyProxy const&,
+                                    InvokeInfo const& info) override
+    {
+        {
+            lock_guard<mutex> lock(mutex_);
+            max_active_ = max(max_active_, ++active_);
+        }
+        this_thread::sleep_for(chrono::milliseconds(20));
+        {
+            lock_guard<mutex> lock(mutex_);
+            --active_;
+        }
+        return info.mw->create_query_ctrl_proxy("ctrl", "ipc:///tmp/ctrl");
+    }
+
+    int max_active_ = 0;
+
+private:
+    int active_ = 0;
+    mutex mutex_;
+};
+
+// The scope adapter dispatches remote invocations on a single thread, so direct
+// invocations from several threads must not run concurrently either.
+
+TEST(ZmqMiddleware, direct_dispatch_is_serialized)
+{
+    ZmqMiddleware server_mw("direct-server", nullptr, zmq_ini);
+    ZmqMiddleware client_mw("direct-client", nullptr, zmq_ini);
+    server_mw.start();
+    client_mw.start();
+
+    auto so = make_shared<SerialScopeObject>();
+    server_mw.add_scope_object("serial-scope", so, -1);
+
+    auto ro = make_shared<DirectReplyObject>();
+    auto reply = client_mw.add_reply_object(ro);
+    auto scope = client_mw.create_scope_proxy("serial-scope");
+
+    vector<thread> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.emplace_back([scope, reply]
+        {
+            auto ctrl = scope->search(CannedQuery("serial-scope"),
+                                      SearchMetadata("en", "phone").serialize(),
+                                      VariantMap(),
+                                      reply);
+            EXPECT_TRUE(ctrl != nullptr);
+        });
+    }
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+    EXPECT_EQ(1, so->max_active_);
+
+    client_mw.stop();
+    server_mw.stop();
+    client_mw.wait_for_shutdown();
+    server_mw.wait_for_shutdown();
+}
+
+class TimingsReplyObject : public ReplyObjectBase
+{
+public:
+    virtual void push(VariantMap const&) noexcept override
+    {
+    }
+
+    virtual void finished(CompletionDetails const& details) noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        details_.reset(new CompletionDetails(details));
+        cond_.notify_all();
+    }
+
+    virtual void info(OperationInfo const&) noexcept override
+    {
+    }
+
+    CompletionDetails wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return details_ != nullptr; });
+        return *details_;
+    }
+
+private:
+    unique_ptr<CompletionDetails> details_;
+    mutex mutex_;
+    condition_variable cond_;
+};
+
+// Sends two pushes and finished() from a server-side ZmqReply to a reply object
+// in client_mw, and returns the details that arrive with finished().
+
+CompletionDetails send_reply(ZmqMiddleware& server_mw, ZmqMiddleware& client_mw)
+{
+    auto ro = make_shared<TimingsReplyObject>();
+    auto client_reply = dynamic_pointer_cast<ZmqReply>(client_mw.add_reply_object(ro));
+    EXPECT_TRUE(client_reply != nullptr);
+
+    ZmqReply reply(&server_mw, client_reply->endpoint(), client_reply->identity(), client_reply->target_category());
+    reply.run_started("timings-scope");
+
+    VariantMap result;
+    result["result"] = string(100, 'x');
+    reply.push(result);
+    reply.push(result);
+
+    QueryTimingsImpl child;
+    child.set_scope_id("child-scope");
+    child.set_total(chrono::microseconds(1234));
+    child.set_result_count(3);
+    child.set_byte_count(567);
+    reply.add_subquery_timings(QueryTimingsImpl::create(child));
+
+    reply.finished(CompletionDetails(CompletionDetails::OK));
+    return ro->wait_until_finished();
+}
+
+void check_scope_timings(CompletionDetails const& details, chrono::system_clock::time_point start)
+{
+    ASSERT_TRUE(details.has_timings());
+    auto const timings = CompletionDetailsImpl::impl(details)->timings_impl();
+    ASSERT_TRUE(timings != nullptr);
+
+    EXPECT_EQ("timings-scope", timings->scope_id());
+    // The run start travels in microseconds.
+    auto const us = [](chrono::system_clock::time_point t)
+    {
+        return chrono::duration_cast<chrono::microseconds>(t.time_since_epoch());
+    };
+    EXPECT_LE(us(start), us(timings->run_start_time()));
+    EXPECT_GE(chrono::system_clock::now(), timings->run_start_time());
+
+    auto const subqueries = timings->subqueries();
+    ASSERT_EQ(1u, subqueries.size());
+    EXPECT_EQ("child-scope", subqueries[0].scope_id());
+    EXPECT_EQ(chrono::microseconds(1234), subqueries[0].total());
+    EXPECT_EQ(3u, subqueries[0].result_count());
+    EXPECT_EQ(567u, subqueries[0].byte_count());
+    EXPECT_TRUE(subqueries[0].subqueries().empty());
+}
+
+// The scope's part of the timings survives the round trip through the Reply FinishedRequest,
+// and byte_count is the size of the marshaled pushes.
+
+TEST(ZmqMiddleware, finished_timings)
+{
+    auto rt = RuntimeImpl::create("timings-client", runtime_ini);  // Needed for the IPC logger
+    ZmqMiddleware server_mw("timings-server", rt.get(), zmq_nodirect_ini);
+    ZmqMiddleware client_mw("timings-client", rt.get(), zmq_nodirect_ini);
+    server_mw.start();
+    client_mw.start();
+
+    auto const start = chrono::system_clock::now();
+    auto const details = send_reply(server_mw, client_mw);
+    check_scope_timings(details, start);
+    EXPECT_GT(details.timings().byte_count(), 200u);  // Two pushes with 100 bytes of payload each
+
+    client_mw.stop();
+    server_mw.stop();
+    client_mw.wait_for_shutdown();
+    server_mw.wait_for_shutdown();
+}
+
+// With direct dispatch, the same timings arrive, but nothing is marshaled.
+
+TEST(ZmqMiddleware, finished_timings_direct)
+{
+    ZmqMiddleware server_mw("timings-server", nullptr, zmq_ini);
+    ZmqMiddleware client_mw("timings-client", nullptr, zmq_ini);
+    server_mw.start();
+    client_mw.start();
+
+    auto const start = chrono::system_clock::now();
+    auto const details = send_reply(server_mw, client_mw);
+    check_scope_timings(details, start);
+    EXPECT_EQ(0u, details.timings().byte_count());
+
+    client_mw.stop();
+    server_mw.stop();
+    client_mw.wait_for_shutdown();
+    server_mw.wait_for_shutdown();
+}
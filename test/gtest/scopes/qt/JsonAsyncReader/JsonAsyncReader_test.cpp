@@ -30,6 +30,9 @@
 
 #include <core/posix/exec.h>
 
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 namespace posix = core::posix;
 
 using namespace std;
@@ -113,6 +116,42 @@ TEST_F(ExceptionsTest, bad_url_test)
         FAIL() << e.what();
     }
 }
+TEST_F(ExceptionsTest, cancel_fd_aborts_download)
+{
+    int fd = eventfd(0, EFD_CLOEXEC);
+    ASSERT_NE(-1, fd);
+
+    JsonAsyncReader reader;
+    reader.set_cancel_fd(fd);
+    JsonAsyncReader::JsonParameters parameters{{"method", "slow"}};
+
+    // The server takes ten seconds to respond.
+    auto reader_future = reader.async_get<Client::Result>(fake_server_host, parameters, "track");
+    this_thread::sleep_for(chrono::milliseconds(500));
+    EXPECT_EQ(future_status::timeout, reader_future.wait_for(chrono::seconds(0)));
+
+    uint64_t const one = 1;
+    ASSERT_EQ(ssize_t(sizeof(one)), write(fd, &one, sizeof(one)));
+
+    auto const start = chrono::steady_clock::now();
+    try
+    {
+        HttpAsyncReader::get_or_throw(reader_future, 5);
+        FAIL();
+    }
+    catch (unity::LogicException const&)
+    {
+        // The download was aborted, so the future holds the error.
+    }
+    catch (std::exception const& e)
+    {
+        FAIL() << e.what();
+    }
+    EXPECT_LT(chrono::steady_clock::now() - start, chrono::seconds(5));
+
+    close(fd);
+}
+
 TEST(BadUrlException, state)
 {
     JsonAsyncReader reader;
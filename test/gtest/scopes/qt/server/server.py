@@ -18,6 +18,7 @@
 # Authored by: Pete Woods <pete.woods@canonical.com>
 
 import base64
+import datetime
 import json
 import os
 import tornado.httpserver
@@ -44,8 +45,13 @@ class ErrorHandler(tornado.web.RequestHandler):
         self.write(json.dumps({'error': '%s: %d' % (kwargs["exc_info"][1], status_code)}))
 
 class Query(ErrorHandler):
+    @tornado.web.asynchronous
     def get(self):
 #         validate_argument(self, 'part', 'snippet,statistics')
+        if self.get_argument('method', None) == 'slow':
+            # Respond after ten seconds, so the client has time to abort the download.
+            tornado.ioloop.IOLoop.instance().add_timeout(datetime.timedelta(seconds=10), self.respond_slow)
+            return
         file = 'queries/%s.txt' % self.get_argument('method', None );
         if "not_found" in file:
             file = 'queries/not_found.txt'
@@ -53,6 +59,10 @@ class Query(ErrorHandler):
         self.write(read_file(file))
         self.finish()
 
+    def respond_slow(self):
+        self.write(read_file('queries/json_chart_gettoptracks.txt'))
+        self.finish()
+
 def validate_argument(self, name, expected):
     actual = self.get_argument(name, '')
     if actual != expected:
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares latency and throughput of queries on a scope in the same process,
+// once with direct dispatch and once with all invocations going through zmq.
+
+#include <unity/scopes/CannedQuery.h>
+#include <unity/scopes/internal/MWQueryCtrl.h>
+#include <unity/scopes/internal/MWReply.h>
+#include <unity/scopes/internal/MWScope.h>
+#include <unity/scopes/internal/ReplyObjectBase.h>
+#include <unity/scopes/internal/ScopeObjectBase.h>
+#include <unity/scopes/internal/zmq_middleware/ZmqMiddleware.h>
+#include <unity/scopes/SearchMetadata.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+using namespace unity::scopes::internal::zmq_middleware;
+
+namespace
+{
+
+int const num_queries = 2000;
+int const results_per_query = 20;
+
+class BenchScopeObject : public ScopeObjectBase
+{
+public:
+    virtual MWQueryCtrlProxy search(CannedQuery const&,
+                                    SearchMetadata const&,
+                                    VariantMap const&,
+                                    MWReplyProxy const& reply,
+                                    InvokeInfo const& info) override
+    {
+        VariantMap result;
+        result["uri"] = "scope://bench";
+        result["title"] = "A result with a title of typical length";
+        for (int i = 0; i < results_per_query; ++i)
+        {
+            result["n"] = i;
+            reply->push(result);
+        }
+        reply->finished(CompletionDetails(CompletionDetails::OK));
+        return info.mw->create_query_ctrl_proxy("ctrl", "ipc:///tmp/bench-ctrl");
+    }
+
+    virtual MWQueryCtrlProxy activate(Result const&, ActionMetadata const&, VariantMap const&,
+                                      MWReplyProxy const&, InvokeInfo const&) override
+    {
+        return nullptr;
+    }
+
+    virtual MWQueryCtrlProxy perform_action(Result const&, ActionMetadata const&, string const&, string const&,
+                                            MWReplyProxy const&, InvokeInfo const&) override
+    {
+        return nullptr;
+    }
+
+    virtual MWQueryCtrlProxy activate_result_action(Result const&, ActionMetadata const&, string const&,
+                                                    MWReplyProxy const&, InvokeInfo const&) override
+    {
+        return nullptr;
+    }
+
+    virtual MWQueryCtrlProxy preview(Result const&, ActionMetadata const&, VariantMap const&,
+                                     MWReplyProxy const&, InvokeInfo const&) override
+    {
+        return nullptr;
+    }
+
+    virtual ChildScopeList child_scopes() const override
+    {
+        return ChildScopeList();
+    }
+
+    virtual bool set_child_scopes(ChildScopeList const&) override
+    {
+        return false;
+    }
+
+    virtual bool debug_mode() const override
+    {
+        return false;
+    }
+};
+
+class BenchReplyObject : public ReplyObjectBase
+{
+public:
+    virtual void push(VariantMap const&) noexcept override
+    {
+        lock_guard<mutex> lock(mutex_);
+        ++count_;
+    }
+
+    virtual void finished(CompletionDetails const&) noexcept override
+    {
+        disconnect();
+        lock_guard<mutex> lock(mutex_);
+        finished_ = true;
+        cond_.notify_all();
+    }
+
+    virtual void info(OperationInfo const&) noexcept override
+    {
+    }
+
+    int wait_until_finished()
+    {
+        unique_lock<mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return finished_; });
+        return count_;
+    }
+
+private:
+    int count_ = 0;
+    bool finished_ = false;
+    mutex mutex_;
+    condition_variable cond_;
+};
+
+void run_bench(string const& label, string const& zmq_ini)
+{
+    ZmqMiddleware server_mw("bench-server-" + label, nullptr, zmq_ini);
+    ZmqMiddleware client_mw("bench-client-" + label, nullptr, zmq_ini);
+    server_mw.start();
+    client_mw.start();
+    server_mw.add_scope_object("bench-scope-" + label, make_shared<BenchScopeObject>(), -1);
+
+    auto scope = client_mw.create_scope_proxy("bench-scope-" + label);
+    auto hints = SearchMetadata("en", "phone").serialize();
+    CannedQuery query("bench-scope-" + label);
+
+    vector<double> latencies;
+    latencies.reserve(num_queries);
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < num_queries; ++i)
+    {
+        auto query_start = chrono::steady_clock::now();
+        auto ro = make_shared<BenchReplyObject>();
+        auto reply = client_mw.add_reply_object(ro);
+        scope->search(query, hints, VariantMap(), reply);
+        ASSERT_EQ(results_per_query, ro->wait_until_finished());
+        latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - query_start).count());
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    sort(latencies.begin(), latencies.end());
+    cout << label << ": " << num_queries << " queries, " << results_per_query << " results each" << endl
+         << "    median latency: " << latencies[latencies.size() / 2] << " us" << endl
+         << "    99th percentile: " << latencies[latencies.size() * 99 / 100] << " us" << endl
+         << "    throughput: " << num_queries * results_per_query / elapsed << " results/s" << endl;
+
+    client_mw.stop();
+    server_mw.stop();
+    client_mw.wait_for_shutdown();
+    server_mw.wait_for_shutdown();
+}
+
+} // namespace
+
+TEST(DirectDispatch, zmq)
+{
+    run_bench("zmq", TEST_RUNTIME_PATH "/ZmqNoDirect.ini");
+}
+
+TEST(DirectDispatch, direct)
+{
+    run_bench("direct", TEST_RUNTIME_PATH "/Zmq.ini");
+}
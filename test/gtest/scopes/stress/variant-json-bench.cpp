@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares the throughput of the native Variant JSON codec with the json-glib
+// based JsonCppNode, using the recorded smart scopes traffic as the corpus.
+
+#include <unity/scopes/internal/JsonCppNode.h>
+#include <unity/scopes/internal/VariantJson.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+
+using namespace std;
+using namespace unity::scopes;
+using namespace unity::scopes::internal;
+
+namespace
+{
+
+int const iterations = 2000;
+
+vector<string> const& corpus()
+{
+    static vector<string> docs;
+    if (docs.empty())
+    {
+        for (auto const& name : { "search.jsonl", "preview.jsonl", "remote-scopes.json" })
+        {
+            ifstream in(string(CORPUS_DIR) + "/" + name);
+            string line;
+            while (getline(in, line))
+            {
+                if (!line.empty())
+                {
+                    docs.push_back(line);
+                }
+            }
+        }
+    }
+    return docs;
+}
+
+size_t corpus_size()
+{
+    size_t size = 0;
+    for (auto const& doc : corpus())
+    {
+        size += doc.size();
+    }
+    return size;
+}
+
+void report(string const& label, function<void()> const& run_once)
+{
+    run_once();  // Warm up
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        run_once();
+    }
+    auto secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    double const mb = double(corpus_size()) * iterations / (1024 * 1024);
+    cout << label << ": " << iterations << " passes over " << corpus().size() << " documents" << endl
+         << "    " << mb / secs << " MB/s, " << secs * 1e9 / (double(iterations) * corpus().size())
+         << " ns per document" << endl;
+}
+
+}  // namespace
+
+TEST(VariantJson, parse)
+{
+    ASSERT_FALSE(corpus().empty());
+
+    report("json-glib parse", []
+    {
+        for (auto const& doc : corpus())
+        {
+            JsonCppNode(doc).to_variant();
+        }
+    });
+    report("native parse", []
+    {
+        for (auto const& doc : corpus())
+        {
+            json_to_variant(doc);
+        }
+    });
+}
+
+TEST(VariantJson, serialize)
+{
+    vector<Variant> vars;
+    for (auto const& doc : corpus())
+    {
+        vars.push_back(json_to_variant(doc));
+    }
+    ASSERT_FALSE(vars.empty());
+
+    report("json-glib serialize", [&vars]
+    {
+        for (auto const& v : vars)
+        {
+            JsonCppNode(v).to_json_string();
+        }
+    });
+    string buf;
+    report("native serialize", [&vars, &buf]
+    {
+        for (auto const& v : vars)
+        {
+            buf.clear();
+            variant_to_json(v, buf);
+        }
+    });
+}
@@ -0,0 +1,450 @@
+/*
+ * Copyright (C) 2016 Canonical Ltd
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <unity/scopes/testing/Benchmark.h>
+#include <unity/scopes/testing/InProcessBenchmark.h>
+
+#include <unity/scopes/CategorisedResult.h>
+#include <unity/scopes/CategoryRenderer.h>
+#include <unity/scopes/ScopeBase.h>
+#include <unity/scopes/SearchReply.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wctor-dtor-privacy"
+#include <gtest/gtest.h>
+#pragma GCC diagnostic pop
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+// Tests for the parts of the benchmarking API that do not depend on the speed of the machine
+// (or depend on it only loosely). The statistical benchmark tests are in IsolatedScopeBenchmark.
+
+namespace
+{
+
+typedef unity::scopes::testing::Benchmark::Result::Timing::Seconds Seconds;
+
+const std::string scope_id{"does.not.exist.scope"};
+const std::string default_locale{"C"};
+const std::string default_form_factor{"SuperDuperPhablet"};
+
+const std::string result_file{TEST_DIR "/test.result"};
+
+// Each search runs for the time returned by latency(n), where n counts the searches (from 0).
+// Pushes a single result half-way through. Unlike testing::Scope, safe to use from several
+// threads at once.
+
+struct LatencyScope : public unity::scopes::ScopeBase
+{
+    typedef std::function<std::chrono::milliseconds(unsigned)> Latency;
+
+    struct Query : public unity::scopes::SearchQueryBase
+    {
+        Query(unity::scopes::CannedQuery const& query,
+              unity::scopes::SearchMetadata const& metadata,
+              std::chrono::milliseconds const& delay)
+            : unity::scopes::SearchQueryBase(query, metadata),
+              delay(delay)
+        {
+        }
+
+        void cancelled() override
+        {
+        }
+
+        void run(unity::scopes::SearchReplyProxy const& reply) override
+        {
+            std::this_thread::sleep_for(delay / 2);
+            auto cat = reply->register_category("cat", "Category", "", unity::scopes::CategoryRenderer());
+            unity::scopes::CategorisedResult result(cat);
+            result.set_uri("uri");
+            reply->push(result);
+            std::this_thread::sleep_for(delay / 2);
+        }
+
+        std::chrono::milliseconds delay;
+    };
+
+    explicit LatencyScope(Latency const& latency)
+        : latency(latency)
+    {
+    }
+
+    unity::scopes::SearchQueryBase::UPtr search(
+            unity::scopes::CannedQuery const& query,
+            unity::scopes::SearchMetadata const& metadata) override
+    {
+        return unity::scopes::SearchQueryBase::UPtr{new Query(query, metadata, latency(count++))};
+    }
+
+    unity::scopes::PreviewQueryBase::UPtr preview(
+            unity::scopes::Result const&,
+            unity::scopes::ActionMetadata const&) override
+    {
+        return nullptr;
+    }
+
+    Latency latency;
+    std::atomic<unsigned> count{0};
+};
+
+std::shared_ptr<LatencyScope> fixed_latency_scope(std::chrono::milliseconds const& latency)
+{
+    return std::make_shared<LatencyScope>([latency](unsigned) { return latency; });
+}
+
+unity::scopes::testing::Benchmark::QueryConfiguration query_configuration()
+{
+    unity::scopes::CannedQuery query{scope_id};
+    query.set_query_string("test");
+
+    unity::scopes::SearchMetadata meta_data{default_locale, default_form_factor};
+
+    unity::scopes::testing::Benchmark::QueryConfiguration config;
+    config.sampler = [query, meta_data]()
+    {
+        return std::make_pair(query, meta_data);
+    };
+    config.trial_configuration.trial_count = 10;
+    return config;
+}
+
+bool none_available(unity::scopes::testing::Benchmark::CounterResult const& counters)
+{
+    return !counters.cycles.available
+        && !counters.instructions.available
+        && !counters.cache_misses.available
+        && !counters.context_switches.available
+        && !counters.page_faults.available;
+}
+
+// Makes perf_event_open() fail with EACCES for the calling process, the way it does
+// with a restrictive perf_event_paranoid setting or inside a container.
+bool deny_perf_event_open()
+{
+    struct sock_filter filter[] =
+    {
+        BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(struct seccomp_data, nr)),
+        BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_perf_event_open, 0, 1),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | (EACCES & SECCOMP_RET_DATA)),
+        BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW),
+    };
+    struct sock_fprog program =
+    {
+        static_cast<unsigned short>(sizeof(filter) / sizeof(filter[0])),
+        filter
+    };
+
+    return ::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0
+        && ::prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) == 0;
+}
+
+unity::scopes::testing::Benchmark::LoadConfiguration load_configuration()
+{
+    unity::scopes::CannedQuery query{scope_id};
+    query.set_query_string("test");
+
+    unity::scopes::SearchMetadata meta_data{default_locale, default_form_factor};
+
+    unity::scopes::testing::Benchmark::LoadConfiguration config;
+    config.sampler = [query, meta_data]()
+    {
+        return std::make_pair(query, meta_data);
+    };
+    config.client_count = 4;
+    config.warm_up = std::chrono::milliseconds{100};
+    config.duration = std::chrono::seconds{1};
+    return config;
+}
+
+// A benchmark written against the interface as it was before load tests and counters were added.
+
+struct LegacyBenchmark : public unity::scopes::testing::Benchmark
+{
+    Result for_query(const std::shared_ptr<unity::scopes::ScopeBase>&, QueryConfiguration) override
+    {
+        return Result{};
+    }
+
+    Result for_preview(const std::shared_ptr<unity::scopes::ScopeBase>&, PreviewConfiguration) override
+    {
+        return Result{};
+    }
+
+    Result for_activation(const std::shared_ptr<unity::scopes::ScopeBase>&, ActivationConfiguration) override
+    {
+        return Result{};
+    }
+
+    Result for_action(const std::shared_ptr<unity::scopes::ScopeBase>&, ActionConfiguration) override
+    {
+        return Result{};
+    }
+};
+
+}
+
+TEST(BenchmarkResult, saving_and_loading_load_results_works)
+{
+    std::remove(result_file.c_str());
+
+    unity::scopes::testing::Benchmark::LoadResult reference;
+    reference.result.sample_size = 100;
+    reference.result.timing.sample.assign(100, Seconds{0.1});
+    reference.client_count = 8;
+    reference.duration = Seconds{10};
+    reference.completed = 100;
+    reference.failed = 2;
+    reference.throughput = 10;
+    reference.latency.p50 = Seconds{0.1};
+    reference.latency.p999 = Seconds{0.5};
+    reference.time_to_first_result.p90 = Seconds{0.05};
+
+    {
+        std::ofstream out{result_file.c_str()};
+        ASSERT_NO_THROW(reference.save_to(out));
+    }
+
+    {
+        unity::scopes::testing::Benchmark::LoadResult result;
+        std::ifstream in{result_file.c_str()};
+        ASSERT_NO_THROW(result.load_from(in));
+        EXPECT_EQ(reference, result);
+    }
+
+    std::remove(result_file.c_str());
+
+    {
+        std::ofstream out{result_file.c_str()};
+        ASSERT_NO_THROW(reference.save_to_xml(out));
+    }
+
+    {
+        unity::scopes::testing::Benchmark::LoadResult result;
+        std::ifstream in{result_file.c_str()};
+        ASSERT_NO_THROW(result.load_from_xml(in));
+        EXPECT_EQ(reference, result);
+    }
+
+    std::remove(result_file.c_str());
+}
+
+TEST(BenchmarkResult, loading_version_0_results_works)
+{
+    unity::scopes::testing::Benchmark::Result result;
+    std::ifstream in{VERSION_0_RESULT_FILE};
+    ASSERT_NO_THROW(result.load_from_xml(in));
+
+    EXPECT_EQ(25u, result.sample_size);
+    EXPECT_EQ(25u, result.timing.sample.size());
+}
+
+TEST(BenchmarkResult, saving_and_loading_counters_works)
+{
+    std::remove(result_file.c_str());
+
+    unity::scopes::testing::Benchmark::CounterResult reference;
+    reference.result.sample_size = 100;
+    reference.cycles.available = true;
+    reference.cycles.mean = 123456;
+    reference.cycles.std_dev = 42;
+    reference.page_faults.available = true;
+    reference.page_faults.mean = 3;
+
+    {
+        std::ofstream out{result_file.c_str()};
+        ASSERT_NO_THROW(reference.save_to(out));
+    }
+
+    {
+        unity::scopes::testing::Benchmark::CounterResult result;
+        std::ifstream in{result_file.c_str()};
+        ASSERT_NO_THROW(result.load_from(in));
+        EXPECT_EQ(reference, result);
+        EXPECT_FALSE(result.instructions.available);
+    }
+
+    std::remove(result_file.c_str());
+
+    {
+        std::ofstream out{result_file.c_str()};
+        ASSERT_NO_THROW(reference.save_to_xml(out));
+    }
+
+    {
+        unity::scopes::testing::Benchmark::CounterResult result;
+        std::ifstream in{result_file.c_str()};
+        ASSERT_NO_THROW(result.load_from_xml(in));
+        EXPECT_EQ(reference, result);
+        EXPECT_EQ(42, result.cycles.std_dev);
+    }
+
+    std::remove(result_file.c_str());
+}
+
+// Counters may or may not be available here (perf_event_paranoid, virtual machine, seccomp),
+// so we only check that the benchmark works either way, and that the counts make sense if we get them.
+TEST(PerformanceCounters, sampled_if_available)
+{
+    unity::scopes::testing::InProcessBenchmark benchmark;
+
+    auto result = benchmark.for_query_with_counters(fixed_latency_scope(std::chrono::milliseconds{1}),
+                                                    query_configuration());
+    EXPECT_EQ(10u, result.result.sample_size);
+
+    if (result.instructions.available)
+    {
+        EXPECT_GT(result.instructions.mean, 0);
+    }
+    EXPECT_GE(result.context_switches.mean, 0);
+    EXPECT_GE(result.page_faults.std_dev, 0);
+}
+
+TEST(PerformanceCounters, not_supported_by_default)
+{
+    LegacyBenchmark benchmark;
+    EXPECT_THROW(benchmark.for_query_with_counters(fixed_latency_scope(std::chrono::milliseconds{1}),
+                                                   query_configuration()),
+                 std::logic_error);
+}
+
+TEST(PerformanceCounters, unavailable_counters_do_not_fail_the_benchmark)
+{
+    ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+
+    // The seccomp filter cannot be removed again, so we install it in a child process.
+    EXPECT_EXIT(
+    {
+        if (!deny_perf_event_open())
+        {
+            std::fprintf(stderr, "cannot install seccomp filter\n");
+            std::exit(2);
+        }
+
+        unity::scopes::testing::InProcessBenchmark benchmark;
+        auto result = benchmark.for_query_with_counters(fixed_latency_scope(std::chrono::milliseconds{1}),
+                                                        query_configuration());
+        std::exit(result.result.sample_size == 10u && none_available(result) ? 0 : 1);
+    }, ::testing::ExitedWithCode(0), "");
+}
+
+TEST(LoadBenchmark, closed_loop)
+{
+    unity::scopes::testing::InProcessBenchmark benchmark;
+    auto config = load_configuration();
+    // Without a warm-up period, every query the scope sees is measured.
+    config.warm_up = std::chrono::microseconds::zero();
+    auto scope = fixed_latency_scope(std::chrono::milliseconds{20});
+
+    auto result = benchmark.for_query_load(scope, config);
+
+    EXPECT_EQ(4u, result.client_count);
+    EXPECT_EQ(Seconds{1}, result.duration);
+    EXPECT_GT(result.completed, 0u);
+    EXPECT_EQ(scope->count.load(), result.completed + result.failed);
+    EXPECT_EQ(result.completed, result.result.sample_size);
+    EXPECT_EQ(result.completed, result.result.timing.sample.size());
+    EXPECT_DOUBLE_EQ(result.completed / result.duration.count(), result.throughput);
+
+    // The scope sleeps for 20ms, so no query can be faster than that.
+    EXPECT_GE(result.latency.p50, std::chrono::milliseconds{20});
+    EXPECT_LE(result.latency.p50, result.latency.p90);
+    EXPECT_LE(result.latency.p90, result.latency.p99);
+    EXPECT_LE(result.latency.p99, result.latency.p999);
+    EXPECT_GE(result.time_to_first_result.p50, std::chrono::milliseconds{10});
+    EXPECT_LE(result.time_to_first_result.p50, result.latency.p50);
+}
+
+TEST(LoadBenchmark, percentiles)
+{
+    // With a single client, the queries run in sequence, and every tenth query is slow.
+    auto scope = std::make_shared<LatencyScope>([](unsigned n)
+    {
+        return std::chrono::milliseconds{n % 10 == 9 ? 100 : 2};
+    });
+
+    unity::scopes::testing::InProcessBenchmark benchmark;
+    auto config = load_configuration();
+    config.client_count = 1;
+
+    config.warm_up = std::chrono::microseconds::zero();
+
+    auto result = benchmark.for_query_load(scope, config);
+    ASSERT_GE(result.completed, 10u);
+
+    // Nearest rank: at least one query in ten is slow, so more than one percent are.
+    // We only check lower bounds, which hold however slow the machine is.
+    EXPECT_GE(result.latency.p50, std::chrono::milliseconds{2});
+    EXPECT_LE(result.latency.p50, result.latency.p90);
+    EXPECT_LE(result.latency.p90, result.latency.p99);
+    EXPECT_LE(result.latency.p99, result.latency.p999);
+    EXPECT_GE(result.latency.p99, std::chrono::milliseconds{100});
+    EXPECT_GE(result.time_to_first_result.p99, std::chrono::milliseconds{50});
+}
+
+TEST(LoadBenchmark, open_loop)
+{
+    unity::scopes::testing::InProcessBenchmark benchmark;
+    auto config = load_configuration();
+    config.target_qps = 40;
+
+    auto result = benchmark.for_query_load(fixed_latency_scope(std::chrono::milliseconds{10}), config);
+
+    // The schedule does not depend on how long the queries take: each of the four clients
+    // starts a query every 100ms, so ten of them fall into the one-second measurement interval.
+    EXPECT_EQ(40u, result.completed + result.failed);
+}
+
+TEST(LoadBenchmark, misconfiguration)
+{
+    unity::scopes::testing::InProcessBenchmark benchmark;
+    auto scope = fixed_latency_scope(std::chrono::milliseconds{10});
+
+    auto config = load_configuration();
+    config.client_count = 0;
+    EXPECT_THROW(benchmark.for_query_load(scope, config), std::logic_error);
+
+    config = load_configuration();
+    config.sampler = nullptr;
+    EXPECT_THROW(benchmark.for_query_load(scope, config), std::logic_error);
+
+    config = load_configuration();
+    config.target_qps = -1;
+    EXPECT_THROW(benchmark.for_query_load(scope, config), std::logic_error);
+
+    config = load_configuration();
+    config.duration = std::chrono::microseconds::zero();
+    EXPECT_THROW(benchmark.for_query_load(scope, config), std::logic_error);
+}
+
+TEST(LoadBenchmark, not_supported_by_default)
+{
+    LegacyBenchmark benchmark;
+    EXPECT_THROW(benchmark.for_query_load(fixed_latency_scope(std::chrono::milliseconds{10}), load_configuration()),
+                 std::logic_error);
+}
@@ -27,6 +27,9 @@
 #include <unity/scopes/testing/Category.h>
 #include <unity/UnityExceptions.h>
 
+#include <atomic>
+#include <thread>
+
 using namespace unity::scopes;
 using namespace unity::scopes::utility;
 using namespace unity::scopes::internal;
@@ -45,6 +48,14 @@ class SearchReceiver : public BufferedResultForwarder
         {
         }
 
+        SearchReceiver(unity::scopes::SearchReplyProxy const& upstream,
+                       std::chrono::milliseconds budget,
+                       std::string const& child_id,
+                       BufferedResultForwarder::SPtr const& next_forwarder = BufferedResultForwarder::SPtr())
+            : BufferedResultForwarder(upstream, budget, child_id, next_forwarder)
+        {
+        }
+
         void push(CategorisedResult result) override
         {
             upstream()->push(result);
@@ -66,6 +77,14 @@ class SearchReceiverWithoutSetReady : public BufferedResultForwarder
         {
         }
 
+        SearchReceiverWithoutSetReady(unity::scopes::SearchReplyProxy const& upstream,
+                                      std::chrono::milliseconds budget,
+                                      std::string const& child_id,
+                                      BufferedResultForwarder::SPtr const& next_forwarder = BufferedResultForwarder::SPtr())
+            : BufferedResultForwarder(upstream, budget, child_id, next_forwarder)
+        {
+        }
+
         void push(CategorisedResult result) override
         {
             // never call set_ready()
@@ -319,6 +338,147 @@ TEST(BufferedResultForwarder, no_results_from_first_scope)
     base1->finished(status);
 }
 
+TEST(BufferedResultForwarder, budget_met)
+{
+    const unity::scopes::CategoryRenderer renderer{};
+
+    NiceMock<unity::scopes::testing::MockSearchReply> reply;
+    unity::scopes::SearchReplyProxy upstream
+    {
+        &reply, [](unity::scopes::SearchReply*) {}
+    };
+
+    auto fwd2 = std::make_shared<SearchReceiver>(upstream);
+    auto fwd1 = std::make_shared<SearchReceiver>(upstream, std::chrono::seconds(10), "scope1", fwd2);
+
+    SearchListenerBase::SPtr base2 = fwd2;
+    SearchListenerBase::SPtr base1 = fwd1;
+
+    EXPECT_CALL(reply, info(_)).Times(0);
+    {
+        InSequence s;
+        EXPECT_CALL(reply, push(Matcher<unity::scopes::CategorisedResult const&>(ResultProp("title", "scope1")))).Times(2);
+        EXPECT_CALL(reply, push(Matcher<unity::scopes::CategorisedResult const&>(ResultProp("title", "scope2")))).Times(2);
+    }
+
+    Category::SCPtr cat2 = std::make_shared<unity::scopes::testing::Category>("scope2cat", "Scope2", "", renderer);
+    push_results(cat2, "scope2", "scope2", 2, base2);
+
+    Category::SCPtr cat1 = std::make_shared<unity::scopes::testing::Category>("scope1cat", "Scope1", "", renderer);
+    push_results(cat1, "scope1", "scope1", 2, base1);
+
+    CompletionDetails status(CompletionDetails::CompletionStatus::OK);
+    base1->finished(status);
+    base2->finished(status);
+}
+
+TEST(BufferedResultForwarder, budget_expired)
+{
+    const unity::scopes::CategoryRenderer renderer{};
+
+    NiceMock<unity::scopes::testing::MockSearchReply> reply;
+    unity::scopes::SearchReplyProxy upstream
+    {
+        &reply, [](unity::scopes::SearchReply*) {}
+    };
+
+    // fwd1 doesn't become ready within its budget, so results from fwd2 go first
+    auto fwd2 = std::make_shared<SearchReceiver>(upstream);
+    auto fwd1 = std::make_shared<SearchReceiverWithoutSetReady>(upstream, std::chrono::milliseconds(50), "scope1", fwd2);
+
+    SearchListenerBase::SPtr base2 = fwd2;
+    SearchListenerBase::SPtr base1 = fwd1;
+
+    {
+        InSequence s;
+        EXPECT_CALL(reply, info(Property(&OperationInfo::code, OperationInfo::ResultsIncomplete))).Times(1);
+        EXPECT_CALL(reply, push(Matcher<unity::scopes::CategorisedResult const&>(ResultProp("title", "scope2")))).Times(2);
+        EXPECT_CALL(reply, push(Matcher<unity::scopes::CategorisedResult const&>(ResultProp("title", "scope1")))).Times(2);
+    }
+
+    Category::SCPtr cat2 = std::make_shared<unity::scopes::testing::Category>("scope2cat", "Scope2", "", renderer);
+    push_results(cat2, "scope2", "scope2", 2, base2);
+    EXPECT_TRUE(fwd2->is_ready());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    // Late results from scope1 are appended
+    Category::SCPtr cat1 = std::make_shared<unity::scopes::testing::Category>("scope1cat", "Scope1", "", renderer);
+    push_results(cat1, "scope1", "scope1", 2, base1);
+    EXPECT_FALSE(fwd1->is_ready());
+
+    CompletionDetails status(CompletionDetails::CompletionStatus::OK);
+    base1->finished(status);
+    EXPECT_TRUE(fwd1->is_ready());
+    base2->finished(status);
+}
+
+TEST(BufferedResultForwarder, budget_expired_before_end_of_chain)
+{
+    const unity::scopes::CategoryRenderer renderer{};
+
+    NiceMock<unity::scopes::testing::MockSearchReply> reply;
+    unity::scopes::SearchReplyProxy upstream
+    {
+        &reply, [](unity::scopes::SearchReply*) {}
+    };
+
+    auto fwd3 = std::make_shared<SearchReceiverWithoutSetReady>(upstream);
+    auto fwd2 = std::make_shared<SearchReceiverWithoutSetReady>(upstream, fwd3);
+    auto fwd1 = std::make_shared<SearchReceiverWithoutSetReady>(upstream, std::chrono::milliseconds(50), "scope1", fwd2);
+
+    SearchListenerBase::SPtr base3 = fwd3;
+    SearchListenerBase::SPtr base2 = fwd2;
+    SearchListenerBase::SPtr base1 = fwd1;
+
+    {
+        InSequence s;
+        EXPECT_CALL(reply, info(Property(&OperationInfo::code, OperationInfo::ResultsIncomplete))).Times(1);
+        EXPECT_CALL(reply, push(Matcher<unity::scopes::CategorisedResult const&>(ResultProp("title", "scope2")))).Times(1);
+        EXPECT_CALL(reply, push(Matcher<unity::scopes::CategorisedResult const&>(ResultProp("title", "scope3")))).Times(1);
+        EXPECT_CALL(reply, push(Matcher<unity::scopes::CategorisedResult const&>(ResultProp("title", "scope1")))).Times(1);
+    }
+
+    Category::SCPtr cat = std::make_shared<unity::scopes::testing::Category>("cat", "Cat", "", renderer);
+    push_results(cat, "scope1", "scope1", 1, base1);
+    push_results(cat, "scope2", "scope2", 1, base2);
+    push_results(cat, "scope3", "scope3", 1, base3);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+
+    // fwd1 becomes ready after its budget expired, but before the last forwarder
+    // is ready, so its results are held back until then.
+    CompletionDetails status(CompletionDetails::CompletionStatus::OK);
+    base1->finished(status);
+    base2->finished(status);
+    base3->finished(status);
+}
+
+TEST(BufferedResultForwarder, destroyed_while_budget_expires)
+{
+    NiceMock<unity::scopes::testing::MockSearchReply> reply;
+    unity::scopes::SearchReplyProxy upstream
+    {
+        &reply, [](unity::scopes::SearchReply*) {}
+    };
+
+    // The info message for the expired budget is slow; destroying the forwarder
+    // while it is being sent waits for it to complete.
+    std::atomic<bool> info_sent(false);
+    EXPECT_CALL(reply, info(Property(&OperationInfo::code, OperationInfo::ResultsIncomplete)))
+        .WillOnce(InvokeWithoutArgs([&info_sent]
+                                    {
+                                        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+                                        info_sent = true;
+                                    }));
+
+    auto fwd = std::make_shared<SearchReceiverWithoutSetReady>(upstream, std::chrono::milliseconds(20), "scope1");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_FALSE(info_sent);
+    fwd.reset();
+    EXPECT_TRUE(info_sent);
+}
+
 TEST(BufferedResultForwarder, exceptions)
 {
     NiceMock<unity::scopes::testing::MockSearchReply> reply;
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+#
+# Copyright (C) 2016 Canonical Ltd
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License version 3 as
+# published by the Free Software Foundation.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Merges the *.trace files written by the scopes run-time (see Trace.Dir in the
+# runtime config) into a single file in Chrome trace format, which can be loaded
+# into chrome://tracing or https://ui.perfetto.dev.
+#
+# Each span becomes a complete event. A flow arrow links each span to its parent,
+# so a request can be followed from the shell through the registry into the scopes
+# (and their subsearches).
+
+import argparse, json, os, sys
+from glob import glob
+
+def read_spans(paths):
+    spans = []
+    for path in paths:
+        with open(path) as f:
+            for lineno, line in enumerate(f, 1):
+                line = line.strip()
+                if not line:
+                    continue
+                try:
+                    spans.append(json.loads(line))
+                except ValueError:
+                    # A process that was killed may have left a partial last line.
+                    print('%s:%d: ignoring malformed span' % (path, lineno), file=sys.stderr)
+    return spans
+
+def to_chrome(spans):
+    events = []
+    by_id = {}
+    for s in spans:
+        by_id[(s['trace'], s['span'])] = s
+        events.append({'name': s['name'],
+                       'cat': s['process'],
+                       'ph': 'X',
+                       'ts': s['ts'],
+                       'dur': s['dur'],
+                       'pid': s['pid'],
+                       'tid': s['tid'],
+                       'args': {'trace': s['trace'],
+                                'span': s['span'],
+                                'parent': s['parent'],
+                                'target': s['target']}})
+    flow_id = 0
+    for s in spans:
+        parent = by_id.get((s['trace'], s['parent']))
+        if parent is None:
+            continue
+        flow_id += 1
+        events.append({'name': 'call', 'cat': 'flow', 'ph': 's', 'id': flow_id,
+                       'ts': parent['ts'], 'pid': parent['pid'], 'tid': parent['tid']})
+        events.append({'name': 'call', 'cat': 'flow', 'ph': 'f', 'bp': 'e', 'id': flow_id,
+                       'ts': s['ts'], 'pid': s['pid'], 'tid': s['tid']})
+    pids = {}
+    for s in spans:
+        pids[s['pid']] = s['process']
+    for pid, process in pids.items():
+        events.append({'name': 'process_name', 'ph': 'M', 'pid': pid, 'args': {'name': process}})
+    return {'traceEvents': events, 'displayTimeUnit': 'ms'}
+
+def main():
+    parser = argparse.ArgumentParser(description='Merge scope trace files into a Chrome trace.')
+    parser.add_argument('inputs', nargs='+', help='trace files, or directories containing *.trace files')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    parser.add_argument('-t', '--trace', help='only include spans of the trace with this (hex) ID')
+    args = parser.parse_args()
+
+    paths = []
+    for i in args.inputs:
+        if os.path.isdir(i):
+            paths += sorted(glob(os.path.join(i, '*.trace')))
+        else:
+            paths.append(i)
+    spans = read_spans(paths)
+    if args.trace:
+        trace_id = args.trace.lower().zfill(16)
+        spans = [s for s in spans if s['trace'] == trace_id]
+
+    result = to_chrome(spans)
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(result, f)
+    else:
+        json.dump(result, sys.stdout)
+        sys.stdout.write('\n')
+
+if __name__ == '__main__':
+    main()